@@ -0,0 +1,144 @@
+/**
+ * @file async_command_bus.h
+ * @brief Command bus that renders heavy commands on worker threads.
+ * @author Laurent Jiang
+ * @date 2026-02-26
+ */
+
+#pragma once
+
+#include "core/command_bus.h"
+#include "core/command_executor.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace gimp {
+class Layer;
+class ReplayableCommand;
+
+/*!
+ * @class AsyncCommandBus
+ * @brief CommandBus that can run replayable commands off the GUI thread.
+ *
+ * dispatch() stays synchronous. dispatchAsync() snapshots the layer and
+ * replays the command into a scratch copy on a CommandExecutor worker, so
+ * the live layer is never touched off the GUI thread and keeps rendering
+ * while the command runs. Commands on the same document run in dispatch
+ * order; a command queued behind another one on the same layer starts from
+ * its result.
+ *
+ * Finished commands are committed on the GUI thread by
+ * processCompletions(): the result is written into the layer, the command
+ * is recorded through the wrapped BasicCommandBus and a
+ * CommandCompletedEvent is published. Layers are versioned rather than
+ * locked: if the layer was edited while the command ran, the stale result
+ * is discarded and the command, along with every later one on the layer,
+ * is rendered again on a worker from a fresh snapshot of the current pixels.
+ */
+class AsyncCommandBus final : public CommandBus {
+  public:
+    /*! @brief Called from a worker thread when a result is ready. */
+    using CompletionNotifier = std::function<void()>;
+
+    /*!
+     * @brief Constructs a bus recording into the given history.
+     * @param history History manager that stores executed commands.
+     * @param threadCount Worker threads; 0 picks a count from the hardware.
+     */
+    explicit AsyncCommandBus(HistoryManager& history, std::size_t threadCount = 0);
+
+    /*! @brief Waits for running commands; uncommitted results are dropped. */
+    ~AsyncCommandBus() override;
+
+    AsyncCommandBus(const AsyncCommandBus&) = delete;
+    AsyncCommandBus& operator=(const AsyncCommandBus&) = delete;
+
+    void dispatch(std::shared_ptr<Command> command) override;
+    HistoryManager& history() override;
+    void beginTransaction() override;
+    void endTransaction() override;
+
+    /*!
+     * @brief Queues a command to render on a worker thread.
+     *
+     * Must be called on the GUI thread. The command is recorded when its
+     * result is committed, not as part of an open transaction.
+     * @param command Command to run; its layer must stay the same size until commit.
+     * @param orderKey Commands with the same key run in order, typically the
+     *        document; null uses the layer.
+     */
+    void dispatchAsync(std::shared_ptr<ReplayableCommand> command,
+                       const void* orderKey = nullptr);
+
+    /*!
+     * @brief Commits finished commands, in the order they finished.
+     *
+     * Must be called on the GUI thread, typically from the notifier.
+     * @return Number of commands committed.
+     */
+    std::size_t processCompletions();
+
+    /*!
+     * @brief Sets the callback run on a worker thread when a result is ready.
+     *
+     * The notifier should schedule processCompletions() on the GUI thread.
+     * Set it before the first dispatchAsync().
+     * @param notifier Thread-safe callback.
+     */
+    void setCompletionNotifier(CompletionNotifier notifier) { notifier_ = std::move(notifier); }
+
+    /*! @brief Blocks until every queued command finished, including reruns, and commits them. */
+    void waitIdle();
+
+    /*! @brief Returns the number of commands dispatched but not yet committed.
+     *  @return Pending command count.
+     */
+    [[nodiscard]] std::size_t pendingCount() const { return pendingCount_; }
+
+    /*! @brief Returns true while an asynchronous command targets the layer.
+     *  @param layer Layer to check.
+     *  @return True if a command on the layer is not yet committed.
+     */
+    [[nodiscard]] bool isPending(const Layer& layer) const;
+
+    /*! @brief Forwards to BasicCommandBus::setCoalesceWindow().
+     *  @param window Maximum gap between coalesced dispatches.
+     */
+    void setCoalesceWindow(std::chrono::milliseconds window) { bus_.setCoalesceWindow(window); }
+
+  private:
+    struct Job;
+
+    /// Asynchronous commands of one layer that are not committed yet.
+    struct PendingLayer {
+        std::uint64_t version = 0;              ///< Layer version the next result must apply to.
+        std::deque<std::shared_ptr<Job>> jobs;  ///< Uncommitted jobs in dispatch order.
+        const void* orderKey = nullptr;         ///< Executor key of the jobs.
+    };
+
+    /// Renders a job into a scratch layer; runs on a worker thread.
+    void render(const std::shared_ptr<Job>& job);
+
+    /// Writes a finished job into its layer and records it.
+    void commit(const std::shared_ptr<Job>& job);
+
+    /// Renders every uncommitted job of a layer again, starting from its current pixels.
+    void retry(PendingLayer& entry, Layer& layer);
+
+    BasicCommandBus bus_;                                     ///< Records commands.
+    std::unordered_map<const Layer*, PendingLayer> pending_;  ///< GUI thread only.
+    std::size_t pendingCount_ = 0;                            ///< GUI thread only.
+    std::mutex completedMutex_;                               ///< Guards completed_.
+    std::deque<std::shared_ptr<Job>> completed_;              ///< Finished, not committed.
+    CompletionNotifier notifier_;                             ///< Wakes the GUI thread.
+    CommandExecutor executor_;                                ///< Last member: joined first.
+};
+}  // namespace gimp
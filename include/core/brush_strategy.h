@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include "pixel_format.h"
+#include "simd_level.h"
+
 #include <algorithm>
 #include <cstdint>
 #include <memory>
@@ -14,6 +17,9 @@
 
 namespace gimp {
 
+class StrokeBuffer;
+struct Rect;
+
 /**
  * @brief Abstract strategy for brush dab rendering.
  *
@@ -28,7 +34,7 @@ class BrushStrategy {
 
     /**
      * @brief Renders a single brush dab at the given position.
-     * @param target Pointer to the target pixel buffer (RGBA, 4 bytes per pixel).
+     * @param target Pointer to the target pixel buffer (RGBA in pixelFormat()).
      * @param targetWidth Width of the target buffer in pixels.
      * @param targetHeight Height of the target buffer in pixels.
      * @param x Center X position for the dab.
@@ -46,10 +52,146 @@ class BrushStrategy {
                            std::uint32_t color,
                            float pressure) = 0;
 
+    /**
+     * @brief Renders a dab centered between pixels.
+     *
+     * Integer coordinates are pixel centers and render exactly like
+     * renderDab(). Mask brushes place the dab to the nearest quarter pixel;
+     * the stamp brush rounds to the nearest pixel.
+     *
+     * @param target Pointer to the target pixel buffer (RGBA in pixelFormat()).
+     * @param targetWidth Width of the target buffer in pixels.
+     * @param targetHeight Height of the target buffer in pixels.
+     * @param x Center X position for the dab.
+     * @param y Center Y position for the dab.
+     * @param size Brush diameter in pixels.
+     * @param color Base color in RGBA format (0xRRGGBBAA).
+     * @param pressure Pen pressure (0.0 to 1.0), affects opacity/size.
+     */
+    void renderSubpixelDab(std::uint8_t* target,
+                           int targetWidth,
+                           int targetHeight,
+                           float x,
+                           float y,
+                           int size,
+                           std::uint32_t color,
+                           float pressure)
+    {
+        renderDabRows(
+            target, targetWidth, targetHeight, x, y, size, color, pressure, 0, targetHeight);
+    }
+
+    /**
+     * @brief Renders the part of a dab that falls in a band of rows.
+     *
+     * Rendering a dab band by band writes the same bytes as rendering it
+     * whole. Calls for disjoint bands may run concurrently on one brush, as
+     * long as its settings do not change meanwhile.
+     *
+     * @param target Pointer to the target pixel buffer (RGBA in pixelFormat()).
+     * @param targetWidth Width of the target buffer in pixels.
+     * @param targetHeight Height of the target buffer in pixels.
+     * @param x Center X position for the dab.
+     * @param y Center Y position for the dab.
+     * @param size Brush diameter in pixels.
+     * @param color Base color in RGBA format (0xRRGGBBAA).
+     * @param pressure Pen pressure (0.0 to 1.0), affects opacity/size.
+     * @param firstRow First target row that may be written.
+     * @param endRow Row past the last one that may be written; at most targetHeight.
+     */
+    virtual void renderDabRows(std::uint8_t* target,
+                               int targetWidth,
+                               int targetHeight,
+                               float x,
+                               float y,
+                               int size,
+                               std::uint32_t color,
+                               float pressure,
+                               int firstRow,
+                               int endRow) = 0;
+
+    /**
+     * @brief Adds the coverage of a dab to a stroke buffer.
+     *
+     * Color and opacity are left out; they apply when the buffer is
+     * composited with compositeStroke().
+     *
+     * @param buffer Stroke buffer; the dab is clipped to its area.
+     * @param x Center X position for the dab.
+     * @param y Center Y position for the dab.
+     * @param size Brush diameter in pixels.
+     * @param pressure Pen pressure (0.0 to 1.0), scales the coverage.
+     */
+    void accumulateDab(StrokeBuffer& buffer, float x, float y, int size, float pressure);
+
+    /**
+     * @brief Adds the coverage of the part of a dab in a band of rows to a stroke buffer.
+     *
+     * Calls for disjoint bands may run concurrently, as for renderDabRows().
+     *
+     * @param buffer Stroke buffer; the dab is clipped to its area.
+     * @param x Center X position for the dab.
+     * @param y Center Y position for the dab.
+     * @param size Brush diameter in pixels.
+     * @param pressure Pen pressure (0.0 to 1.0), scales the coverage.
+     * @param firstRow First buffer row that may be written.
+     * @param endRow Row past the last one that may be written.
+     */
+    virtual void accumulateDabRows(StrokeBuffer& buffer,
+                                   float x,
+                                   float y,
+                                   int size,
+                                   float pressure,
+                                   int firstRow,
+                                   int endRow) = 0;
+
+    /**
+     * @brief Blends the coverage of a stroke buffer onto a target.
+     *
+     * Paints the color with its alpha scaled by the coverage of each pixel;
+     * the eraser lowers alpha instead. The target region must hold the
+     * pixels the stroke is drawn over.
+     *
+     * @param target Pointer to the target pixel buffer (RGBA in pixelFormat()).
+     * @param targetWidth Width of the target buffer in pixels.
+     * @param buffer Coverage of the stroke.
+     * @param region Region to blend; clipped to the buffer area.
+     * @param color Base color in RGBA format (0xRRGGBBAA); alpha is the stroke opacity.
+     */
+    virtual void compositeStroke(std::uint8_t* target,
+                                 int targetWidth,
+                                 const StrokeBuffer& buffer,
+                                 const Rect& region,
+                                 std::uint32_t color);
+
     /*! @brief Returns a unique identifier for this strategy type.
      *  @return Strategy type name.
      */
     [[nodiscard]] virtual const char* typeName() const = 0;
+
+    /*! @brief Sets the pixel format of the buffers passed to renderDab().
+     *  @param format Target buffer format (straight RGBA8 by default).
+     */
+    void setPixelFormat(PixelFormat format) { pixelFormat_ = format; }
+
+    /*! @brief Returns the pixel format dabs are rendered in.
+     *  @return Target buffer format.
+     */
+    [[nodiscard]] PixelFormat pixelFormat() const { return pixelFormat_; }
+
+    /*! @brief Limits the instruction set used for 8-bit dabs (for testing).
+     *  @param level Highest level to use; lowered to what the CPU supports.
+     */
+    void setSimdLevel(SimdLevel level) { simdLevel_ = level; }
+
+    /*! @brief Returns the highest instruction set used for 8-bit dabs.
+     *  @return Requested SIMD level.
+     */
+    [[nodiscard]] SimdLevel simdLevel() const { return simdLevel_; }
+
+  protected:
+    PixelFormat pixelFormat_ = PixelFormat::Rgba8;  ///< Format of the target buffer.
+    SimdLevel simdLevel_ = detectSimdLevel();       ///< Highest dab kernel instruction set.
 };
 
 /**
@@ -68,6 +210,25 @@ class SolidBrush : public BrushStrategy {
                    std::uint32_t color,
                    float pressure) override;
 
+    void renderDabRows(std::uint8_t* target,
+                       int targetWidth,
+                       int targetHeight,
+                       float x,
+                       float y,
+                       int size,
+                       std::uint32_t color,
+                       float pressure,
+                       int firstRow,
+                       int endRow) override;
+
+    void accumulateDabRows(StrokeBuffer& buffer,
+                           float x,
+                           float y,
+                           int size,
+                           float pressure,
+                           int firstRow,
+                           int endRow) override;
+
     [[nodiscard]] const char* typeName() const override { return "solid"; }
 };
 
@@ -89,6 +250,25 @@ class SoftBrush : public BrushStrategy {
                    std::uint32_t color,
                    float pressure) override;
 
+    void renderDabRows(std::uint8_t* target,
+                       int targetWidth,
+                       int targetHeight,
+                       float x,
+                       float y,
+                       int size,
+                       std::uint32_t color,
+                       float pressure,
+                       int firstRow,
+                       int endRow) override;
+
+    void accumulateDabRows(StrokeBuffer& buffer,
+                           float x,
+                           float y,
+                           int size,
+                           float pressure,
+                           int firstRow,
+                           int endRow) override;
+
     [[nodiscard]] const char* typeName() const override { return "soft"; }
 
     /*! @brief Sets the brush hardness.
@@ -129,6 +309,25 @@ class StampBrush : public BrushStrategy {
                    std::uint32_t color,
                    float pressure) override;
 
+    void renderDabRows(std::uint8_t* target,
+                       int targetWidth,
+                       int targetHeight,
+                       float x,
+                       float y,
+                       int size,
+                       std::uint32_t color,
+                       float pressure,
+                       int firstRow,
+                       int endRow) override;
+
+    void accumulateDabRows(StrokeBuffer& buffer,
+                           float x,
+                           float y,
+                           int size,
+                           float pressure,
+                           int firstRow,
+                           int endRow) override;
+
     [[nodiscard]] const char* typeName() const override { return "stamp"; }
 
   private:
@@ -137,9 +336,79 @@ class StampBrush : public BrushStrategy {
     int stampHeight_ = 0;
 };
 
+/**
+ * @brief Eraser that lowers the alpha of the pixels under the dab.
+ *
+ * The color passed to renderDab() is ignored. Strength combines pressure,
+ * opacity and a linear edge falloff controlled by the hardness.
+ */
+class EraserBrush : public BrushStrategy {
+  public:
+    void renderDab(std::uint8_t* target,
+                   int targetWidth,
+                   int targetHeight,
+                   int x,
+                   int y,
+                   int size,
+                   std::uint32_t color,
+                   float pressure) override;
+
+    void renderDabRows(std::uint8_t* target,
+                       int targetWidth,
+                       int targetHeight,
+                       float x,
+                       float y,
+                       int size,
+                       std::uint32_t color,
+                       float pressure,
+                       int firstRow,
+                       int endRow) override;
+
+    void accumulateDabRows(StrokeBuffer& buffer,
+                           float x,
+                           float y,
+                           int size,
+                           float pressure,
+                           int firstRow,
+                           int endRow) override;
+
+    /*! @brief Erases with the stroke coverage scaled by opacity(); color is ignored. */
+    void compositeStroke(std::uint8_t* target,
+                         int targetWidth,
+                         const StrokeBuffer& buffer,
+                         const Rect& region,
+                         std::uint32_t color) override;
+
+    [[nodiscard]] const char* typeName() const override { return "eraser"; }
+
+    /*! @brief Sets the eraser hardness.
+     *  @param hardness Value from 0.0 (soft edges) to 1.0 (hard edges).
+     */
+    void setHardness(float hardness) { hardness_ = std::clamp(hardness, 0.0F, 1.0F); }
+
+    /*! @brief Returns the current hardness.
+     *  @return Hardness value.
+     */
+    [[nodiscard]] float hardness() const { return hardness_; }
+
+    /*! @brief Sets the eraser opacity.
+     *  @param opacity Value from 0.0 (no effect) to 1.0 (full erase).
+     */
+    void setOpacity(float opacity) { opacity_ = std::clamp(opacity, 0.0F, 1.0F); }
+
+    /*! @brief Returns the current opacity.
+     *  @return Opacity value.
+     */
+    [[nodiscard]] float opacity() const { return opacity_; }
+
+  private:
+    float hardness_ = 0.5F;
+    float opacity_ = 1.0F;
+};
+
 /**
  * @brief Creates a BrushStrategy from a type name.
- * @param typeName The strategy type ("solid", "stamp").
+ * @param typeName The strategy type ("solid", "soft", "stamp", "eraser").
  * @return Unique pointer to the created strategy, or nullptr if unknown.
  */
 std::unique_ptr<BrushStrategy> createBrushStrategy(const char* typeName);
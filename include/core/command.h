@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
+
 namespace gimp {
+class UndoSwapFile;
 
 /*!
  * @class Command
@@ -22,5 +26,31 @@ class Command {
 
     /*! @brief Reverts the command. */
     virtual void undo() = 0;
+
+    /*! @brief Returns the bytes of undo/redo state held by the command.
+     *  @return Approximate memory footprint; 0 for commands without pixel state.
+     */
+    [[nodiscard]] virtual std::size_t byteSize() const { return 0; }
+
+    /*!
+     * @brief Pages the command's undo state out to a swap file.
+     *
+     * Only metadata stays in memory; the next apply() or undo() reads the
+     * state back. byteSize() then reports the resident part only.
+     * @param swap Swap file to write to.
+     * @return True if the state now lives in the swap file.
+     */
+    virtual bool spill(const std::shared_ptr<UndoSwapFile>& /*swap*/) { return false; }
+
+    /*!
+     * @brief Absorbs a command that was applied right after this one.
+     *
+     * On success this command undoes and redoes the effect of both, and
+     * @p next is discarded. Used to coalesce repeated edits (nudges,
+     * selection tweaks) into one history entry.
+     * @param next Command applied immediately after this one.
+     * @return True if @p next was merged.
+     */
+    virtual bool mergeWith(Command& /*next*/) { return false; }
 };
 }  // namespace gimp
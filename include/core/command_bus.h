@@ -7,10 +7,12 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 namespace gimp {
 class Command;
+class CompoundCommand;
 class HistoryManager;
 
 /*!
@@ -31,6 +33,41 @@ class CommandBus {
      *  @return Reference to the history manager.
      */
     virtual HistoryManager& history() = 0;
+
+    /*!
+     * @brief Starts grouping dispatched commands into one history entry.
+     *
+     * Commands dispatched until the matching endTransaction() are applied
+     * immediately but recorded together. Transactions nest; only the
+     * outermost one records.
+     */
+    virtual void beginTransaction() = 0;
+
+    /*!
+     * @brief Ends a transaction and records its commands as one undo step.
+     */
+    virtual void endTransaction() = 0;
+};
+
+/*!
+ * @class CommandTransaction
+ * @brief Scope guard that wraps a CommandBus transaction.
+ */
+class CommandTransaction {
+  public:
+    /*! @brief Begins a transaction on the bus.
+     *  @param bus Bus to group commands on.
+     */
+    explicit CommandTransaction(CommandBus& bus) : bus_{&bus} { bus_->beginTransaction(); }
+
+    /*! @brief Ends the transaction. */
+    ~CommandTransaction() { bus_->endTransaction(); }
+
+    CommandTransaction(const CommandTransaction&) = delete;
+    CommandTransaction& operator=(const CommandTransaction&) = delete;
+
+  private:
+    CommandBus* bus_;
 };
 
 /*!
@@ -47,8 +84,36 @@ class BasicCommandBus final : public CommandBus {
 
     void dispatch(std::shared_ptr<Command> command) override;
     HistoryManager& history() override;
+    void beginTransaction() override;
+    void endTransaction() override;
+
+    /*!
+     * @brief Sets how close together commands must be to be coalesced.
+     *
+     * A command dispatched within the window of the previous dispatch is
+     * offered to the newest history entry (see Command::mergeWith()), so
+     * bursts such as repeated nudges collapse into one undo step.
+     * @param window Maximum gap between dispatches; zero disables coalescing.
+     */
+    void setCoalesceWindow(std::chrono::milliseconds window) { coalesceWindow_ = window; }
+
+    /*! @brief Returns the coalescing window.
+     *  @return Maximum gap between coalesced dispatches.
+     */
+    [[nodiscard]] std::chrono::milliseconds coalesceWindow() const { return coalesceWindow_; }
+
+    /*! @brief Returns true while a transaction is open.
+     *  @return True between beginTransaction() and the matching endTransaction().
+     */
+    [[nodiscard]] bool inTransaction() const { return transactionDepth_ > 0; }
 
   private:
+    using Clock = std::chrono::steady_clock;
+
     HistoryManager* history_;
+    std::shared_ptr<CompoundCommand> transaction_;  ///< Commands of the open transaction.
+    int transactionDepth_ = 0;                      ///< Nesting level of open transactions.
+    std::chrono::milliseconds coalesceWindow_{0};   ///< Zero disables coalescing.
+    Clock::time_point lastDispatch_{};              ///< When the last command was recorded.
 };
 }  // namespace gimp
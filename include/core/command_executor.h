@@ -0,0 +1,82 @@
+/**
+ * @file command_executor.h
+ * @brief Worker pool that runs tasks off the GUI thread, ordered per key.
+ * @author Laurent Jiang
+ * @date 2026-02-26
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class CommandExecutor
+ * @brief Fixed pool of worker threads with per-key ordering.
+ *
+ * Tasks submitted under the same key run one at a time in submission
+ * order; tasks under different keys run in parallel. AsyncCommandBus keys
+ * tasks by document so the commands of one document never overtake each
+ * other.
+ */
+class CommandExecutor {
+  public:
+    /*! @brief Work item run on a worker thread; must not throw. */
+    using Task = std::function<void()>;
+
+    /*!
+     * @brief Starts the worker threads.
+     * @param threadCount Number of workers; 0 uses one less than the hardware
+     *        concurrency, leaving a core for the GUI thread.
+     */
+    explicit CommandExecutor(std::size_t threadCount = 0);
+
+    /*! @brief Runs the queued tasks to completion, then joins the workers. */
+    ~CommandExecutor();
+
+    CommandExecutor(const CommandExecutor&) = delete;
+    CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    /*!
+     * @brief Queues a task.
+     * @param key Ordering key; tasks with equal keys never run concurrently.
+     * @param task Work to run on a worker thread.
+     */
+    void submit(const void* key, Task task);
+
+    /*! @brief Blocks until every submitted task has finished. */
+    void waitIdle();
+
+    /*! @brief Returns the number of worker threads.
+     *  @return Worker count.
+     */
+    [[nodiscard]] std::size_t threadCount() const { return workers_.size(); }
+
+  private:
+    /// Tasks of one key; at most one of them runs at a time.
+    struct Strand {
+        std::deque<Task> tasks;
+        bool running = false;
+    };
+
+    void workerLoop();
+
+    std::mutex mutex_;                                 ///< Guards every member below.
+    std::condition_variable wake_;                     ///< Signals queued work or shutdown.
+    std::condition_variable idle_;                     ///< Signals that outstanding_ hit zero.
+    std::unordered_map<const void*, Strand> strands_;  ///< Queued tasks by key.
+    std::deque<const void*> ready_;                    ///< Keys with a task ready to run.
+    std::size_t outstanding_ = 0;                      ///< Tasks queued or running.
+    bool stopping_ = false;                            ///< Set by the destructor.
+    std::vector<std::thread> workers_;                 ///< Worker threads.
+};
+
+}  // namespace gimp
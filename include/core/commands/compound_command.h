@@ -0,0 +1,89 @@
+/**
+ * @file compound_command.h
+ * @brief Command grouping several commands into one undo step.
+ * @author Laurent Jiang
+ * @date 2026-02-25
+ */
+
+#pragma once
+
+#include "core/command.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gimp {
+
+/**
+ * @brief Macro command that applies its children in order and undoes them in reverse.
+ *
+ * Built by CommandBus transactions: each dispatched command is applied and
+ * added here, and the whole group becomes a single history entry. Adjacent
+ * children that support Command::mergeWith() are merged as they are added.
+ */
+class CompoundCommand : public Command {
+  public:
+    /**
+     * @brief Constructs an empty compound command.
+     * @param description Human-readable name of the operation.
+     */
+    explicit CompoundCommand(std::string description = {});
+
+    ~CompoundCommand() override = default;
+
+    /**
+     * @brief Adds a command that has already been applied.
+     * @param command Command to append; merged into the last child if possible.
+     */
+    void add(std::shared_ptr<Command> command);
+
+    /**
+     * @brief Re-applies every child in order.
+     */
+    void apply() override;
+
+    /**
+     * @brief Undoes every child in reverse order.
+     */
+    void undo() override;
+
+    /**
+     * @brief Returns the bytes held by all children.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /**
+     * @brief Pages out the state of every child.
+     * @return True if any child moved its state to the swap file.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
+    /**
+     * @brief Returns the child commands.
+     * @return Commands in the order they were applied.
+     */
+    [[nodiscard]] const std::vector<std::shared_ptr<Command>>& commands() const
+    {
+        return commands_;
+    }
+
+    /**
+     * @brief Returns true if no command was added.
+     * @return True when empty.
+     */
+    [[nodiscard]] bool empty() const { return commands_.empty(); }
+
+    /**
+     * @brief Returns the description of this command.
+     * @return Command description string.
+     */
+    [[nodiscard]] const std::string& description() const { return description_; }
+
+  private:
+    std::string description_;
+    std::vector<std::shared_ptr<Command>> commands_;
+};
+
+}  // namespace gimp
@@ -9,6 +9,8 @@
 
 #include "core/command.h"
 #include "core/selection_manager.h"
+#include "core/tile_buffer.h"
+#include "core/undo_swap_file.h"
 
 #include <QPainterPath>
 #include <QPoint>
@@ -47,10 +49,25 @@ class CropCommand : public Command {
      */
     void undo() override;
 
+    /**
+     * @brief Returns the bytes held only by the layer snapshots.
+     *
+     * Tiles shared with other snapshots, such as later history steps, are
+     * not counted, as for ReplayableCommand. Shared tiles kept in memory
+     * while the rest is spilled still count.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /**
+     * @brief Writes the layer snapshots to the swap file, one layer at a time.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
   private:
     struct LayerSnapshot {
         std::shared_ptr<Layer> layer;
-        std::vector<std::uint8_t> data;
+        TileBuffer tiles;      ///< Copy-on-write pixels, shares unchanged tiles with the layer.
+        SwappedTiles swapped;  ///< The pixels while spilled; tiles is empty then.
     };
 
     void captureBeforeState();
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "core/command.h"
+#include "core/compressed_buffer.h"
 
 #include <cstdint>
 #include <memory>
@@ -53,6 +54,17 @@ class DrawCommand : public Command {
      */
     void captureBeforeState();
 
+    /*!
+     * @brief Sets the before state from pixels saved by the caller.
+     *
+     * Lets tools that save pixels while drawing (see StrokeRecorder) skip
+     * restoring the layer just to capture it.
+     *
+     * @param pixels Pixels of the region clipped to the layer, in the layer
+     *               format, rows packed without padding.
+     */
+    void captureBeforeState(std::vector<std::uint8_t> pixels);
+
     /*!
      * @brief Captures the current state of the affected region (after state).
      *
@@ -60,19 +72,39 @@ class DrawCommand : public Command {
      */
     void captureAfterState();
 
+    /*!
+     * @brief Returns the bytes held by the captured before and after states.
+     *
+     * Both states are kept LZ4-compressed once captureAfterState() ran, the
+     * after state as a delta against the before state.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /*!
+     * @brief Writes the compressed states to the swap file.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
   private:
     std::shared_ptr<Layer> layer_;
     int regionX_;                            ///< Left edge of affected region.
     int regionY_;                            ///< Top edge of affected region.
     int regionWidth_;                        ///< Width of affected region.
     int regionHeight_;                       ///< Height of affected region.
-    std::vector<std::uint8_t> beforeState_;  ///< Pixel data before drawing.
-    std::vector<std::uint8_t> afterState_;   ///< Pixel data after drawing.
+    std::vector<std::uint8_t> beforeState_;  ///< Raw before pixels until captureAfterState().
+    CompressedBuffer before_;                ///< Compressed pixel data before drawing.
+    CompressedBuffer afterDelta_;            ///< Compressed XOR of after against before.
 
     /*!
      * @brief Updates pixel data from a saved state.
      * @param state The state buffer to restore from.
      */
     void updateState(const std::vector<std::uint8_t>& state);
+
+    /*!
+     * @brief Reads spilled states back into memory.
+     * @return False if they cannot be read.
+     */
+    bool faultIn();
 };
 }  // namespace gimp
@@ -0,0 +1,57 @@
+/**
+ * @file filter_command.h
+ * @brief Replayable filter application (blur, sharpen, ...).
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#pragma once
+
+#include "core/commands/replayable_command.h"
+
+#include <memory>
+
+namespace gimp {
+
+class Filter;
+
+/**
+ * @brief Applies a configured filter to a layer.
+ *
+ * The command keeps the filter, whose id and parameters fully describe the
+ * operation, and runs it again on redo or replay.
+ */
+class FilterCommand : public ReplayableCommand {
+  public:
+    /**
+     * @brief Constructs a filter command.
+     * @param layer Layer to filter.
+     * @param filter Filter with its parameters set; must not be changed afterwards.
+     */
+    FilterCommand(std::shared_ptr<Layer> layer, std::shared_ptr<Filter> filter);
+
+    void replay(Layer& target) const override;
+
+    [[nodiscard]] std::size_t replayCost() const override;
+
+    /**
+     * @brief Returns the filter the command runs.
+     * @return Configured filter.
+     */
+    [[nodiscard]] const std::shared_ptr<Filter>& filter() const { return filter_; }
+
+    /**
+     * @brief Returns whether the last replay succeeded.
+     * @return False if the filter reported an error.
+     */
+    [[nodiscard]] bool succeeded() const { return succeeded_; }
+
+  protected:
+    [[nodiscard]] std::size_t inputByteSize() const override { return 0; }
+
+  private:
+    std::shared_ptr<Filter> filter_;
+    mutable bool succeeded_ = false;
+};
+
+}  // namespace gimp
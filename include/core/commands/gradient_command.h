@@ -0,0 +1,124 @@
+/**
+ * @file gradient_command.h
+ * @brief Command that renders a gradient over a layer (undoable).
+ * @author Laurent Jiang
+ * @date 2026-02-23
+ */
+
+#pragma once
+
+#include "core/command.h"
+#include "core/tile_buffer.h"
+#include "core/undo_swap_file.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace gimp {
+
+class Layer;
+
+/**
+ * @brief Gradient mode enumeration.
+ */
+enum class GradientMode {
+    Linear,  ///< Linear gradient from start to end point
+    Radial   ///< Radial gradient from center point
+};
+
+/**
+ * @brief Parametric description of a gradient.
+ */
+struct GradientParams {
+    GradientMode mode = GradientMode::Linear;  ///< Linear or radial.
+    int startX = 0;                            ///< Start point (radial: center), X.
+    int startY = 0;                            ///< Start point (radial: center), Y.
+    int endX = 0;                              ///< End point (radial: on the rim), X.
+    int endY = 0;                              ///< End point (radial: on the rim), Y.
+    std::uint32_t startColor = 0;              ///< Color at the start point (RGBA).
+    std::uint32_t endColor = 0;                ///< Color at the end point (RGBA).
+};
+
+/**
+ * @brief Command that fills a whole layer with a gradient.
+ *
+ * A gradient overwrites every pixel of the layer, so storing its result
+ * would cost a full layer per step. The command keeps only the gradient
+ * parameters and renders them again on redo. The before state is a tiled
+ * snapshot that shares its tiles with the layer's own snapshot cache.
+ */
+class GradientCommand : public Command {
+  public:
+    /**
+     * @brief Constructs a gradient command.
+     * @param layer Layer to fill.
+     * @param params Gradient to render.
+     */
+    GradientCommand(std::shared_ptr<Layer> layer, const GradientParams& params);
+
+    ~GradientCommand() override = default;
+
+    /**
+     * @brief Captures the layer pixels before the gradient.
+     *
+     * Called by apply() if it was not called before.
+     */
+    void captureBeforeState();
+
+    /**
+     * @brief Renders the gradient into the layer.
+     */
+    void apply() override;
+
+    /**
+     * @brief Restores the pixels captured before the gradient.
+     */
+    void undo() override;
+
+    /**
+     * @brief Returns the bytes held by the before snapshot.
+     *
+     * Only tiles the snapshot holds alone are counted; tiles shared with
+     * other snapshots are freed by neither when one is dropped.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /**
+     * @brief Writes the before snapshot to the swap file.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
+    /**
+     * @brief Returns the rendered gradient.
+     * @return Gradient parameters.
+     */
+    [[nodiscard]] const GradientParams& params() const { return params_; }
+
+    /**
+     * @brief Renders a gradient over a whole layer.
+     *
+     * Colors are interpolated as straight RGBA8 and converted to the layer format.
+     *
+     * @param layer Layer to fill.
+     * @param params Gradient to render.
+     */
+    static void render(Layer& layer, const GradientParams& params);
+
+    /**
+     * @brief Interpolates between two colors.
+     * @param color1 First color (RGBA).
+     * @param color2 Second color (RGBA).
+     * @param t Interpolation factor (0.0 to 1.0).
+     * @return Interpolated color (RGBA).
+     */
+    static std::uint32_t lerpColor(std::uint32_t color1, std::uint32_t color2, float t);
+
+  private:
+    std::shared_ptr<Layer> layer_;
+    GradientParams params_;
+    TileBuffer before_;     ///< Copy-on-write pixels before the gradient.
+    SwappedTiles swapped_;  ///< The before pixels while spilled; before_ is empty then.
+    bool captured_ = false;
+};
+
+}  // namespace gimp
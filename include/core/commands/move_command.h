@@ -8,6 +8,7 @@
 #pragma once
 
 #include "core/command.h"
+#include "core/compressed_buffer.h"
 #include "core/selection_manager.h"
 
 #include <QPainterPath>
@@ -62,11 +63,33 @@ class MoveCommand : public Command {
      */
     void captureAfterState();
 
+    /**
+     * @brief Returns the bytes held by the captured before and after states.
+     *
+     * Both states are kept LZ4-compressed once captureAfterState() ran, the
+     * after state as a delta against the before state.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /**
+     * @brief Writes the compressed states to the swap file.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
+    /**
+     * @brief Merges a following move on the same layer into this one.
+     *
+     * The merged command covers the union of both regions and restores the
+     * pixels and selection from before this move on undo.
+     */
+    bool mergeWith(Command& next) override;
+
   private:
     std::shared_ptr<Layer> layer_;
     QRect affectedRegion_;                   ///< Bounding box of all changed pixels.
-    std::vector<std::uint8_t> beforeState_;  ///< Pixel data before move.
-    std::vector<std::uint8_t> afterState_;   ///< Pixel data after move.
+    std::vector<std::uint8_t> beforeState_;  ///< Raw before pixels until captureAfterState().
+    CompressedBuffer before_;                ///< Compressed pixel data before move.
+    CompressedBuffer afterDelta_;            ///< Compressed XOR of after against before.
 
     // Selection state tracking for complete undo/redo
     QPainterPath beforeSelectionPath_;                            ///< Selection path before move.
@@ -80,6 +103,18 @@ class MoveCommand : public Command {
      */
     void updateState(const std::vector<std::uint8_t>& state);
 
+    /**
+     * @brief Returns the affected region clipped to the layer.
+     * @return Clipped region; empty if it lies outside the layer.
+     */
+    [[nodiscard]] QRect clippedRegion() const;
+
+    /**
+     * @brief Reads spilled states back into memory.
+     * @return False if they cannot be read.
+     */
+    bool faultIn();
+
     /**
      * @brief Restores selection from saved state.
      * @param path The selection path to restore.
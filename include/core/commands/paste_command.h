@@ -8,6 +8,7 @@
 #pragma once
 
 #include "core/command.h"
+#include "core/undo_swap_file.h"
 
 #include <QImage>
 
@@ -36,8 +37,11 @@ class PasteCommand : public Command {
 
     void apply() override;
     void undo() override;
+    [[nodiscard]] std::size_t byteSize() const override;
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
 
   private:
+    bool faultIn();
     void captureBeforeState();
     void captureAfterState();
     void updateState(const std::vector<std::uint8_t>& state);
@@ -55,6 +59,11 @@ class PasteCommand : public Command {
     std::vector<std::uint8_t> beforeState_;
     std::vector<std::uint8_t> afterState_;
     std::vector<std::uint8_t> imageData_;
+
+    bool spilled_ = false;     ///< True while the buffers below hold the state.
+    SwapBlock swappedBefore_;  ///< beforeState_ while spilled.
+    SwapBlock swappedAfter_;   ///< afterState_ while spilled.
+    SwapBlock swappedImage_;   ///< imageData_ while spilled.
 };
 
 }  // namespace gimp
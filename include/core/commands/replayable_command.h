@@ -0,0 +1,160 @@
+/**
+ * @file replayable_command.h
+ * @brief Base for commands that store their inputs and re-render on demand.
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#pragma once
+
+#include "core/command.h"
+#include "core/pixel_format.h"
+#include "core/tile_buffer.h"
+#include "core/undo_swap_file.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace gimp {
+
+class Layer;
+
+/**
+ * @brief Command that keeps its inputs instead of the pixels it produced.
+ *
+ * A replayable command can render its effect onto any layer holding the
+ * pixels it started from (replay()). Undo needs those starting pixels: a
+ * command may keep them as a checkpoint, a copy-on-write snapshot of the
+ * layer taken before it ran. HistoryStack keeps checkpoints only every few
+ * commands of a run on the same layer and drops the others; undoing a
+ * command without one restores the nearest earlier checkpoint and replays
+ * the commands between it and the undone command.
+ */
+class ReplayableCommand : public Command {
+  public:
+    /**
+     * @brief Constructs a command on a layer.
+     * @param layer Layer the command renders into.
+     */
+    explicit ReplayableCommand(std::shared_ptr<Layer> layer);
+
+    ~ReplayableCommand() override = default;
+
+    /**
+     * @brief Takes the checkpoint if needed and renders the command into its layer.
+     *
+     * After adoptCheckpoint() the first call leaves the layer alone, since
+     * the effect was already rendered while the command was recorded.
+     */
+    void apply() override;
+
+    /**
+     * @brief Restores the checkpoint, if the command still holds one.
+     *
+     * Commands without a checkpoint are undone by HistoryStack, which
+     * replays them from an earlier checkpoint.
+     */
+    void undo() override;
+
+    /**
+     * @brief Returns the bytes held by the checkpoint plus the stored inputs.
+     *
+     * Only tiles the checkpoint holds alone are counted; tiles shared with
+     * neighbouring checkpoints are freed by neither when one is dropped.
+     */
+    [[nodiscard]] std::size_t byteSize() const override;
+
+    /**
+     * @brief Writes the checkpoint to the swap file.
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap) override;
+
+    /**
+     * @brief Renders the command's effect onto a layer.
+     *
+     * The result only matches the original when the target holds the pixels
+     * the command started from.
+     *
+     * @param target Layer to render into; same size and format as layer().
+     */
+    virtual void replay(Layer& target) const = 0;
+
+    /**
+     * @brief Estimates the work of one replay().
+     * @return Number of pixels processed.
+     */
+    [[nodiscard]] virtual std::size_t replayCost() const = 0;
+
+    /**
+     * @brief Snapshots the layer as the checkpoint.
+     *
+     * Called by the first apply() if no checkpoint was set before.
+     */
+    void captureCheckpoint();
+
+    /**
+     * @brief Sets the checkpoint for an effect that is already in the layer.
+     *
+     * Used by tools that render while recording the inputs.
+     *
+     * @param before Snapshot of the layer before the effect.
+     */
+    void adoptCheckpoint(TileBuffer before);
+
+    /**
+     * @brief Writes the checkpoint back into the layer.
+     * @return False if there is no checkpoint or it no longer fits the layer.
+     */
+    bool restoreCheckpoint();
+
+    /**
+     * @brief Frees the checkpoint; undo then depends on an earlier command.
+     */
+    void dropCheckpoint();
+
+    /**
+     * @brief Rebuilds the checkpoint from the previous command of the run.
+     *
+     * Replays @p previous from its checkpoint into a scratch layer, so that
+     * this command stays undoable once @p previous is discarded.
+     *
+     * @param previous Command that ran just before this one on the same layer.
+     * @return False if @p previous has no usable checkpoint.
+     */
+    bool rebaseOnto(const ReplayableCommand& previous);
+
+    /**
+     * @brief Returns true while the command holds a checkpoint.
+     * @return True if undo() restores the layer on its own.
+     */
+    [[nodiscard]] bool hasCheckpoint() const { return hasCheckpoint_; }
+
+    /**
+     * @brief Returns the layer the command renders into.
+     * @return Target layer.
+     */
+    [[nodiscard]] const std::shared_ptr<Layer>& layer() const { return layer_; }
+
+  protected:
+    /**
+     * @brief Returns the memory held by the stored inputs.
+     * @return Input bytes.
+     */
+    [[nodiscard]] virtual std::size_t inputByteSize() const = 0;
+
+  private:
+    /// Reads the checkpoint back from the swap file if it was spilled.
+    bool loadCheckpoint() const;
+
+    std::shared_ptr<Layer> layer_;
+    mutable TileBuffer checkpoint_;            ///< Pixels before the command.
+    mutable SwappedTiles swapped_;             ///< Checkpoint while spilled.
+    int width_ = 0;                            ///< Layer width at the checkpoint.
+    int height_ = 0;                           ///< Layer height at the checkpoint.
+    PixelFormat format_ = PixelFormat::Rgba8;  ///< Layer format at the checkpoint.
+    bool hasCheckpoint_ = false;               ///< Checkpoint held in memory or on disk.
+    bool captured_ = false;                    ///< A checkpoint was taken once.
+    bool rendered_ = false;                    ///< Effect already in the layer.
+};
+
+}  // namespace gimp
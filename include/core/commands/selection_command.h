@@ -56,6 +56,14 @@ class SelectionCommand : public Command {
      */
     void captureAfterState();
 
+    /**
+     * @brief Merges a following selection change into this one.
+     *
+     * The merged command restores this command's before state on undo and
+     * the other command's after state on redo.
+     */
+    bool mergeWith(Command& next) override;
+
     /**
      * @brief Returns the description of this command.
      * @return Command description string.
@@ -0,0 +1,118 @@
+/**
+ * @file stroke_command.h
+ * @brief Replayable paint stroke: brush settings plus the dabs it placed.
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#pragma once
+
+#include "core/commands/replayable_command.h"
+#include "core/stroke_interpolator.h"
+#include "core/tile_store.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gimp {
+
+class BrushStrategy;
+
+/**
+ * @brief Brush a stroke is rendered with.
+ */
+enum class StrokeBrush {
+    Solid,  ///< Hard circular dab (pencil).
+    Soft,   ///< Dab with hardness falloff (paintbrush).
+    Eraser  ///< Alpha-reducing dab (eraser).
+};
+
+/**
+ * @brief Brush settings shared by every dab of a stroke.
+ */
+struct StrokeParams {
+    StrokeBrush brush = StrokeBrush::Soft;  ///< Dab renderer.
+    int size = 10;                          ///< Dab diameter in pixels.
+    float hardness = 0.5F;                  ///< Edge hardness (Soft, Eraser).
+    float opacity = 1.0F;                   ///< Erase strength (Eraser).
+    std::uint32_t color = 0;                ///< Dab color as passed to the brush (RGBA).
+};
+
+/**
+ * @brief Paint stroke stored as brush settings and dab positions.
+ *
+ * A stroke of a few hundred dabs needs a few kilobytes instead of a copy of
+ * the pixels it covered. Tools record every dab exactly as rendered, sub-pixel
+ * position included. A replay accumulates them in a StrokeBuffer and
+ * composites it once, as the tools do, so on the starting pixels it
+ * reproduces the stroke bit for bit.
+ */
+class StrokeCommand : public ReplayableCommand {
+  public:
+    /**
+     * @brief Constructs a stroke.
+     * @param layer Layer the stroke paints on.
+     * @param params Brush settings.
+     * @param dabs Dabs in rendering order.
+     */
+    StrokeCommand(std::shared_ptr<Layer> layer,
+                  const StrokeParams& params,
+                  std::vector<StrokeDab> dabs);
+
+    void replay(Layer& target) const override;
+
+    [[nodiscard]] std::size_t replayCost() const override;
+
+    /**
+     * @brief Returns the brush settings.
+     * @return Stroke parameters.
+     */
+    [[nodiscard]] const StrokeParams& params() const { return params_; }
+
+    /**
+     * @brief Returns the recorded dabs.
+     * @return Dabs in rendering order.
+     */
+    [[nodiscard]] const std::vector<StrokeDab>& dabs() const { return dabs_; }
+
+    /**
+     * @brief Returns the bounds of all dabs, unclipped.
+     * @return Rectangle covering every pixel the stroke may touch.
+     */
+    [[nodiscard]] const Rect& bounds() const { return bounds_; }
+
+    /**
+     * @brief Returns the bounds of a single dab, unclipped.
+     * @param x Dab center X.
+     * @param y Dab center Y.
+     * @param size Dab diameter.
+     * @return Rectangle covering every pixel the dab may touch.
+     */
+    static Rect dabBounds(float x, float y, int size);
+
+    /**
+     * @brief Returns the bounds of a run of dabs, unclipped.
+     * @param dabs Dabs of one stroke; must not be empty.
+     * @param size Dab diameter.
+     * @return Union of dabBounds() over the dabs.
+     */
+    static Rect dabBounds(const std::vector<StrokeDab>& dabs, int size);
+
+    /**
+     * @brief Creates the brush strategy that renders the stroke's dabs.
+     * @param params Brush settings.
+     * @return Configured strategy.
+     */
+    static std::unique_ptr<BrushStrategy> createBrush(const StrokeParams& params);
+
+  protected:
+    [[nodiscard]] std::size_t inputByteSize() const override;
+
+  private:
+    StrokeParams params_;
+    std::vector<StrokeDab> dabs_;
+    Rect bounds_{0, 0, 0, 0};  ///< Union of dabBounds() over dabs_.
+};
+
+}  // namespace gimp
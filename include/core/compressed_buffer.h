@@ -0,0 +1,104 @@
+/**
+ * @file compressed_buffer.h
+ * @brief LZ4-compressed byte buffers for undo snapshots.
+ * @author Laurent Jiang
+ * @date 2026-02-21
+ */
+
+#pragma once
+
+#include "core/undo_swap_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class CompressedBuffer
+ * @brief Holds a byte buffer in LZ4-compressed form.
+ *
+ * Undo commands keep their before state compressed and their after state as a
+ * compressed XOR delta against it. Pixels a stroke did not touch XOR to zero,
+ * so the delta of a typical brush stroke compresses to a small fraction of the
+ * raw region. Buffers are only decompressed when undo or redo needs them.
+ * Inputs beyond the LZ4 block limit are stored uncompressed. The compressed
+ * bytes can be paged out to an UndoSwapFile with spill() and read back with
+ * load().
+ */
+class CompressedBuffer {
+  public:
+    CompressedBuffer() = default;
+
+    /*!
+     * @brief Compresses a buffer.
+     * @param data Bytes to compress.
+     * @return Compressed buffer; empty if data is empty.
+     */
+    static CompressedBuffer compress(const std::vector<std::uint8_t>& data);
+
+    /*!
+     * @brief Compresses the XOR difference between two equally sized buffers.
+     * @param base Reference buffer.
+     * @param target Buffer to encode relative to base.
+     * @return Compressed delta; empty if the sizes differ or are zero.
+     */
+    static CompressedBuffer compressDelta(const std::vector<std::uint8_t>& base,
+                                          const std::vector<std::uint8_t>& target);
+
+    /*!
+     * @brief Decompresses the buffer.
+     * @param out Receives the original bytes (resized to rawSize()).
+     * @return False if the buffer is empty, spilled or corrupted.
+     */
+    bool decompress(std::vector<std::uint8_t>& out) const;
+
+    /*!
+     * @brief Applies a delta made by compressDelta() to its base buffer.
+     * @param data Base buffer; becomes the target buffer on success.
+     * @return False if the buffer is empty, corrupted or sized differently.
+     */
+    bool applyDelta(std::vector<std::uint8_t>& data) const;
+
+    /*!
+     * @brief Moves the compressed bytes to a swap file.
+     * @param swap Swap file to write to.
+     * @return True if the bytes now live in the swap file (or already did).
+     */
+    bool spill(const std::shared_ptr<UndoSwapFile>& swap);
+
+    /*!
+     * @brief Reads spilled bytes back into memory and releases their swap space.
+     * @return True if the bytes are resident afterwards.
+     */
+    bool load();
+
+    /*! @brief Returns true while the compressed bytes live in a swap file.
+     *  @return True after a successful spill() until load().
+     */
+    [[nodiscard]] bool spilled() const { return m_spilled.size() > 0; }
+
+    /*! @brief Returns true if the buffer holds no data.
+     *  @return True when nothing was compressed.
+     */
+    [[nodiscard]] bool empty() const { return m_rawSize == 0; }
+
+    /*! @brief Returns the size of the decompressed data.
+     *  @return Uncompressed size in bytes.
+     */
+    [[nodiscard]] std::size_t rawSize() const { return m_rawSize; }
+
+    /*! @brief Returns the memory held by the compressed data.
+     *  @return Resident compressed size in bytes; 0 while spilled.
+     */
+    [[nodiscard]] std::size_t byteSize() const { return m_data.size(); }
+
+  private:
+    std::vector<char> m_data;   ///< LZ4 block, or the raw bytes if m_stored.
+    std::size_t m_rawSize = 0;  ///< Decompressed size in bytes.
+    bool m_stored = false;      ///< True if the data was too large for LZ4 and kept as is.
+    SwapBlock m_spilled;        ///< Compressed bytes while paged out.
+};
+
+}  // namespace gimp
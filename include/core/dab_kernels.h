@@ -0,0 +1,63 @@
+/**
+ * @file dab_kernels.h
+ * @brief RGBA8 brush dab row kernels with runtime SIMD dispatch.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ */
+
+#pragma once
+
+#include "core/simd_level.h"
+
+#include <cstdint>
+
+namespace gimp {
+
+/*!
+ * @enum DabOp
+ * @brief What a dab row kernel does to the pixels it covers.
+ */
+enum class DabOp {
+    Paint,               ///< Color over straight-alpha pixels.
+    PaintPremultiplied,  ///< Color over premultiplied pixels.
+    Erase,               ///< Alpha reduction of straight-alpha pixels.
+    ErasePremultiplied   ///< Reduction of all channels of premultiplied pixels.
+};
+
+/*!
+ * @brief Applies a dab to a row of RGBA8 pixels in place.
+ *
+ * Pixel i is covered with strength scale * coverage[i]. Painting blends the
+ * straight color (0xRRGGBBAA, alpha ignored) over the pixel with that
+ * strength as alpha (0-255); erasing removes that fraction (0-1) of the
+ * pixel's alpha and ignores color. Pixels with zero coverage are left
+ * untouched. All kernels of an operation produce identical bytes.
+ */
+using DabRowFn = void (*)(std::uint8_t* dst,
+                          const float* coverage,
+                          int count,
+                          std::uint32_t color,
+                          float scale);
+
+/*!
+ * @brief Returns the row kernel for a dab operation.
+ * @param op Dab operation.
+ * @param level Highest instruction set to use; lowered to what the CPU supports.
+ * @return Kernel function, never null.
+ */
+DabRowFn dabRowKernel(DabOp op, SimdLevel level);
+
+namespace detail {
+
+/// Portable kernel for an operation; also used for row tails by the SIMD kernels.
+DabRowFn scalarDabRow(DabOp op);
+
+/// SSE4.1 kernel for an operation, or nullptr if not built for x86.
+DabRowFn sse41DabRow(DabOp op);
+
+/// AVX2 kernel for an operation, or nullptr if not built for x86.
+DabRowFn avx2DabRow(DabOp op);
+
+}  // namespace detail
+
+}  // namespace gimp
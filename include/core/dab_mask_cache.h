@@ -0,0 +1,157 @@
+/**
+ * @file dab_mask_cache.h
+ * @brief Cache of precomputed brush dab coverage masks.
+ * @author Laurent Jiang
+ * @date 2026-02-27
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace gimp {
+
+/**
+ * @brief Coverage of one dab around its center pixel.
+ *
+ * Column i of row j covers the target pixel (x + left + i, y + top + j) for
+ * a dab centered on pixel (x, y). Zero coverage leaves the pixel untouched.
+ */
+struct DabMask {
+    int left = 0;                 ///< Offset of the first column from the center.
+    int top = 0;                  ///< Offset of the first row from the center.
+    int width = 0;                ///< Columns in the mask.
+    int height = 0;               ///< Rows in the mask.
+    std::vector<float> coverage;  ///< Row-major coverage in [0, 1].
+
+    /*! @brief Returns the coverage of a mask row.
+     *  @param row Row index in [0, height).
+     *  @return Pointer to width coverage values.
+     */
+    [[nodiscard]] const float* row(int row) const
+    {
+        return coverage.data() + static_cast<std::size_t>(row) * static_cast<std::size_t>(width);
+    }
+};
+
+/**
+ * @brief Process-wide cache of dab masks keyed on shape, size, hardness and sub-pixel offset.
+ *
+ * Soft dabs need a square root, a power and the falloff curve per pixel,
+ * eraser dabs a square root and a falloff, solid dabs a distance test. The
+ * cache evaluates them once per key, so rendering a dab is a blend of the
+ * brush color scaled by the mask.
+ * Sub-pixel offsets are quantized to 1/kSubpixelSteps of a pixel. Masks are
+ * evicted least recently used first once the byte budget is exceeded.
+ * Thread-safe; returned masks stay valid after eviction.
+ */
+class DabMaskCache {
+  public:
+    /*! @brief Sub-pixel positions per pixel along each axis. */
+    static constexpr int kSubpixelSteps = 4;
+
+    /*! @brief Default memory budget for cached masks. */
+    static constexpr std::size_t kDefaultByteBudget = std::size_t{32} * 1024 * 1024;
+
+    /*! @brief Returns the shared cache.
+     *  @return Reference to the process-wide cache.
+     */
+    static DabMaskCache& instance();
+
+    /**
+     * @brief Returns the mask of a hard-edged circular dab.
+     * @param size Brush diameter in pixels.
+     * @param offsetX Horizontal sub-pixel offset of the center, in [0, 1).
+     * @param offsetY Vertical sub-pixel offset of the center, in [0, 1).
+     * @return Mask with coverage 0 or 1.
+     */
+    std::shared_ptr<const DabMask> solid(int size, float offsetX = 0.0F, float offsetY = 0.0F);
+
+    /**
+     * @brief Returns the mask of a dab with GIMP-style falloff.
+     * @param size Brush diameter in pixels.
+     * @param hardness Hardness from 0.0 (soft) to 1.0 (hard).
+     * @param offsetX Horizontal sub-pixel offset of the center, in [0, 1).
+     * @param offsetY Vertical sub-pixel offset of the center, in [0, 1).
+     * @return Mask with the falloff as coverage.
+     */
+    std::shared_ptr<const DabMask> soft(int size,
+                                        float hardness,
+                                        float offsetX = 0.0F,
+                                        float offsetY = 0.0F);
+
+    /**
+     * @brief Returns the mask of an eraser dab with a linear edge falloff.
+     * @param size Eraser diameter in pixels.
+     * @param hardness Fraction of the radius erased at full strength.
+     * @param offsetX Horizontal sub-pixel offset of the center, in [0, 1).
+     * @param offsetY Vertical sub-pixel offset of the center, in [0, 1).
+     * @return Mask with the erase strength as coverage.
+     */
+    std::shared_ptr<const DabMask> eraser(int size,
+                                          float hardness,
+                                          float offsetX = 0.0F,
+                                          float offsetY = 0.0F);
+
+    /*! @brief Sets the memory budget and evicts masks beyond it.
+     *  @param bytes Maximum bytes held by cached masks.
+     */
+    void setByteBudget(std::size_t bytes);
+
+    /*! @brief Returns the bytes held by cached masks.
+     *  @return Cached coverage bytes.
+     */
+    [[nodiscard]] std::size_t byteSize() const;
+
+    /*! @brief Returns the number of cached masks.
+     *  @return Cached mask count.
+     */
+    [[nodiscard]] std::size_t count() const;
+
+    /*! @brief Drops every cached mask. */
+    void clear();
+
+  private:
+    DabMaskCache() = default;
+
+    enum class Shape : std::uint8_t { Solid, Soft, Eraser };
+
+    struct Key {
+        Shape shape = Shape::Solid;
+        int size = 0;
+        std::uint32_t hardness = 0;  ///< Bit pattern of the hardness.
+        int subX = 0;                ///< Quantized sub-pixel offset.
+        int subY = 0;                ///< Quantized sub-pixel offset.
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const DabMask> mask;
+    };
+
+    /// Returns the cached mask for the key, building it on a miss.
+    std::shared_ptr<const DabMask> lookup(const Key& key, float hardness);
+
+    /// Evicts least recently used masks until the budget holds; mutex_ held.
+    void evict();
+
+    mutable std::mutex mutex_;                                              ///< Guards the cache.
+    std::list<Entry> lru_;                                                  ///< Most recent first.
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> entries_;  ///< Index into lru_.
+    std::size_t bytes_ = 0;                                                 ///< Bytes in lru_.
+    std::size_t budget_ = kDefaultByteBudget;                               ///< Byte budget.
+};
+
+}  // namespace gimp
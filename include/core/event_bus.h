@@ -7,22 +7,58 @@
 
 #pragma once
 
-#include <any>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <typeindex>
-#include <unordered_map>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace gimp {
 
+/**
+ * @brief Event type whose newer instances replace queued older ones.
+ *
+ * An event opts in by defining `bool supersedes(const T& older) const`.
+ * EventBus::post() drops every queued event the new one supersedes, so a
+ * "latest wins" event returns true unconditionally.
+ */
+template <typename T>
+concept CoalescedEvent = requires(const T& newer, const T& older) {
+    { newer.supersedes(older) } -> std::convertible_to<bool>;
+};
+
 /**
  * @brief Type-safe event bus for decoupled component communication.
  *
  * Supports typed events where subscribers register handlers for specific
  * event types and publishers emit events that are delivered to all matching
  * subscribers.
+ *
+ * Each event type has its own channel holding an immutable subscriber list
+ * behind an atomic raw pointer. publish() loads the current list and calls
+ * the handlers directly: it takes no lock, touches no shared reference
+ * count, allocates nothing and does not box the event, so high-frequency
+ * events such as MousePositionChangedEvent stay cheap even when several
+ * threads publish. subscribe(), unsubscribe() and clear() copy the list,
+ * edit the copy and swap it in under a mutex. The old list is retired
+ * rather than freed: publishers still holding it finish delivering from it,
+ * and it is deleted by a later edit once no publisher can be reading it.
+ *
+ * Publishers announce themselves in a reader counter picked by thread, so
+ * threads rarely share a cache line, and by the parity of an epoch that
+ * every edit advances. A retired list is freed once both parities have been
+ * seen drained after it was swapped out. Edits never wait for publishers,
+ * so handlers may subscribe and unsubscribe.
+ *
+ * post() is the queued alternative to publish(): events wait per type until
+ * the next flush(), and CoalescedEvent types keep only the latest instance.
+ * The application flushes once per event-loop iteration (see
+ * setFlushScheduler()), so handlers of events posted at input rate run at
+ * most once per iteration.
  */
 class EventBus {
   public:
@@ -47,12 +83,14 @@ class EventBus {
     template <typename T>
     SubscriptionId subscribe(std::function<void(const T&)> handler)
     {
+        auto& typed = channel<T>();
         const std::scoped_lock lock(mutex_);
         auto id = nextId_++;
-        auto wrapper = [handler = std::move(handler)](const std::any& event) {
-            handler(std::any_cast<const T&>(event));
-        };
-        subscribers_[std::type_index(typeid(T))].push_back({id, std::move(wrapper)});
+        const auto* current = typed.subscribers.load(std::memory_order_acquire);
+        auto next = current ? std::make_unique<typename Channel<T>::List>(*current)
+                            : std::make_unique<typename Channel<T>::List>();
+        next->push_back({id, std::move(handler)});
+        typed.replace(*this, std::move(next));
         return id;
     }
 
@@ -63,54 +101,283 @@ class EventBus {
     void unsubscribe(SubscriptionId id)
     {
         const std::scoped_lock lock(mutex_);
-        for (auto& [type, subs] : subscribers_) {
-            std::erase_if(subs, [id](const Subscriber& s) { return s.id == id; });
+        for (const auto& channel : channels_) {
+            if (channel->remove(*this, id)) {
+                return;
+            }
         }
     }
 
     /**
      * @brief Publish an event to all subscribers of type T.
+     *
+     * Safe to call from any thread; handlers run on the calling thread.
      * @tparam T The event type.
      * @param event The event instance to publish.
      */
     template <typename T>
     void publish(const T& event)
     {
-        std::vector<std::function<void(const std::any&)>> handlers;
+        const ReadGuard guard(*this);
+        const auto* subscribers = channel<T>().subscribers.load(std::memory_order_seq_cst);
+        if (!subscribers) {
+            return;
+        }
+        for (const auto& subscriber : *subscribers) {
+            subscriber.handler(event);
+        }
+    }
+
+    /**
+     * @brief Queue an event of type T for the next flush().
+     *
+     * Safe to call from any thread. If T is a CoalescedEvent, queued events
+     * that @p event supersedes are dropped.
+     * @tparam T The event type.
+     * @param event The event instance to queue.
+     */
+    template <typename T>
+    void post(T event)
+    {
+        auto& typed = channel<T>();
+        bool schedule = false;
         {
-            const std::scoped_lock lock(mutex_);
-            auto it = subscribers_.find(std::type_index(typeid(T)));
-            if (it != subscribers_.end()) {
-                for (const auto& sub : it->second) {
-                    handlers.push_back(sub.handler);
-                }
+            const std::scoped_lock lock(queueMutex_);
+            if constexpr (CoalescedEvent<T>) {
+                std::erase_if(typed.queued,
+                              [&event](const T& older) { return event.supersedes(older); });
+            }
+            typed.queued.push_back(std::move(event));
+            if (!typed.dirty) {
+                typed.dirty = true;
+                dirty_.push_back(&typed);
             }
+            schedule = !flushScheduled_;
+            flushScheduled_ = true;
         }
-        for (const auto& handler : handlers) {
-            handler(event);
+        if (schedule && flushScheduler_) {
+            flushScheduler_();
         }
     }
 
     /**
-     * @brief Remove all subscribers (useful for testing).
+     * @brief Deliver every queued event, type by type, in the order posted.
+     *
+     * Handlers run on the calling thread. Events posted while flushing wait
+     * for the next flush().
+     */
+    void flush()
+    {
+        std::vector<ChannelBase*> dirty;
+        {
+            const std::scoped_lock lock(queueMutex_);
+            dirty.swap(dirty_);
+            flushScheduled_ = false;
+            for (auto* channel : dirty) {
+                channel->dirty = false;
+            }
+        }
+        for (auto* channel : dirty) {
+            channel->deliverQueued(*this);
+        }
+    }
+
+    /**
+     * @brief Set the callback asking the application to call flush() soon.
+     *
+     * Invoked by the first post() after a flush, possibly from another
+     * thread. Set it once at startup, before events are posted.
+     * @param scheduler Callback, typically queuing flush() on the event loop.
+     */
+    void setFlushScheduler(std::function<void()> scheduler)
+    {
+        flushScheduler_ = std::move(scheduler);
+    }
+
+    /**
+     * @brief Remove all subscribers and queued events (useful for testing).
      */
     void clear()
     {
-        const std::scoped_lock lock(mutex_);
-        subscribers_.clear();
+        const std::scoped_lock lock(mutex_, queueMutex_);
+        for (const auto& channel : channels_) {
+            channel->reset(*this);
+        }
+        dirty_.clear();
+        flushScheduled_ = false;
     }
 
   private:
     EventBus() = default;
 
-    struct Subscriber {
-        SubscriptionId id;
-        std::function<void(const std::any&)> handler;
+    /// Reader counters spread over cache lines; threads are hashed onto them.
+    static constexpr std::size_t kReaderSlots = 16;
+
+    /// Publishers currently reading a subscriber list, by epoch parity.
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::size_t> active[2] = {};
+    };
+
+    /// Counts the calling thread as a reader of the current epoch's parity while alive.
+    class ReadGuard {
+      public:
+        explicit ReadGuard(EventBus& bus)
+            : counter_(bus.readerSlot().active[bus.epoch_.load(std::memory_order_seq_cst) & 1])
+        {
+            counter_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~ReadGuard() { counter_.fetch_sub(1, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+      private:
+        std::atomic<std::size_t>& counter_;
+    };
+
+    /// Type-independent part of a channel, used by unsubscribe() and clear().
+    struct ChannelBase {
+        virtual ~ChannelBase() = default;
+        /// Removes a subscriber; returns true if it belonged to this channel.
+        virtual bool remove(EventBus& bus, SubscriptionId id) = 0;
+        /// Removes every subscriber and queued event; called with both mutexes held.
+        virtual void reset(EventBus& bus) = 0;
+        /// Delivers the queued events; takes queueMutex_ only to move them out.
+        virtual void deliverQueued(EventBus& bus) = 0;
+
+        bool dirty = false;  ///< Listed in dirty_; guarded by queueMutex_.
     };
 
-    std::mutex mutex_;
-    SubscriptionId nextId_ = 1;
-    std::unordered_map<std::type_index, std::vector<Subscriber>> subscribers_;
+    /// Subscribers of one event type. Lists are never modified once published.
+    template <typename T>
+    struct Channel final : ChannelBase {
+        struct Subscriber {
+            SubscriptionId id;
+            std::function<void(const T&)> handler;
+        };
+        using List = std::vector<Subscriber>;
+
+        /// A list swapped out while publishers may still be reading it.
+        struct Retired {
+            std::unique_ptr<const List> list;
+            bool drained[2] = {false, false};  ///< Parities seen without readers since.
+        };
+
+        ~Channel() override { delete subscribers.load(std::memory_order_acquire); }
+
+        /// Publishes @p next and frees retired lists no publisher can still read; mutex_ held.
+        void replace(EventBus& bus, std::unique_ptr<const List> next)
+        {
+            const List* old = subscribers.exchange(next.release(), std::memory_order_seq_cst);
+            if (old != nullptr) {
+                retired.push_back({std::unique_ptr<const List>(old)});
+            }
+            // New publishers count under the other parity, so the old one drains
+            bus.epoch_.fetch_add(1, std::memory_order_seq_cst);
+            const bool drained[2] = {bus.drained(0), bus.drained(1)};
+            std::erase_if(retired, [&drained](Retired& entry) {
+                entry.drained[0] = entry.drained[0] || drained[0];
+                entry.drained[1] = entry.drained[1] || drained[1];
+                return entry.drained[0] && entry.drained[1];
+            });
+        }
+
+        bool remove(EventBus& bus, SubscriptionId id) override
+        {
+            const auto* current = subscribers.load(std::memory_order_acquire);
+            if (!current) {
+                return false;
+            }
+            auto next = std::make_unique<List>(*current);
+            if (std::erase_if(*next, [id](const Subscriber& s) { return s.id == id; }) == 0) {
+                return false;
+            }
+            replace(bus, std::move(next));
+            return true;
+        }
+
+        void reset(EventBus& bus) override
+        {
+            replace(bus, nullptr);
+            queued.clear();
+            dirty = false;
+        }
+
+        void deliverQueued(EventBus& bus) override
+        {
+            std::vector<T> batch;
+            {
+                const std::scoped_lock lock(bus.queueMutex_);
+                batch.swap(queued);
+            }
+            const ReadGuard guard(bus);
+            if (const auto* current = subscribers.load(std::memory_order_seq_cst)) {
+                for (const auto& event : batch) {
+                    for (const auto& subscriber : *current) {
+                        subscriber.handler(event);
+                    }
+                }
+            }
+            // Hand the storage back so steady posting does not allocate
+            batch.clear();
+            const std::scoped_lock lock(bus.queueMutex_);
+            if (queued.empty() && queued.capacity() < batch.capacity()) {
+                queued.swap(batch);
+            }
+        }
+
+        std::atomic<const List*> subscribers{nullptr};  ///< Current snapshot, owned.
+        std::vector<Retired> retired;                   ///< Guarded by mutex_.
+        std::vector<T> queued;                          ///< Guarded by queueMutex_.
+    };
+
+    /// Returns the reader counters of the calling thread.
+    ReaderSlot& readerSlot()
+    {
+        static thread_local const std::size_t slot =
+            std::hash<std::thread::id>{}(std::this_thread::get_id()) % kReaderSlots;
+        return readers_[slot];
+    }
+
+    /// Returns true if no publisher is counted under @p parity right now.
+    bool drained(std::size_t parity) const
+    {
+        for (const auto& slot : readers_) {
+            if (slot.active[parity].load(std::memory_order_seq_cst) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Returns the channel for T, creating it on first use.
+    template <typename T>
+    Channel<T>& channel()
+    {
+        // One channel per type for the process; EventBus is a singleton
+        static Channel<T>& typed = addChannel(std::make_unique<Channel<T>>());
+        return typed;
+    }
+
+    /// Takes ownership of a new channel so unsubscribe() and clear() can reach it.
+    template <typename C>
+    C& addChannel(std::unique_ptr<C> channel)
+    {
+        const std::scoped_lock lock(mutex_);
+        auto& typed = *channel;
+        channels_.push_back(std::move(channel));
+        return typed;
+    }
+
+    std::mutex mutex_;                                    ///< Serializes subscriber edits.
+    SubscriptionId nextId_ = 1;                           ///< Next subscription ID.
+    std::vector<std::unique_ptr<ChannelBase>> channels_;  ///< Every channel created so far.
+    std::mutex queueMutex_;                               ///< Guards posted events.
+    std::vector<ChannelBase*> dirty_;                     ///< Channels with queued events.
+    bool flushScheduled_ = false;                         ///< Scheduler called since last flush.
+    std::function<void()> flushScheduler_;                ///< Requests a flush().
+    std::atomic<std::size_t> epoch_{0};                   ///< Advanced by every list swap.
+    ReaderSlot readers_[kReaderSlots];                    ///< Publishers in flight.
 };
 
 }  // namespace gimp
@@ -14,6 +14,7 @@
 
 namespace gimp {
 
+class Command;
 class Layer;
 class Document;
 
@@ -32,6 +33,12 @@ struct LayerSelectionChangedEvent {
 struct LayerPropertyChangedEvent {
     std::shared_ptr<Layer> layer;  ///< The layer whose property changed.
     std::string propertyName;      ///< Name of the changed property (e.g., "opacity", "visible").
+
+    /*! @brief Queued changes of the same property of the same layer collapse. */
+    [[nodiscard]] bool supersedes(const LayerPropertyChangedEvent& older) const
+    {
+        return layer == older.layer && propertyName == older.propertyName;
+    }
 };
 
 /**
@@ -55,6 +62,9 @@ struct HistoryChangedEvent {
     std::size_t undoCount = 0;   ///< Number of available undo steps.
     std::size_t redoCount = 0;   ///< Number of available redo steps.
     std::string lastActionName;  ///< Name of the most recent action.
+    std::size_t byteSize = 0;    ///< Memory held by the undo/redo state.
+    std::size_t byteBudget = 0;  ///< Memory budget of the history.
+    std::size_t swapSize = 0;    ///< Undo state paged out to the swap file.
 };
 
 /**
@@ -87,6 +97,9 @@ struct CanvasViewChangedEvent {
     float zoomLevel = 1.0F;  ///< Current zoom level (1.0 = 100%).
     float panX = 0.0F;       ///< Horizontal pan offset in pixels.
     float panY = 0.0F;       ///< Vertical pan offset in pixels.
+
+    /*! @brief Only the latest queued view matters. */
+    [[nodiscard]] bool supersedes(const CanvasViewChangedEvent& /*older*/) const { return true; }
 };
 
 /**
@@ -97,6 +110,12 @@ struct MousePositionChangedEvent {
     int canvasY = 0;  ///< Mouse Y position in canvas coordinates.
     int screenX = 0;  ///< Mouse X position in screen coordinates.
     int screenY = 0;  ///< Mouse Y position in screen coordinates.
+
+    /*! @brief Only the latest queued position matters. */
+    [[nodiscard]] bool supersedes(const MousePositionChangedEvent& /*older*/) const
+    {
+        return true;
+    }
 };
 
 /**
@@ -160,4 +179,16 @@ struct SelectionChangedEvent {
     std::string source;         ///< Source of the change (e.g., "menu", "tool").
 };
 
+/**
+ * @brief Event fired on the GUI thread when an asynchronous command was committed.
+ *
+ * Published by AsyncCommandBus once the worker result is written into the
+ * layer and the command is recorded in the history.
+ */
+struct CommandCompletedEvent {
+    std::shared_ptr<Command> command;  ///< The committed command.
+    std::shared_ptr<Layer> layer;      ///< Layer the command rendered into.
+    bool rerun = false;  ///< True if the layer changed meanwhile and the command ran again.
+};
+
 }  // namespace gimp
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/pixel_format.h"
 #include "filter.h"
 
 namespace gimp {
@@ -49,27 +50,31 @@ class BlurFilter : public Filter {
   private:
     /**
      * @brief Applies horizontal blur pass.
-     * @param data Layer pixel data (RGBA).
+     * @param data Layer pixel data (RGBA in format).
      * @param width Layer width.
      * @param height Layer height.
      * @param kernel Precomputed blur kernel.
+     * @param format Pixel format of data.
      */
     void applyHorizontalBlur(std::vector<std::uint8_t>& data,
                              int width,
                              int height,
-                             const std::vector<float>& kernel);
+                             const std::vector<float>& kernel,
+                             PixelFormat format);
 
     /**
      * @brief Applies vertical blur pass.
-     * @param data Layer pixel data (RGBA).
+     * @param data Layer pixel data (RGBA in format).
      * @param width Layer width.
      * @param height Layer height.
      * @param kernel Precomputed blur kernel.
+     * @param format Pixel format of data.
      */
     void applyVerticalBlur(std::vector<std::uint8_t>& data,
                            int width,
                            int height,
-                           const std::vector<float>& kernel);
+                           const std::vector<float>& kernel,
+                           PixelFormat format);
 
     /**
      * @brief Generates a Gaussian blur kernel.
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/pixel_format.h"
 #include "filter.h"
 
 namespace gimp {
@@ -65,11 +66,13 @@ class SharpenFilter : public Filter {
      * @param data Original layer data.
      * @param width Layer width.
      * @param height Layer height.
+     * @param format Pixel format of data.
      * @return Blurred copy of the data.
      */
     std::vector<std::uint8_t> createBlurredCopy(const std::vector<std::uint8_t>& data,
                                                 int width,
-                                                int height) const;
+                                                int height,
+                                                PixelFormat format) const;
 
     float amount_ = 1.0F;  ///< Sharpening strength (0.0-2.0).
     float radius_ = 1.0F;  ///< Blur radius for unsharp mask.
@@ -124,7 +124,7 @@ class FloatingBuffer {
      */
     void rasterizeSelectionMask(const QPainterPath& selPath, const QRect& bounds);
 
-    std::vector<std::uint8_t> buffer_;  ///< Extracted pixel data (RGBA).
+    std::vector<std::uint8_t> buffer_;  ///< Extracted pixel data (straight RGBA8).
     QRect sourceRect_;                  ///< Source bounding rectangle.
     std::vector<bool> selectionMask_;   ///< Pre-rasterized selection mask.
 };
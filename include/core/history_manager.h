@@ -37,5 +37,15 @@ class HistoryManager {
      * @return True if a redo was performed.
      */
     virtual bool redo() = 0;
+
+    /*!
+     * @brief Merges an applied command into the newest history entry.
+     *
+     * Fails if there is nothing to merge into, if commands were undone since
+     * the newest entry was recorded, or if the entry rejects the command.
+     * @param command Command that was just applied.
+     * @return True if merged; otherwise the caller should push() it.
+     */
+    virtual bool coalesce(const std::shared_ptr<Command>& /*command*/) { return false; }
 };
 }  // namespace gimp
@@ -7,7 +7,11 @@
 
 #pragma once
 
+#include "pixel_format.h"
+#include "tile_buffer.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -31,19 +35,34 @@ enum class BlendMode {
 /*!
  * @class Layer
  * @brief A single compositable image layer with RGBA pixel data.
+ *
+ * Pixels are stored as bytes in pixelFormat(); a pixel spans bytesPerPixel()
+ * bytes (4 for the RGBA8 formats, 8 or 16 for the high bit-depth ones).
+ *
+ * The working pixels are one contiguous buffer: renderers, tools, filters
+ * and I/O index data() linearly. Tiles only back snapshots (see snapshot()),
+ * which share unchanged tiles with each other and with undo history. A
+ * layer therefore still needs one allocation of its full size, and
+ * resize() and setPixelFormat() with a new pixel size reallocate it.
  */
 class Layer {
   public:
     virtual ~Layer() = default;
 
     /*!
-     * @brief Constructs a layer with the given dimensions.
+     * @brief Constructs a transparent layer with the given dimensions.
      * @param width Layer width in pixels.
      * @param height Layer height in pixels.
+     * @param format In-memory pixel format.
      */
-    Layer(int width, int height) : m_width(width), m_height(height)
+    Layer(int width, int height, PixelFormat format = PixelFormat::Rgba8)
+        : m_width(width), m_height(height), m_format(format)
     {
-        m_data.resize(width * height * 4, 0);
+        m_data.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) *
+                          bytesPerPixel(),
+                      0);
+        bumpVersion();
+        bumpPropertiesVersion();
     }
 
     /*! @brief Sets the layer name.
@@ -59,7 +78,11 @@ class Layer {
     /*! @brief Sets layer visibility.
      *  @param visible True to show the layer, false to hide.
      */
-    void setVisible(bool visible) { m_visible = visible; }
+    void setVisible(bool visible)
+    {
+        m_visible = visible;
+        bumpPropertiesVersion();
+    }
 
     /*! @brief Returns true if the layer is visible.
      *  @return Visibility state.
@@ -69,7 +92,11 @@ class Layer {
     /*! @brief Sets layer opacity (0.0 to 1.0).
      *  @param opacity The new opacity value.
      */
-    void setOpacity(float opacity) { m_opacity = opacity; }
+    void setOpacity(float opacity)
+    {
+        m_opacity = opacity;
+        bumpPropertiesVersion();
+    }
 
     /*! @brief Returns the layer opacity.
      *  @return Opacity value (0.0 to 1.0).
@@ -79,13 +106,80 @@ class Layer {
     /*! @brief Sets the blend mode.
      *  @param mode The new blend mode.
      */
-    void setBlendMode(BlendMode mode) { m_blend_mode = mode; }
+    void setBlendMode(BlendMode mode)
+    {
+        m_blend_mode = mode;
+        bumpPropertiesVersion();
+    }
 
     /*! @brief Returns the blend mode.
      *  @return The current blend mode.
      */
     [[nodiscard]] BlendMode blendMode() const { return m_blend_mode; }
 
+    /*! @brief Returns the in-memory pixel format.
+     *  @return Current format; data(), row() and the region accessors use it.
+     */
+    [[nodiscard]] PixelFormat pixelFormat() const { return m_format; }
+
+    /*! @brief Returns the storage size of one pixel.
+     *  @return Bytes per pixel of pixelFormat().
+     */
+    [[nodiscard]] std::size_t bytesPerPixel() const
+    {
+        return static_cast<std::size_t>(describe(m_format).bytesPerPixel());
+    }
+
+    /*! @brief Converts the pixels to another format.
+     *
+     *  Converts in place when both formats have the same pixel size, otherwise
+     *  into a new buffer.
+     *  @param format New pixel format.
+     */
+    void setPixelFormat(PixelFormat format)
+    {
+        if (format == m_format) {
+            return;
+        }
+        const std::size_t count = pixelCount();
+        if (describe(format).bytesPerPixel() == describe(m_format).bytesPerPixel()) {
+            convertPixels(m_data.data(), m_data.data(), count, m_format, format);
+        } else {
+            std::vector<uint8_t> converted(count * describe(format).bytesPerPixel());
+            convertPixels(converted.data(), m_data.data(), count, m_format, format);
+            m_data = std::move(converted);
+        }
+        m_format = format;
+        m_tiles = WeakTileBuffer();
+        markDirty({0, 0, m_width, m_height});
+    }
+
+    /*! @brief Returns a copy of all pixels converted to a format.
+     *
+     *  Used at import/export boundaries, which always exchange straight alpha.
+     *  @param format Format of the returned pixels.
+     *  @return width() * height() pixels.
+     */
+    [[nodiscard]] std::vector<uint8_t> pixelsAs(PixelFormat format) const
+    {
+        std::vector<uint8_t> pixels(pixelCount() * describe(format).bytesPerPixel());
+        convertPixels(pixels.data(), m_data.data(), pixelCount(), m_format, format);
+        return pixels;
+    }
+
+    /*! @brief Replaces all pixels, converting them to the layer format.
+     *  @param pixels width() * height() pixels; ignored if the size differs.
+     *  @param format Format of pixels.
+     */
+    void assignPixels(const std::vector<uint8_t>& pixels, PixelFormat format)
+    {
+        if (pixels.size() != pixelCount() * describe(format).bytesPerPixel()) {
+            return;
+        }
+        convertPixels(m_data.data(), pixels.data(), pixelCount(), format, m_format);
+        markDirty({0, 0, m_width, m_height});
+    }
+
     /*! @brief Returns the layer width.
      *  @return Width in pixels.
      */
@@ -96,16 +190,183 @@ class Layer {
      */
     [[nodiscard]] int height() const { return m_height; }
 
-    /*! @brief Returns mutable access to pixel data (RGBA, 4 bytes per pixel).
+    /*! @brief Returns mutable access to pixel data (RGBA in pixelFormat()).
+     *
+     *  Callers may write anywhere through the returned reference, so the whole
+     *  layer is considered modified for the next snapshot(). Prefer row() or
+     *  writeRegion() when only part of the layer changes.
      *  @return Reference to the pixel data vector.
      */
-    std::vector<uint8_t>& data() { return m_data; }
+    std::vector<uint8_t>& data()
+    {
+        markDirty({0, 0, m_width, m_height});
+        return m_data;
+    }
+
+    /*! @brief Returns mutable pixel data for writes confined to a region.
+     *
+     *  Only the region is considered modified for the next snapshot(), so
+     *  callers must not write outside it. Dab renderers use this to keep
+     *  snapshots proportional to the painted area.
+     *  @param region Rectangle the caller writes to, in layer coordinates.
+     *  @return Pointer to the first pixel of the layer.
+     */
+    std::uint8_t* regionData(const Rect& region)
+    {
+        markDirty(region);
+        return m_data.data();
+    }
 
     /*! @brief Returns const access to pixel data.
      *  @return Const reference to the pixel data vector.
      */
     [[nodiscard]] const std::vector<uint8_t>& data() const { return m_data; }
 
+    /*! @brief Returns a pointer to the first pixel of a row for reading.
+     *  @param y Row index (0 to height - 1).
+     *  @return Pointer to width() pixels.
+     */
+    [[nodiscard]] const std::uint8_t* row(int y) const
+    {
+        return m_data.data() + static_cast<std::size_t>(y) * rowBytes();
+    }
+
+    /*! @brief Returns a pointer to the first pixel of a row for writing.
+     *  @param y Row index (0 to height - 1).
+     *  @return Pointer to width() pixels.
+     */
+    std::uint8_t* row(int y)
+    {
+        markDirty({0, y, m_width, 1});
+        return m_data.data() + static_cast<std::size_t>(y) * rowBytes();
+    }
+
+    /*! @brief Returns the number of bytes in one pixel row.
+     *  @return width() * bytesPerPixel().
+     */
+    [[nodiscard]] std::size_t rowBytes() const
+    {
+        return static_cast<std::size_t>(m_width) * bytesPerPixel();
+    }
+
+    /*! @brief Copies a region into a tightly packed buffer in pixelFormat().
+     *  @param region Source rectangle; must lie inside the layer.
+     *  @param dst Destination with room for region.w * region.h * bytesPerPixel() bytes.
+     */
+    void readRegion(const Rect& region, std::uint8_t* dst) const
+    {
+        const std::size_t regionRowBytes = static_cast<std::size_t>(region.w) * bytesPerPixel();
+        for (int y = 0; y < region.h; ++y) {
+            std::memcpy(dst + static_cast<std::size_t>(y) * regionRowBytes,
+                        row(region.y + y) + static_cast<std::size_t>(region.x) * bytesPerPixel(),
+                        regionRowBytes);
+        }
+    }
+
+    /*! @brief Writes a tightly packed buffer in pixelFormat() into a region.
+     *  @param region Destination rectangle; must lie inside the layer.
+     *  @param src Source with region.w * region.h * bytesPerPixel() bytes.
+     */
+    void writeRegion(const Rect& region, const std::uint8_t* src)
+    {
+        markDirty(region);
+        const std::size_t regionRowBytes = static_cast<std::size_t>(region.w) * bytesPerPixel();
+        for (int y = 0; y < region.h; ++y) {
+            std::memcpy(m_data.data() + static_cast<std::size_t>(region.y + y) * rowBytes() +
+                            static_cast<std::size_t>(region.x) * bytesPerPixel(),
+                        src + static_cast<std::size_t>(y) * regionRowBytes,
+                        regionRowBytes);
+        }
+    }
+
+    /*! @brief Returns a version that changes whenever the pixels change.
+     *
+     *  Versions are unique across all layers, so a (layer, version) pair never
+     *  repeats even if a destroyed layer's address is reused. Caches of the
+     *  pixels, such as uploaded images and mip levels, use it to decide whether
+     *  they are stale.
+     *  @return Current content version.
+     */
+    [[nodiscard]] std::uint64_t version() const { return m_version; }
+
+    /*! @brief Returns a version that changes whenever visibility, opacity or blend mode change.
+     *
+     *  Unique across all layers like version(). Composites of several layers
+     *  key on both, so a property edit recomposes without re-uploading pixels.
+     *  @return Current properties version.
+     */
+    [[nodiscard]] std::uint64_t propertiesVersion() const { return m_propertiesVersion; }
+
+    /*! @brief Records that a region was modified since the last snapshot().
+     *  @param region The modified rectangle in layer coordinates.
+     */
+    void markDirty(const Rect& region) const
+    {
+        if (region.w <= 0 || region.h <= 0) {
+            return;
+        }
+        bumpVersion();
+        if (m_dirty.w <= 0 || m_dirty.h <= 0) {
+            m_dirty = region;
+            return;
+        }
+        const int x0 = std::min(m_dirty.x, region.x);
+        const int y0 = std::min(m_dirty.y, region.y);
+        const int x1 = std::max(m_dirty.x + m_dirty.w, region.x + region.w);
+        const int y1 = std::max(m_dirty.y + m_dirty.h, region.y + region.h);
+        m_dirty = {x0, y0, x1 - x0, y1 - y0};
+    }
+
+    /*! @brief Returns a tiled copy of the pixels that shares unchanged tiles.
+     *
+     *  The layer remembers the tiles of its last snapshot without keeping them
+     *  alive. Tiles still held elsewhere (by earlier snapshots or undo history)
+     *  are shared again unless they overlap regions modified since; only those
+     *  regions and tiles freed in the meantime are compared and re-copied.
+     *  Successive snapshots of a mostly unchanged layer therefore share most
+     *  storage, while the layer itself holds no tile memory between them.
+     *  High bit-depth pixels are tiled as runs of 4-byte units, so the
+     *  snapshot is tileUnits() units wide.
+     *  @return Tiled snapshot of the current pixels.
+     */
+    [[nodiscard]] TileBuffer snapshot() const
+    {
+        std::vector<Rect> expired;
+        TileBuffer tiles = m_tiles.lock(expired);
+        if (tiles.width() != tileUnits(m_width) || tiles.height() != m_height) {
+            tiles = TileBuffer(tileUnits(m_width), m_height);
+            expired.clear();
+            m_dirty = {0, 0, m_width, m_height};
+        }
+        for (const Rect& tile : expired) {
+            tiles.syncFrom(m_data.data(), rowBytes(), tile);
+        }
+        if (m_dirty.w > 0 && m_dirty.h > 0) {
+            tiles.syncFrom(m_data.data(),
+                           rowBytes(),
+                           {tileUnits(m_dirty.x), m_dirty.y, tileUnits(m_dirty.w), m_dirty.h});
+            m_dirty = {0, 0, 0, 0};
+        }
+        m_tiles = WeakTileBuffer(tiles);
+        return tiles;
+    }
+
+    /*! @brief Restores pixels from a snapshot taken at the current dimensions and format.
+     *  @param tiles Snapshot returned by snapshot().
+     *  @return False if the snapshot dimensions do not match the layer.
+     */
+    bool restore(const TileBuffer& tiles)
+    {
+        if (tiles.width() != tileUnits(m_width) || tiles.height() != m_height) {
+            return false;
+        }
+        tiles.readRegion({0, 0, tiles.width(), m_height}, m_data.data(), rowBytes());
+        m_tiles = WeakTileBuffer(tiles);
+        m_dirty = {0, 0, 0, 0};
+        bumpVersion();
+        return true;
+    }
+
     /*! @brief Resizes the layer and repositions existing content.
      *  @param width New width in pixels.
      *  @param height New height in pixels.
@@ -118,11 +379,15 @@ class Layer {
             m_width = std::max(0, width);
             m_height = std::max(0, height);
             m_data.clear();
+            m_tiles = WeakTileBuffer();
+            m_dirty = {0, 0, 0, 0};
+            bumpVersion();
             return;
         }
 
         std::vector<uint8_t> newData;
-        newData.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4U, 0);
+        const std::size_t pixelSize = bytesPerPixel();
+        newData.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * pixelSize, 0);
 
         const int srcX = std::max(0, -offsetX);
         const int srcY = std::max(0, -offsetY);
@@ -133,17 +398,15 @@ class Layer {
         const int copyHeight = std::min(m_height - srcY, height - dstY);
 
         if (copyWidth > 0 && copyHeight > 0) {
-            const int srcStride = m_width * 4;
-            const int dstStride = width * 4;
-            const size_t rowBytes = static_cast<size_t>(copyWidth) * 4U;
+            const size_t srcStride = static_cast<size_t>(m_width) * pixelSize;
+            const size_t dstStride = static_cast<size_t>(width) * pixelSize;
+            const size_t rowBytes = static_cast<size_t>(copyWidth) * pixelSize;
 
             for (int row = 0; row < copyHeight; ++row) {
-                const size_t srcOffset =
-                    static_cast<size_t>(srcY + row) * static_cast<size_t>(srcStride) +
-                    static_cast<size_t>(srcX) * 4U;
-                const size_t dstOffset =
-                    static_cast<size_t>(dstY + row) * static_cast<size_t>(dstStride) +
-                    static_cast<size_t>(dstX) * 4U;
+                const size_t srcOffset = static_cast<size_t>(srcY + row) * srcStride +
+                                         static_cast<size_t>(srcX) * pixelSize;
+                const size_t dstOffset = static_cast<size_t>(dstY + row) * dstStride +
+                                         static_cast<size_t>(dstX) * pixelSize;
 
                 std::memcpy(newData.data() + dstOffset, m_data.data() + srcOffset, rowBytes);
             }
@@ -152,17 +415,51 @@ class Layer {
         m_width = width;
         m_height = height;
         m_data = std::move(newData);
+        m_tiles = WeakTileBuffer();
+        m_dirty = {0, 0, 0, 0};
+        bumpVersion();
     }
 
   private:
+    /*! @brief Returns the number of pixels. */
+    [[nodiscard]] std::size_t pixelCount() const
+    {
+        return static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height);
+    }
+
+    /*! @brief Converts a pixel count along X to 4-byte tile units. */
+    [[nodiscard]] int tileUnits(int pixels) const
+    {
+        return pixels * describe(m_format).bytesPerPixel() / TileBuffer::kBytesPerPixel;
+    }
+
+    /*! @brief Returns a fresh, globally unique version number. */
+    static std::uint64_t nextVersion()
+    {
+        static std::atomic<std::uint64_t> s_nextVersion{1};
+        return s_nextVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /*! @brief Assigns a fresh content version to the layer. */
+    void bumpVersion() const { m_version = nextVersion(); }
+
+    /*! @brief Assigns a fresh properties version to the layer. */
+    void bumpPropertiesVersion() { m_propertiesVersion = nextVersion(); }
+
     std::string m_name = "Layer";                ///< Layer display name.
     bool m_visible = true;                       ///< Visibility flag.
     float m_opacity = 1.0F;                      ///< Opacity (0.0 to 1.0).
     BlendMode m_blend_mode = BlendMode::Normal;  ///< Blend mode.
+    std::uint64_t m_propertiesVersion = 0;       ///< Properties version, see propertiesVersion().
+
+    int m_width = 0;                            ///< Width in pixels.
+    int m_height = 0;                           ///< Height in pixels.
+    PixelFormat m_format = PixelFormat::Rgba8;  ///< Layout of m_data.
+    std::vector<uint8_t> m_data;                ///< Working pixels in m_format, row-major.
 
-    int m_width = 0;              ///< Width in pixels.
-    int m_height = 0;             ///< Height in pixels.
-    std::vector<uint8_t> m_data;  ///< RGBA pixel buffer.
+    mutable WeakTileBuffer m_tiles;       ///< Tiles of the last snapshot, not kept alive.
+    mutable Rect m_dirty{0, 0, 0, 0};     ///< Bounds modified since the last snapshot.
+    mutable std::uint64_t m_version = 0;  ///< Content version, see version().
 };
 
 }  // namespace gimp
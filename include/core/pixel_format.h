@@ -0,0 +1,340 @@
+/**
+ * @file pixel_format.h
+ * @brief Layer pixel formats, channel types and pixel conversions.
+ * @author Laurent Jiang
+ * @date 2026-02-20
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace gimp {
+
+/*!
+ * @enum PixelFormat
+ * @brief In-memory layout of layer pixels.
+ */
+enum class PixelFormat : std::uint8_t {
+    Rgba8,               ///< 8-bit RGBA, straight (unpremultiplied) alpha.
+    Rgba8Premultiplied,  ///< 8-bit RGBA, color channels multiplied by alpha.
+    Rgba16,              ///< 16-bit unsigned normalized RGBA, straight alpha.
+    Rgba16F,             ///< Half-float RGBA, straight alpha, 1.0 = full intensity.
+    Rgba32F              ///< Float RGBA, straight alpha, 1.0 = full intensity.
+};
+
+/*!
+ * @struct PixelFormatDescriptor
+ * @brief Static properties of a pixel format.
+ */
+struct PixelFormatDescriptor {
+    int channels;         ///< Channels per pixel (always RGBA).
+    int bytesPerChannel;  ///< Storage size of one channel.
+    bool premultiplied;   ///< True if color channels are multiplied by alpha.
+
+    /*! @brief Returns the storage size of one pixel.
+     *  @return channels * bytesPerChannel.
+     */
+    [[nodiscard]] constexpr int bytesPerPixel() const { return channels * bytesPerChannel; }
+};
+
+/*!
+ * @brief Returns the properties of a pixel format.
+ * @param format Pixel format.
+ * @return Descriptor of the format.
+ */
+constexpr PixelFormatDescriptor describe(PixelFormat format)
+{
+    switch (format) {
+        case PixelFormat::Rgba8:
+            return {4, 1, false};
+        case PixelFormat::Rgba8Premultiplied:
+            return {4, 1, true};
+        case PixelFormat::Rgba16:
+        case PixelFormat::Rgba16F:
+            return {4, 2, false};
+        case PixelFormat::Rgba32F:
+            return {4, 4, false};
+    }
+    return {4, 1, false};
+}
+
+/*!
+ * @struct Half
+ * @brief IEEE 754 binary16 value, the channel type of PixelFormat::Rgba16F.
+ */
+struct Half {
+    std::uint16_t bits = 0;  ///< Raw binary16 encoding.
+};
+
+/*!
+ * @brief Converts a float to half precision, rounding to nearest even.
+ * @param value Value to convert; out of range values become infinity.
+ * @return Half with the closest representable value.
+ */
+inline Half floatToHalf(float value)
+{
+    const auto f = std::bit_cast<std::uint32_t>(value);
+    const auto sign = static_cast<std::uint16_t>((f >> 16) & 0x8000U);
+    const std::uint32_t magnitude = f & 0x7FFFFFFFU;
+
+    if (magnitude >= 0x7F800000U) {
+        // Infinity stays infinity, NaN stays a (quiet) NaN
+        const std::uint32_t quiet = magnitude > 0x7F800000U ? 0x200U : 0U;
+        return {static_cast<std::uint16_t>(sign | 0x7C00U | quiet)};
+    }
+    if (magnitude >= 0x47800000U) {
+        return {static_cast<std::uint16_t>(sign | 0x7C00U)};
+    }
+
+    std::uint32_t half = 0;
+    std::uint32_t remainder = 0;
+    std::uint32_t halfway = 0;
+    if (magnitude < 0x38800000U) {
+        // Below the smallest normal half: encode as a subnormal (or zero)
+        if (magnitude < 0x33000000U) {
+            return {sign};
+        }
+        const std::uint32_t shift = 126U - (magnitude >> 23);
+        const std::uint32_t mantissa = (magnitude & 0x7FFFFFU) | 0x800000U;
+        half = mantissa >> shift;
+        remainder = mantissa & ((1U << shift) - 1U);
+        halfway = 1U << (shift - 1U);
+    } else {
+        // Rebias the exponent from 127 to 15 and drop 13 mantissa bits
+        half = (magnitude - 0x38000000U) >> 13;
+        remainder = magnitude & 0x1FFFU;
+        halfway = 0x1000U;
+    }
+    if (remainder > halfway || (remainder == halfway && (half & 1U) != 0)) {
+        ++half;  // a carry into the exponent is the correctly rounded result
+    }
+    return {static_cast<std::uint16_t>(sign | half)};
+}
+
+/*!
+ * @brief Converts a half precision value to float (exact).
+ * @param value Half to convert.
+ * @return Same value as a float.
+ */
+inline float halfToFloat(Half value)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(value.bits & 0x8000U) << 16;
+    const std::uint32_t exponent = (value.bits >> 10) & 0x1FU;
+    const std::uint32_t mantissa = value.bits & 0x3FFU;
+    if (exponent == 0x1FU) {
+        return std::bit_cast<float>(sign | 0x7F800000U | (mantissa << 13));
+    }
+    if (exponent == 0) {
+        // Zero or subnormal: mantissa * 2^-24
+        const float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-8F;
+        return sign != 0 ? -magnitude : magnitude;
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112U) << 23) | (mantissa << 13));
+}
+
+/*!
+ * @struct ChannelTraits
+ * @brief Per-channel-type constants and conversions used by format-specialized kernels.
+ *
+ * Kernels work on "raw" float values: the channel value itself for integer
+ * types (0-255, 0-65535) and the stored value for floating-point types
+ * (1.0 = full intensity). kOne is the raw value of full intensity. store()
+ * truncates integer channels after clamping; add kRound first to round.
+ */
+template <typename Channel>
+struct ChannelTraits;
+
+template <>
+struct ChannelTraits<std::uint8_t> {
+    static constexpr float kOne = 255.0F;  ///< Raw value of full intensity.
+    static constexpr float kRound = 0.5F;  ///< Bias that turns store() into rounding.
+
+    static float load(std::uint8_t value) { return static_cast<float>(value); }
+    static std::uint8_t store(float raw)
+    {
+        return static_cast<std::uint8_t>(std::clamp(raw, 0.0F, kOne));
+    }
+};
+
+template <>
+struct ChannelTraits<std::uint16_t> {
+    static constexpr float kOne = 65535.0F;  ///< Raw value of full intensity.
+    static constexpr float kRound = 0.5F;    ///< Bias that turns store() into rounding.
+
+    static float load(std::uint16_t value) { return static_cast<float>(value); }
+    static std::uint16_t store(float raw)
+    {
+        return static_cast<std::uint16_t>(std::clamp(raw, 0.0F, kOne));
+    }
+};
+
+template <>
+struct ChannelTraits<Half> {
+    static constexpr float kOne = 1.0F;    ///< Raw value of full intensity.
+    static constexpr float kRound = 0.0F;  ///< store() already rounds.
+
+    static float load(Half value) { return halfToFloat(value); }
+    static Half store(float raw) { return floatToHalf(raw); }
+};
+
+template <>
+struct ChannelTraits<float> {
+    static constexpr float kOne = 1.0F;    ///< Raw value of full intensity.
+    static constexpr float kRound = 0.0F;  ///< store() is exact.
+
+    static float load(float value) { return value; }
+    static float store(float raw) { return raw; }
+};
+
+/*!
+ * @brief Reads one channel from (possibly unaligned) pixel storage.
+ * @param channel Address of the channel.
+ * @return Raw channel value, see ChannelTraits.
+ */
+template <typename Channel>
+float loadChannel(const std::uint8_t* channel)
+{
+    Channel value{};
+    std::memcpy(&value, channel, sizeof(Channel));
+    return ChannelTraits<Channel>::load(value);
+}
+
+/*!
+ * @brief Writes one channel to (possibly unaligned) pixel storage.
+ * @param channel Address of the channel.
+ * @param raw Raw channel value, see ChannelTraits.
+ */
+template <typename Channel>
+void storeChannel(std::uint8_t* channel, float raw)
+{
+    const Channel value = ChannelTraits<Channel>::store(raw);
+    std::memcpy(channel, &value, sizeof(Channel));
+}
+
+/*!
+ * @brief Calls a function with a value of the channel type of a format.
+ *
+ * Lets callers instantiate one kernel per channel type:
+ * `visitChannelType(format, [&](auto zero) { kernel<decltype(zero)>(...); })`.
+ * Both RGBA8 formats map to std::uint8_t.
+ * @param format Pixel format.
+ * @param fn Generic callable.
+ * @return Result of fn.
+ */
+template <typename Fn>
+decltype(auto) visitChannelType(PixelFormat format, Fn&& fn)
+{
+    switch (format) {
+        case PixelFormat::Rgba16:
+            return fn(std::uint16_t{});
+        case PixelFormat::Rgba16F:
+            return fn(Half{});
+        case PixelFormat::Rgba32F:
+            return fn(0.0F);
+        case PixelFormat::Rgba8:
+        case PixelFormat::Rgba8Premultiplied:
+            break;
+    }
+    return fn(std::uint8_t{});
+}
+
+/*!
+ * @brief Returns round(a * b / 255) for a, b in [0, 255].
+ *
+ * Exact for all inputs; the basis of every 8-bit premultiplied operation.
+ */
+constexpr std::uint32_t mulDiv255(std::uint32_t a, std::uint32_t b)
+{
+    const std::uint32_t t = a * b + 128U;
+    return (t + (t >> 8)) >> 8;
+}
+
+/*!
+ * @brief Premultiplies a packed color.
+ * @param rgba Straight color (0xRRGGBBAA).
+ * @return Premultiplied color (0xRRGGBBAA).
+ */
+constexpr std::uint32_t premultiplyColor(std::uint32_t rgba)
+{
+    const std::uint32_t a = rgba & 0xFFU;
+    const std::uint32_t r = mulDiv255((rgba >> 24) & 0xFFU, a);
+    const std::uint32_t g = mulDiv255((rgba >> 16) & 0xFFU, a);
+    const std::uint32_t b = mulDiv255((rgba >> 8) & 0xFFU, a);
+    return (r << 24) | (g << 16) | (b << 8) | a;
+}
+
+/*!
+ * @brief Converts a packed premultiplied color back to straight alpha.
+ * @param rgba Premultiplied color (0xRRGGBBAA).
+ * @return Straight color (0xRRGGBBAA); fully transparent colors become 0.
+ */
+constexpr std::uint32_t unpremultiplyColor(std::uint32_t rgba)
+{
+    const std::uint32_t a = rgba & 0xFFU;
+    if (a == 0) {
+        return 0;
+    }
+    const auto channel = [a](std::uint32_t c) {
+        const std::uint32_t value = (c * 255U + a / 2) / a;
+        return value > 255U ? 255U : value;
+    };
+    return (channel((rgba >> 24) & 0xFFU) << 24) | (channel((rgba >> 16) & 0xFFU) << 16) |
+           (channel((rgba >> 8) & 0xFFU) << 8) | a;
+}
+
+/*!
+ * @brief Converts unpremultiplied RGBA8 pixels to premultiplied.
+ * @param dst Destination pixels (may alias src).
+ * @param src Source pixels.
+ * @param count Number of pixels.
+ */
+void premultiplyRow(std::uint8_t* dst, const std::uint8_t* src, int count);
+
+/*!
+ * @brief Converts premultiplied RGBA8 pixels to unpremultiplied.
+ * @param dst Destination pixels (may alias src).
+ * @param src Source pixels.
+ * @param count Number of pixels.
+ */
+void unpremultiplyRow(std::uint8_t* dst, const std::uint8_t* src, int count);
+
+/*!
+ * @brief Converts pixels between formats.
+ *
+ * Conversions between the RGBA8 formats use exact integer math; all others
+ * go through float. Float values outside [0, 1] are clamped when stored in
+ * integer formats.
+ * @param dst Destination pixels; may alias src only if both formats have the same pixel size.
+ * @param src Source pixels.
+ * @param count Number of pixels.
+ * @param from Format of src.
+ * @param to Format written to dst.
+ */
+void convertPixels(std::uint8_t* dst,
+                   const std::uint8_t* src,
+                   std::size_t count,
+                   PixelFormat from,
+                   PixelFormat to);
+
+/*!
+ * @brief Reads one pixel as a straight RGBA8 color.
+ * @param pixel Pixel storage in format.
+ * @param format Format of pixel.
+ * @return Straight color (0xRRGGBBAA).
+ */
+std::uint32_t readColor(const std::uint8_t* pixel, PixelFormat format);
+
+/*!
+ * @brief Writes a straight RGBA8 color to one pixel.
+ * @param pixel Pixel storage in format.
+ * @param format Format of pixel.
+ * @param rgba Straight color (0xRRGGBBAA).
+ */
+void writeColor(std::uint8_t* pixel, PixelFormat format, std::uint32_t rgba);
+
+}  // namespace gimp
@@ -0,0 +1,35 @@
+/**
+ * @file simd_level.h
+ * @brief Instruction sets available to the pixel kernels, detected at runtime.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ */
+
+#pragma once
+
+namespace gimp {
+
+/*!
+ * @enum SimdLevel
+ * @brief Instruction set used by the row kernels.
+ */
+enum class SimdLevel {
+    Scalar,  ///< Portable C++.
+    Sse41,   ///< SSE4.1, 4 pixels per step.
+    Avx2     ///< AVX2, 8 pixels per step.
+};
+
+/*!
+ * @brief Returns the best instruction set supported by the running CPU.
+ * @return Detected level; Scalar on non-x86 builds.
+ */
+SimdLevel detectSimdLevel();
+
+/*!
+ * @brief Lowers a requested level to what the running CPU supports.
+ * @param level Highest instruction set the caller wants.
+ * @return The lower of level and detectSimdLevel().
+ */
+SimdLevel supportedSimdLevel(SimdLevel level);
+
+}  // namespace gimp
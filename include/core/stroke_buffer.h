@@ -0,0 +1,128 @@
+/**
+ * @file stroke_buffer.h
+ * @brief 8-bit coverage of a paint stroke, composited onto the layer in one pass.
+ * @author Laurent Jiang
+ * @date 2026-03-02
+ */
+
+#pragma once
+
+#include "core/tile_store.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class StrokeBuffer
+ * @brief Accumulates the coverage of a stroke's dabs before it reaches the layer.
+ *
+ * Dabs write one byte per pixel and overlapping dabs keep the larger
+ * coverage, so a stroke never paints a pixel more strongly than its
+ * strongest dab: opacity applies to the stroke as a whole instead of
+ * compounding where dabs overlap. The layer is blended from its original
+ * pixels and the buffer, only over the area that changed since the last
+ * composite (takeDirty()), and bounds() is the area the stroke modified.
+ *
+ * Coverage is stored in kTileSize x kTileSize tiles allocated the first time
+ * a dab writes into them, so a buffer spanning the whole layer only costs the
+ * tiles the stroke touches; untouched pixels read as zero. reset() frees them.
+ */
+class StrokeBuffer {
+  public:
+    static constexpr int kTileSize = 64;  ///< Tile edge length in pixels.
+    static constexpr std::size_t kTileBytes =  ///< Bytes held by one tile.
+        static_cast<std::size_t>(kTileSize) * kTileSize;
+
+    StrokeBuffer() = default;
+    ~StrokeBuffer();
+    StrokeBuffer(const StrokeBuffer&) = delete;
+    StrokeBuffer& operator=(const StrokeBuffer&) = delete;
+
+    /*!
+     * @brief Starts a stroke over an area, dropping any previous one.
+     * @param area Pixels the buffer covers, usually the whole layer.
+     */
+    void begin(const Rect& area);
+
+    /*! @brief Clears the coverage of the current stroke and stops it. */
+    void reset();
+
+    /*! @brief Returns true between begin() and reset().
+     *  @return True while a stroke is buffered.
+     */
+    [[nodiscard]] bool active() const { return active_; }
+
+    /*! @brief Returns the pixels the buffer covers.
+     *  @return Area passed to begin().
+     */
+    [[nodiscard]] const Rect& area() const { return area_; }
+
+    /*!
+     * @brief Raises the coverage of a run of pixels on one row.
+     *
+     * Each pixel keeps the larger of its coverage and strength * coverage[i].
+     * Calls on different rows may run concurrently, including ones that
+     * allocate the same tile.
+     *
+     * @param x First pixel X; the run must lie inside area().
+     * @param y Row Y inside area().
+     * @param coverage Dab coverage of each pixel (0 to 1).
+     * @param count Pixels in the run.
+     * @param strength Factor applied to the coverage, such as pen pressure.
+     */
+    void accumulateRow(int x, int y, const float* coverage, int count, float strength);
+
+    /*!
+     * @brief Copies the coverage of part of one row into a linear buffer.
+     * @param y Row Y inside area().
+     * @param x First pixel X; the run must lie inside area().
+     * @param count Pixels in the run.
+     * @param dst Destination, one byte (0 to 255) per pixel.
+     */
+    void readRow(int y, int x, int count, std::uint8_t* dst) const;
+
+    /*!
+     * @brief Adds a region whose coverage changed to the dirty area.
+     * @param region Region written since the last call (clipped to area()).
+     */
+    void markDirty(const Rect& region);
+
+    /*! @brief Returns and clears the area changed since the last call.
+     *  @return Bounding box of the marked regions; empty if nothing changed.
+     */
+    Rect takeDirty();
+
+    /*! @brief Returns the area the stroke has covered so far.
+     *  @return Bounding box of every marked region; empty before the first one.
+     */
+    [[nodiscard]] const Rect& bounds() const { return bounds_; }
+
+    /*! @brief Returns the number of allocated coverage tiles.
+     *  @return Tiles written since begin().
+     */
+    [[nodiscard]] std::size_t allocatedTileCount() const;
+
+  private:
+    /// Coverage of one tile, row-major, one byte per pixel.
+    using Tile = std::array<std::uint8_t, kTileBytes>;
+
+    /// Returns the tile holding a pixel of area_, allocating it if needed.
+    Tile& tileFor(int localX, int localY);
+
+    /// Returns the tile holding a pixel of area_, or nullptr if it was never written.
+    [[nodiscard]] const Tile* findTile(int localX, int localY) const;
+
+    std::vector<std::atomic<Tile*>> tiles_;  ///< Tile grid over area_, nullptr = no coverage.
+    int tilesX_ = 0;                         ///< Tile columns.
+    Rect area_{0, 0, 0, 0};
+    Rect bounds_{0, 0, 0, 0};  ///< Union of marked regions this stroke.
+    Rect dirty_{0, 0, 0, 0};   ///< Union of marked regions since takeDirty().
+    bool active_ = false;
+};
+
+}  // namespace gimp
@@ -0,0 +1,114 @@
+/**
+ * @file stroke_interpolator.h
+ * @brief Places evenly spaced dabs along the input points of a stroke.
+ * @author Laurent Jiang
+ * @date 2026-03-01
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace gimp {
+
+/**
+ * @brief One dab of a stroke.
+ */
+struct StrokeDab {
+    float x = 0.0F;         ///< Center X in layer coordinates; integers are pixel centers.
+    float y = 0.0F;         ///< Center Y in layer coordinates; integers are pixel centers.
+    float pressure = 1.0F;  ///< Effective pressure of the dab.
+};
+
+/**
+ * @brief Turns the input points of a stroke into dab positions.
+ *
+ * Dabs are placed every spacing() pixels of path length. The distance left
+ * over at the end of a segment carries into the next one, so spacing stays
+ * even however the input events are spread: slow strokes do not pile dabs on
+ * top of each other and fast ones do not leave gaps. Positions are not
+ * rounded to pixels.
+ *
+ * With smoothing enabled the path is a Catmull-Rom spline through the input
+ * points. A segment then needs the point after it, so each call emits the
+ * dabs of the previous segment and finish() emits the last one.
+ *
+ * Each call returns the dabs it placed in a buffer that is reused by the next
+ * call, so a stroke does not allocate once the buffer has grown.
+ */
+class StrokeInterpolator {
+  public:
+    /*! @brief Sets the distance between dabs.
+     *  @param pixels Path length between dab centers, at least 0.25 pixels.
+     */
+    void setSpacing(float pixels);
+
+    /*! @brief Returns the distance between dabs.
+     *  @return Path length between dab centers in pixels.
+     */
+    [[nodiscard]] float spacing() const { return spacing_; }
+
+    /*! @brief Enables or disables Catmull-Rom smoothing of the path.
+     *  @param enabled True to curve through the input points.
+     */
+    void setSmoothing(bool enabled) { smoothing_ = enabled; }
+
+    /*! @brief Returns whether the path is smoothed.
+     *  @return True if input points are joined by a spline.
+     */
+    [[nodiscard]] bool smoothing() const { return smoothing_; }
+
+    /**
+     * @brief Starts a stroke with a dab at its first point.
+     * @param x First point X.
+     * @param y First point Y.
+     * @param pressure Pressure at the first point.
+     * @return The first dab.
+     */
+    const std::vector<StrokeDab>& begin(float x, float y, float pressure);
+
+    /**
+     * @brief Extends the stroke to the next input point.
+     * @param x Point X.
+     * @param y Point Y.
+     * @param pressure Pressure at the point; interpolated linearly between points.
+     * @return Dabs placed by this call, possibly none.
+     */
+    const std::vector<StrokeDab>& addPoint(float x, float y, float pressure);
+
+    /**
+     * @brief Ends the stroke.
+     * @return Dabs of the last smoothed segment; none without smoothing.
+     */
+    const std::vector<StrokeDab>& finish();
+
+    /*! @brief Abandons the stroke without placing further dabs. */
+    void reset();
+
+    /*! @brief Returns whether a stroke is in progress.
+     *  @return True between begin() and finish() or reset().
+     */
+    [[nodiscard]] bool active() const { return active_; }
+
+    /*! @brief Returns the most recent input point.
+     *  @return Last point passed to begin() or addPoint().
+     */
+    [[nodiscard]] const StrokeDab& lastPoint() const { return points_[2]; }
+
+  private:
+    void walkSegment(const StrokeDab& p0,
+                     const StrokeDab& p1,
+                     const StrokeDab& p2,
+                     const StrokeDab& p3);
+    void walkLine(const StrokeDab& from, const StrokeDab& to);
+
+    std::vector<StrokeDab> dabs_;  ///< Dabs placed by the current call.
+    StrokeDab points_[3];          ///< Last three input points, oldest first.
+    float nextDab_ = 0.0F;         ///< Path length from the walk position to the next dab.
+    float spacing_ = 1.0F;
+    bool smoothing_ = false;
+    bool pending_ = false;  ///< Whether the segment ending at points_[2] is still to be placed.
+    bool active_ = false;
+};
+
+}  // namespace gimp
@@ -0,0 +1,112 @@
+/**
+ * @file stroke_recorder.h
+ * @brief Lazy capture of the pixels a paint stroke overwrites.
+ * @author Laurent Jiang
+ * @date 2026-02-23
+ */
+
+#pragma once
+
+#include "core/tile_buffer.h"
+#include "core/tile_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace gimp {
+
+class DrawCommand;
+class Layer;
+
+/*!
+ * @class StrokeRecorder
+ * @brief Saves the original pixels of a layer tile by tile while a stroke paints on it.
+ *
+ * Paint and fill tools call record() with the bounds of each dab or span
+ * before rendering it.
+ * The first time a tile is touched its pixels are copied; later dabs on the
+ * same tile cost a hash lookup. finish() assembles the before state of the
+ * stroke bounds from the saved tiles (untouched tiles are read from the layer,
+ * which still holds their original pixels) and builds the DrawCommand;
+ * finishSnapshot() instead yields a whole-layer before snapshot for replayable
+ * commands. Work is proportional to the area painted, not to the size of the layer.
+ */
+class StrokeRecorder {
+  public:
+    static constexpr int kTileSize = 64;  ///< Edge length of a saved tile in pixels.
+
+    /*!
+     * @brief Starts recording a stroke, dropping any previous one.
+     * @param layer Layer the stroke paints on.
+     */
+    void begin(std::shared_ptr<Layer> layer);
+
+    /*!
+     * @brief Saves the tiles of a region that were not saved yet.
+     *
+     * Must be called before the region is modified.
+     *
+     * @param region Region about to be painted (clipped to the layer).
+     */
+    void record(const Rect& region);
+
+    /*!
+     * @brief Builds the undo command for the stroke and stops recording.
+     * @param region Bounds of the stroke (clipped to the layer).
+     * @return Command holding the before and current pixels of the region,
+     *         or nullptr if nothing is being recorded or the region is empty.
+     */
+    std::shared_ptr<DrawCommand> finish(const Rect& region);
+
+    /*! @brief Returns a snapshot of the layer as it was before the stroke and stops recording.
+     *
+     *  The snapshot is the layer's current snapshot with the saved tiles
+     *  written over it, so it shares every tile the stroke did not touch.
+     *  @return Before state of the whole layer, or an empty buffer if idle.
+     */
+    TileBuffer finishSnapshot();
+
+    /*! @brief Writes the saved tiles back into the layer and stops recording.
+     *
+     *  Used to roll back a cancelled stroke.
+     */
+    void restore();
+
+    /*!
+     * @brief Writes the saved pixels of a region back into the layer and keeps recording.
+     *
+     * Lets a stroke be redrawn from its original pixels. Parts of the region
+     * on tiles that were not saved are left alone.
+     *
+     * @param region Region to restore (clipped to the layer).
+     */
+    void restoreRegion(const Rect& region);
+
+    /*! @brief Stops recording and frees the saved tiles. */
+    void reset();
+
+    /*! @brief Returns true between begin() and finish() or reset().
+     *  @return True while recording.
+     */
+    [[nodiscard]] bool active() const { return m_layer != nullptr; }
+
+    /*! @brief Returns the number of tiles saved so far.
+     *  @return Saved tile count.
+     */
+    [[nodiscard]] std::size_t savedTileCount() const { return m_tiles.size(); }
+
+  private:
+    /// Copies one tile of the layer into m_tiles.
+    void saveTile(int tx, int ty);
+
+    std::shared_ptr<Layer> m_layer;  ///< Layer being recorded, null when idle.
+    int m_tilesX = 0;                ///< Tile columns of the layer.
+    std::size_t m_pixelBytes = 0;    ///< Bytes per pixel of the layer format.
+    /// Original pixels by tile index; rows are packed at the tile width clipped to the layer.
+    std::unordered_map<std::size_t, std::vector<std::uint8_t>> m_tiles;
+};
+
+}  // namespace gimp
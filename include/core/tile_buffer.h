@@ -0,0 +1,231 @@
+/**
+ * @file tile_buffer.h
+ * @brief Tiled RGBA pixel storage with copy-on-write tiles.
+ * @author Laurent Jiang
+ * @date 2026-02-14
+ */
+
+#pragma once
+
+#include "tile_store.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class TileBuffer
+ * @brief RGBA8 image split into fixed-size tiles held by shared pointers.
+ *
+ * Copying a TileBuffer is cheap: the copy shares every tile with the source.
+ * A tile is cloned the first time it is written through a buffer that shares it
+ * (copy-on-write), so snapshots only pay for the tiles that actually diverge.
+ * Fully transparent tiles are not allocated at all.
+ */
+class TileBuffer {
+    friend class WeakTileBuffer;
+
+  public:
+    static constexpr int kTileSize = 64;       ///< Tile edge length in pixels.
+    static constexpr int kBytesPerPixel = 4;   ///< RGBA, one byte per channel.
+    static constexpr std::size_t kTileBytes =  ///< Bytes held by one tile.
+        static_cast<std::size_t>(kTileSize) * kTileSize * kBytesPerPixel;
+
+    /*!
+     * @struct Tile
+     * @brief Pixel payload of a single tile (row-major, kTileSize * 4 bytes per row).
+     */
+    struct Tile {
+        std::array<std::uint8_t, kTileBytes> pixels{};  ///< RGBA pixel data.
+        /// Set once a WeakTileBuffer records the tile; writers copy it from then on.
+        std::atomic<bool> tracked{false};
+    };
+
+    TileBuffer() = default;
+
+    /*!
+     * @brief Constructs a fully transparent buffer.
+     * @param width Width in pixels.
+     * @param height Height in pixels.
+     */
+    TileBuffer(int width, int height);
+
+    /*! @brief Returns the buffer width.
+     *  @return Width in pixels.
+     */
+    [[nodiscard]] int width() const { return m_width; }
+
+    /*! @brief Returns the buffer height.
+     *  @return Height in pixels.
+     */
+    [[nodiscard]] int height() const { return m_height; }
+
+    /*! @brief Returns the number of tile columns.
+     *  @return Tile count along X.
+     */
+    [[nodiscard]] int tilesX() const { return m_tilesX; }
+
+    /*! @brief Returns the number of tile rows.
+     *  @return Tile count along Y.
+     */
+    [[nodiscard]] int tilesY() const { return m_tilesY; }
+
+    /*! @brief Returns true if the buffer has no pixels.
+     *  @return True when width or height is zero.
+     */
+    [[nodiscard]] bool empty() const { return m_tiles.empty(); }
+
+    /*!
+     * @brief Returns read access to a tile.
+     * @param tx Tile column.
+     * @param ty Tile row.
+     * @return Pointer to the tile pixels, or nullptr if the tile is transparent.
+     */
+    [[nodiscard]] const std::uint8_t* tileData(int tx, int ty) const;
+
+    /*!
+     * @brief Returns write access to a tile, allocating or unsharing it first.
+     * @param tx Tile column.
+     * @param ty Tile row.
+     * @return Pointer to pixels owned exclusively by this buffer.
+     */
+    std::uint8_t* mutableTileData(int tx, int ty);
+
+    /*!
+     * @brief Returns true if both buffers reference the same tile storage.
+     * @param other Buffer to compare with.
+     * @param tx Tile column.
+     * @param ty Tile row.
+     * @return True when the tile is shared (or transparent in both).
+     */
+    [[nodiscard]] bool sharesTile(const TileBuffer& other, int tx, int ty) const;
+
+    /*!
+     * @brief Returns true if no other buffer references a tile.
+     * @param tx Tile column.
+     * @param ty Tile row.
+     * @return True when the tile is allocated and held by this buffer alone.
+     */
+    [[nodiscard]] bool ownsTile(int tx, int ty) const;
+
+    /*!
+     * @brief Drops this buffer's reference to a tile; it reads as transparent afterwards.
+     * @param tx Tile column.
+     * @param ty Tile row.
+     */
+    void releaseTile(int tx, int ty);
+
+    /*!
+     * @brief Copies a region into a linear RGBA buffer.
+     * @param region Source rectangle (must lie inside the buffer).
+     * @param dst Destination pixels.
+     * @param dstStride Destination row stride in bytes.
+     */
+    void readRegion(const Rect& region, std::uint8_t* dst, std::size_t dstStride) const;
+
+    /*!
+     * @brief Copies a linear RGBA buffer into a region, unsharing touched tiles.
+     * @param region Destination rectangle (must lie inside the buffer).
+     * @param src Source pixels.
+     * @param srcStride Source row stride in bytes.
+     */
+    void writeRegion(const Rect& region, const std::uint8_t* src, std::size_t srcStride);
+
+    /*!
+     * @brief Copies part of one row into a linear buffer.
+     * @param y Row index.
+     * @param x First column.
+     * @param count Number of pixels.
+     * @param dst Destination pixels (count * 4 bytes).
+     */
+    void readRow(int y, int x, int count, std::uint8_t* dst) const;
+
+    /*!
+     * @brief Writes part of one row from a linear buffer.
+     * @param y Row index.
+     * @param x First column.
+     * @param count Number of pixels.
+     * @param src Source pixels (count * 4 bytes).
+     */
+    void writeRow(int y, int x, int count, const std::uint8_t* src);
+
+    /*!
+     * @brief Updates tiles overlapping a region from a full-size linear image.
+     *
+     * Tiles whose content is unchanged keep their current (possibly shared)
+     * storage; only tiles that differ are unshared and rewritten.
+     *
+     * @param linear Full linear RGBA image of the same dimensions.
+     * @param stride Row stride of the linear image in bytes.
+     * @param region Region to synchronize (clipped to the buffer).
+     * @return Number of tiles whose storage changed.
+     */
+    std::size_t syncFrom(const std::uint8_t* linear, std::size_t stride, const Rect& region);
+
+    /*! @brief Returns the number of allocated (non-transparent) tiles.
+     *  @return Allocated tile count.
+     */
+    [[nodiscard]] std::size_t allocatedTileCount() const;
+
+    /*! @brief Returns the bytes referenced by this buffer, shared or not.
+     *  @return Allocated tile count times kTileBytes.
+     */
+    [[nodiscard]] std::size_t byteSize() const;
+
+    /*! @brief Returns the bytes held only by this buffer (tiles shared with no one).
+     *  @return Exclusive tile count times kTileBytes.
+     */
+    [[nodiscard]] std::size_t exclusiveByteSize() const;
+
+  private:
+    [[nodiscard]] std::size_t tileIndex(int tx, int ty) const
+    {
+        return static_cast<std::size_t>(ty) * static_cast<std::size_t>(m_tilesX) +
+               static_cast<std::size_t>(tx);
+    }
+
+    int m_width = 0;                            ///< Width in pixels.
+    int m_height = 0;                           ///< Height in pixels.
+    int m_tilesX = 0;                           ///< Tile columns.
+    int m_tilesY = 0;                           ///< Tile rows.
+    std::vector<std::shared_ptr<Tile>> m_tiles;  ///< Tile grid, nullptr = transparent.
+};
+
+/*!
+ * @class WeakTileBuffer
+ * @brief Records the tiles of a TileBuffer without keeping them alive.
+ *
+ * Tiles are freed as soon as no TileBuffer references them. Recorded tiles
+ * are never written in place afterwards (writers unshare them first), so a
+ * tile that is still alive holds exactly the pixels it had when recorded.
+ */
+class WeakTileBuffer {
+  public:
+    WeakTileBuffer() = default;
+
+    /*!
+     * @brief Records the tiles of a buffer.
+     * @param tiles Buffer whose tiles are recorded.
+     */
+    explicit WeakTileBuffer(const TileBuffer& tiles);
+
+    /*!
+     * @brief Returns a buffer sharing every recorded tile that is still alive.
+     * @param expired Receives the regions of recorded tiles that were freed since.
+     * @return Buffer of the recorded dimensions; freed tiles read as transparent.
+     */
+    [[nodiscard]] TileBuffer lock(std::vector<Rect>& expired) const;
+
+  private:
+    int m_width = 0;                                       ///< Width in pixels.
+    int m_height = 0;                                      ///< Height in pixels.
+    std::vector<std::weak_ptr<TileBuffer::Tile>> m_tiles;  ///< Tile grid.
+    std::vector<bool> m_allocated;                         ///< Tiles that were allocated.
+};
+
+}  // namespace gimp
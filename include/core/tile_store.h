@@ -8,9 +8,12 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 namespace gimp {
 
+class Layer;
+
 /*!
  * @struct Rect
  * @brief Axis-aligned rectangle for region specification.
@@ -25,6 +28,9 @@ struct Rect {
 /*!
  * @class TileStore
  * @brief Abstract interface for tile-based dirty region tracking.
+ *
+ * Producers (tools, commands) report modified regions; the renderer consumes
+ * the accumulated dirty rectangles once per frame and then clears them.
  */
 class TileStore {
   public:
@@ -35,5 +41,42 @@ class TileStore {
      * @param region The rectangle to invalidate.
      */
     virtual void invalidate(const Rect& region) = 0;
+
+    /*!
+     * @brief Marks a region of a specific layer as modified.
+     *
+     * Also invalidates the same region of the composite.
+     *
+     * @param layer The layer whose pixels changed.
+     * @param region The modified rectangle in canvas coordinates.
+     */
+    virtual void invalidateLayer(const Layer& layer, const Rect& region) = 0;
+
+    /*! @brief Marks the whole canvas as needing redraw. */
+    virtual void invalidateAll() = 0;
+
+    /*! @brief Returns true if the whole canvas must be redrawn.
+     *  @return Full invalidation state.
+     */
+    [[nodiscard]] virtual bool isFullyInvalid() const = 0;
+
+    /*! @brief Returns true if any region is waiting to be redrawn.
+     *  @return True if dirtyRects() is non-empty or the canvas is fully invalid.
+     */
+    [[nodiscard]] virtual bool hasDirtyRegions() const = 0;
+
+    /*! @brief Returns the coalesced dirty rectangles of the composite.
+     *  @return Non-overlapping rectangles in canvas coordinates.
+     */
+    [[nodiscard]] virtual std::vector<Rect> dirtyRects() const = 0;
+
+    /*! @brief Returns the coalesced dirty rectangles of one layer.
+     *  @param layer The layer to query.
+     *  @return Non-overlapping rectangles in canvas coordinates.
+     */
+    [[nodiscard]] virtual std::vector<Rect> dirtyRects(const Layer& layer) const = 0;
+
+    /*! @brief Forgets all dirty regions once they have been redrawn. */
+    virtual void clear() = 0;
 };
 }  // namespace gimp
@@ -17,6 +17,8 @@ namespace gimp {
 
 class Document;
 class CommandBus;
+class Layer;
+struct Rect;
 
 /**
  * @brief Input event data passed to tools during mouse interactions.
@@ -139,7 +141,27 @@ class Tool {
      */
     virtual bool onKeyRelease(Qt::Key key, Qt::KeyboardModifiers modifiers);
 
+    /**
+     * @brief Called before the canvas draws a frame.
+     *
+     * Tools that defer writing pixels while a stroke is in progress apply
+     * the pending changes here and invalidate them, so the layer is updated
+     * at most once per frame however many input events arrived.
+     */
+    virtual void prepareFrame() {}
+
   protected:
+    /**
+     * @brief Reports modified layer pixels to the document's tile store.
+     *
+     * Tools call this after writing pixels so the renderer only recomposites
+     * the affected tiles. Does nothing without a document.
+     *
+     * @param layer The layer that was modified.
+     * @param region The modified rectangle in canvas coordinates.
+     */
+    void invalidateRegion(const Layer& layer, const Rect& region) const;
+
     /*! @brief Called when transitioning from Idle to Active.
      *  @param event The triggering input event.
      */
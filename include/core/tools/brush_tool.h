@@ -9,7 +9,10 @@
 
 #include "core/brush_dynamics.h"
 #include "core/brush_strategy.h"
-#include "core/commands/draw_command.h"
+#include "core/commands/stroke_command.h"
+#include "core/stroke_buffer.h"
+#include "core/stroke_interpolator.h"
+#include "core/stroke_recorder.h"
 #include "core/tool.h"
 #include "core/tool_factory.h"
 #include "core/tool_options.h"
@@ -25,7 +28,8 @@ namespace gimp {
  *
  * The brush tool uses a SoftBrush strategy to render strokes with
  * variable edge softness controlled by the hardness parameter.
- * Opacity controls the overall transparency of the stroke.
+ * Opacity controls the overall transparency of the stroke: dabs collect in a
+ * StrokeBuffer, so overlapping dabs do not build up alpha.
  */
 class BrushTool : public Tool, public ToolOptions {
   public:
@@ -84,11 +88,24 @@ class BrushTool : public Tool, public ToolOptions {
      */
     [[nodiscard]] bool velocityDynamics() const { return dynamics_.config().useVelocity; }
 
+    /*! @brief Enables or disables smoothing of the stroke path.
+     *  @param enabled True to curve the stroke through the input points.
+     */
+    void setSmoothing(bool enabled) { interpolator_.setSmoothing(enabled); }
+
+    /*! @brief Returns whether the stroke path is smoothed.
+     *  @return True if smoothing is enabled.
+     */
+    [[nodiscard]] bool smoothing() const { return interpolator_.smoothing(); }
+
     /*! @brief Returns a reference to the dynamics configuration.
      *  @return Reference to DynamicsConfig for full customization.
      */
     [[nodiscard]] DynamicsConfig& dynamicsConfig() { return dynamics_.config(); }
 
+    /*! @brief Composites the dabs placed since the last frame onto the layer. */
+    void prepareFrame() override;
+
   protected:
     void beginStroke(const ToolInputEvent& event) override;
     void continueStroke(const ToolInputEvent& event) override;
@@ -103,27 +120,18 @@ class BrushTool : public Tool, public ToolOptions {
         const std::string& optionId) const override;
 
   private:
-    /**
-     * @brief Single point in a stroke.
-     */
-    struct StrokePoint {
-        int x = 0;              ///< X coordinate in canvas space.
-        int y = 0;              ///< Y coordinate in canvas space.
-        float pressure = 1.0F;  ///< Pen pressure.
-    };
-
-    std::shared_ptr<DrawCommand> buildDrawCommand(int minX, int maxX, int minY, int maxY);
-    void renderSegment(int fromX,
-                       int fromY,
-                       float fromPressure,
-                       int toX,
-                       int toY,
-                       float toPressure);
+    std::shared_ptr<StrokeCommand> buildStrokeCommand();
+    void extendStroke(const ToolInputEvent& event);
+    void renderDabs(const std::vector<StrokeDab>& dabs);
+    void compositeStroke();
 
     std::unique_ptr<SoftBrush> brush_;
     BrushDynamics dynamics_;
-    std::vector<StrokePoint> strokePoints_;
-    std::vector<uint8_t> beforeState_;    ///< Layer data before stroke for undo.
+    StrokeInterpolator interpolator_;     ///< Places dabs along the input points.
+    std::vector<StrokeDab> dabs_;         ///< Dabs rendered so far, replayed by the command.
+    StrokeParams stroke_;                 ///< Brush settings latched at stroke start.
+    StrokeRecorder recorder_;             ///< Original pixels of the tiles the stroke touched.
+    StrokeBuffer buffer_;                 ///< Coverage of the stroke, composited per frame.
     std::shared_ptr<Layer> activeLayer_;  ///< Layer being drawn on during stroke.
     int brushSize_ = 20;
     float hardness_ = 0.5F;
@@ -7,7 +7,11 @@
 
 #pragma once
 
-#include "core/commands/draw_command.h"
+#include "core/brush_strategy.h"
+#include "core/commands/stroke_command.h"
+#include "core/stroke_buffer.h"
+#include "core/stroke_interpolator.h"
+#include "core/stroke_recorder.h"
 #include "core/tool.h"
 #include "core/tool_options.h"
 
@@ -61,6 +65,9 @@ class EraserTool : public Tool, public ToolOptions {
      */
     [[nodiscard]] float opacity() const { return opacity_; }
 
+    /*! @brief Composites the dabs placed since the last frame onto the layer. */
+    void prepareFrame() override;
+
   protected:
     void beginStroke(const ToolInputEvent& event) override;
     void continueStroke(const ToolInputEvent& event) override;
@@ -75,26 +82,17 @@ class EraserTool : public Tool, public ToolOptions {
         const std::string& optionId) const override;
 
   private:
-    /**
-     * @brief Single point in a stroke.
-     */
-    struct StrokePoint {
-        int x = 0;              ///< X coordinate in canvas space.
-        int y = 0;              ///< Y coordinate in canvas space.
-        float pressure = 1.0F;  ///< Pen pressure.
-    };
-
-    std::shared_ptr<DrawCommand> buildDrawCommand(int minX, int maxX, int minY, int maxY);
-    void renderSegment(int fromX,
-                       int fromY,
-                       float fromPressure,
-                       int toX,
-                       int toY,
-                       float toPressure);
-    void eraseAt(int x, int y, float pressure);
-
-    std::vector<StrokePoint> strokePoints_;
-    std::vector<uint8_t> beforeState_;    ///< Layer data before stroke for undo.
+    std::shared_ptr<StrokeCommand> buildStrokeCommand();
+    void extendStroke(const ToolInputEvent& event);
+    void renderDabs(const std::vector<StrokeDab>& dabs);
+    void compositeStroke();
+
+    StrokeInterpolator interpolator_;     ///< Places dabs along the input points.
+    std::vector<StrokeDab> dabs_;         ///< Dabs rendered so far, replayed by the command.
+    StrokeParams stroke_;                 ///< Eraser settings latched at stroke start.
+    EraserBrush eraser_;                  ///< Dab renderer configured from stroke_.
+    StrokeRecorder recorder_;             ///< Original pixels of the tiles the stroke touched.
+    StrokeBuffer buffer_;                 ///< Coverage of the stroke, composited per frame.
     std::shared_ptr<Layer> activeLayer_;  ///< Layer being erased during stroke.
     int brushSize_ = 10;
     float hardness_ = 0.5F;
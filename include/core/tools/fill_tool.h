@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/stroke_recorder.h"
 #include "core/tool.h"
 #include "core/tool_factory.h"
 #include "core/tool_options.h"
@@ -71,8 +72,9 @@ class FillTool : public Tool, public ToolOptions {
      * @param startX Starting X coordinate.
      * @param startY Starting Y coordinate.
      * @param fillColor The color to fill with (RGBA).
+     * @return Bounds of the filled pixels; empty if nothing was filled.
      */
-    void floodFill(int startX, int startY, std::uint32_t fillColor);
+    Rect floodFill(int startX, int startY, std::uint32_t fillColor);
 
     /**
      * @brief Checks if a pixel's color matches the target within tolerance.
@@ -106,7 +108,8 @@ class FillTool : public Tool, public ToolOptions {
                               int width,
                               std::uint32_t color);
 
-    std::vector<uint8_t> beforeState_;    ///< Layer data before fill for undo.
+    StrokeRecorder recorder_;             ///< Original pixels of the tiles the fill touched.
+    Rect fillBounds_{0, 0, 0, 0};         ///< Bounds of the pending fill.
     std::shared_ptr<Layer> activeLayer_;  ///< Layer being filled.
     int tolerance_ = 0;                   ///< Color matching tolerance (0-255).
     bool fillPending_ = false;            ///< Whether a fill operation is pending commit.
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/commands/gradient_command.h"
 #include "core/tool.h"
 #include "core/tool_options.h"
 
@@ -20,15 +21,6 @@ namespace gimp {
 
 class Document;
 class Layer;
-class DrawCommand;
-
-/**
- * @brief Gradient mode enumeration.
- */
-enum class GradientMode {
-    Linear,  ///< Linear gradient from start to end point
-    Radial   ///< Radial gradient from center point
-};
 
 /**
  * @brief Gradient fill mode.
@@ -45,7 +37,8 @@ enum class GradientFill {
  * - Linear gradients (drag from start to end point)
  * - Radial gradients (drag to define radius)
  * - Foreground-to-background and foreground-to-transparent modes
- * - Undo/redo via DrawCommand
+ * - Undo/redo via GradientCommand, which stores the gradient parameters
+ *   instead of the rendered pixels
  */
 class GradientTool : public Tool, public ToolOptions {
   public:
@@ -122,26 +115,6 @@ class GradientTool : public Tool, public ToolOptions {
     void cancelStroke() override;
 
   private:
-    /**
-     * @brief Applies a linear gradient to the layer.
-     * @param layer The target layer.
-     * @param startColor Starting color (RGBA).
-     * @param endColor Ending color (RGBA).
-     */
-    void applyLinearGradient(const std::shared_ptr<Layer>& layer,
-                             std::uint32_t startColor,
-                             std::uint32_t endColor) const;
-
-    /**
-     * @brief Applies a radial gradient to the layer.
-     * @param layer The target layer.
-     * @param startColor Starting color (RGBA).
-     * @param endColor Ending color (RGBA).
-     */
-    void applyRadialGradient(const std::shared_ptr<Layer>& layer,
-                             std::uint32_t startColor,
-                             std::uint32_t endColor) const;
-
     GradientMode mode_ = GradientMode::Linear;
     GradientFill fill_ = GradientFill::ForegroundToBackground;
 
@@ -150,8 +123,6 @@ class GradientTool : public Tool, public ToolOptions {
     int endX_ = 0;
     int endY_ = 0;
 
-    std::vector<std::uint8_t> beforeState_;
-    std::shared_ptr<DrawCommand> command_;
     std::shared_ptr<Layer> activeLayer_;  ///< Layer being drawn on during stroke.
 };
 
@@ -7,7 +7,11 @@
 
 #pragma once
 
-#include "core/commands/draw_command.h"
+#include "core/brush_strategy.h"
+#include "core/commands/stroke_command.h"
+#include "core/stroke_buffer.h"
+#include "core/stroke_interpolator.h"
+#include "core/stroke_recorder.h"
 #include "core/tool.h"
 #include "core/tool_factory.h"
 #include "core/tool_options.h"
@@ -51,6 +55,9 @@ class PencilTool : public Tool, public ToolOptions {
      */
     [[nodiscard]] std::uint32_t color() const { return ToolFactory::instance().foregroundColor(); }
 
+    /*! @brief Composites the dabs placed since the last frame onto the layer. */
+    void prepareFrame() override;
+
   protected:
     void beginStroke(const ToolInputEvent& event) override;
     void continueStroke(const ToolInputEvent& event) override;
@@ -65,25 +72,17 @@ class PencilTool : public Tool, public ToolOptions {
         const std::string& optionId) const override;
 
   private:
-    /**
-     * @brief Single point in a stroke.
-     */
-    struct StrokePoint {
-        int x = 0;              ///< X coordinate in canvas space.
-        int y = 0;              ///< Y coordinate in canvas space.
-        float pressure = 1.0F;  ///< Pen pressure.
-    };
-
-    std::shared_ptr<DrawCommand> buildDrawCommand(int minX, int maxX, int minY, int maxY);
-    void renderSegment(int fromX,
-                       int fromY,
-                       float fromPressure,
-                       int toX,
-                       int toY,
-                       float toPressure);
-
-    std::vector<StrokePoint> strokePoints_;
-    std::vector<uint8_t> beforeState_;    ///< Layer data before stroke for undo.
+    std::shared_ptr<StrokeCommand> buildStrokeCommand();
+    void extendStroke(const ToolInputEvent& event);
+    void renderDabs(const std::vector<StrokeDab>& dabs);
+    void compositeStroke();
+
+    StrokeInterpolator interpolator_;     ///< Places dabs along the input points.
+    std::vector<StrokeDab> dabs_;         ///< Dabs rendered so far, replayed by the command.
+    StrokeParams stroke_;                 ///< Brush settings latched at stroke start.
+    SolidBrush brush_;                    ///< Hard dab renderer.
+    StrokeRecorder recorder_;             ///< Original pixels of the tiles the stroke touched.
+    StrokeBuffer buffer_;                 ///< Coverage of the stroke, composited per frame.
     std::shared_ptr<Layer> activeLayer_;  ///< Layer being drawn on during stroke.
     int brushSize_ = 3;
     float opacity_ = 1.0F;  ///< Opacity/alpha value (0.0 to 1.0)
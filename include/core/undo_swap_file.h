@@ -0,0 +1,229 @@
+/**
+ * @file undo_swap_file.h
+ * @brief Temporary file that holds undo state paged out of memory.
+ * @author Laurent Jiang
+ * @date 2026-02-22
+ */
+
+#pragma once
+
+#include "core/tile_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class UndoSwapFile
+ * @brief Swap file for cold undo payloads.
+ *
+ * Space is handed out in extents. Released extents are merged with free
+ * neighbours and reused first-fit, so the file only grows when no hole is
+ * large enough. The file is created in a temporary directory and deleted
+ * when the last reference goes away. All members are thread-safe.
+ */
+class UndoSwapFile {
+  public:
+    /*!
+     * @struct Extent
+     * @brief Byte range of the swap file owned by one payload.
+     */
+    struct Extent {
+        std::uint64_t offset = 0;  ///< First byte in the file.
+        std::uint64_t size = 0;    ///< Length in bytes.
+    };
+
+    /*!
+     * @brief Creates a swap file with a unique name.
+     * @param directory Directory to create the file in.
+     * @return The swap file, or nullptr if it cannot be created.
+     */
+    static std::shared_ptr<UndoSwapFile> create(
+        const std::filesystem::path& directory = std::filesystem::temp_directory_path());
+
+    ~UndoSwapFile();
+
+    UndoSwapFile(const UndoSwapFile&) = delete;
+    UndoSwapFile& operator=(const UndoSwapFile&) = delete;
+
+    /*!
+     * @brief Reserves space in the file.
+     * @param size Bytes to reserve; must be positive.
+     * @return The reserved extent, or std::nullopt if size is zero.
+     */
+    std::optional<Extent> allocate(std::uint64_t size);
+
+    /*!
+     * @brief Writes bytes into an extent.
+     * @param extent Extent returned by allocate().
+     * @param offset Offset inside the extent.
+     * @param data Bytes to write.
+     * @param size Number of bytes; offset + size must not exceed the extent.
+     * @return False on I/O errors or out-of-range writes.
+     */
+    bool write(const Extent& extent, std::uint64_t offset, const void* data, std::size_t size);
+
+    /*!
+     * @brief Reads bytes from an extent.
+     * @param extent Extent returned by allocate().
+     * @param offset Offset inside the extent.
+     * @param out Destination buffer.
+     * @param size Number of bytes; offset + size must not exceed the extent.
+     * @return False on I/O errors or out-of-range reads.
+     */
+    bool read(const Extent& extent, std::uint64_t offset, void* out, std::size_t size);
+
+    /*!
+     * @brief Returns an extent to the free list.
+     * @param extent Extent returned by allocate(); must not be used afterwards.
+     */
+    void release(const Extent& extent);
+
+    /*! @brief Returns the bytes held by live extents.
+     *  @return Allocated bytes.
+     */
+    [[nodiscard]] std::uint64_t usedBytes() const;
+
+    /*! @brief Returns the path of the swap file.
+     *  @return File path.
+     */
+    [[nodiscard]] const std::filesystem::path& path() const { return m_path; }
+
+  private:
+    UndoSwapFile(std::filesystem::path path, std::fstream file);
+
+    std::filesystem::path m_path;                   ///< Location of the file.
+    std::fstream m_file;                            ///< Open read/write stream.
+    std::map<std::uint64_t, std::uint64_t> m_free;  ///< Free extents: offset -> size.
+    std::uint64_t m_end = 0;                        ///< End of the used part of the file.
+    std::uint64_t m_used = 0;                       ///< Bytes held by live extents.
+    mutable std::mutex m_mutex;                     ///< Guards the stream and the free list.
+};
+
+/*!
+ * @class SwapBlock
+ * @brief Owns one extent of an UndoSwapFile and releases it on destruction.
+ */
+class SwapBlock {
+  public:
+    SwapBlock() = default;
+    ~SwapBlock();
+
+    SwapBlock(const SwapBlock&) = delete;
+    SwapBlock& operator=(const SwapBlock&) = delete;
+    SwapBlock(SwapBlock&& other) noexcept;
+    SwapBlock& operator=(SwapBlock&& other) noexcept;
+
+    /*!
+     * @brief Reserves space for later write() calls, releasing any previous extent.
+     * @param swap Swap file to allocate from.
+     * @param size Bytes to reserve.
+     * @return False if the swap file is null or size is zero.
+     */
+    bool allocate(const std::shared_ptr<UndoSwapFile>& swap, std::uint64_t size);
+
+    /*!
+     * @brief Writes a whole buffer into a new extent.
+     * @param swap Swap file to write to.
+     * @param data Bytes to store; an empty buffer is stored without touching the file.
+     * @return False on I/O errors; the block is then empty.
+     */
+    bool store(const std::shared_ptr<UndoSwapFile>& swap, const std::vector<std::uint8_t>& data);
+
+    /*!
+     * @brief Reads back a buffer written by store().
+     * @param out Receives size() bytes.
+     * @return False on I/O errors.
+     */
+    bool load(std::vector<std::uint8_t>& out) const;
+
+    /*!
+     * @brief Writes bytes at an offset of the block.
+     * @param offset Offset inside the block.
+     * @param data Bytes to write.
+     * @param size Number of bytes; offset + size must not exceed size().
+     * @return False on I/O errors or if the block is empty.
+     */
+    bool write(std::uint64_t offset, const void* data, std::size_t size);
+
+    /*!
+     * @brief Reads bytes at an offset of the block.
+     * @param offset Offset inside the block.
+     * @param out Destination buffer.
+     * @param size Number of bytes; offset + size must not exceed size().
+     * @return False on I/O errors or if the block is empty.
+     */
+    bool read(std::uint64_t offset, void* out, std::size_t size) const;
+
+    /*! @brief Releases the extent. */
+    void reset();
+
+    /*! @brief Returns the number of bytes in the block.
+     *  @return Block size; 0 when empty.
+     */
+    [[nodiscard]] std::uint64_t size() const { return m_extent.size; }
+
+  private:
+    std::shared_ptr<UndoSwapFile> m_swap;  ///< Owner of the extent, null when empty.
+    UndoSwapFile::Extent m_extent;         ///< Reserved byte range.
+};
+
+/*!
+ * @class SwappedTiles
+ * @brief A TileBuffer written out to an UndoSwapFile.
+ *
+ * Only tiles the buffer owns alone are written; tiles shared with other
+ * buffers (neighbouring checkpoints, the layer's snapshot) stay referenced in
+ * memory, since writing them out would free nothing, and are shared again on
+ * load(). Transparent tiles stay implicit. The tile index list remains in memory.
+ */
+class SwappedTiles {
+  public:
+    /*!
+     * @brief Writes the tiles of a buffer to the swap file.
+     *
+     * The caller is expected to drop its buffer afterwards, which frees the
+     * tiles that were written.
+     *
+     * @param swap Swap file to write to.
+     * @param tiles Buffer to store.
+     * @return False on I/O errors; nothing is stored then.
+     */
+    bool store(const std::shared_ptr<UndoSwapFile>& swap, const TileBuffer& tiles);
+
+    /*!
+     * @brief Rebuilds the stored buffer.
+     * @param tiles Receives the buffer.
+     * @return False if nothing is stored or on I/O errors.
+     */
+    bool load(TileBuffer& tiles) const;
+
+    /*! @brief Returns the bytes of kept tiles that no other buffer references any more.
+     *  @return Exclusive bytes of the tiles kept in memory.
+     */
+    [[nodiscard]] std::size_t residentByteSize() const { return m_resident.exclusiveByteSize(); }
+
+    /*! @brief Returns true if no buffer is stored.
+     *  @return True before store() succeeded or after reset().
+     */
+    [[nodiscard]] bool empty() const { return !m_stored; }
+
+    /*! @brief Releases the stored tiles. */
+    void reset();
+
+  private:
+    TileBuffer m_resident;                 ///< Shared tiles, kept by reference.
+    std::vector<std::uint32_t> m_indices;  ///< Written tiles, row-major tile index.
+    SwapBlock m_block;                     ///< Tile payloads in m_indices order.
+    bool m_stored = false;                 ///< True while a buffer is stored.
+};
+
+}  // namespace gimp
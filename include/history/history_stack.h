@@ -7,11 +7,15 @@
 
 #pragma once
 
+#include <cstddef>
 #include <deque>
 #include <memory>
+#include <unordered_map>
 
 namespace gimp {
 class Command;
+class ReplayableCommand;
+class UndoSwapFile;
 
 /**
  * @class HistoryStack
@@ -20,9 +24,25 @@ class Command;
  * This class maintains two stacks: one for undo history and one for redo history.
  * Commands are pushed onto the undo stack, and undo/redo operations manage
  * movement between the two stacks.
+ *
+ * Consecutive ReplayableCommand entries on the same layer form a run. Only
+ * some commands of a run keep a pixel checkpoint: one is kept at the start
+ * of the run and whenever the commands since the last checkpoint reach a
+ * count or replay cost limit. Undoing a command without a checkpoint
+ * restores the nearest earlier one and replays forward.
+ *
+ * The bytes held by the history are kept as a running total. Each
+ * operation re-measures only the commands it touches, and a dropped command
+ * triggers a full re-measure: the tiles it shared may now be held by a
+ * single other command.
  */
 class HistoryStack {
   public:
+    /// Default number of replayable commands per checkpoint.
+    static constexpr size_t kDefaultCheckpointInterval = 16;
+    /// Default replay work between checkpoints, in pixels (64 Mpx).
+    static constexpr size_t kDefaultCheckpointCost = size_t{64} << 20;
+
     HistoryStack() = default;
     ~HistoryStack() = default;
 
@@ -48,6 +68,17 @@ class HistoryStack {
      */
     bool redo();
 
+    /**
+     * @brief Merge a command into the newest undoable command.
+     *
+     * Only possible while the redo stack is empty, so the merged entry
+     * always ends at the current state.
+     *
+     * @param command Command applied right after the newest entry.
+     * @return true if the newest entry absorbed the command.
+     */
+    bool merge_top(Command& command);
+
     /**
      * @brief Clear all history.
      */
@@ -81,8 +112,83 @@ class HistoryStack {
      */
     [[nodiscard]] size_t redo_size() const;
 
+    /**
+     * @brief Get the memory held by all commands in both stacks.
+     *
+     * Cheap: returns the running total. It can overestimate after a push,
+     * because a new checkpoint may share tiles that an earlier one counted
+     * as its own until then. Use measure_byte_size() before evicting.
+     *
+     * @return Sum of the last measured Command::byteSize() of each command.
+     */
+    [[nodiscard]] size_t byte_size() const;
+
+    /**
+     * @brief Re-measure every command and refresh the running total.
+     *
+     * @return Sum of Command::byteSize() over the undo and redo stacks.
+     */
+    size_t measure_byte_size();
+
+    /**
+     * @brief Discard the oldest undoable command.
+     *
+     * The command can no longer be undone; later commands are unaffected.
+     * Every remaining command is re-measured afterwards, so byte_size() is
+     * exact.
+     *
+     * @return Bytes released, or 0 if the undo stack is empty.
+     */
+    size_t drop_oldest();
+
+    /**
+     * @brief Page undoable commands out to a swap file, oldest first.
+     *
+     * Stops once the resident bytes fit the budget. The newest undoable
+     * command stays resident so the next undo does not touch the disk.
+     *
+     * @param swap Swap file to write to.
+     * @param budget Resident bytes to get under.
+     * @return Resident bytes afterwards, see byte_size().
+     */
+    size_t spill_oldest(const std::shared_ptr<UndoSwapFile>& swap, size_t budget);
+
+    /**
+     * @brief Set how many replayable commands may share one checkpoint.
+     *
+     * Applies to commands pushed afterwards.
+     *
+     * @param commands Commands replayed at most by one undo; 1 keeps every checkpoint.
+     */
+    void set_checkpoint_interval(size_t commands);
+
+    /**
+     * @brief Set the replay work after which a new checkpoint is kept.
+     *
+     * Applies to commands pushed afterwards.
+     *
+     * @param pixels Sum of ReplayableCommand::replayCost() between checkpoints.
+     */
+    void set_checkpoint_cost(size_t pixels);
+
   private:
+    /// Keeps or drops the checkpoint of a command about to be pushed.
+    void place_checkpoint(ReplayableCommand& command) const;
+
+    /// Undoes a command without a checkpoint by replaying its run.
+    void replay_to(ReplayableCommand& command);
+
+    /// Removes the oldest undoable command, rebasing the command that depends on it.
+    void drop_front();
+
+    /// Updates the recorded size of one command and the running total.
+    void remeasure(const Command& command);
+
     std::deque<std::shared_ptr<Command>> undo_stack_;
     std::deque<std::shared_ptr<Command>> redo_stack_;
+    std::unordered_map<const Command*, size_t> sizes_;  ///< Last measured byteSize().
+    size_t bytes_ = 0;                                  ///< Sum of sizes_.
+    size_t checkpoint_interval_ = kDefaultCheckpointInterval;
+    size_t checkpoint_cost_ = kDefaultCheckpointCost;
 };
 }  // namespace gimp
@@ -13,16 +13,27 @@
 
 namespace gimp {
 class HistoryStack;
+class UndoSwapFile;
 
 /**
  * @class SimpleHistoryManager
  * @brief Concrete implementation of HistoryManager using HistoryStack.
  *
  * This manager wraps a HistoryStack to provide command history management
- * with undo/redo functionality.
+ * with undo/redo functionality. The history is kept within a memory budget:
+ * when a push exceeds it, the oldest undo steps are paged out to the swap
+ * file (if one is set), and discarded when that is not possible or the swap
+ * file outgrows its own budget. The most recent command is always kept, even
+ * when it alone exceeds the budget. Every change publishes a
+ * HistoryChangedEvent.
  */
 class SimpleHistoryManager final : public HistoryManager {
   public:
+    /// Default memory budget for undo/redo state (1 GiB).
+    static constexpr size_t kDefaultMemoryBudget = size_t{1} << 30;
+    /// Default disk budget for spilled undo state (16 GiB).
+    static constexpr size_t kDefaultSwapBudget = size_t{16} << 30;
+
     /**
      * @brief Construct a SimpleHistoryManager with a new history stack.
      */
@@ -40,6 +51,7 @@ class SimpleHistoryManager final : public HistoryManager {
     void push(std::shared_ptr<Command> command) override;
     bool undo() override;
     bool redo() override;
+    bool coalesce(const std::shared_ptr<Command>& command) override;
 
     /**
      * @brief Clear the entire history.
@@ -74,7 +86,55 @@ class SimpleHistoryManager final : public HistoryManager {
      */
     [[nodiscard]] size_t redo_size() const;
 
+    /**
+     * @brief Set the memory budget and evict old steps that no longer fit.
+     *
+     * @param bytes Maximum bytes of undo/redo state to keep.
+     */
+    void set_memory_budget(size_t bytes);
+
+    /**
+     * @brief Get the memory budget.
+     *
+     * @return Maximum bytes of undo/redo state kept.
+     */
+    [[nodiscard]] size_t memory_budget() const { return budget_; }
+
+    /**
+     * @brief Get the memory currently held by the history.
+     *
+     * @return Bytes of undo/redo state, see Command::byteSize().
+     */
+    [[nodiscard]] size_t byte_size() const;
+
+    /**
+     * @brief Set the swap file cold history entries are paged out to.
+     *
+     * @param swap Swap file, or nullptr to discard old steps instead.
+     */
+    void set_swap_file(std::shared_ptr<UndoSwapFile> swap);
+
+    /**
+     * @brief Set the disk budget of the swap file and evict steps that no longer fit.
+     *
+     * @param bytes Maximum bytes of spilled undo state to keep.
+     */
+    void set_swap_budget(size_t bytes);
+
+    /**
+     * @brief Get the bytes of undo state currently held in the swap file.
+     *
+     * @return Spilled bytes; 0 without a swap file.
+     */
+    [[nodiscard]] size_t swap_size() const;
+
   private:
+    void enforce_budget();
+    void publish_changed() const;
+
     std::shared_ptr<HistoryStack> stack_;
+    std::shared_ptr<UndoSwapFile> swap_;
+    size_t budget_ = kDefaultMemoryBudget;
+    size_t swap_budget_ = kDefaultSwapBudget;
 };
 }  // namespace gimp
@@ -34,7 +34,7 @@ class BinaryProjectReader {
 
   private:
     static constexpr uint32_t kMagic = 0x504D4947;  // "GIMP" in little-endian
-    static constexpr uint32_t kSupportedVersion = 1;
+    static constexpr uint32_t kSupportedVersion = 2;
 };
 
 }  // namespace gimp
@@ -22,7 +22,8 @@ namespace gimp {
  * File format specification:
  * - Header (16 bytes): Magic "GIMP", version, width, height
  * - Chunk table: count + entries (type, offset, compressed_size, uncompressed_size)
- * - Layer chunks: name, visibility, opacity, blend mode, LZ4-compressed RGBA
+ * - Layer chunks: name, visibility, opacity, blend mode, size, pixel format and
+ *   LZ4-compressed straight-alpha RGBA in that format (8-bit layers as Rgba8)
  * - Selection chunk: serialized QPainterPath elements
  */
 class BinaryProjectWriter {
@@ -37,7 +38,7 @@ class BinaryProjectWriter {
 
   private:
     static constexpr uint32_t kMagic = 0x504D4947;  // "GIMP" in little-endian
-    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kVersion = 2;  // 2: per-layer pixel format
 };
 
 }  // namespace gimp
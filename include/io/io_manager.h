@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/layer.h"
 #include "io/image_file.h"
 #include "io/project_file.h"
 
@@ -59,6 +60,9 @@ class IOManager {
 
     /*!
      * @brief Exports a project to a JSON file.
+     *
+     * Wide layers keep their pixel format; their data holds the native
+     * little-endian channel bytes.
      * @param project The project to export.
      * @param filePath Destination file path.
      * @return True on success, false on failure.
@@ -75,6 +79,27 @@ class IOManager {
      */
     ImageFile readImage(const std::string& filePath);
 
+    /*!
+     * @brief Converts a loaded image into a layer, keeping its bit depth.
+     *
+     * 8-bit images become Rgba8 layers, 16-bit images Rgba16, half-float images
+     * Rgba16F and float images Rgba32F. Gray, BGR and BGRA channel layouts are
+     * converted to RGBA.
+     * @param image The image to convert.
+     * @return The new layer, or nullptr if the image is empty or its depth or
+     *         channel count is not supported.
+     */
+    std::shared_ptr<Layer> imageToLayer(const ImageFile& image);
+
+    /*!
+     * @brief Opens an image file as a new single-layer project.
+     *
+     * The layer keeps the image's bit depth (see imageToLayer()).
+     * @param path Path to the image file.
+     * @return Result containing the new ProjectFile or an error.
+     */
+    error::Result<std::shared_ptr<ProjectFile>> loadImage(const std::filesystem::path& path);
+
     /*!
      * @brief Writes an image to disk.
      * @param mat The image matrix to write.
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "core/dirty_tile_store.h"
 #include "core/document.h"
 
 #include <QPainterPath>
@@ -34,7 +35,13 @@ class ProjectFile : public Document {
      * @param h Canvas height in pixels.
      * @param dpi Resolution in DPI.
      */
-    ProjectFile(int w, int h, double dpi = 72.0) : m_width(w), m_height(h), m_dpi(dpi) {}
+    ProjectFile(int w, int h, double dpi = 72.0)
+        : m_width(w),
+          m_height(h),
+          m_dpi(dpi),
+          m_tileStore(w, h)
+    {
+    }
 
     ~ProjectFile() override = default;
 
@@ -74,6 +81,7 @@ class ProjectFile : public Document {
         }
 
         m_layers.removeLayer(layer);
+        m_tileStore.invalidateAll();
 
         // Adjust active layer index if needed
         if (!m_layers.empty()) {
@@ -133,7 +141,7 @@ class ProjectFile : public Document {
     /*! @brief Returns the tile store for dirty region tracking.
      *  @return Reference to the tile store.
      */
-    gimp::TileStore& tileStore() override { return m_dummyTileStore; }
+    gimp::TileStore& tileStore() override { return m_tileStore; }
 
     /*! @brief Returns the canvas width in pixels.
      *  @return Width in pixels.
@@ -177,6 +185,7 @@ class ProjectFile : public Document {
 
         m_width = width;
         m_height = height;
+        m_tileStore.setSize(width, height);
     }
 
     /*! @brief Sets the document selection path.
@@ -208,10 +217,6 @@ class ProjectFile : public Document {
     gimp::LayerStack m_layers;           ///< Layer stack.
     QPainterPath selection_;             ///< Stored selection path.
     std::optional<std::filesystem::path> m_filePath;  ///< Associated file path.
-
-    /*! @brief Placeholder TileStore that does nothing. */
-    class DummyTileStore : public TileStore {
-        void invalidate(const gimp::Rect&) override {}
-    } m_dummyTileStore;
+    gimp::DirtyTileStore m_tileStore;                 ///< Dirty region tracking for rendering.
 };  // class ProjectFile
 }  // namespace gimp
@@ -58,4 +58,51 @@ inline BlendMode string_to_blend_mode(const std::string& mode)
     return BlendMode::Normal;
 }
 
+/**
+ * @brief Returns the format a layer's pixels are stored in by project files.
+ *
+ * Wide formats are stored as they are; 8-bit layers are stored as straight Rgba8.
+ * @param format The layer's pixel format.
+ * @return The format to store.
+ */
+inline PixelFormat project_storage_format(PixelFormat format)
+{
+    return format == PixelFormat::Rgba8Premultiplied ? PixelFormat::Rgba8 : format;
+}
+
+/**
+ * @brief Convert a stored PixelFormat to its string representation.
+ * @param format The pixel format to convert.
+ * @return String representation of the pixel format.
+ */
+inline std::string pixel_format_to_string(PixelFormat format)
+{
+    switch (format) {
+        case PixelFormat::Rgba16:
+            return "Rgba16";
+        case PixelFormat::Rgba16F:
+            return "Rgba16F";
+        case PixelFormat::Rgba32F:
+            return "Rgba32F";
+        default:
+            return "Rgba8";
+    }
+}
+
+/**
+ * @brief Convert string to a stored PixelFormat.
+ * @param format String representation of the pixel format.
+ * @return The corresponding PixelFormat, Rgba8 if unknown.
+ */
+inline PixelFormat string_to_pixel_format(const std::string& format)
+{
+    if (format == "Rgba16")
+        return PixelFormat::Rgba16;
+    if (format == "Rgba16F")
+        return PixelFormat::Rgba16F;
+    if (format == "Rgba32F")
+        return PixelFormat::Rgba32F;
+    return PixelFormat::Rgba8;
+}
+
 }  // namespace gimp
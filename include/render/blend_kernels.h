@@ -0,0 +1,50 @@
+/**
+ * @file blend_kernels.h
+ * @brief Premultiplied RGBA8 row blending kernels with runtime SIMD dispatch.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ */
+
+#pragma once
+
+#include "core/layer.h"
+#include "core/pixel_format.h"
+#include "core/simd_level.h"
+
+#include <cstdint>
+
+namespace gimp {
+
+/*!
+ * @brief Blends a row of source pixels onto destination pixels in place.
+ *
+ * Both rows hold premultiplied RGBA8 pixels. The source is scaled by opacity
+ * (0-255) before blending. All kernels of a mode produce identical bytes.
+ */
+using BlendRowFn = void (*)(std::uint8_t* dst,
+                            const std::uint8_t* src,
+                            int count,
+                            std::uint8_t opacity);
+
+/*!
+ * @brief Returns the row kernel for a blend mode.
+ * @param mode Blend mode.
+ * @param level Highest instruction set to use; lowered to what the CPU supports.
+ * @return Kernel function, never null.
+ */
+BlendRowFn blendRowKernel(BlendMode mode, SimdLevel level);
+
+namespace detail {
+
+/// Portable kernel for a mode; also used for row tails by the SIMD kernels.
+BlendRowFn scalarBlendRow(BlendMode mode);
+
+/// SSE4.1 kernel for a mode, or nullptr if not built for x86.
+BlendRowFn sse41BlendRow(BlendMode mode);
+
+/// AVX2 kernel for a mode, or nullptr if not built for x86.
+BlendRowFn avx2BlendRow(BlendMode mode);
+
+}  // namespace detail
+
+}  // namespace gimp
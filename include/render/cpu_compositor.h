@@ -0,0 +1,74 @@
+/**
+ * @file cpu_compositor.h
+ * @brief Headless layer compositor working on premultiplied RGBA8 buffers.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ */
+
+#pragma once
+
+#include "core/layer_stack.h"
+#include "core/tile_store.h"
+#include "render/blend_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gimp {
+
+/*!
+ * @class CpuCompositor
+ * @brief Composites layer stacks without Skia or a GPU.
+ *
+ * Other formats (straight RGBA8 and the high bit-depth ones) are converted to
+ * premultiplied RGBA8 one row at a time by the format-specialized loaders of
+ * convertPixels(); premultiplied RGBA8 layers are blended straight from their
+ * storage. Blending uses the row
+ * kernels from blend_kernels.h, so results are deterministic and identical on
+ * every instruction set. Intended for export and tests.
+ */
+class CpuCompositor {
+  public:
+    /*!
+     * @brief Limits the instruction set used by the kernels.
+     * @param level Highest level to use (defaults to the detected one).
+     */
+    void setSimdLevel(SimdLevel level) { m_level = level; }
+
+    /*! @brief Returns the requested instruction set.
+     *  @return Highest level the kernels may use.
+     */
+    [[nodiscard]] SimdLevel simdLevel() const { return m_level; }
+
+    /*!
+     * @brief Composites visible layers over a region of a premultiplied buffer.
+     *
+     * The buffer is blended onto, not cleared; its pixels must be valid
+     * premultiplied RGBA (color <= alpha).
+     *
+     * @param layers Layers to composite, bottom first.
+     * @param region Document region covered by the buffer.
+     * @param dst First pixel of the buffer, at region.x, region.y.
+     * @param dstRowBytes Distance between buffer rows in bytes.
+     */
+    void compose(const LayerStack& layers,
+                 const Rect& region,
+                 std::uint8_t* dst,
+                 std::size_t dstRowBytes);
+
+    /*!
+     * @brief Composites visible layers onto a transparent image.
+     * @param layers Layers to composite, bottom first.
+     * @param width Image width in pixels.
+     * @param height Image height in pixels.
+     * @return Unpremultiplied RGBA8 pixels, in the layout of an Rgba8 Layer::data().
+     */
+    std::vector<std::uint8_t> flatten(const LayerStack& layers, int width, int height);
+
+  private:
+    SimdLevel m_level = detectSimdLevel();  ///< Highest instruction set to use.
+    std::vector<std::uint8_t> m_row;        ///< Premultiplied copy of one layer row.
+};
+
+}  // namespace gimp
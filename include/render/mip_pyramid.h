@@ -0,0 +1,166 @@
+/**
+ * @file mip_pyramid.h
+ * @brief Downsampled layer levels for zoomed-out display.
+ * @author Laurent Jiang
+ * @date 2026-02-17
+ */
+
+#pragma once
+
+#include "core/pixel_format.h"
+#include "core/tile_store.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gimp {
+
+class Layer;
+class LayerStack;
+
+/*!
+ * @struct MipLevel
+ * @brief One downsampled level of a layer, stored in the layer's pixel format.
+ */
+struct MipLevel {
+    int width = 0;                            ///< Level width in pixels.
+    int height = 0;                           ///< Level height in pixels.
+    PixelFormat format = PixelFormat::Rgba8;  ///< Same format as the source layer.
+    std::vector<std::uint8_t> pixels;         ///< Tightly packed RGBA pixels in format.
+};
+
+/*!
+ * @class MipPyramid
+ * @brief Chain of half-resolution copies of a layer, updated from dirty regions.
+ *
+ * Level 0 is the layer itself and is never stored. Level n has dimensions
+ * ceil(size / 2^n) and each pixel is the average of a 2x2 block of level
+ * n - 1, alpha-weighted for straight-alpha layers. Modified regions are
+ * accumulated with markDirty() and only the corresponding blocks of each
+ * level are recomputed on update().
+ */
+class MipPyramid {
+  public:
+    /*! @brief Deepest level ever built. */
+    static constexpr int kMaxLevel = 8;
+
+    /*!
+     * @brief Returns the level whose scale is the smallest one not below a zoom factor.
+     * @param zoom View zoom level (1.0 = 100%).
+     * @return 0 for zoom >= 1, otherwise floor(log2(1 / zoom)) capped at kMaxLevel.
+     */
+    static int levelForZoom(float zoom);
+
+    /*!
+     * @brief Returns the extent of a dimension at a level.
+     * @param size Full-resolution size in pixels.
+     * @param level Mip level.
+     * @return ceil(size / 2^level).
+     */
+    static int levelExtent(int size, int level);
+
+    /*!
+     * @brief Records a modified region of the source layer.
+     * @param region Modified rectangle in layer coordinates.
+     */
+    void markDirty(const Rect& region);
+
+    /*!
+     * @brief Records that the layer may have changed anywhere.
+     *
+     * The next update() rebuilds all levels, unless the layer's version is
+     * still the one the levels were built from.
+     */
+    void markAllDirty();
+
+    /*!
+     * @brief Brings levels 1..levelCount up to date with the layer.
+     *
+     * Nothing is recomputed while the layer's version, size and pixel format
+     * are those of the last update, whatever was marked dirty. Otherwise
+     * pending dirty regions are recomputed level by level. If the layer
+     * changed without reporting a region (its version moved but nothing is
+     * pending, or markAllDirty() was called), or its size or pixel format
+     * changed, all levels are rebuilt.
+     *
+     * @param layer Source layer.
+     * @param levelCount Number of levels below level 0 that must be valid.
+     * @return True if any level pixels were recomputed.
+     */
+    bool update(const Layer& layer, int levelCount);
+
+    /*!
+     * @brief Returns a built level.
+     * @param level Level index, 1..builtLevels().
+     * @return The level, or nullptr if it has not been built.
+     */
+    [[nodiscard]] const MipLevel* level(int level) const;
+
+    /*! @brief Returns the number of built levels below level 0.
+     *  @return Built level count.
+     */
+    [[nodiscard]] int builtLevels() const { return static_cast<int>(m_levels.size()); }
+
+  private:
+    /*!
+     * @brief Recomputes a region of one level from the level above it.
+     * @param index Level to update (1-based).
+     * @param source Pixels of level index - 1.
+     * @param srcWidth Width of level index - 1.
+     * @param srcHeight Height of level index - 1.
+     * @param region Region of level index - 1 that changed.
+     */
+    void downsample(int index,
+                    const std::uint8_t* source,
+                    int srcWidth,
+                    int srcHeight,
+                    const Rect& region);
+
+    std::vector<MipLevel> m_levels;             ///< Levels 1..n.
+    int m_sourceWidth = 0;                      ///< Layer width the levels were built for.
+    int m_sourceHeight = 0;                     ///< Layer height the levels were built for.
+    PixelFormat m_format = PixelFormat::Rgba8;  ///< Layer format the levels were built for.
+    std::uint64_t m_version = 0;                ///< Layer::version() at the last update.
+    Rect m_pending{0, 0, 0, 0};                 ///< Union of regions modified since last update.
+    bool m_fullRebuild = true;                  ///< Pending region is unknown; rebuild everything.
+};
+
+/*!
+ * @class LayerMipCache
+ * @brief Per-layer mip pyramids shared by the renderer and compositor.
+ */
+class LayerMipCache {
+  public:
+    /*!
+     * @brief Forwards the regions collected in a tile store to existing pyramids.
+     *
+     * Must be called before the store is cleared.
+     *
+     * @param store Dirty region tracker for the current frame.
+     * @param layers Layers of the document.
+     */
+    void noteDirty(const TileStore& store, const LayerStack& layers);
+
+    /*!
+     * @brief Returns an up-to-date level of a layer, building the pyramid if needed.
+     * @param layer Source layer.
+     * @param level Level index (>= 1).
+     * @return The level, or nullptr if level < 1.
+     */
+    const MipLevel* level(const Layer& layer, int level);
+
+    /*!
+     * @brief Drops pyramids of layers that are no longer in the stack.
+     * @param layers Layers of the document.
+     */
+    void prune(const LayerStack& layers);
+
+    /*! @brief Drops all pyramids. */
+    void clear() { m_pyramids.clear(); }
+
+  private:
+    std::unordered_map<const Layer*, MipPyramid> m_pyramids;  ///< Pyramids by layer.
+};
+
+}  // namespace gimp
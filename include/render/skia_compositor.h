@@ -8,19 +8,95 @@
 #pragma once
 
 #include "core/layer_stack.h"
+#include "core/tile_store.h"
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <include/core/SkImage.h>
+#include <include/core/SkRefCnt.h>
+#include <include/core/SkSamplingOptions.h>
+#include <include/core/SkSurface.h>
 
 class SkCanvas;
 
 namespace gimp {
 
 class Layer;
+class LayerMipCache;
+struct MipLevel;
 
 /*!
  * @class SkiaCompositor
  * @brief Composites layer stacks onto a Skia canvas.
+ *
+ * Each layer (and each mip level of it) is uploaded once into a surface
+ * compatible with the target canvas (a GPU texture under Ganesh) and reused
+ * until Layer::version() changes. Regions forwarded with noteDirty() are then
+ * re-uploaded on their own; a change without a known region re-uploads the
+ * whole layer.
  */
 class SkiaCompositor {
   public:
+    /*! @brief Frames a cached layer image may go unused before it is released. */
+    static constexpr std::uint64_t kMaxIdleFrames = 240;
+
+    /*! @brief Pending regions kept per layer before they are merged into one. */
+    static constexpr std::size_t kMaxPendingRegions = 32;
+
+    /*!
+     * @brief Sets the sampling used when layers are drawn under a scaling transform.
+     * @param sampling Sampling options (nearest neighbour by default).
+     */
+    void setSampling(const SkSamplingOptions& sampling) { m_sampling = sampling; }
+
+    /*! @brief Returns the current layer sampling.
+     *  @return Sampling options.
+     */
+    [[nodiscard]] const SkSamplingOptions& sampling() const { return m_sampling; }
+
+    /*!
+     * @brief Draws layers from a downsampled mip level instead of full resolution.
+     *
+     * Level n pixels are drawn scaled by 2^n, so callers keep using document
+     * coordinates. Pass level 0 (or a null cache) to draw full-resolution pixels.
+     *
+     * @param mips Mip pyramids to draw from; must outlive its use by the compositor.
+     * @param level Mip level to use.
+     */
+    void setMipSource(LayerMipCache* mips, int level)
+    {
+        m_mips = mips;
+        m_mipLevel = level;
+    }
+
+    /*! @brief Returns the mip level layers are drawn from.
+     *  @return 0 when drawing at full resolution.
+     */
+    [[nodiscard]] int mipLevel() const { return m_mips ? m_mipLevel : 0; }
+
+    /*!
+     * @brief Forwards the regions collected in a tile store to cached layer images.
+     *
+     * Must be called once per frame, before the store is cleared. Also releases
+     * images of layers no longer in the stack and of entries left idle for
+     * kMaxIdleFrames frames.
+     *
+     * @param store Dirty region tracker for the current frame.
+     * @param layers Layers of the document.
+     */
+    void noteDirty(const TileStore& store, const LayerStack& layers);
+
+    /*! @brief Releases all cached layer images. */
+    void clearImageCache() { m_images.clear(); }
+
+    /*! @brief Returns the number of cached layer images.
+     *  @return Entry count, one per (layer, mip level) pair.
+     */
+    [[nodiscard]] std::size_t cachedImageCount() const { return m_images.size(); }
+
     /*!
      * @brief Composites all visible layers onto the canvas.
      * @param canvas The Skia canvas to draw on.
@@ -39,12 +115,69 @@ class SkiaCompositor {
      */
     void composeUpTo(SkCanvas* canvas, const LayerStack& layers, std::size_t stopBeforeIndex);
 
+    /*!
+     * @brief Composites visible layers in the index range [beginIndex, endIndex).
+     *
+     * Used for caching layers above the active layer.
+     *
+     * @param canvas The Skia canvas to draw on.
+     * @param layers The layer stack to composite.
+     * @param beginIndex First layer index to composite.
+     * @param endIndex One past the last layer index to composite (clamped to the stack size).
+     */
+    void composeRange(SkCanvas* canvas,
+                      const LayerStack& layers,
+                      std::size_t beginIndex,
+                      std::size_t endIndex);
+
     /*!
      * @brief Composites a single layer onto the canvas.
      * @param canvas The Skia canvas to draw on.
      * @param layer The layer to composite.
      */
     void composeSingleLayer(SkCanvas* canvas, const Layer& layer);
+
+  private:
+    /*!
+     * @brief Uploaded copy of a layer (or one of its mip levels).
+     */
+    struct CachedImage {
+        sk_sp<SkSurface> surface;    ///< Premultiplied copy of the pixels.
+        sk_sp<SkImage> image;        ///< Snapshot of surface; dropped before each upload.
+        std::uint64_t version = 0;   ///< Layer::version() of the uploaded pixels.
+        std::vector<Rect> pending;   ///< Level-0 regions modified since the last upload.
+        bool fullUpload = true;      ///< Pending regions are unknown; upload everything.
+        std::uint64_t lastUsed = 0;  ///< Frame the image was last drawn in.
+    };
+
+    /// Cache key: source layer and mip level (0 = full resolution).
+    using ImageKey = std::pair<const Layer*, int>;
+
+    /*!
+     * @brief Draws one layer from the configured mip level or at full resolution.
+     * @param canvas The Skia canvas to draw on.
+     * @param layer The layer to draw.
+     */
+    void drawLayer(SkCanvas* canvas, const Layer& layer);
+
+    /*!
+     * @brief Returns an up-to-date image of a layer, uploading what changed.
+     * @param canvas Canvas the image will be drawn on; decides the surface backend.
+     * @param layer Source layer.
+     * @param mip Mip level to upload instead of the layer pixels, or nullptr.
+     * @param level Index of mip (0 when mip is nullptr).
+     * @return The cached image, or nullptr if no compatible surface could be made.
+     */
+    sk_sp<SkImage> layerImage(SkCanvas* canvas,
+                              const Layer& layer,
+                              const MipLevel* mip,
+                              int level);
+
+    SkSamplingOptions m_sampling;     ///< Sampling for layer images.
+    LayerMipCache* m_mips = nullptr;  ///< Mip source, or nullptr for full resolution.
+    int m_mipLevel = 0;               ///< Mip level drawn when m_mips is set.
+    std::map<ImageKey, CachedImage> m_images;  ///< Uploaded layer images.
+    std::uint64_t m_frame = 0;                 ///< Frame counter advanced by noteDirty().
 };
 
 }  // namespace gimp
@@ -7,15 +7,24 @@
 
 #pragma once
 
+#include "core/tile_store.h"
+#include "mip_pyramid.h"
 #include "renderer.h"
 #include "skia_compositor.h"
+#include "viewport_state.h"
+
+#include <cstdint>
+#include <vector>
 
 #include <include/core/SkImage.h>
+#include <include/core/SkMatrix.h>
+#include <include/core/SkRect.h>
 #include <include/core/SkSurface.h>
 
 namespace gimp {
 class Document;
 class IGpuContext;
+class Layer;
 
 /*!
  * @class SkiaRenderer
@@ -55,6 +64,48 @@ class SkiaRenderer : public Renderer {
      */
     void render(const Document& document) override;
 
+    /*!
+     * @brief Re-renders only the regions reported dirty since the last frame.
+     *
+     * Falls back to a full redraw when the surface is (re)created or the tile
+     * store is fully invalid. Consumes the dirty regions by clearing the store.
+     *
+     * Layers below and above the active layer are served from cached
+     * composites that are rebuilt only when one of their layers changes
+     * version, so a stroke re-blends just the active layer between two images.
+     *
+     * @param document The document to render.
+     * @param dirtyTiles Dirty region tracker fed by tools and commands.
+     * @post get_result() reflects the current document content.
+     */
+    void render(const Document& document, TileStore& dirtyTiles);
+
+    /*!
+     * @brief Renders only the visible part of the document into a view-sized surface.
+     *
+     * The surface matches the view, so cost depends on the view size and the
+     * visible document area rather than the document size. Pan, zoom or view
+     * size changes redraw the whole view; otherwise only on-screen dirty
+     * regions are recomposited. Afterwards surface() holds the view image and
+     * lastRenderedRegions() are in view coordinates.
+     *
+     * Below 100% zoom, layers and the cached composites are drawn from the
+     * per-layer mip level matching the zoom, which is updated incrementally
+     * from the dirty tiles. The cached composites cover only the visible
+     * region at that level, so rebuilding them also costs as much as the view.
+     *
+     * @param document The document to render.
+     * @param dirtyTiles Dirty region tracker fed by tools and commands.
+     * @param viewport Pan and zoom mapping document to view pixels.
+     * @param viewWidth View width in pixels.
+     * @param viewHeight View height in pixels.
+     */
+    void render(const Document& document,
+                TileStore& dirtyTiles,
+                const ViewportState& viewport,
+                int viewWidth,
+                int viewHeight);
+
     /*!
      * @brief Renders layers below the active layer.
      *
@@ -83,7 +134,79 @@ class SkiaRenderer : public Renderer {
      */
     sk_sp<SkImage> get_result();
 
+    /*!
+     * @brief Returns the regions of surface() redrawn by the last render call.
+     *
+     * Presenters use this to copy only changed pixels out of surface().
+     *
+     * @return Rectangles in document coordinates; empty if nothing changed.
+     */
+    [[nodiscard]] const std::vector<Rect>& lastRenderedRegions() const
+    {
+        return m_lastRendered;
+    }
+
+    /*! @brief Drops the cached below/above composites. */
+    void invalidateCompositeCache();
+
   private:
+    /*!
+     * @struct LayerKey
+     * @brief Identifies one layer state contributing to a cached composite.
+     */
+    struct LayerKey {
+        const Layer* layer = nullptr;  ///< Layer identity.
+        std::uint64_t version = 0;     ///< Layer::version() when the cache was built.
+        std::uint64_t properties = 0;  ///< Layer::propertiesVersion() when the cache was built.
+
+        bool operator==(const LayerKey&) const = default;
+    };
+
+    /*!
+     * @struct CachedComposite
+     * @brief Composite of a contiguous layer range, valid while its key matches.
+     */
+    struct CachedComposite {
+        std::vector<LayerKey> key;  ///< Layers and versions the image was built from.
+        sk_sp<SkSurface> surface;   ///< Surface the image is rendered into.
+        sk_sp<SkImage> image;       ///< Cached composite, nullptr for an empty range.
+        int level = 0;              ///< Mip level the image was built at.
+        Rect area{0, 0, 0, 0};      ///< Region the image covers, in mip level pixels.
+    };
+
+    /*!
+     * @brief Rebuilds a cached composite if its layer range changed or it misses part of area.
+     * @param cache The cache to update.
+     * @param document The document being rendered.
+     * @param beginIndex First layer index of the range.
+     * @param endIndex One past the last layer index of the range.
+     * @param area Document region the cache must cover.
+     */
+    void updateComposite(CachedComposite& cache,
+                         const Document& document,
+                         std::size_t beginIndex,
+                         std::size_t endIndex,
+                         const Rect& area);
+
+    /*!
+     * @brief Rebuilds the below/above composites for the current active layer as needed.
+     * @param document The document being rendered.
+     * @param area Document region the composites must cover.
+     */
+    void updateCompositeCaches(const Document& document, const Rect& area);
+
+    /*!
+     * @brief Composites a clipped region of the document from the cached images.
+     * @param canvas Destination canvas.
+     * @param document The document being rendered.
+     * @param clip Region to redraw in device coordinates.
+     * @param docToView Transform from document to device coordinates.
+     */
+    void composeCached(SkCanvas* canvas,
+                       const Document& document,
+                       const SkIRect& clip,
+                       const SkMatrix& docToView);
+
     /*!
      * @brief Create or recreate a surface with the given dimensions.
      * @param surface The surface smart pointer to update.
@@ -93,9 +216,17 @@ class SkiaRenderer : public Renderer {
      */
     bool ensureSurface(sk_sp<SkSurface>& surface, int width, int height);
 
-    SkiaCompositor m_compositor;        ///< Compositor for layer blending.
-    sk_sp<SkSurface> m_surface;         ///< Offscreen render surface for full renders.
-    sk_sp<SkSurface> m_partialSurface;  ///< Offscreen surface for partial renders.
+    SkiaCompositor m_compositor;          ///< Compositor for layer blending.
+    sk_sp<SkSurface> m_surface;           ///< Offscreen render surface for full renders.
+    sk_sp<SkSurface> m_partialSurface;    ///< Offscreen surface for partial renders.
+    CachedComposite m_below;              ///< Layers below the active layer.
+    CachedComposite m_above;              ///< Layers above the active layer (Normal blend only).
+    std::vector<LayerKey> m_keyScratch;   ///< Reused buffer for building cache keys.
+    bool m_composeAboveDirectly = false;  ///< Above layers use non-Normal blending; no cache.
+    std::vector<Rect> m_lastRendered;     ///< Regions redrawn by the last render call.
+    bool m_viewportMode = false;          ///< m_surface holds a view rather than the document.
+    ViewportState m_lastViewport;         ///< Viewport of the last view render.
+    LayerMipCache m_mips;                 ///< Per-layer mip levels for zoomed-out views.
     IGpuContext* m_gpuContext =
         nullptr;            ///< GPU context (never null after init, uses NullGpuContext).
     bool m_useGpu = false;  ///< Whether GPU rendering is currently active.
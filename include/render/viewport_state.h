@@ -0,0 +1,90 @@
+/**
+ * @file viewport_state.h
+ * @brief Pan/zoom state of a canvas view and document/view rectangle mapping.
+ * @author Laurent Jiang
+ * @date 2026-02-16
+ */
+
+#pragma once
+
+#include "core/tile_store.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gimp {
+
+/**
+ * @brief Viewport transformation state for pan and zoom.
+ *
+ * A document pixel (x, y) appears at view position (x * zoomLevel + panX,
+ * y * zoomLevel + panY).
+ */
+struct ViewportState {
+    float zoomLevel = 1.0F;  ///< Current zoom level (1.0 = 100%).
+    float panX = 0.0F;       ///< Horizontal pan offset in widget pixels.
+    float panY = 0.0F;       ///< Vertical pan offset in widget pixels.
+
+    static constexpr float MIN_ZOOM = 0.1F;    ///< Minimum zoom level (10%).
+    static constexpr float MAX_ZOOM = 32.0F;   ///< Maximum zoom level (3200%).
+    static constexpr float ZOOM_STEP = 1.25F;  ///< Zoom factor per scroll step.
+
+    bool operator==(const ViewportState&) const = default;
+};
+
+/**
+ * @brief Returns the part of the document visible in a view.
+ * @param viewport Current pan and zoom.
+ * @param viewWidth View width in pixels.
+ * @param viewHeight View height in pixels.
+ * @param docWidth Document width in pixels.
+ * @param docHeight Document height in pixels.
+ * @return Visible document rectangle, rounded outwards; empty (w or h == 0) if none.
+ */
+inline Rect visibleDocumentRect(const ViewportState& viewport,
+                                int viewWidth,
+                                int viewHeight,
+                                int docWidth,
+                                int docHeight)
+{
+    if (viewport.zoomLevel <= 0.0F) {
+        return {0, 0, 0, 0};
+    }
+    const auto x0 = static_cast<int>(std::floor(-viewport.panX / viewport.zoomLevel));
+    const auto y0 = static_cast<int>(std::floor(-viewport.panY / viewport.zoomLevel));
+    const auto x1 = static_cast<int>(
+        std::ceil((static_cast<float>(viewWidth) - viewport.panX) / viewport.zoomLevel));
+    const auto y1 = static_cast<int>(
+        std::ceil((static_cast<float>(viewHeight) - viewport.panY) / viewport.zoomLevel));
+
+    const int left = std::clamp(x0, 0, docWidth);
+    const int top = std::clamp(y0, 0, docHeight);
+    const int right = std::clamp(x1, 0, docWidth);
+    const int bottom = std::clamp(y1, 0, docHeight);
+    return {left, top, right - left, bottom - top};
+}
+
+/**
+ * @brief Maps a document rectangle to the view pixels it covers.
+ *
+ * The result is rounded outwards and grown by one pixel so filtered sampling
+ * at the edges is redrawn as well. It is not clipped to the view.
+ *
+ * @param viewport Current pan and zoom.
+ * @param docRect Rectangle in document coordinates.
+ * @return Rectangle in view coordinates.
+ */
+inline Rect documentToViewRect(const ViewportState& viewport, const Rect& docRect)
+{
+    const auto x0 = static_cast<int>(
+        std::floor(static_cast<float>(docRect.x) * viewport.zoomLevel + viewport.panX));
+    const auto y0 = static_cast<int>(
+        std::floor(static_cast<float>(docRect.y) * viewport.zoomLevel + viewport.panY));
+    const auto x1 = static_cast<int>(std::ceil(
+        static_cast<float>(docRect.x + docRect.w) * viewport.zoomLevel + viewport.panX));
+    const auto y1 = static_cast<int>(std::ceil(
+        static_cast<float>(docRect.y + docRect.h) * viewport.zoomLevel + viewport.panY));
+    return {x0 - 1, y0 - 1, x1 - x0 + 2, y1 - y0 + 2};
+}
+
+}  // namespace gimp
@@ -9,6 +9,7 @@
 
 #include "core/event_bus.h"
 
+#include <QLabel>
 #include <QListWidget>
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -29,8 +30,8 @@ struct HistoryEntry {
 /**
  * @brief Panel displaying the undo/redo history stack.
  *
- * Shows a list of all actions that can be undone or redone.
- * Clicking an entry jumps to that point in history.
+ * Shows a list of all actions that can be undone or redone, and the memory
+ * held by the history. Clicking an entry jumps to that point in history.
  */
 class HistoryPanel : public QWidget {
     Q_OBJECT
@@ -49,6 +50,13 @@ class HistoryPanel : public QWidget {
     /*! @brief Clears all history entries. */
     void clear();
 
+    /*! @brief Shows the memory held by the history.
+     *  @param bytes Bytes of undo/redo state in memory.
+     *  @param budget Memory budget of the history in bytes.
+     *  @param swapped Bytes of undo state paged out to disk.
+     */
+    void setMemoryUsage(std::size_t bytes, std::size_t budget, std::size_t swapped = 0);
+
   signals:
     /*! @brief Emitted when the user wants to jump to a history point.
      *  @param index The target history index.
@@ -67,6 +75,7 @@ class HistoryPanel : public QWidget {
 
     QVBoxLayout* mainLayout_ = nullptr;
     QListWidget* historyList_ = nullptr;
+    QLabel* memoryLabel_ = nullptr;
     QPushButton* undoButton_ = nullptr;
     QPushButton* redoButton_ = nullptr;
     QPushButton* clearButton_ = nullptr;
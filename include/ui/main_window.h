@@ -24,7 +24,7 @@
 
 namespace gimp {
 
-class BasicCommandBus;
+class AsyncCommandBus;
 class ColorChooserPanel;
 class CommandPalette;
 class DebugHud;
@@ -98,6 +98,7 @@ class MainWindow : public QMainWindow {
     void onSelectInvert();
     void onNewProject();
     void onOpenProject();
+    void onOpenImage();
     void onSaveProject();
     void onSaveProjectAs();
     void onCanvasResize();
@@ -122,12 +123,13 @@ class MainWindow : public QMainWindow {
     std::shared_ptr<Document> m_document;
     std::shared_ptr<SkiaRenderer> m_renderer;
     std::unique_ptr<SimpleHistoryManager> m_historyManager;
-    std::unique_ptr<BasicCommandBus> m_commandBus;
+    std::unique_ptr<AsyncCommandBus> m_commandBus;
 
     EventBus::SubscriptionId m_toolChangedSubscription = 0;
     EventBus::SubscriptionId m_colorChangedSubscription = 0;
     EventBus::SubscriptionId m_layerSelectionSubscription = 0;
     EventBus::SubscriptionId m_mousePositionSubscription = 0;
+    EventBus::SubscriptionId m_commandCompletedSubscription = 0;
 
     QPoint m_lastCanvasMousePos;
 
@@ -10,7 +10,9 @@
 
 #include "core/event_bus.h"
 #include "render/gpu_context.h"
+#include "render/viewport_state.h"
 
+#include <QImage>
 #include <QOpenGLWidget>
 #include <QPointF>
 #include <QTimer>
@@ -23,19 +25,6 @@ class Document;
 class SkiaRenderer;
 class Tool;
 
-/**
- * @brief Viewport transformation state for pan and zoom.
- */
-struct ViewportState {
-    float zoomLevel = 1.0F;  ///< Current zoom level (1.0 = 100%).
-    float panX = 0.0F;       ///< Horizontal pan offset in widget pixels.
-    float panY = 0.0F;       ///< Vertical pan offset in widget pixels.
-
-    static constexpr float MIN_ZOOM = 0.1F;    ///< Minimum zoom level (10%).
-    static constexpr float MAX_ZOOM = 32.0F;   ///< Maximum zoom level (3200%).
-    static constexpr float ZOOM_STEP = 1.25F;  ///< Zoom factor per scroll step.
-};
-
 /**
  * @brief Interactive canvas widget that displays a document rendered via Skia.
  *
@@ -234,11 +223,20 @@ class SkiaCanvasWidget : public QOpenGLWidget {
      */
     void drawCheckerboard(QPainter& painter, const QRectF& rect);
 
+    /*! @brief Returns the rendered document as a QImage for QPainter presentation.
+     *
+     *  Raster surfaces are wrapped without copying. GPU surfaces are read back
+     *  into a persistent image, copying only the regions redrawn this frame.
+     *  @return The document image, or a null image on failure.
+     */
+    QImage presentableImage();
+
     std::shared_ptr<Document> m_document;
     std::shared_ptr<SkiaRenderer> m_renderer;
     ViewportState m_viewport;
 
     std::unique_ptr<IGpuContext> m_gpuContext;  ///< GPU context for Skia rendering.
+    QImage m_presentImage;                      ///< CPU copy of the GPU surface for presentation.
 
     bool m_isPanning = false;
     bool m_spaceHeld = false;
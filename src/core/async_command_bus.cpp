@@ -0,0 +1,204 @@
+/**
+ * @file async_command_bus.cpp
+ * @brief Implementation of AsyncCommandBus.
+ * @author Laurent Jiang
+ * @date 2026-02-26
+ */
+
+#include "core/async_command_bus.h"
+
+#include "core/commands/replayable_command.h"
+#include "core/event_bus.h"
+#include "core/events.h"
+#include "core/layer.h"
+#include "core/pixel_format.h"
+#include "core/tile_buffer.h"
+
+#include <utility>
+
+namespace gimp {
+
+/// A command in flight. Written by one worker, then read on the GUI thread.
+struct AsyncCommandBus::Job {
+    std::shared_ptr<ReplayableCommand> command;  ///< Command to render.
+    std::shared_ptr<Job> previous;               ///< Job whose output is the input, if any.
+    TileBuffer input;                            ///< Pixels the command starts from.
+    TileBuffer output;                           ///< Pixels after the command.
+    int width = 0;                               ///< Layer width at dispatch.
+    int height = 0;                              ///< Layer height at dispatch.
+    PixelFormat format = PixelFormat::Rgba8;     ///< Layer format at dispatch.
+    bool rendered = false;                       ///< Output holds a valid result.
+    bool retried = false;                        ///< Rendered again after a stale result.
+};
+
+AsyncCommandBus::AsyncCommandBus(HistoryManager& history, std::size_t threadCount)
+    : bus_{history},
+      executor_{threadCount}
+{
+}
+
+AsyncCommandBus::~AsyncCommandBus() = default;
+
+void AsyncCommandBus::dispatch(std::shared_ptr<Command> command)
+{
+    bus_.dispatch(std::move(command));
+}
+
+HistoryManager& AsyncCommandBus::history()
+{
+    return bus_.history();
+}
+
+void AsyncCommandBus::beginTransaction()
+{
+    bus_.beginTransaction();
+}
+
+void AsyncCommandBus::endTransaction()
+{
+    bus_.endTransaction();
+}
+
+void AsyncCommandBus::dispatchAsync(std::shared_ptr<ReplayableCommand> command,
+                                    const void* orderKey)
+{
+    if (!command || !command->layer()) {
+        return;
+    }
+    const auto& layer = command->layer();
+
+    auto job = std::make_shared<Job>();
+    job->command = std::move(command);
+    job->width = layer->width();
+    job->height = layer->height();
+    job->format = layer->pixelFormat();
+
+    auto& entry = pending_[layer.get()];
+    if (entry.jobs.empty()) {
+        // The snapshot shares tiles with the layer, so taking it is cheap
+        entry.version = layer->version();
+        entry.orderKey = orderKey != nullptr ? orderKey : layer.get();
+        job->input = layer->snapshot();
+    } else {
+        job->previous = entry.jobs.back();
+    }
+    entry.jobs.push_back(job);
+    ++pendingCount_;
+
+    executor_.submit(entry.orderKey, [this, job] { render(job); });
+}
+
+std::size_t AsyncCommandBus::processCompletions()
+{
+    std::deque<std::shared_ptr<Job>> completed;
+    {
+        const std::scoped_lock lock(completedMutex_);
+        completed.swap(completed_);
+    }
+    for (const auto& job : completed) {
+        commit(job);
+    }
+    return completed.size();
+}
+
+void AsyncCommandBus::waitIdle()
+{
+    // Committing a stale result queues it again, so wait until nothing is left
+    do {
+        executor_.waitIdle();
+    } while (processCompletions() > 0 && pendingCount_ > 0);
+}
+
+bool AsyncCommandBus::isPending(const Layer& layer) const
+{
+    return pending_.contains(&layer);
+}
+
+void AsyncCommandBus::render(const std::shared_ptr<Job>& job)
+{
+    bool ready = true;
+    if (job->previous) {
+        // Same strand, so the previous job has finished
+        ready = job->previous->rendered;
+        if (ready) {
+            job->input = job->previous->output;
+        }
+        job->previous.reset();
+    }
+
+    Layer scratch(job->width, job->height, job->format);
+    if (ready && scratch.restore(job->input)) {
+        job->command->replay(scratch);
+        job->output = scratch.snapshot();
+        job->rendered = true;
+    }
+
+    {
+        const std::scoped_lock lock(completedMutex_);
+        completed_.push_back(job);
+    }
+    if (notifier_) {
+        notifier_();
+    }
+}
+
+void AsyncCommandBus::commit(const std::shared_ptr<Job>& job)
+{
+    auto layer = job->command->layer();
+    auto it = pending_.find(layer.get());
+    // Jobs replaced by a retry still finish; their results are dropped
+    if (it == pending_.end() || it->second.jobs.empty() || it->second.jobs.front() != job) {
+        return;
+    }
+    auto& entry = it->second;
+
+    const bool current = job->rendered && layer->version() == entry.version &&
+                         layer->width() == job->width && layer->height() == job->height &&
+                         layer->pixelFormat() == job->format;
+    if (current && layer->restore(job->output)) {
+        entry.version = layer->version();
+        job->command->adoptCheckpoint(std::move(job->input));
+    } else if (job->rendered || !job->retried) {
+        // Later jobs on this layer started from the stale result; they render again too
+        retry(entry, *layer);
+        return;
+    }
+
+    // Adopted commands skip their first apply(); a retry that could not
+    // render at all runs on the live layer instead
+    bus_.dispatch(job->command);
+
+    entry.jobs.pop_front();
+    if (entry.jobs.empty()) {
+        pending_.erase(it);
+    }
+    --pendingCount_;
+
+    // NOLINTNEXTLINE(modernize-use-designated-initializers)
+    EventBus::instance().publish(CommandCompletedEvent{job->command, layer, job->retried});
+}
+
+void AsyncCommandBus::retry(PendingLayer& entry, Layer& layer)
+{
+    // Replacement jobs, so that workers still reading the old ones are unaffected
+    entry.version = layer.version();
+    std::shared_ptr<Job> previous;
+    for (auto& stale : entry.jobs) {
+        auto job = std::make_shared<Job>();
+        job->command = stale->command;
+        job->width = layer.width();
+        job->height = layer.height();
+        job->format = layer.pixelFormat();
+        job->retried = true;
+        if (previous) {
+            job->previous = previous;
+        } else {
+            job->input = layer.snapshot();
+        }
+        executor_.submit(entry.orderKey, [this, job] { render(job); });
+        stale = job;
+        previous = std::move(job);
+    }
+}
+
+}  // namespace gimp
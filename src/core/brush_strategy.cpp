@@ -7,9 +7,14 @@
 
 #include "core/brush_strategy.h"
 
+#include "core/dab_kernels.h"
+#include "core/dab_mask_cache.h"
+#include "core/stroke_buffer.h"
+
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <type_traits>
 
 namespace gimp {
 
@@ -36,54 +41,273 @@ void unpackRGBA(std::uint32_t rgba,
 }
 
 /**
- * @brief Blends a source color over a destination with alpha.
- * @param dst Pointer to destination pixel (RGBA).
- * @param sr Source red.
- * @param sg Source green.
- * @param sb Source blue.
- * @param sa Source alpha.
+ * @brief Straight RGBA8 color of a dab.
+ */
+struct DabColor {
+    std::uint8_t r = 0;
+    std::uint8_t g = 0;
+    std::uint8_t b = 0;
+    std::uint8_t a = 0;
+};
+
+/**
+ * @brief Blends a dab color over one pixel with a wide channel type.
+ *
+ * Blends in float so the coverage gradient of soft edges is not quantized
+ * to 8 bits. 8-bit pixels go through the dab kernels instead.
+ * @param pixel Destination pixel.
+ * @param color Dab color.
+ * @param alpha Dab alpha (0-255, fractional).
  */
-void blendPixel(std::uint8_t* dst,
-                std::uint8_t sr,
-                std::uint8_t sg,
-                std::uint8_t sb,
-                std::uint8_t sa)
+template <typename Channel>
+void blendDab(std::uint8_t* pixel, const DabColor& color, float alpha)
 {
-    if (sa == 0) {
+    using Traits = ChannelTraits<Channel>;
+    const float sa = alpha / 255.0F;
+    if (sa <= 0.0F) {
         return;
     }
+    const float da = loadChannel<Channel>(pixel + 3 * sizeof(Channel)) / Traits::kOne;
+    const float outA = sa + da * (1.0F - sa);
+    const float source[3] = {color.r / 255.0F, color.g / 255.0F, color.b / 255.0F};
+    for (int c = 0; c < 3; ++c) {
+        std::uint8_t* channel = pixel + c * sizeof(Channel);
+        const float dst = loadChannel<Channel>(channel) / Traits::kOne;
+        const float value = (source[c] * sa + dst * da * (1.0F - sa)) / outA;
+        storeChannel<Channel>(channel, value * Traits::kOne + Traits::kRound);
+    }
+    storeChannel<Channel>(pixel + 3 * sizeof(Channel), outA * Traits::kOne + Traits::kRound);
+}
 
-    std::uint8_t dr = dst[0];
-    std::uint8_t dg = dst[1];
-    std::uint8_t db = dst[2];
-    std::uint8_t da = dst[3];
+/**
+ * @brief Scales the alpha channel of a straight-alpha pixel.
+ * @param pixel Pixel with channels of type Channel.
+ * @param keep Fraction of alpha to keep.
+ */
+template <typename Channel>
+void scaleAlpha(std::uint8_t* pixel, float keep)
+{
+    std::uint8_t* alpha = pixel + 3 * sizeof(Channel);
+    storeChannel<Channel>(alpha, std::max(0.0F, loadChannel<Channel>(alpha) * keep));
+}
 
-    if (sa == 255 || da == 0) {
-        dst[0] = sr;
-        dst[1] = sg;
-        dst[2] = sb;
-        dst[3] = sa;
+/**
+ * @brief Blends the dab color over a row of pixels, scaled by coverage.
+ * @param line First pixel of the row.
+ * @param coverage Coverage of each pixel.
+ * @param count Pixels in the row.
+ * @param color Dab color.
+ * @param alphaScale Dab alpha (0-255) at full coverage.
+ * @param kernel Paint kernel used for 8-bit rows.
+ */
+template <typename Channel>
+void paintRow(std::uint8_t* line,
+              const float* coverage,
+              int count,
+              const DabColor& color,
+              float alphaScale,
+              DabRowFn kernel)
+{
+    if constexpr (std::is_same_v<Channel, std::uint8_t>) {
+        const std::uint32_t rgb = (static_cast<std::uint32_t>(color.r) << 24) |
+                                  (static_cast<std::uint32_t>(color.g) << 16) |
+                                  (static_cast<std::uint32_t>(color.b) << 8);
+        kernel(line, coverage, count, rgb, alphaScale);
+    } else {
+        for (int i = 0; i < count; ++i) {
+            if (coverage[i] > 0.0F) {
+                blendDab<Channel>(line + i * 4 * sizeof(Channel), color, alphaScale * coverage[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Calls row(line, coverage, count) for the part of each mask row inside the target.
+ * @param firstRow First target row that may be written.
+ * @param endRow Row past the last one that may be written.
+ */
+template <typename Channel, typename RowFn>
+void forEachMaskRow(std::uint8_t* target,
+                    int targetWidth,
+                    int firstRow,
+                    int endRow,
+                    int x,
+                    int y,
+                    const DabMask& mask,
+                    RowFn&& row)
+{
+    constexpr std::size_t kPixelBytes = 4 * sizeof(Channel);
+    const int left = x + mask.left;
+    const int top = y + mask.top;
+
+    const int minCol = std::max(0, -left);
+    const int maxCol = std::min(mask.width, targetWidth - left);
+    const int minRow = std::max(0, firstRow - top);
+    const int maxRow = std::min(mask.height, endRow - top);
+    if (minCol >= maxCol) {
+        return;
+    }
+
+    for (int r = minRow; r < maxRow; ++r) {
+        std::uint8_t* line =
+            target +
+            (static_cast<std::size_t>(top + r) * targetWidth + (left + minCol)) * kPixelBytes;
+        row(line, mask.row(r) + minCol, maxCol - minCol);
+    }
+}
+
+/**
+ * @brief Raises the coverage of a stroke buffer to a dab mask scaled by strength.
+ * @param firstRow First buffer row that may be written.
+ * @param endRow Row past the last one that may be written.
+ */
+void accumulateMaskDab(StrokeBuffer& buffer,
+                       int firstRow,
+                       int endRow,
+                       int x,
+                       int y,
+                       const DabMask& mask,
+                       float strength)
+{
+    const Rect& area = buffer.area();
+    const int left = x + mask.left;
+    const int top = y + mask.top;
+
+    const int minCol = std::max(0, area.x - left);
+    const int maxCol = std::min(mask.width, area.x + area.w - left);
+    const int minRow = std::max(0, std::max(firstRow, area.y) - top);
+    const int maxRow = std::min(mask.height, std::min(endRow, area.y + area.h) - top);
+    for (int r = minRow; r < maxRow && minCol < maxCol; ++r) {
+        buffer.accumulateRow(
+            left + minCol, top + r, mask.row(r) + minCol, maxCol - minCol, strength);
+    }
+}
+
+/**
+ * @brief Calls row(line, coverage, count) for each row of a stroke buffer region.
+ *
+ * Coverage is converted from the buffer's bytes to the 0-1 floats the dab
+ * kernels take.
+ */
+template <typename Channel, typename RowFn>
+void forEachStrokeRow(std::uint8_t* target,
+                      int targetWidth,
+                      const StrokeBuffer& buffer,
+                      const Rect& region,
+                      RowFn&& row)
+{
+    constexpr std::size_t kPixelBytes = 4 * sizeof(Channel);
+    const Rect& area = buffer.area();
+    const int x0 = std::max(region.x, area.x);
+    const int y0 = std::max(region.y, area.y);
+    const int x1 = std::min(region.x + region.w, area.x + area.w);
+    const int y1 = std::min(region.y + region.h, area.y + area.h);
+    if (x0 >= x1) {
         return;
     }
 
-    // Porter-Duff "over" compositing
-    float srcA = static_cast<float>(sa) / 255.0F;
-    float dstA = static_cast<float>(da) / 255.0F;
-    float outA = srcA + dstA * (1.0F - srcA);
-
-    if (outA > 0.0F) {
-        dst[0] = static_cast<std::uint8_t>(
-            (static_cast<float>(sr) * srcA + static_cast<float>(dr) * dstA * (1.0F - srcA)) / outA);
-        dst[1] = static_cast<std::uint8_t>(
-            (static_cast<float>(sg) * srcA + static_cast<float>(dg) * dstA * (1.0F - srcA)) / outA);
-        dst[2] = static_cast<std::uint8_t>(
-            (static_cast<float>(sb) * srcA + static_cast<float>(db) * dstA * (1.0F - srcA)) / outA);
-        dst[3] = static_cast<std::uint8_t>(outA * 255.0F);
+    std::vector<std::uint8_t> bytes(static_cast<std::size_t>(x1 - x0));
+    std::vector<float> coverage(bytes.size());
+    for (int y = y0; y < y1; ++y) {
+        buffer.readRow(y, x0, x1 - x0, bytes.data());
+        for (std::size_t i = 0; i < coverage.size(); ++i) {
+            coverage[i] = static_cast<float>(bytes[i]) * (1.0F / 255.0F);
+        }
+        std::uint8_t* line =
+            target + (static_cast<std::size_t>(y) * targetWidth + x0) * kPixelBytes;
+        row(line, coverage.data(), x1 - x0);
     }
 }
 
+/**
+ * @brief Renders a dab by blending the color scaled by a coverage mask.
+ * @param alphaScale Dab alpha (0-255) at full coverage.
+ * @param kernel Paint kernel used for 8-bit targets.
+ */
+template <typename Channel>
+void renderMaskDab(std::uint8_t* target,
+                   int targetWidth,
+                   int firstRow,
+                   int endRow,
+                   int x,
+                   int y,
+                   const DabMask& mask,
+                   const DabColor& color,
+                   float alphaScale,
+                   DabRowFn kernel)
+{
+    const auto paint = [&](std::uint8_t* line, const float* coverage, int count) {
+        paintRow<Channel>(line, coverage, count, color, alphaScale, kernel);
+    };
+    forEachMaskRow<Channel>(target, targetWidth, firstRow, endRow, x, y, mask, paint);
+}
+
+/**
+ * @brief Selects the paint kernel for a target format.
+ */
+DabRowFn paintKernel(PixelFormat format, SimdLevel level)
+{
+    return dabRowKernel(describe(format).premultiplied ? DabOp::PaintPremultiplied : DabOp::Paint,
+                        level);
+}
+
+/**
+ * @brief Pixel and sub-pixel offset of a dab center.
+ */
+struct DabCenter {
+    int x = 0;
+    int y = 0;
+    float offsetX = 0.0F;  ///< In [0, 1), a multiple of 1 / kSubpixelSteps.
+    float offsetY = 0.0F;  ///< In [0, 1), a multiple of 1 / kSubpixelSteps.
+};
+
+/**
+ * @brief Splits a dab center into its pixel and sub-pixel offset.
+ *
+ * The center is rounded to the nearest sub-pixel step of the mask cache, so
+ * integer centers get a zero offset.
+ */
+DabCenter splitCenter(float x, float y)
+{
+    constexpr auto kSteps = static_cast<float>(DabMaskCache::kSubpixelSteps);
+    const float snappedX = std::round(x * kSteps) / kSteps;
+    const float snappedY = std::round(y * kSteps) / kSteps;
+    const float pixelX = std::floor(snappedX);
+    const float pixelY = std::floor(snappedY);
+    return DabCenter{static_cast<int>(pixelX),
+                     static_cast<int>(pixelY),
+                     snappedX - pixelX,
+                     snappedY - pixelY};
+}
+
 }  // namespace
 
+void BrushStrategy::accumulateDab(StrokeBuffer& buffer, float x, float y, int size, float pressure)
+{
+    const Rect& area = buffer.area();
+    accumulateDabRows(buffer, x, y, size, pressure, area.y, area.y + area.h);
+}
+
+void BrushStrategy::compositeStroke(std::uint8_t* target,
+                                    int targetWidth,
+                                    const StrokeBuffer& buffer,
+                                    const Rect& region,
+                                    std::uint32_t color)
+{
+    DabColor dab;
+    unpackRGBA(color, dab.r, dab.g, dab.b, dab.a);
+
+    const DabRowFn kernel = paintKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        using Channel = decltype(zero);
+        const auto paint = [&](std::uint8_t* line, const float* coverage, int count) {
+            paintRow<Channel>(line, coverage, count, dab, static_cast<float>(dab.a), kernel);
+        };
+        forEachStrokeRow<Channel>(target, targetWidth, buffer, region, paint);
+    });
+}
+
 void SolidBrush::renderDab(std::uint8_t* target,
                            int targetWidth,
                            int targetHeight,
@@ -93,55 +317,161 @@ void SolidBrush::renderDab(std::uint8_t* target,
                            std::uint32_t color,
                            float pressure)
 {
-    std::uint8_t r = 0;
-    std::uint8_t g = 0;
-    std::uint8_t b = 0;
-    std::uint8_t a = 0;
-    unpackRGBA(color, r, g, b, a);
+    renderSubpixelDab(target,
+                      targetWidth,
+                      targetHeight,
+                      static_cast<float>(x),
+                      static_cast<float>(y),
+                      size,
+                      color,
+                      pressure);
+}
+
+void SolidBrush::renderDabRows(std::uint8_t* target,
+                               int targetWidth,
+                               int /*targetHeight*/,
+                               float x,
+                               float y,
+                               int size,
+                               std::uint32_t color,
+                               float pressure,
+                               int firstRow,
+                               int endRow)
+{
+    DabColor dab;
+    unpackRGBA(color, dab.r, dab.g, dab.b, dab.a);
 
     // Apply pressure to alpha
-    a = static_cast<std::uint8_t>(static_cast<float>(a) * pressure);
+    dab.a = static_cast<std::uint8_t>(static_cast<float>(dab.a) * pressure);
+
+    const DabCenter center = splitCenter(x, y);
+    const auto mask = DabMaskCache::instance().solid(size, center.offsetX, center.offsetY);
+    const DabRowFn kernel = paintKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        renderMaskDab<decltype(zero)>(target,
+                                      targetWidth,
+                                      firstRow,
+                                      endRow,
+                                      center.x,
+                                      center.y,
+                                      *mask,
+                                      dab,
+                                      static_cast<float>(dab.a),
+                                      kernel);
+    });
+}
+
+void SolidBrush::accumulateDabRows(StrokeBuffer& buffer,
+                                   float x,
+                                   float y,
+                                   int size,
+                                   float pressure,
+                                   int firstRow,
+                                   int endRow)
+{
+    const DabCenter center = splitCenter(x, y);
+    const auto mask = DabMaskCache::instance().solid(size, center.offsetX, center.offsetY);
+    accumulateMaskDab(buffer, firstRow, endRow, center.x, center.y, *mask, pressure);
+}
 
-    int radius = size / 2;
-    int radiusSq = radius * radius;
+namespace {
+/**
+ * @brief Calls row(py, minX, coverage, count) for each row of a stamp dab.
+ *
+ * Coverage is the stamp alpha scaled by strength / 255 and pressure.
+ * @param minCol First column that may be written.
+ * @param endCol Column past the last one that may be written.
+ */
+template <typename RowFn>
+void forEachStampRow(int minCol,
+                     int endCol,
+                     int firstRow,
+                     int endRow,
+                     int x,
+                     int y,
+                     int size,
+                     float strength,
+                     float pressure,
+                     const std::vector<std::uint8_t>& stamp,
+                     int stampWidth,
+                     int stampHeight,
+                     RowFn&& row)
+{
+    // Scale factor from stamp size to requested size
+    float scale = static_cast<float>(size) / static_cast<float>(std::max(stampWidth, stampHeight));
+    int halfSize = size / 2;
 
-    int minX = std::max(0, x - radius);
-    int maxX = std::min(targetWidth - 1, x + radius);
-    int minY = std::max(0, y - radius);
-    int maxY = std::min(targetHeight - 1, y + radius);
+    int minX = std::max(minCol, x - halfSize);
+    int maxX = std::min(endCol - 1, x + halfSize);
+    int minY = std::max(firstRow, y - halfSize);
+    int maxY = std::min(endRow - 1, y + halfSize);
+
+    if (minX > maxX || minY > maxY) {
+        return;
+    }
 
+    std::vector<float> coverage(static_cast<std::size_t>(maxX - minX + 1));
     for (int py = minY; py <= maxY; ++py) {
         for (int px = minX; px <= maxX; ++px) {
-            int dx = px - x;
-            int dy = py - y;
-            if (dx * dx + dy * dy <= radiusSq) {
-                std::uint8_t* pixel = target + (py * targetWidth + px) * 4;
-                blendPixel(pixel, r, g, b, a);
+            // Map target pixel back to stamp coordinates
+            float stampX = static_cast<float>(px - x + halfSize) / scale;
+            float stampY = static_cast<float>(py - y + halfSize) / scale;
+
+            int sx = static_cast<int>(stampX);
+            int sy = static_cast<int>(stampY);
+
+            float finalAlpha = 0.0F;
+            if (sx >= 0 && sx < stampWidth && sy >= 0 && sy < stampHeight) {
+                std::uint8_t stampAlpha = stamp[sy * stampWidth + sx];
+                finalAlpha = strength * static_cast<float>(stampAlpha) / 255.0F * pressure;
             }
+            coverage[px - minX] = finalAlpha;
         }
+        row(py, minX, coverage.data(), static_cast<int>(coverage.size()));
     }
 }
 
-namespace {
 /**
- * @brief GIMP-style piecewise falloff function (not true Gaussian).
- *
- * This produces a smoother, more natural brush edge than a simple Gaussian.
- * @param f Normalized distance value.
- * @return Falloff intensity.
+ * @brief Renders a dab from a grayscale stamp mask.
  */
-float gimpGauss(float f)
+template <typename Channel>
+void renderStampDab(std::uint8_t* target,
+                    int targetWidth,
+                    int firstRow,
+                    int endRow,
+                    int x,
+                    int y,
+                    int size,
+                    const DabColor& color,
+                    float pressure,
+                    const std::vector<std::uint8_t>& stamp,
+                    int stampWidth,
+                    int stampHeight,
+                    DabRowFn kernel)
 {
-    if (f < -0.5F) {
-        f = -1.0F - f;
-        return 2.0F * f * f;
-    }
-    if (f < 0.5F) {
-        return 1.0F - 2.0F * f * f;
-    }
-    f = 1.0F - f;
-    return 2.0F * f * f;
+    constexpr std::size_t kPixelBytes = 4 * sizeof(Channel);
+
+    // The stamp alpha becomes the coverage of a row painted at full scale
+    const auto paint = [&](int py, int minX, const float* coverage, int count) {
+        std::uint8_t* line =
+            target + (static_cast<std::size_t>(py) * targetWidth + minX) * kPixelBytes;
+        paintRow<Channel>(line, coverage, count, color, 1.0F, kernel);
+    };
+    forEachStampRow(0,
+                    targetWidth,
+                    firstRow,
+                    endRow,
+                    x,
+                    y,
+                    size,
+                    static_cast<float>(color.a),
+                    pressure,
+                    stamp,
+                    stampWidth,
+                    stampHeight,
+                    paint);
 }
+
 }  // namespace
 
 void SoftBrush::renderDab(std::uint8_t* target,
@@ -153,50 +483,60 @@ void SoftBrush::renderDab(std::uint8_t* target,
                           std::uint32_t color,
                           float pressure)
 {
-    std::uint8_t r = 0;
-    std::uint8_t g = 0;
-    std::uint8_t b = 0;
-    std::uint8_t a = 0;
-    unpackRGBA(color, r, g, b, a);
-
-    float radius = std::max(static_cast<float>(size) / 2.0F, 0.5F);
-
-    int minX = std::max(0, x - static_cast<int>(radius) - 1);
-    int maxX = std::min(targetWidth - 1, x + static_cast<int>(radius) + 1);
-    int minY = std::max(0, y - static_cast<int>(radius) - 1);
-    int maxY = std::min(targetHeight - 1, y + static_cast<int>(radius) + 1);
-
-    // GIMP-style exponent from hardness: harder = sharper falloff curve
-    // At hardness = 1.0: exponent approaches infinity (solid edge)
-    // At hardness = 0.0: exponent = 0.4 (maximum softness)
-    float exponent = 0.4F;
-    if ((1.0F - hardness_) > 0.0001F) {
-        exponent = 0.4F / (1.0F - hardness_);
-    } else {
-        exponent = 1000000.0F;
-    }
-
-    for (int py = minY; py <= maxY; ++py) {
-        for (int px = minX; px <= maxX; ++px) {
-            float dx = static_cast<float>(px - x);
-            float dy = static_cast<float>(py - y);
-            float dist = std::sqrt(dx * dx + dy * dy);
-
-            if (dist > radius) {
-                continue;
-            }
-
-            // GIMP-style falloff: gauss(pow(d / radius, exponent))
-            float normalizedDist = dist / radius;
-            float falloff = gimpGauss(std::pow(normalizedDist, exponent));
+    renderSubpixelDab(target,
+                      targetWidth,
+                      targetHeight,
+                      static_cast<float>(x),
+                      static_cast<float>(y),
+                      size,
+                      color,
+                      pressure);
+}
 
-            std::uint8_t finalAlpha =
-                static_cast<std::uint8_t>(static_cast<float>(a) * pressure * falloff);
+void SoftBrush::renderDabRows(std::uint8_t* target,
+                              int targetWidth,
+                              int /*targetHeight*/,
+                              float x,
+                              float y,
+                              int size,
+                              std::uint32_t color,
+                              float pressure,
+                              int firstRow,
+                              int endRow)
+{
+    DabColor dab;
+    unpackRGBA(color, dab.r, dab.g, dab.b, dab.a);
+
+    const DabCenter center = splitCenter(x, y);
+    const auto mask =
+        DabMaskCache::instance().soft(size, hardness_, center.offsetX, center.offsetY);
+    const DabRowFn kernel = paintKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        renderMaskDab<decltype(zero)>(target,
+                                      targetWidth,
+                                      firstRow,
+                                      endRow,
+                                      center.x,
+                                      center.y,
+                                      *mask,
+                                      dab,
+                                      static_cast<float>(dab.a) * pressure,
+                                      kernel);
+    });
+}
 
-            std::uint8_t* pixel = target + (py * targetWidth + px) * 4;
-            blendPixel(pixel, r, g, b, finalAlpha);
-        }
-    }
+void SoftBrush::accumulateDabRows(StrokeBuffer& buffer,
+                                  float x,
+                                  float y,
+                                  int size,
+                                  float pressure,
+                                  int firstRow,
+                                  int endRow)
+{
+    const DabCenter center = splitCenter(x, y);
+    const auto mask =
+        DabMaskCache::instance().soft(size, hardness_, center.offsetX, center.offsetY);
+    accumulateMaskDab(buffer, firstRow, endRow, center.x, center.y, *mask, pressure);
 }
 
 void StampBrush::setStamp(std::vector<std::uint8_t> data, int width, int height)
@@ -214,48 +554,213 @@ void StampBrush::renderDab(std::uint8_t* target,
                            int size,
                            std::uint32_t color,
                            float pressure)
+{
+    renderSubpixelDab(target,
+                      targetWidth,
+                      targetHeight,
+                      static_cast<float>(x),
+                      static_cast<float>(y),
+                      size,
+                      color,
+                      pressure);
+}
+
+void StampBrush::renderDabRows(std::uint8_t* target,
+                               int targetWidth,
+                               int /*targetHeight*/,
+                               float x,
+                               float y,
+                               int size,
+                               std::uint32_t color,
+                               float pressure,
+                               int firstRow,
+                               int endRow)
 {
     if (stampData_.empty() || stampWidth_ <= 0 || stampHeight_ <= 0) {
         return;
     }
 
-    std::uint8_t r = 0;
-    std::uint8_t g = 0;
-    std::uint8_t b = 0;
-    std::uint8_t a = 0;
-    unpackRGBA(color, r, g, b, a);
-
-    // Scale factor from stamp size to requested size
-    float scale =
-        static_cast<float>(size) / static_cast<float>(std::max(stampWidth_, stampHeight_));
-    int halfSize = size / 2;
-
-    int minX = std::max(0, x - halfSize);
-    int maxX = std::min(targetWidth - 1, x + halfSize);
-    int minY = std::max(0, y - halfSize);
-    int maxY = std::min(targetHeight - 1, y + halfSize);
-
-    for (int py = minY; py <= maxY; ++py) {
-        for (int px = minX; px <= maxX; ++px) {
-            // Map target pixel back to stamp coordinates
-            float stampX = static_cast<float>(px - x + halfSize) / scale;
-            float stampY = static_cast<float>(py - y + halfSize) / scale;
+    DabColor dab;
+    unpackRGBA(color, dab.r, dab.g, dab.b, dab.a);
+
+    // Stamps are sampled per whole pixel, so the center rounds to the nearest one
+    const auto centerX = static_cast<int>(std::lround(x));
+    const auto centerY = static_cast<int>(std::lround(y));
+    const DabRowFn kernel = paintKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        renderStampDab<decltype(zero)>(target,
+                                       targetWidth,
+                                       firstRow,
+                                       endRow,
+                                       centerX,
+                                       centerY,
+                                       size,
+                                       dab,
+                                       pressure,
+                                       stampData_,
+                                       stampWidth_,
+                                       stampHeight_,
+                                       kernel);
+    });
+}
 
-            int sx = static_cast<int>(stampX);
-            int sy = static_cast<int>(stampY);
+void StampBrush::accumulateDabRows(StrokeBuffer& buffer,
+                                   float x,
+                                   float y,
+                                   int size,
+                                   float pressure,
+                                   int firstRow,
+                                   int endRow)
+{
+    if (stampData_.empty() || stampWidth_ <= 0 || stampHeight_ <= 0) {
+        return;
+    }
 
-            if (sx >= 0 && sx < stampWidth_ && sy >= 0 && sy < stampHeight_) {
-                std::uint8_t stampAlpha = stampData_[sy * stampWidth_ + sx];
-                std::uint8_t finalAlpha = static_cast<std::uint8_t>(
-                    static_cast<float>(a) * static_cast<float>(stampAlpha) / 255.0F * pressure);
+    const Rect& area = buffer.area();
+    const auto accumulate = [&](int py, int minX, const float* coverage, int count) {
+        buffer.accumulateRow(minX, py, coverage, count, 1.0F);
+    };
+    forEachStampRow(area.x,
+                    area.x + area.w,
+                    std::max(firstRow, area.y),
+                    std::min(endRow, area.y + area.h),
+                    static_cast<int>(std::lround(x)),
+                    static_cast<int>(std::lround(y)),
+                    size,
+                    1.0F,
+                    pressure,
+                    stampData_,
+                    stampWidth_,
+                    stampHeight_,
+                    accumulate);
+}
 
-                std::uint8_t* pixel = target + (py * targetWidth + px) * 4;
-                blendPixel(pixel, r, g, b, finalAlpha);
+namespace {
+/**
+ * @brief Lowers the alpha of a row of pixels scaled by coverage.
+ * @param strength Fraction of alpha removed at full coverage.
+ * @param kernel Erase kernel used for 8-bit rows.
+ */
+template <typename Channel>
+void eraseRow(std::uint8_t* line, const float* coverage, int count, float strength, DabRowFn kernel)
+{
+    if constexpr (std::is_same_v<Channel, std::uint8_t>) {
+        kernel(line, coverage, count, 0, strength);
+    } else {
+        // Erase by reducing alpha (making pixels transparent)
+        for (int i = 0; i < count; ++i) {
+            if (coverage[i] > 0.0F) {
+                scaleAlpha<Channel>(line + i * 4 * sizeof(Channel), 1.0F - strength * coverage[i]);
             }
         }
     }
 }
 
+/**
+ * @brief Selects the erase kernel for a target format.
+ */
+DabRowFn eraseKernel(PixelFormat format, SimdLevel level)
+{
+    return dabRowKernel(describe(format).premultiplied ? DabOp::ErasePremultiplied : DabOp::Erase,
+                        level);
+}
+
+/**
+ * @brief Lowers the alpha under an eraser dab.
+ * @param strength Fraction of alpha removed at full coverage.
+ * @param kernel Erase kernel used for 8-bit targets.
+ */
+template <typename Channel>
+void renderEraseDab(std::uint8_t* target,
+                    int targetWidth,
+                    int firstRow,
+                    int endRow,
+                    int x,
+                    int y,
+                    const DabMask& mask,
+                    float strength,
+                    DabRowFn kernel)
+{
+    const auto erase = [&](std::uint8_t* line, const float* coverage, int count) {
+        eraseRow<Channel>(line, coverage, count, strength, kernel);
+    };
+    forEachMaskRow<Channel>(target, targetWidth, firstRow, endRow, x, y, mask, erase);
+}
+
+}  // namespace
+
+void EraserBrush::renderDab(std::uint8_t* target,
+                            int targetWidth,
+                            int targetHeight,
+                            int x,
+                            int y,
+                            int size,
+                            std::uint32_t color,
+                            float pressure)
+{
+    renderSubpixelDab(target,
+                      targetWidth,
+                      targetHeight,
+                      static_cast<float>(x),
+                      static_cast<float>(y),
+                      size,
+                      color,
+                      pressure);
+}
+
+void EraserBrush::renderDabRows(std::uint8_t* target,
+                                int targetWidth,
+                                int /*targetHeight*/,
+                                float x,
+                                float y,
+                                int size,
+                                std::uint32_t /*color*/,
+                                float pressure,
+                                int firstRow,
+                                int endRow)
+{
+    // Erase strength combines pressure, opacity and the edge falloff in the mask
+    const DabCenter center = splitCenter(x, y);
+    const auto mask =
+        DabMaskCache::instance().eraser(size, hardness_, center.offsetX, center.offsetY);
+    const float strength = pressure * opacity_;
+    const DabRowFn kernel = eraseKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        renderEraseDab<decltype(zero)>(
+            target, targetWidth, firstRow, endRow, center.x, center.y, *mask, strength, kernel);
+    });
+}
+
+void EraserBrush::accumulateDabRows(StrokeBuffer& buffer,
+                                    float x,
+                                    float y,
+                                    int size,
+                                    float pressure,
+                                    int firstRow,
+                                    int endRow)
+{
+    const DabCenter center = splitCenter(x, y);
+    const auto mask =
+        DabMaskCache::instance().eraser(size, hardness_, center.offsetX, center.offsetY);
+    accumulateMaskDab(buffer, firstRow, endRow, center.x, center.y, *mask, pressure);
+}
+
+void EraserBrush::compositeStroke(std::uint8_t* target,
+                                  int targetWidth,
+                                  const StrokeBuffer& buffer,
+                                  const Rect& region,
+                                  std::uint32_t /*color*/)
+{
+    const DabRowFn kernel = eraseKernel(pixelFormat_, simdLevel_);
+    visitChannelType(pixelFormat_, [&](auto zero) {
+        using Channel = decltype(zero);
+        const auto erase = [&](std::uint8_t* line, const float* coverage, int count) {
+            eraseRow<Channel>(line, coverage, count, opacity_, kernel);
+        };
+        forEachStrokeRow<Channel>(target, targetWidth, buffer, region, erase);
+    });
+}
+
 std::unique_ptr<BrushStrategy> createBrushStrategy(const char* typeName)
 {
     if (std::strcmp(typeName, "solid") == 0) {
@@ -267,6 +772,9 @@ std::unique_ptr<BrushStrategy> createBrushStrategy(const char* typeName)
     if (std::strcmp(typeName, "stamp") == 0) {
         return std::make_unique<StampBrush>();
     }
+    if (std::strcmp(typeName, "eraser") == 0) {
+        return std::make_unique<EraserBrush>();
+    }
     return nullptr;
 }
 
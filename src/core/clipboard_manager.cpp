@@ -24,6 +24,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 namespace gimp {
 
@@ -68,6 +70,13 @@ QImage toRgbaImage(const QImage& image)
     return image.convertToFormat(QImage::Format_RGBA8888);
 }
 
+/// Returns the QImage format whose byte layout matches a layer's pixels.
+QImage::Format imageFormatFor(const Layer& layer)
+{
+    return describe(layer.pixelFormat()).premultiplied ? QImage::Format_RGBA8888_Premultiplied
+                                                       : QImage::Format_RGBA8888;
+}
+
 }  // namespace
 
 bool ClipboardManager::copySelection(const std::shared_ptr<Document>& document,
@@ -84,13 +93,19 @@ bool ClipboardManager::copySelection(const std::shared_ptr<Document>& document,
     }
     const int layerWidth = sourceLayer->width();
     const int layerHeight = sourceLayer->height();
-    const auto& data = sourceLayer->data();
+
+    // The clipboard holds 8-bit images; wider formats are copied through a straight RGBA8 view
+    std::vector<std::uint8_t> view;
+    if (describe(sourceLayer->pixelFormat()).bytesPerChannel != 1) {
+        view = sourceLayer->pixelsAs(PixelFormat::Rgba8);
+    }
+    const auto& data = view.empty() ? std::as_const(*sourceLayer).data() : view;
 
     const auto& selectionPath = SelectionManager::instance().selectionPath();
 
     // If no selection, copy entire layer (GIMP behavior)
     if (selectionPath.isEmpty()) {
-        QImage image(layerWidth, layerHeight, QImage::Format_RGBA8888);
+        QImage image(layerWidth, layerHeight, imageFormatFor(*sourceLayer));
         std::memcpy(image.bits(), data.data(), data.size());
         setImageInternal(image);
         return true;
@@ -111,7 +126,7 @@ bool ClipboardManager::copySelection(const std::shared_ptr<Document>& document,
         return false;
     }
 
-    QImage image(regionWidth, regionHeight, QImage::Format_RGBA8888);
+    QImage image(regionWidth, regionHeight, imageFormatFor(*sourceLayer));
     image.fill(Qt::transparent);
 
     for (int y = 0; y < regionHeight; ++y) {
@@ -188,6 +203,7 @@ bool ClipboardManager::cutSelection(const std::shared_ptr<Document>& document,
 
     auto& data = targetLayer->data();
     const int layerWidth = targetLayer->width();
+    const std::size_t pixelSize = targetLayer->bytesPerPixel();
 
     for (int y = 0; y < regionHeight; ++y) {
         const int srcY = regionY + y;
@@ -200,11 +216,8 @@ bool ClipboardManager::cutSelection(const std::shared_ptr<Document>& document,
             const std::size_t dstIndex =
                 (static_cast<std::size_t>(srcY) * static_cast<std::size_t>(layerWidth) +
                  static_cast<std::size_t>(srcX)) *
-                4U;
-            data[dstIndex + 0] = 0;
-            data[dstIndex + 1] = 0;
-            data[dstIndex + 2] = 0;
-            data[dstIndex + 3] = 0;
+                pixelSize;
+            std::memset(data.data() + dstIndex, 0, pixelSize);
         }
     }
 
@@ -8,6 +8,7 @@
 #include "core/command_bus.h"
 
 #include "core/command.h"
+#include "core/commands/compound_command.h"
 #include "core/history_manager.h"
 
 namespace gimp {
@@ -20,6 +21,18 @@ void BasicCommandBus::dispatch(std::shared_ptr<Command> command)
     }
 
     command->apply();
+    if (transactionDepth_ > 0) {
+        transaction_->add(std::move(command));
+        return;
+    }
+
+    // Bursts of mergeable commands collapse into the newest history entry
+    const auto now = Clock::now();
+    const bool recent = coalesceWindow_.count() > 0 && now - lastDispatch_ <= coalesceWindow_;
+    lastDispatch_ = now;
+    if (recent && history_->coalesce(command)) {
+        return;
+    }
     history_->push(std::move(command));
 }
 
@@ -27,4 +40,31 @@ HistoryManager& BasicCommandBus::history()
 {
     return *history_;
 }
+
+void BasicCommandBus::beginTransaction()
+{
+    if (transactionDepth_++ == 0) {
+        transaction_ = std::make_shared<CompoundCommand>();
+    }
+}
+
+void BasicCommandBus::endTransaction()
+{
+    if (transactionDepth_ == 0 || --transactionDepth_ > 0) {
+        return;
+    }
+
+    auto transaction = std::move(transaction_);
+    if (transaction->empty() || history_ == nullptr) {
+        return;
+    }
+
+    // A transaction is its own step; the next dispatch does not merge into it
+    lastDispatch_ = {};
+    if (transaction->commands().size() == 1) {
+        history_->push(transaction->commands().front());
+        return;
+    }
+    history_->push(std::move(transaction));
+}
 }  // namespace gimp
@@ -0,0 +1,98 @@
+/**
+ * @file command_executor.cpp
+ * @brief Implementation of CommandExecutor.
+ * @author Laurent Jiang
+ * @date 2026-02-26
+ */
+
+#include "core/command_executor.h"
+
+#include <utility>
+
+namespace gimp {
+
+CommandExecutor::CommandExecutor(std::size_t threadCount)
+{
+    if (threadCount == 0) {
+        const std::size_t hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    workers_.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+CommandExecutor::~CommandExecutor()
+{
+    {
+        const std::scoped_lock lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void CommandExecutor::submit(const void* key, Task task)
+{
+    if (!task) {
+        return;
+    }
+    {
+        const std::scoped_lock lock(mutex_);
+        auto& strand = strands_[key];
+        strand.tasks.push_back(std::move(task));
+        ++outstanding_;
+        // A strand is queued once; the worker running it requeues it when done
+        if (!strand.running && strand.tasks.size() == 1) {
+            ready_.push_back(key);
+        }
+    }
+    wake_.notify_one();
+}
+
+void CommandExecutor::waitIdle()
+{
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return outstanding_ == 0; });
+}
+
+void CommandExecutor::workerLoop()
+{
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+        if (ready_.empty()) {
+            return;  // Stopping with nothing left to run
+        }
+
+        const void* key = ready_.front();
+        ready_.pop_front();
+        auto& strand = strands_[key];
+        Task task = std::move(strand.tasks.front());
+        strand.tasks.pop_front();
+        strand.running = true;
+
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+
+        // The map may have rehashed while unlocked
+        auto& current = strands_[key];
+        current.running = false;
+        if (current.tasks.empty()) {
+            strands_.erase(key);
+        } else {
+            ready_.push_back(key);
+            wake_.notify_one();
+        }
+        if (--outstanding_ == 0) {
+            idle_.notify_all();
+        }
+    }
+}
+
+}  // namespace gimp
@@ -0,0 +1,63 @@
+/**
+ * @file compound_command.cpp
+ * @brief Implementation of CompoundCommand.
+ * @author Laurent Jiang
+ * @date 2026-02-25
+ */
+
+#include "core/commands/compound_command.h"
+
+#include <utility>
+
+namespace gimp {
+
+CompoundCommand::CompoundCommand(std::string description) : description_(std::move(description))
+{
+}
+
+void CompoundCommand::add(std::shared_ptr<Command> command)
+{
+    if (!command) {
+        return;
+    }
+    if (!commands_.empty() && commands_.back()->mergeWith(*command)) {
+        return;
+    }
+    commands_.push_back(std::move(command));
+}
+
+void CompoundCommand::apply()
+{
+    for (const auto& command : commands_) {
+        command->apply();
+    }
+}
+
+void CompoundCommand::undo()
+{
+    for (auto it = commands_.rbegin(); it != commands_.rend(); ++it) {
+        (*it)->undo();
+    }
+}
+
+std::size_t CompoundCommand::byteSize() const
+{
+    std::size_t bytes = 0;
+    for (const auto& command : commands_) {
+        bytes += command->byteSize();
+    }
+    return bytes;
+}
+
+bool CompoundCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    bool spilled = false;
+    for (const auto& command : commands_) {
+        if (command->byteSize() > 0 && command->spill(swap)) {
+            spilled = true;
+        }
+    }
+    return spilled;
+}
+
+}  // namespace gimp
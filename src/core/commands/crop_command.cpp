@@ -53,6 +53,31 @@ void CropCommand::undo()
     restoreSelection(beforeSelection_, beforeSelectionType_, "undo");
 }
 
+std::size_t CropCommand::byteSize() const
+{
+    std::size_t bytes = 0;
+    for (const auto& snapshot : beforeLayers_) {
+        bytes += snapshot.tiles.exclusiveByteSize() + snapshot.swapped.residentByteSize();
+    }
+    return bytes;
+}
+
+bool CropCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    bool spilledAll = !beforeLayers_.empty();
+    for (auto& snapshot : beforeLayers_) {
+        if (!snapshot.swapped.empty()) {
+            continue;
+        }
+        if (snapshot.swapped.store(swap, snapshot.tiles)) {
+            snapshot.tiles = TileBuffer();
+        } else {
+            spilledAll = false;
+        }
+    }
+    return spilledAll;
+}
+
 void CropCommand::captureBeforeState()
 {
     if (!document_) {
@@ -72,7 +97,7 @@ void CropCommand::captureBeforeState()
 
         LayerSnapshot snapshot;
         snapshot.layer = layer;
-        snapshot.data = layer->data();
+        snapshot.tiles = layer->snapshot();
         beforeLayers_.push_back(std::move(snapshot));
     }
 
@@ -91,7 +116,11 @@ void CropCommand::restoreBeforeLayers()
             continue;
         }
 
-        snapshot.layer->data() = snapshot.data;
+        if (!snapshot.swapped.empty() && snapshot.swapped.load(snapshot.tiles)) {
+            snapshot.swapped.reset();
+        }
+
+        snapshot.layer->restore(snapshot.tiles);
     }
 }
 
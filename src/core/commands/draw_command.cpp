@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <utility>
 
 namespace gimp {
 
@@ -40,25 +41,32 @@ void DrawCommand::captureBeforeState()
         return;
     }
 
-    // Allocate space for the region (RGBA = 4 bytes per pixel)
-    beforeState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4);
+    // Allocate space for the region in the layer's pixel format
+    beforeState_.resize(static_cast<std::size_t>(clippedWidth) *
+                        static_cast<std::size_t>(clippedHeight) * layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
+    // Read through a const layer so capturing does not mark the pixels modified
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     // Copy the region from the layer
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
         std::memcpy(beforeState_.data() + dstOffset,
                     layerData.data() + srcOffset,
-                    (clippedWidth * pixelSize));
+                    static_cast<std::size_t>(clippedWidth) * pixelSize);
     }
 }
 
+void DrawCommand::captureBeforeState(std::vector<std::uint8_t> pixels)
+{
+    beforeState_ = std::move(pixels);
+}
+
 void DrawCommand::captureAfterState()
 {
     if (!layer_) {
@@ -72,37 +80,75 @@ void DrawCommand::captureAfterState()
     int clippedHeight = std::min(regionHeight_, layer_->height() - clippedY);
 
     if (clippedWidth <= 0 || clippedHeight <= 0) {
-        afterState_.clear();
+        afterDelta_ = {};
         return;
     }
 
-    // Allocate space for the region (RGBA = 4 bytes per pixel)
-    afterState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4);
+    // Allocate space for the region in the layer's pixel format
+    std::vector<std::uint8_t> afterState(static_cast<std::size_t>(clippedWidth) *
+                                         static_cast<std::size_t>(clippedHeight) *
+                                         layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     // Copy the region from the layer
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
-        std::memcpy(afterState_.data() + dstOffset,
+        std::memcpy(afterState.data() + dstOffset,
                     layerData.data() + srcOffset,
-                    (clippedWidth * pixelSize));
+                    static_cast<std::size_t>(clippedWidth) * pixelSize);
     }
+
+    // Keep both states compressed: before as is, after as a delta against before
+    before_ = CompressedBuffer::compress(beforeState_);
+    afterDelta_ = CompressedBuffer::compressDelta(beforeState_, afterState);
+    beforeState_.clear();
+    beforeState_.shrink_to_fit();
 }
 
 void DrawCommand::apply()
 {
-    updateState(afterState_);
+    // Until captureAfterState() there is no after state to restore
+    std::vector<std::uint8_t> state;
+    if (beforeState_.empty() && faultIn() && before_.decompress(state) &&
+        afterDelta_.applyDelta(state)) {
+        updateState(state);
+    }
 }
 
 void DrawCommand::undo()
 {
-    updateState(beforeState_);
+    std::vector<std::uint8_t> state;
+    if (!beforeState_.empty()) {
+        // Only captureBeforeState() ran; the before pixels are still raw
+        updateState(beforeState_);
+    } else if (faultIn() && before_.decompress(state)) {
+        updateState(state);
+    }
+}
+
+std::size_t DrawCommand::byteSize() const
+{
+    return beforeState_.size() + before_.byteSize() + afterDelta_.byteSize();
+}
+
+bool DrawCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    // Nothing to page out before both states were captured
+    if (!beforeState_.empty() || before_.empty()) {
+        return false;
+    }
+    return before_.spill(swap) && (afterDelta_.empty() || afterDelta_.spill(swap));
+}
+
+bool DrawCommand::faultIn()
+{
+    return before_.load() && afterDelta_.load();
 }
 
 void DrawCommand::updateState(const std::vector<std::uint8_t>& state)
@@ -120,19 +166,8 @@ void DrawCommand::updateState(const std::vector<std::uint8_t>& state)
         return;
     }
 
-    auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
-
-    // Restore the region to the layer
-    for (int row = 0; row < clippedHeight; ++row) {
-        const int dstRow = clippedY + row;
-        const int dstOffset = (dstRow * layerWidth + clippedX) * pixelSize;
-        const int srcOffset = row * clippedWidth * pixelSize;
-
-        std::memcpy(
-            layerData.data() + dstOffset, state.data() + srcOffset, (clippedWidth * pixelSize));
-    }
+    // Restore only the region, so the rest of the layer keeps its tiles and caches
+    layer_->writeRegion(Rect{clippedX, clippedY, clippedWidth, clippedHeight}, state.data());
 }
 
 }  // namespace gimp
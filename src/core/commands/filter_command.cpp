@@ -0,0 +1,42 @@
+/**
+ * @file filter_command.cpp
+ * @brief Implementation of FilterCommand.
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#include "core/commands/filter_command.h"
+
+#include "core/filters/filter.h"
+#include "core/layer.h"
+
+#include <utility>
+
+namespace gimp {
+
+FilterCommand::FilterCommand(std::shared_ptr<Layer> layer, std::shared_ptr<Filter> filter)
+    : ReplayableCommand{std::move(layer)},
+      filter_{std::move(filter)}
+{
+}
+
+void FilterCommand::replay(Layer& target) const
+{
+    if (!filter_) {
+        succeeded_ = false;
+        return;
+    }
+    // Filters take shared ownership; the target outlives the call, so alias it
+    succeeded_ = filter_->apply(std::shared_ptr<Layer>(std::shared_ptr<Layer>{}, &target));
+}
+
+std::size_t FilterCommand::replayCost() const
+{
+    const auto& target = layer();
+    if (!target) {
+        return 0;
+    }
+    return static_cast<std::size_t>(target->width()) * static_cast<std::size_t>(target->height());
+}
+
+}  // namespace gimp
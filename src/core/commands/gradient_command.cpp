@@ -0,0 +1,160 @@
+/**
+ * @file gradient_command.cpp
+ * @brief Implementation of GradientCommand.
+ * @author Laurent Jiang
+ * @date 2026-02-23
+ */
+
+#include "core/commands/gradient_command.h"
+
+#include "core/layer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace gimp {
+
+namespace {
+
+/// Writes an RGBA color into a straight RGBA8 pixel.
+void storeColor(std::uint8_t* pixel, std::uint32_t color)
+{
+    pixel[0] = static_cast<std::uint8_t>((color >> 24) & 0xFF);
+    pixel[1] = static_cast<std::uint8_t>((color >> 16) & 0xFF);
+    pixel[2] = static_cast<std::uint8_t>((color >> 8) & 0xFF);
+    pixel[3] = static_cast<std::uint8_t>(color & 0xFF);
+}
+
+/// Fills straight RGBA8 pixels with a linear or radial gradient.
+void fillGradient(std::uint8_t* data, int width, int height, const GradientParams& params)
+{
+    const float dx = static_cast<float>(params.endX - params.startX);
+    const float dy = static_cast<float>(params.endY - params.startY);
+    const float distSq = dx * dx + dy * dy;
+    const float radius = std::sqrt(distSq);
+    const bool linear = params.mode == GradientMode::Linear;
+
+    // Degenerate case: start and end are the same, fill with the start color
+    if ((linear && distSq < 0.001F) || (!linear && radius < 0.001F)) {
+        for (std::size_t i = 0; i < static_cast<std::size_t>(width) * height; ++i) {
+            storeColor(data + i * 4, params.startColor);
+        }
+        return;
+    }
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float px = static_cast<float>(x - params.startX);
+            const float py = static_cast<float>(y - params.startY);
+
+            // Linear: project onto the gradient vector; radial: distance from the center
+            float t = linear ? (px * dx + py * dy) / distSq : std::sqrt(px * px + py * py) / radius;
+            t = std::clamp(t, 0.0F, 1.0F);
+
+            const std::size_t index = static_cast<std::size_t>(y) * width + x;
+            storeColor(data + index * 4,
+                       GradientCommand::lerpColor(params.startColor, params.endColor, t));
+        }
+    }
+}
+
+}  // namespace
+
+GradientCommand::GradientCommand(std::shared_ptr<Layer> layer, const GradientParams& params)
+    : layer_{std::move(layer)},
+      params_{params}
+{
+}
+
+void GradientCommand::captureBeforeState()
+{
+    if (!layer_) {
+        return;
+    }
+    before_ = layer_->snapshot();
+    swapped_.reset();
+    captured_ = true;
+}
+
+void GradientCommand::apply()
+{
+    if (!layer_) {
+        return;
+    }
+    if (!captured_) {
+        captureBeforeState();
+    }
+    render(*layer_, params_);
+}
+
+void GradientCommand::undo()
+{
+    if (!layer_ || !captured_) {
+        return;
+    }
+    if (!swapped_.empty() && swapped_.load(before_)) {
+        swapped_.reset();
+    }
+    layer_->restore(before_);
+}
+
+std::size_t GradientCommand::byteSize() const
+{
+    return before_.exclusiveByteSize() + swapped_.residentByteSize();
+}
+
+bool GradientCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    if (!captured_ || !swapped_.empty()) {
+        return !swapped_.empty();
+    }
+    if (!swapped_.store(swap, before_)) {
+        return false;
+    }
+    before_ = TileBuffer();
+    return true;
+}
+
+void GradientCommand::render(Layer& layer, const GradientParams& params)
+{
+    const int width = layer.width();
+    const int height = layer.height();
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    // Gradients interpolate straight RGBA8 colors; other formats are rendered
+    // into a scratch buffer and converted once
+    if (layer.pixelFormat() == PixelFormat::Rgba8) {
+        fillGradient(layer.data().data(), width, height, params);
+        return;
+    }
+    std::vector<std::uint8_t> scratch(static_cast<std::size_t>(width) * height * 4);
+    fillGradient(scratch.data(), width, height, params);
+    layer.assignPixels(scratch, PixelFormat::Rgba8);
+}
+
+std::uint32_t GradientCommand::lerpColor(std::uint32_t color1, std::uint32_t color2, float t)
+{
+    auto r1 = static_cast<float>((color1 >> 24) & 0xFF);
+    auto g1 = static_cast<float>((color1 >> 16) & 0xFF);
+    auto b1 = static_cast<float>((color1 >> 8) & 0xFF);
+    auto a1 = static_cast<float>(color1 & 0xFF);
+
+    auto r2 = static_cast<float>((color2 >> 24) & 0xFF);
+    auto g2 = static_cast<float>((color2 >> 16) & 0xFF);
+    auto b2 = static_cast<float>((color2 >> 8) & 0xFF);
+    auto a2 = static_cast<float>(color2 & 0xFF);
+
+    auto r = static_cast<std::uint8_t>(r1 * (1.0F - t) + r2 * t);
+    auto g = static_cast<std::uint8_t>(g1 * (1.0F - t) + g2 * t);
+    auto b = static_cast<std::uint8_t>(b1 * (1.0F - t) + b2 * t);
+    auto a = static_cast<std::uint8_t>(a1 * (1.0F - t) + a2 * t);
+
+    return (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) |
+           (static_cast<std::uint32_t>(b) << 8) | static_cast<std::uint32_t>(a);
+}
+
+}  // namespace gimp
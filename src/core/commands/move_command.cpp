@@ -11,12 +11,42 @@
 #include "core/events.h"
 #include "core/layer.h"
 #include "core/selection_manager.h"
+#include "core/tile_store.h"
 
 #include <algorithm>
 #include <cstring>
+#include <utility>
 
 namespace gimp {
 
+namespace {
+
+/**
+ * @brief Copies a packed region into a larger packed region that contains it.
+ * @param src Pixels of srcRect, rows packed.
+ * @param srcRect Source rectangle; must lie inside dstRect.
+ * @param dst Pixels of dstRect, rows packed.
+ * @param dstRect Destination rectangle.
+ * @param pixelSize Bytes per pixel.
+ */
+void copyInto(const std::vector<std::uint8_t>& src,
+              const QRect& srcRect,
+              std::vector<std::uint8_t>& dst,
+              const QRect& dstRect,
+              std::size_t pixelSize)
+{
+    const std::size_t rowBytes = static_cast<std::size_t>(srcRect.width()) * pixelSize;
+    for (int row = 0; row < srcRect.height(); ++row) {
+        const std::size_t dstOffset =
+            (static_cast<std::size_t>(srcRect.y() - dstRect.y() + row) * dstRect.width() +
+             (srcRect.x() - dstRect.x())) *
+            pixelSize;
+        std::memcpy(dst.data() + dstOffset, src.data() + row * rowBytes, rowBytes);
+    }
+}
+
+}  // namespace
+
 MoveCommand::MoveCommand(std::shared_ptr<Layer> layer, QRect affectedRegion)
     : layer_{std::move(layer)},
       affectedRegion_{affectedRegion}
@@ -46,18 +76,19 @@ void MoveCommand::captureBeforeState()
         return;
     }
 
-    // Allocate space for the region (RGBA = 4 bytes per pixel)
-    beforeState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4);
+    // Allocate space for the region in the layer's pixel format
+    beforeState_.resize(static_cast<std::size_t>(clippedWidth) *
+                        static_cast<std::size_t>(clippedHeight) * layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     // Copy the region from the layer
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
         std::memcpy(beforeState_.data() + dstOffset,
                     layerData.data() + srcOffset,
@@ -84,41 +115,125 @@ void MoveCommand::captureAfterState()
     int clippedHeight = clippedBottom - clippedY;
 
     if (clippedWidth <= 0 || clippedHeight <= 0) {
-        afterState_.clear();
+        afterDelta_ = {};
         return;
     }
 
-    // Allocate space for the region (RGBA = 4 bytes per pixel)
-    afterState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4);
+    // Allocate space for the region in the layer's pixel format
+    std::vector<std::uint8_t> afterState(static_cast<std::size_t>(clippedWidth) *
+                                         static_cast<std::size_t>(clippedHeight) *
+                                         layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     // Copy the region from the layer
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
-        std::memcpy(afterState_.data() + dstOffset,
+        std::memcpy(afterState.data() + dstOffset,
                     layerData.data() + srcOffset,
                     static_cast<std::size_t>(clippedWidth) * pixelSize);
     }
+
+    // Keep both states compressed: before as is, after as a delta against before
+    before_ = CompressedBuffer::compress(beforeState_);
+    afterDelta_ = CompressedBuffer::compressDelta(beforeState_, afterState);
+    beforeState_.clear();
+    beforeState_.shrink_to_fit();
 }
 
 void MoveCommand::apply()
 {
-    updateState(afterState_);
+    // Until captureAfterState() there is no after state to restore
+    std::vector<std::uint8_t> state;
+    if (beforeState_.empty() && faultIn() && before_.decompress(state) &&
+        afterDelta_.applyDelta(state)) {
+        updateState(state);
+    }
     restoreSelection(afterSelectionPath_, afterSelectionType_);
 }
 
 void MoveCommand::undo()
 {
-    updateState(beforeState_);
+    std::vector<std::uint8_t> state;
+    if (!beforeState_.empty()) {
+        // Only captureBeforeState() ran; the before pixels are still raw
+        updateState(beforeState_);
+    } else if (faultIn() && before_.decompress(state)) {
+        updateState(state);
+    }
     restoreSelection(beforeSelectionPath_, beforeSelectionType_);
 }
 
+std::size_t MoveCommand::byteSize() const
+{
+    return beforeState_.size() + before_.byteSize() + afterDelta_.byteSize();
+}
+
+bool MoveCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    // Nothing to page out before both states were captured
+    if (!beforeState_.empty() || before_.empty()) {
+        return false;
+    }
+    return before_.spill(swap) && (afterDelta_.empty() || afterDelta_.spill(swap));
+}
+
+bool MoveCommand::mergeWith(Command& next)
+{
+    auto* move = dynamic_cast<MoveCommand*>(&next);
+    if (move == nullptr || move == this || !layer_ || move->layer_ != layer_ ||
+        !beforeState_.empty() || !move->beforeState_.empty()) {
+        return false;
+    }
+
+    const QRect first = clippedRegion();
+    const QRect second = move->clippedRegion();
+    std::vector<std::uint8_t> firstBefore;
+    std::vector<std::uint8_t> secondBefore;
+    if (first.isEmpty() || second.isEmpty() || !faultIn() || !move->faultIn() ||
+        !before_.decompress(firstBefore) || !move->before_.decompress(secondBefore)) {
+        return false;
+    }
+
+    // The layer holds the result of both moves. Pixels of the union that
+    // neither move touched read the same before and after; where the moves
+    // overlap, this move's before state is the older one and wins.
+    const QRect merged = first.united(second);
+    const std::size_t pixelSize = layer_->bytesPerPixel();
+    std::vector<std::uint8_t> after(static_cast<std::size_t>(merged.width()) * merged.height() *
+                                    pixelSize);
+    layer_->readRegion(Rect{merged.x(), merged.y(), merged.width(), merged.height()},
+                       after.data());
+    std::vector<std::uint8_t> before = after;
+    copyInto(secondBefore, second, before, merged, pixelSize);
+    copyInto(firstBefore, first, before, merged, pixelSize);
+
+    affectedRegion_ = merged;
+    before_ = CompressedBuffer::compress(before);
+    afterDelta_ = CompressedBuffer::compressDelta(before, after);
+    afterSelectionPath_ = move->afterSelectionPath_;
+    afterSelectionType_ = move->afterSelectionType_;
+    return true;
+}
+
+QRect MoveCommand::clippedRegion() const
+{
+    if (!layer_) {
+        return {};
+    }
+    return affectedRegion_.intersected(QRect(0, 0, layer_->width(), layer_->height()));
+}
+
+bool MoveCommand::faultIn()
+{
+    return before_.load() && afterDelta_.load();
+}
+
 void MoveCommand::updateState(const std::vector<std::uint8_t>& state)
 {
     if (!layer_ || state.empty()) {
@@ -136,20 +251,8 @@ void MoveCommand::updateState(const std::vector<std::uint8_t>& state)
         return;
     }
 
-    auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;  // RGBA
-
-    // Restore the region to the layer
-    for (int row = 0; row < clippedHeight; ++row) {
-        const int dstRow = clippedY + row;
-        const int dstOffset = (dstRow * layerWidth + clippedX) * pixelSize;
-        const int srcOffset = row * clippedWidth * pixelSize;
-
-        std::memcpy(layerData.data() + dstOffset,
-                    state.data() + srcOffset,
-                    static_cast<std::size_t>(clippedWidth) * pixelSize);
-    }
+    // Restore only the region, so the rest of the layer keeps its tiles and caches
+    layer_->writeRegion(Rect{clippedX, clippedY, clippedWidth, clippedHeight}, state.data());
 }
 
 void MoveCommand::restoreSelection(const QPainterPath& path, SelectionType type)
@@ -14,6 +14,8 @@
 
 #include <algorithm>
 #include <cstring>
+#include <initializer_list>
+#include <utility>
 
 namespace gimp {
 
@@ -48,7 +50,7 @@ PasteCommand::PasteCommand(std::shared_ptr<Document> document, int x, int y, con
 
 void PasteCommand::apply()
 {
-    if (!document_ || imageData_.empty()) {
+    if (!document_ || !faultIn() || imageData_.empty()) {
         return;
     }
 
@@ -105,7 +107,54 @@ void PasteCommand::undo()
         return;
     }
 
-    updateState(beforeState_);
+    if (faultIn()) {
+        updateState(beforeState_);
+    }
+}
+
+std::size_t PasteCommand::byteSize() const
+{
+    return beforeState_.size() + afterState_.size() + imageData_.size();
+}
+
+bool PasteCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    if (spilled_) {
+        return true;
+    }
+
+    if (!swappedBefore_.store(swap, beforeState_) || !swappedAfter_.store(swap, afterState_) ||
+        !swappedImage_.store(swap, imageData_)) {
+        swappedBefore_.reset();
+        swappedAfter_.reset();
+        swappedImage_.reset();
+        return false;
+    }
+
+    for (auto* state : {&beforeState_, &afterState_, &imageData_}) {
+        state->clear();
+        state->shrink_to_fit();
+    }
+    spilled_ = true;
+    return true;
+}
+
+bool PasteCommand::faultIn()
+{
+    if (!spilled_) {
+        return true;
+    }
+
+    if (!swappedBefore_.load(beforeState_) || !swappedAfter_.load(afterState_) ||
+        !swappedImage_.load(imageData_)) {
+        return false;
+    }
+
+    swappedBefore_.reset();
+    swappedAfter_.reset();
+    swappedImage_.reset();
+    spilled_ = false;
+    return true;
 }
 
 void PasteCommand::captureBeforeState()
@@ -124,19 +173,20 @@ void PasteCommand::captureBeforeState()
         return;
     }
 
-    beforeState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4U);
+    beforeState_.resize(static_cast<std::size_t>(clippedWidth) *
+                        static_cast<std::size_t>(clippedHeight) * layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
         const std::size_t rowBytes =
-            static_cast<std::size_t>(clippedWidth) * static_cast<std::size_t>(pixelSize);
+            static_cast<std::size_t>(clippedWidth) * pixelSize;
         std::memcpy(beforeState_.data() + dstOffset, layerData.data() + srcOffset, rowBytes);
     }
 }
@@ -157,19 +207,20 @@ void PasteCommand::captureAfterState()
         return;
     }
 
-    afterState_.resize(static_cast<std::size_t>(clippedWidth * clippedHeight) * 4U);
+    afterState_.resize(static_cast<std::size_t>(clippedWidth) *
+                       static_cast<std::size_t>(clippedHeight) * layer_->bytesPerPixel());
 
-    const auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;
+    const auto& layerData = std::as_const(*layer_).data();
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     for (int row = 0; row < clippedHeight; ++row) {
-        const int srcRow = clippedY + row;
-        const int srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
-        const int dstOffset = row * clippedWidth * pixelSize;
+        const auto srcRow = static_cast<std::size_t>(clippedY + row);
+        const std::size_t srcOffset = (srcRow * layerWidth + clippedX) * pixelSize;
+        const std::size_t dstOffset = static_cast<std::size_t>(row) * clippedWidth * pixelSize;
 
         const std::size_t rowBytes =
-            static_cast<std::size_t>(clippedWidth) * static_cast<std::size_t>(pixelSize);
+            static_cast<std::size_t>(clippedWidth) * pixelSize;
         std::memcpy(afterState_.data() + dstOffset, layerData.data() + srcOffset, rowBytes);
     }
 }
@@ -189,19 +240,8 @@ void PasteCommand::updateState(const std::vector<std::uint8_t>& state)
         return;
     }
 
-    auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;
-
-    for (int row = 0; row < clippedHeight; ++row) {
-        const int dstRow = clippedY + row;
-        const int dstOffset = (dstRow * layerWidth + clippedX) * pixelSize;
-        const int srcOffset = row * clippedWidth * pixelSize;
-
-        const std::size_t rowBytes =
-            static_cast<std::size_t>(clippedWidth) * static_cast<std::size_t>(pixelSize);
-        std::memcpy(layerData.data() + dstOffset, state.data() + srcOffset, rowBytes);
-    }
+    // Restore only the region, so the rest of the layer keeps its tiles and caches
+    layer_->writeRegion(Rect{clippedX, clippedY, clippedWidth, clippedHeight}, state.data());
 }
 
 void PasteCommand::writeImageToLayer()
@@ -219,18 +259,23 @@ void PasteCommand::writeImageToLayer()
         return;
     }
 
-    auto& layerData = layer_->data();
-    const int layerWidth = layer_->width();
-    const int pixelSize = 4;
+    std::uint8_t* layerData =
+        layer_->regionData(Rect{clippedX, clippedY, clippedWidth, clippedHeight});
+    const auto layerWidth = static_cast<std::size_t>(layer_->width());
+    const std::size_t pixelSize = layer_->bytesPerPixel();
 
     for (int row = 0; row < clippedHeight; ++row) {
-        const int dstRow = clippedY + row;
-        const int dstOffset = (dstRow * layerWidth + clippedX) * pixelSize;
-        const int srcOffset = row * regionWidth_ * pixelSize;
-
-        const std::size_t rowBytes =
-            static_cast<std::size_t>(clippedWidth) * static_cast<std::size_t>(pixelSize);
-        std::memcpy(layerData.data() + dstOffset, imageData_.data() + srcOffset, rowBytes);
+        const std::size_t dstOffset =
+            (static_cast<std::size_t>(clippedY + row) * layerWidth + clippedX) * pixelSize;
+        const std::size_t srcOffset =
+            static_cast<std::size_t>(row) * static_cast<std::size_t>(regionWidth_) * 4;
+
+        // Clipboard images are straight RGBA8; store them in the layer's format
+        convertPixels(layerData + dstOffset,
+                      imageData_.data() + srcOffset,
+                      static_cast<std::size_t>(clippedWidth),
+                      PixelFormat::Rgba8,
+                      layer_->pixelFormat());
     }
 }
 
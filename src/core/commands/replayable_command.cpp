@@ -0,0 +1,130 @@
+/**
+ * @file replayable_command.cpp
+ * @brief Implementation of ReplayableCommand.
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#include "core/commands/replayable_command.h"
+
+#include "core/layer.h"
+
+#include <utility>
+
+namespace gimp {
+
+ReplayableCommand::ReplayableCommand(std::shared_ptr<Layer> layer) : layer_{std::move(layer)} {}
+
+void ReplayableCommand::apply()
+{
+    if (!layer_) {
+        return;
+    }
+    if (!captured_) {
+        captureCheckpoint();
+    }
+    if (rendered_) {
+        rendered_ = false;
+        return;
+    }
+    replay(*layer_);
+}
+
+void ReplayableCommand::undo()
+{
+    restoreCheckpoint();
+}
+
+std::size_t ReplayableCommand::byteSize() const
+{
+    return checkpoint_.exclusiveByteSize() + swapped_.residentByteSize() + inputByteSize();
+}
+
+bool ReplayableCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    if (!hasCheckpoint_ || !swapped_.empty()) {
+        return !swapped_.empty();
+    }
+    if (!swapped_.store(swap, checkpoint_)) {
+        return false;
+    }
+    checkpoint_ = TileBuffer();
+    return true;
+}
+
+void ReplayableCommand::captureCheckpoint()
+{
+    if (!layer_) {
+        return;
+    }
+    adoptCheckpoint(layer_->snapshot());
+    rendered_ = false;
+}
+
+void ReplayableCommand::adoptCheckpoint(TileBuffer before)
+{
+    if (!layer_) {
+        return;
+    }
+    checkpoint_ = std::move(before);
+    swapped_.reset();
+    width_ = layer_->width();
+    height_ = layer_->height();
+    format_ = layer_->pixelFormat();
+    hasCheckpoint_ = true;
+    captured_ = true;
+    rendered_ = true;
+}
+
+bool ReplayableCommand::restoreCheckpoint()
+{
+    if (!layer_ || !hasCheckpoint_ || !loadCheckpoint()) {
+        return false;
+    }
+    return layer_->restore(checkpoint_);
+}
+
+void ReplayableCommand::dropCheckpoint()
+{
+    checkpoint_ = TileBuffer();
+    swapped_.reset();
+    hasCheckpoint_ = false;
+}
+
+bool ReplayableCommand::rebaseOnto(const ReplayableCommand& previous)
+{
+    if (!previous.hasCheckpoint_ || !previous.loadCheckpoint()) {
+        return false;
+    }
+
+    // The scratch layer starts from the previous checkpoint's tiles, so the
+    // snapshot taken after the replay shares every tile it left untouched
+    Layer scratch(previous.width_, previous.height_, previous.format_);
+    if (!scratch.restore(previous.checkpoint_)) {
+        return false;
+    }
+    previous.replay(scratch);
+
+    checkpoint_ = scratch.snapshot();
+    swapped_.reset();
+    width_ = previous.width_;
+    height_ = previous.height_;
+    format_ = previous.format_;
+    hasCheckpoint_ = true;
+    captured_ = true;
+    return true;
+}
+
+bool ReplayableCommand::loadCheckpoint() const
+{
+    if (swapped_.empty()) {
+        return true;
+    }
+    if (!swapped_.load(checkpoint_)) {
+        return false;
+    }
+    swapped_.reset();
+    return true;
+}
+
+}  // namespace gimp
@@ -57,6 +57,31 @@ void CanvasResizeCommand::undo()
     restoreSelection(beforeSelection_, beforeSelectionType_, "undo");
 }
 
+std::size_t CanvasResizeCommand::byteSize() const
+{
+    std::size_t bytes = 0;
+    for (const auto& snapshot : beforeLayers_) {
+        bytes += snapshot.tiles.exclusiveByteSize() + snapshot.swapped.residentByteSize();
+    }
+    return bytes;
+}
+
+bool CanvasResizeCommand::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    bool spilledAll = !beforeLayers_.empty();
+    for (auto& snapshot : beforeLayers_) {
+        if (!snapshot.swapped.empty()) {
+            continue;
+        }
+        if (snapshot.swapped.store(swap, snapshot.tiles)) {
+            snapshot.tiles = TileBuffer();
+        } else {
+            spilledAll = false;
+        }
+    }
+    return spilledAll;
+}
+
 void CanvasResizeCommand::captureBeforeState()
 {
     if (!document_) {
@@ -76,7 +101,7 @@ void CanvasResizeCommand::captureBeforeState()
 
         LayerSnapshot snapshot;
         snapshot.layer = layer;
-        snapshot.data = layer->data();
+        snapshot.tiles = layer->snapshot();
         beforeLayers_.push_back(std::move(snapshot));
     }
 
@@ -94,7 +119,11 @@ void CanvasResizeCommand::restoreBeforeLayers()
             continue;
         }
 
-        snapshot.layer->data() = snapshot.data;
+        if (!snapshot.swapped.empty() && snapshot.swapped.load(snapshot.tiles)) {
+            snapshot.swapped.reset();
+        }
+
+        snapshot.layer->restore(snapshot.tiles);
     }
 }
 
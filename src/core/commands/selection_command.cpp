@@ -31,6 +31,17 @@ void SelectionCommand::captureAfterState()
     afterType_ = SelectionManager::instance().selectionType();
 }
 
+bool SelectionCommand::mergeWith(Command& next)
+{
+    const auto* selection = dynamic_cast<const SelectionCommand*>(&next);
+    if (selection == nullptr || selection == this) {
+        return false;
+    }
+    afterPath_ = selection->afterPath_;
+    afterType_ = selection->afterType_;
+    return true;
+}
+
 void SelectionCommand::apply()
 {
     // Restore the after state
@@ -0,0 +1,139 @@
+/**
+ * @file compressed_buffer.cpp
+ * @brief Implementation of CompressedBuffer.
+ * @author Laurent Jiang
+ * @date 2026-02-21
+ */
+
+#include "core/compressed_buffer.h"
+
+#include <cstring>
+#include <utility>
+
+#include <lz4.h>
+
+namespace gimp {
+
+namespace {
+
+/// XORs src into dst; both spans hold size bytes.
+void xorBytes(std::uint8_t* dst, const std::uint8_t* src, std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i) {
+        dst[i] ^= src[i];
+    }
+}
+
+}  // namespace
+
+CompressedBuffer CompressedBuffer::compress(const std::vector<std::uint8_t>& data)
+{
+    CompressedBuffer buffer;
+    if (data.empty()) {
+        return buffer;
+    }
+    buffer.m_rawSize = data.size();
+
+    if (data.size() > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE)) {
+        buffer.m_data.assign(data.begin(), data.end());
+        buffer.m_stored = true;
+        return buffer;
+    }
+
+    const int srcSize = static_cast<int>(data.size());
+    buffer.m_data.resize(static_cast<std::size_t>(LZ4_compressBound(srcSize)));
+    const int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(data.data()),
+                                                    buffer.m_data.data(),
+                                                    srcSize,
+                                                    static_cast<int>(buffer.m_data.size()));
+    if (compressedSize <= 0) {
+        buffer.m_data.assign(data.begin(), data.end());
+        buffer.m_stored = true;
+        return buffer;
+    }
+
+    buffer.m_data.resize(static_cast<std::size_t>(compressedSize));
+    buffer.m_data.shrink_to_fit();
+    return buffer;
+}
+
+CompressedBuffer CompressedBuffer::compressDelta(const std::vector<std::uint8_t>& base,
+                                                 const std::vector<std::uint8_t>& target)
+{
+    if (base.size() != target.size()) {
+        return {};
+    }
+
+    std::vector<std::uint8_t> delta = target;
+    xorBytes(delta.data(), base.data(), delta.size());
+    return compress(delta);
+}
+
+bool CompressedBuffer::decompress(std::vector<std::uint8_t>& out) const
+{
+    if (empty() || spilled()) {
+        return false;
+    }
+
+    out.resize(m_rawSize);
+    if (m_stored) {
+        std::memcpy(out.data(), m_data.data(), m_rawSize);
+        return true;
+    }
+
+    const int decompressedSize = LZ4_decompress_safe(m_data.data(),
+                                                     reinterpret_cast<char*>(out.data()),
+                                                     static_cast<int>(m_data.size()),
+                                                     static_cast<int>(m_rawSize));
+    return decompressedSize == static_cast<int>(m_rawSize);
+}
+
+bool CompressedBuffer::spill(const std::shared_ptr<UndoSwapFile>& swap)
+{
+    if (spilled()) {
+        return true;
+    }
+    if (m_data.empty()) {
+        return false;
+    }
+
+    if (!m_spilled.allocate(swap, m_data.size()) ||
+        !m_spilled.write(0, m_data.data(), m_data.size())) {
+        m_spilled.reset();
+        return false;
+    }
+    m_data.clear();
+    m_data.shrink_to_fit();
+    return true;
+}
+
+bool CompressedBuffer::load()
+{
+    if (!spilled()) {
+        return true;
+    }
+
+    std::vector<char> data(static_cast<std::size_t>(m_spilled.size()));
+    if (!m_spilled.read(0, data.data(), data.size())) {
+        return false;
+    }
+    m_data = std::move(data);
+    m_spilled.reset();
+    return true;
+}
+
+bool CompressedBuffer::applyDelta(std::vector<std::uint8_t>& data) const
+{
+    if (data.size() != m_rawSize) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> delta;
+    if (!decompress(delta)) {
+        return false;
+    }
+    xorBytes(data.data(), delta.data(), data.size());
+    return true;
+}
+
+}  // namespace gimp
@@ -0,0 +1,154 @@
+/**
+ * @file dab_kernels.cpp
+ * @brief Portable dab kernels and SIMD dispatch.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ */
+
+#include "core/dab_kernels.h"
+
+#include "core/pixel_format.h"
+
+#include <algorithm>
+
+namespace gimp {
+
+namespace {
+
+/**
+ * @brief Blends a source color over a destination with alpha.
+ * @param dst Pointer to destination pixel (RGBA).
+ * @param sr Source red.
+ * @param sg Source green.
+ * @param sb Source blue.
+ * @param sa Source alpha.
+ */
+void blendPixel(std::uint8_t* dst,
+                std::uint8_t sr,
+                std::uint8_t sg,
+                std::uint8_t sb,
+                std::uint8_t sa)
+{
+    if (sa == 0) {
+        return;
+    }
+
+    std::uint8_t dr = dst[0];
+    std::uint8_t dg = dst[1];
+    std::uint8_t db = dst[2];
+    std::uint8_t da = dst[3];
+
+    if (sa == 255 || da == 0) {
+        dst[0] = sr;
+        dst[1] = sg;
+        dst[2] = sb;
+        dst[3] = sa;
+        return;
+    }
+
+    // Porter-Duff "over" compositing
+    float srcA = static_cast<float>(sa) / 255.0F;
+    float dstA = static_cast<float>(da) / 255.0F;
+    float outA = srcA + dstA * (1.0F - srcA);
+
+    if (outA > 0.0F) {
+        dst[0] = static_cast<std::uint8_t>(
+            (static_cast<float>(sr) * srcA + static_cast<float>(dr) * dstA * (1.0F - srcA)) / outA);
+        dst[1] = static_cast<std::uint8_t>(
+            (static_cast<float>(sg) * srcA + static_cast<float>(dg) * dstA * (1.0F - srcA)) / outA);
+        dst[2] = static_cast<std::uint8_t>(
+            (static_cast<float>(sb) * srcA + static_cast<float>(db) * dstA * (1.0F - srcA)) / outA);
+        dst[3] = static_cast<std::uint8_t>(outA * 255.0F);
+    }
+}
+
+/**
+ * @brief Blends a source color over a premultiplied destination.
+ *
+ * With premultiplied storage "over" is a single multiply-add per channel.
+ * Channels wrap like the 8-bit stores they end up in; the SIMD kernels
+ * mask to match.
+ */
+void blendPixelPremultiplied(std::uint8_t* dst,
+                             std::uint8_t sr,
+                             std::uint8_t sg,
+                             std::uint8_t sb,
+                             std::uint8_t sa)
+{
+    const std::uint32_t inv = 255U - sa;
+    dst[0] = static_cast<std::uint8_t>(mulDiv255(sr, sa) + mulDiv255(dst[0], inv));
+    dst[1] = static_cast<std::uint8_t>(mulDiv255(sg, sa) + mulDiv255(dst[1], inv));
+    dst[2] = static_cast<std::uint8_t>(mulDiv255(sb, sa) + mulDiv255(dst[2], inv));
+    dst[3] = static_cast<std::uint8_t>(sa + mulDiv255(dst[3], inv));
+}
+
+template <DabOp Op>
+void dabRowScalar(std::uint8_t* dst,
+                  const float* coverage,
+                  int count,
+                  std::uint32_t color,
+                  float scale)
+{
+    const auto r = static_cast<std::uint8_t>((color >> 24) & 0xFFU);
+    const auto g = static_cast<std::uint8_t>((color >> 16) & 0xFFU);
+    const auto b = static_cast<std::uint8_t>((color >> 8) & 0xFFU);
+
+    for (int i = 0; i < count; ++i, dst += 4) {
+        if (coverage[i] <= 0.0F) {
+            continue;
+        }
+        const float strength = scale * coverage[i];
+        if constexpr (Op == DabOp::Paint) {
+            blendPixel(dst, r, g, b, static_cast<std::uint8_t>(strength));
+        } else if constexpr (Op == DabOp::PaintPremultiplied) {
+            blendPixelPremultiplied(dst, r, g, b, static_cast<std::uint8_t>(strength));
+        } else if constexpr (Op == DabOp::Erase) {
+            const float alpha = std::max(0.0F, static_cast<float>(dst[3]) * (1.0F - strength));
+            dst[3] = ChannelTraits<std::uint8_t>::store(alpha);
+        } else {
+            // Premultiplied color scales with alpha
+            const auto keep = static_cast<std::uint32_t>(
+                std::clamp(1.0F - strength, 0.0F, 1.0F) * 255.0F + 0.5F);
+            for (int c = 0; c < 4; ++c) {
+                dst[c] = static_cast<std::uint8_t>(mulDiv255(dst[c], keep));
+            }
+        }
+    }
+}
+
+}  // namespace
+
+DabRowFn dabRowKernel(DabOp op, SimdLevel level)
+{
+    level = supportedSimdLevel(level);
+
+    DabRowFn kernel = nullptr;
+    if (level == SimdLevel::Avx2) {
+        kernel = detail::avx2DabRow(op);
+    }
+    if (!kernel && level != SimdLevel::Scalar) {
+        kernel = detail::sse41DabRow(op);
+    }
+    return kernel ? kernel : detail::scalarDabRow(op);
+}
+
+namespace detail {
+
+DabRowFn scalarDabRow(DabOp op)
+{
+    switch (op) {
+        case DabOp::Paint:
+            return &dabRowScalar<DabOp::Paint>;
+        case DabOp::PaintPremultiplied:
+            return &dabRowScalar<DabOp::PaintPremultiplied>;
+        case DabOp::Erase:
+            return &dabRowScalar<DabOp::Erase>;
+        case DabOp::ErasePremultiplied:
+            return &dabRowScalar<DabOp::ErasePremultiplied>;
+    }
+    return &dabRowScalar<DabOp::Paint>;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
@@ -0,0 +1,283 @@
+/**
+ * @file dab_kernels_avx2.cpp
+ * @brief AVX2 dab kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ *
+ * Built with AVX2 code generation enabled; see blend_kernels_sse41.cpp for
+ * why only functions defined in this file are called from here. Mirrors
+ * dab_kernels_sse41.cpp eight pixels at a time.
+ */
+
+#include "core/dab_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace gimp {
+
+namespace {
+
+/// round(a * b / 255) per 16-bit lane, identical to gimp::mulDiv255.
+inline __m256i mulDiv255(__m256i a, __m256i b)
+{
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+/// Extracts channel c of eight RGBA8 pixels as floats.
+inline __m256 channel(__m256i pixels, int c)
+{
+    const __m256i value = _mm256_and_si256(_mm256_srl_epi32(pixels, _mm_cvtsi32_si128(8 * c)),
+                                        _mm256_set1_epi32(0xFF));
+    return _mm256_cvtepi32_ps(value);
+}
+
+/// Truncates eight floats to bytes and moves them to channel c.
+inline __m256i toChannel(__m256 value, int c)
+{
+    const __m256i bytes = _mm256_and_si256(_mm256_cvttps_epi32(value), _mm256_set1_epi32(0xFF));
+    return _mm256_sll_epi32(bytes, _mm_cvtsi32_si128(8 * c));
+}
+
+/// Widens the first four RGBA8 pixels to 16-bit lanes.
+inline __m256i widenLow(__m256i pixels)
+{
+    return _mm256_cvtepu8_epi16(_mm256_castsi256_si128(pixels));
+}
+
+/// Widens the last four RGBA8 pixels to 16-bit lanes.
+inline __m256i widenHigh(__m256i pixels)
+{
+    return _mm256_cvtepu8_epi16(_mm256_extracti128_si256(pixels, 1));
+}
+
+/// Widens eight 8-bit values in 32-bit lanes to a 16-bit lane per channel.
+inline void spreadToChannels(__m256i value, __m256i& lo, __m256i& hi)
+{
+    const __m256i bytes = _mm256_mullo_epi32(value, _mm256_set1_epi32(0x01010101));
+    lo = widenLow(bytes);
+    hi = widenHigh(bytes);
+}
+
+/// Packs the 16-bit lanes of eight pixels back to RGBA8 in pixel order.
+inline __m256i packPixels(__m256i lo, __m256i hi)
+{
+    // packus works within 128-bit lanes; restore pixel order afterwards
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+void paintRowAvx2(std::uint8_t* dst,
+                  const float* coverage,
+                  int count,
+                  std::uint32_t color,
+                  float scale)
+{
+    const __m256 c255 = _mm256_set1_ps(255.0F);
+    const __m256 one = _mm256_set1_ps(1.0F);
+    const __m256 factor = _mm256_set1_ps(scale);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 source[3] = {_mm256_set1_ps(static_cast<float>((color >> 24) & 0xFFU)),
+                              _mm256_set1_ps(static_cast<float>((color >> 16) & 0xFFU)),
+                              _mm256_set1_ps(static_cast<float>((color >> 8) & 0xFFU))};
+    // Source color in memory order with a zero alpha byte
+    const __m256i rgb = _mm256_set1_epi32(static_cast<int>(
+        ((color >> 24) & 0xFFU) | ((color >> 8) & 0xFF00U) | ((color << 8) & 0xFF0000U)));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 cov = _mm256_loadu_ps(coverage + i);
+        const __m256i sa = _mm256_cvttps_epi32(_mm256_mul_ps(factor, cov));
+        if (_mm256_testz_si256(sa, sa)) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m256i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m256i d = _mm256_loadu_si256(out);
+        const __m256i da = _mm256_srli_epi32(d, 24);
+
+        const __m256 srcA = _mm256_div_ps(_mm256_cvtepi32_ps(sa), c255);
+        const __m256 dstA = _mm256_div_ps(_mm256_cvtepi32_ps(da), c255);
+        const __m256 inv = _mm256_sub_ps(one, srcA);
+        const __m256 outA = _mm256_add_ps(srcA, _mm256_mul_ps(dstA, inv));
+
+        __m256i blended = _mm256_slli_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(outA, c255)), 24);
+        for (int c = 0; c < 3; ++c) {
+            const __m256 own = _mm256_mul_ps(_mm256_mul_ps(channel(d, c), dstA), inv);
+            const __m256 mixed = _mm256_add_ps(_mm256_mul_ps(source[c], srcA), own);
+            blended = _mm256_or_si256(blended, toChannel(_mm256_div_ps(mixed, outA), c));
+        }
+
+        // Opaque dabs and empty pixels take the source as is; zero alpha keeps the pixel
+        const __m256i copy = _mm256_or_si256(
+            _mm256_cmpeq_epi32(sa, _mm256_set1_epi32(255)), _mm256_cmpeq_epi32(da, zero));
+        const __m256i opaque = _mm256_or_si256(rgb, _mm256_slli_epi32(sa, 24));
+        __m256i result = _mm256_blendv_epi8(blended, opaque, copy);
+        result = _mm256_blendv_epi8(result, d, _mm256_cmpeq_epi32(sa, zero));
+        _mm256_storeu_si256(out, result);
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::Paint)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void paintPremultipliedRowAvx2(std::uint8_t* dst,
+                               const float* coverage,
+                               int count,
+                               std::uint32_t color,
+                               float scale)
+{
+    const __m256 factor = _mm256_set1_ps(scale);
+    const __m256i c255 = _mm256_set1_epi16(255);
+    const __m256i byteMask = _mm256_set1_epi16(0xFF);
+    // Alpha 255 makes the alpha lane sa + mulDiv255(da, 255 - sa) like the other lanes
+    const auto r = static_cast<short>((color >> 24) & 0xFFU);
+    const auto g = static_cast<short>((color >> 16) & 0xFFU);
+    const auto b = static_cast<short>((color >> 8) & 0xFFU);
+    const __m256i source =
+        _mm256_setr_epi16(r, g, b, 255, r, g, b, 255, r, g, b, 255, r, g, b, 255);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i sa =
+            _mm256_cvttps_epi32(_mm256_mul_ps(factor, _mm256_loadu_ps(coverage + i)));
+        if (_mm256_testz_si256(sa, sa)) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m256i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m256i d = _mm256_loadu_si256(out);
+
+        __m256i saLo;
+        __m256i saHi;
+        spreadToChannels(sa, saLo, saHi);
+        const __m256i dLo = widenLow(d);
+        const __m256i dHi = widenHigh(d);
+        // Mask before packing: the scalar kernel wraps, packus would saturate
+        const __m256i lo = _mm256_and_si256(
+            _mm256_add_epi16(mulDiv255(source, saLo), mulDiv255(dLo, _mm256_sub_epi16(c255, saLo))),
+            byteMask);
+        const __m256i hi = _mm256_and_si256(
+            _mm256_add_epi16(mulDiv255(source, saHi), mulDiv255(dHi, _mm256_sub_epi16(c255, saHi))),
+            byteMask);
+        _mm256_storeu_si256(out, packPixels(lo, hi));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::PaintPremultiplied)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void eraseRowAvx2(std::uint8_t* dst,
+                  const float* coverage,
+                  int count,
+                  std::uint32_t color,
+                  float scale)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0F);
+    const __m256 c255 = _mm256_set1_ps(255.0F);
+    const __m256 factor = _mm256_set1_ps(scale);
+    const __m256i colorMask = _mm256_set1_epi32(0x00FFFFFF);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 cov = _mm256_loadu_ps(coverage + i);
+        const __m256 skip = _mm256_cmp_ps(cov, zero, _CMP_LE_OQ);
+        if (_mm256_movemask_ps(skip) == 0xFF) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m256i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m256i d = _mm256_loadu_si256(out);
+
+        const __m256 keep = _mm256_sub_ps(one, _mm256_mul_ps(factor, cov));
+        const __m256 alpha = _mm256_cvtepi32_ps(_mm256_srli_epi32(d, 24));
+        const __m256 scaled = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(alpha, keep), zero), c255);
+        const __m256i erased = _mm256_slli_epi32(_mm256_cvttps_epi32(scaled), 24);
+        const __m256i result = _mm256_or_si256(_mm256_and_si256(d, colorMask), erased);
+        _mm256_storeu_si256(out, _mm256_blendv_epi8(result, d, _mm256_castps_si256(skip)));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::Erase)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void erasePremultipliedRowAvx2(std::uint8_t* dst,
+                               const float* coverage,
+                               int count,
+                               std::uint32_t color,
+                               float scale)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0F);
+    const __m256 c255 = _mm256_set1_ps(255.0F);
+    const __m256 half = _mm256_set1_ps(0.5F);
+    const __m256 factor = _mm256_set1_ps(scale);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Zero coverage keeps 255, which leaves the pixel unchanged
+        const __m256 cov = _mm256_loadu_ps(coverage + i);
+        if (_mm256_movemask_ps(_mm256_cmp_ps(cov, zero, _CMP_LE_OQ)) == 0xFF) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m256i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m256i d = _mm256_loadu_si256(out);
+
+        const __m256 keep = _mm256_min_ps(
+            _mm256_max_ps(_mm256_sub_ps(one, _mm256_mul_ps(factor, cov)), zero), one);
+        __m256i keepLo;
+        __m256i keepHi;
+        spreadToChannels(_mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(keep, c255), half)),
+                         keepLo,
+                         keepHi);
+        const __m256i lo = mulDiv255(widenLow(d), keepLo);
+        const __m256i hi = mulDiv255(widenHigh(d), keepHi);
+        _mm256_storeu_si256(out, packPixels(lo, hi));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::ErasePremultiplied)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+}  // namespace
+
+namespace detail {
+
+DabRowFn avx2DabRow(DabOp op)
+{
+    switch (op) {
+        case DabOp::Paint:
+            return &paintRowAvx2;
+        case DabOp::PaintPremultiplied:
+            return &paintPremultipliedRowAvx2;
+        case DabOp::Erase:
+            return &eraseRowAvx2;
+        case DabOp::ErasePremultiplied:
+            return &erasePremultipliedRowAvx2;
+    }
+    return nullptr;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
+
+#else
+
+namespace gimp::detail {
+
+DabRowFn avx2DabRow(DabOp /*op*/)
+{
+    return nullptr;
+}
+
+}  // namespace gimp::detail
+
+#endif
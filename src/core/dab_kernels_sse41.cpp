@@ -0,0 +1,264 @@
+/**
+ * @file dab_kernels_sse41.cpp
+ * @brief SSE4.1 dab kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ *
+ * Built with SSE4.1 code generation enabled; see blend_kernels_sse41.cpp for
+ * why only functions defined in this file are called from here.
+ *
+ * The straight-alpha kernels repeat the float operations of the scalar
+ * kernels in the same order, four pixels at a time, so they round the same
+ * way and produce the same bytes.
+ */
+
+#include "core/dab_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace gimp {
+
+namespace {
+
+/// round(a * b / 255) per 16-bit lane, identical to gimp::mulDiv255.
+inline __m128i mulDiv255(__m128i a, __m128i b)
+{
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/// Extracts channel c of four RGBA8 pixels as floats.
+inline __m128 channel(__m128i pixels, int c)
+{
+    const __m128i value = _mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(8 * c)),
+                                        _mm_set1_epi32(0xFF));
+    return _mm_cvtepi32_ps(value);
+}
+
+/// Truncates four floats to bytes and moves them to channel c.
+inline __m128i toChannel(__m128 value, int c)
+{
+    const __m128i bytes = _mm_and_si128(_mm_cvttps_epi32(value), _mm_set1_epi32(0xFF));
+    return _mm_sll_epi32(bytes, _mm_cvtsi32_si128(8 * c));
+}
+
+/// Widens four 8-bit values in 32-bit lanes to a 16-bit lane per channel.
+inline void spreadToChannels(__m128i value, __m128i& lo, __m128i& hi)
+{
+    const __m128i bytes = _mm_mullo_epi32(value, _mm_set1_epi32(0x01010101));
+    lo = _mm_cvtepu8_epi16(bytes);
+    hi = _mm_unpackhi_epi8(bytes, _mm_setzero_si128());
+}
+
+void paintRowSse41(std::uint8_t* dst,
+                   const float* coverage,
+                   int count,
+                   std::uint32_t color,
+                   float scale)
+{
+    const __m128 c255 = _mm_set1_ps(255.0F);
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 source[3] = {_mm_set1_ps(static_cast<float>((color >> 24) & 0xFFU)),
+                              _mm_set1_ps(static_cast<float>((color >> 16) & 0xFFU)),
+                              _mm_set1_ps(static_cast<float>((color >> 8) & 0xFFU))};
+    // Source color in memory order with a zero alpha byte
+    const __m128i rgb = _mm_set1_epi32(static_cast<int>(
+        ((color >> 24) & 0xFFU) | ((color >> 8) & 0xFF00U) | ((color << 8) & 0xFF0000U)));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 cov = _mm_loadu_ps(coverage + i);
+        const __m128i sa = _mm_cvttps_epi32(_mm_mul_ps(factor, cov));
+        if (_mm_testz_si128(sa, sa)) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m128i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m128i d = _mm_loadu_si128(out);
+        const __m128i da = _mm_srli_epi32(d, 24);
+
+        const __m128 srcA = _mm_div_ps(_mm_cvtepi32_ps(sa), c255);
+        const __m128 dstA = _mm_div_ps(_mm_cvtepi32_ps(da), c255);
+        const __m128 inv = _mm_sub_ps(one, srcA);
+        const __m128 outA = _mm_add_ps(srcA, _mm_mul_ps(dstA, inv));
+
+        __m128i blended = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(outA, c255)), 24);
+        for (int c = 0; c < 3; ++c) {
+            const __m128 own = _mm_mul_ps(_mm_mul_ps(channel(d, c), dstA), inv);
+            const __m128 mixed = _mm_add_ps(_mm_mul_ps(source[c], srcA), own);
+            blended = _mm_or_si128(blended, toChannel(_mm_div_ps(mixed, outA), c));
+        }
+
+        // Opaque dabs and empty pixels take the source as is; zero alpha keeps the pixel
+        const __m128i copy = _mm_or_si128(
+            _mm_cmpeq_epi32(sa, _mm_set1_epi32(255)), _mm_cmpeq_epi32(da, zero));
+        const __m128i opaque = _mm_or_si128(rgb, _mm_slli_epi32(sa, 24));
+        __m128i result = _mm_blendv_epi8(blended, opaque, copy);
+        result = _mm_blendv_epi8(result, d, _mm_cmpeq_epi32(sa, zero));
+        _mm_storeu_si128(out, result);
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::Paint)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void paintPremultipliedRowSse41(std::uint8_t* dst,
+                                const float* coverage,
+                                int count,
+                                std::uint32_t color,
+                                float scale)
+{
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i byteMask = _mm_set1_epi16(0xFF);
+    // Alpha 255 makes the alpha lane sa + mulDiv255(da, 255 - sa) like the other lanes
+    const auto r = static_cast<short>((color >> 24) & 0xFFU);
+    const auto g = static_cast<short>((color >> 16) & 0xFFU);
+    const auto b = static_cast<short>((color >> 8) & 0xFFU);
+    const __m128i source = _mm_setr_epi16(r, g, b, 255, r, g, b, 255);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i sa = _mm_cvttps_epi32(_mm_mul_ps(factor, _mm_loadu_ps(coverage + i)));
+        if (_mm_testz_si128(sa, sa)) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m128i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m128i d = _mm_loadu_si128(out);
+
+        __m128i saLo;
+        __m128i saHi;
+        spreadToChannels(sa, saLo, saHi);
+        const __m128i dLo = _mm_cvtepu8_epi16(d);
+        const __m128i dHi = _mm_unpackhi_epi8(d, _mm_setzero_si128());
+        // Mask before packing: the scalar kernel wraps, packus would saturate
+        const __m128i lo = _mm_and_si128(
+            _mm_add_epi16(mulDiv255(source, saLo), mulDiv255(dLo, _mm_sub_epi16(c255, saLo))),
+            byteMask);
+        const __m128i hi = _mm_and_si128(
+            _mm_add_epi16(mulDiv255(source, saHi), mulDiv255(dHi, _mm_sub_epi16(c255, saHi))),
+            byteMask);
+        _mm_storeu_si128(out, _mm_packus_epi16(lo, hi));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::PaintPremultiplied)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void eraseRowSse41(std::uint8_t* dst,
+                   const float* coverage,
+                   int count,
+                   std::uint32_t color,
+                   float scale)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 c255 = _mm_set1_ps(255.0F);
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 cov = _mm_loadu_ps(coverage + i);
+        const __m128 skip = _mm_cmple_ps(cov, zero);
+        if (_mm_movemask_ps(skip) == 0xF) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m128i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m128i d = _mm_loadu_si128(out);
+
+        const __m128 keep = _mm_sub_ps(one, _mm_mul_ps(factor, cov));
+        const __m128 alpha = _mm_cvtepi32_ps(_mm_srli_epi32(d, 24));
+        const __m128 scaled = _mm_min_ps(_mm_max_ps(_mm_mul_ps(alpha, keep), zero), c255);
+        const __m128i erased = _mm_slli_epi32(_mm_cvttps_epi32(scaled), 24);
+        const __m128i result = _mm_or_si128(_mm_and_si128(d, colorMask), erased);
+        _mm_storeu_si128(out, _mm_blendv_epi8(result, d, _mm_castps_si128(skip)));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::Erase)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+void erasePremultipliedRowSse41(std::uint8_t* dst,
+                                const float* coverage,
+                                int count,
+                                std::uint32_t color,
+                                float scale)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0F);
+    const __m128 c255 = _mm_set1_ps(255.0F);
+    const __m128 half = _mm_set1_ps(0.5F);
+    const __m128 factor = _mm_set1_ps(scale);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Zero coverage keeps 255, which leaves the pixel unchanged
+        const __m128 cov = _mm_loadu_ps(coverage + i);
+        if (_mm_movemask_ps(_mm_cmple_ps(cov, zero)) == 0xF) {
+            continue;
+        }
+        auto* out = reinterpret_cast<__m128i*>(dst + static_cast<std::size_t>(i) * 4U);
+        const __m128i d = _mm_loadu_si128(out);
+
+        const __m128 keep = _mm_min_ps(_mm_max_ps(_mm_sub_ps(one, _mm_mul_ps(factor, cov)), zero),
+                                       one);
+        __m128i keepLo;
+        __m128i keepHi;
+        spreadToChannels(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(keep, c255), half)), keepLo,
+                         keepHi);
+        const __m128i lo = mulDiv255(_mm_cvtepu8_epi16(d), keepLo);
+        const __m128i hi = mulDiv255(_mm_unpackhi_epi8(d, _mm_setzero_si128()), keepHi);
+        _mm_storeu_si128(out, _mm_packus_epi16(lo, hi));
+    }
+
+    if (i < count) {
+        detail::scalarDabRow(DabOp::ErasePremultiplied)(
+            dst + static_cast<std::size_t>(i) * 4U, coverage + i, count - i, color, scale);
+    }
+}
+
+}  // namespace
+
+namespace detail {
+
+DabRowFn sse41DabRow(DabOp op)
+{
+    switch (op) {
+        case DabOp::Paint:
+            return &paintRowSse41;
+        case DabOp::PaintPremultiplied:
+            return &paintPremultipliedRowSse41;
+        case DabOp::Erase:
+            return &eraseRowSse41;
+        case DabOp::ErasePremultiplied:
+            return &erasePremultipliedRowSse41;
+    }
+    return nullptr;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
+
+#else
+
+namespace gimp::detail {
+
+DabRowFn sse41DabRow(DabOp /*op*/)
+{
+    return nullptr;
+}
+
+}  // namespace gimp::detail
+
+#endif
@@ -0,0 +1,283 @@
+/**
+ * @file dab_mask_cache.cpp
+ * @brief Implementation of DabMaskCache.
+ * @author Laurent Jiang
+ * @date 2026-02-27
+ */
+
+#include "core/dab_mask_cache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace gimp {
+
+namespace {
+
+/**
+ * @brief GIMP-style piecewise falloff function (not true Gaussian).
+ *
+ * This produces a smoother, more natural brush edge than a simple Gaussian.
+ * @param f Normalized distance value.
+ * @return Falloff intensity.
+ */
+float gimpGauss(float f)
+{
+    if (f < -0.5F) {
+        f = -1.0F - f;
+        return 2.0F * f * f;
+    }
+    if (f < 0.5F) {
+        return 1.0F - 2.0F * f * f;
+    }
+    f = 1.0F - f;
+    return 2.0F * f * f;
+}
+
+/**
+ * @brief Quantizes a sub-pixel offset to a step index.
+ * @param offset Offset in [0, 1).
+ * @return Step in [0, kSubpixelSteps).
+ */
+int quantizeOffset(float offset)
+{
+    const auto step = static_cast<int>(std::floor(offset * DabMaskCache::kSubpixelSteps));
+    return std::clamp(step, 0, DabMaskCache::kSubpixelSteps - 1);
+}
+
+/**
+ * @brief Allocates a mask covering a circle around a shifted center.
+ * @param radius Circle radius in pixels.
+ * @param cx Horizontal center offset in pixels.
+ * @param cy Vertical center offset in pixels.
+ */
+std::shared_ptr<DabMask> allocateMask(float radius, float cx, float cy)
+{
+    auto mask = std::make_shared<DabMask>();
+    mask->left = static_cast<int>(std::floor(cx - radius));
+    mask->top = static_cast<int>(std::floor(cy - radius));
+    mask->width = static_cast<int>(std::ceil(cx + radius)) - mask->left + 1;
+    mask->height = static_cast<int>(std::ceil(cy + radius)) - mask->top + 1;
+    mask->coverage.assign(
+        static_cast<std::size_t>(mask->width) * static_cast<std::size_t>(mask->height), 0.0F);
+    return mask;
+}
+
+/**
+ * @brief Builds the mask of a hard-edged circular dab.
+ */
+std::shared_ptr<const DabMask> buildSolid(int size, float cx, float cy)
+{
+    const int radius = size / 2;
+    const auto radiusSq = static_cast<float>(radius * radius);
+    auto mask = allocateMask(static_cast<float>(radius), cx, cy);
+    for (int j = 0; j < mask->height; ++j) {
+        const float dy = static_cast<float>(mask->top + j) - cy;
+        float* row = mask->coverage.data() + static_cast<std::size_t>(j) * mask->width;
+        for (int i = 0; i < mask->width; ++i) {
+            const float dx = static_cast<float>(mask->left + i) - cx;
+            if (dx * dx + dy * dy <= radiusSq) {
+                row[i] = 1.0F;
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Builds the mask of a dab with GIMP-style falloff.
+ */
+std::shared_ptr<const DabMask> buildSoft(int size, float hardness, float cx, float cy)
+{
+    const float radius = std::max(static_cast<float>(size) / 2.0F, 0.5F);
+
+    // GIMP-style exponent from hardness: harder = sharper falloff curve
+    // At hardness = 1.0: exponent approaches infinity (solid edge)
+    // At hardness = 0.0: exponent = 0.4 (maximum softness)
+    float exponent = 0.4F;
+    if ((1.0F - hardness) > 0.0001F) {
+        exponent = 0.4F / (1.0F - hardness);
+    } else {
+        exponent = 1000000.0F;
+    }
+
+    auto mask = allocateMask(radius, cx, cy);
+    for (int j = 0; j < mask->height; ++j) {
+        const float dy = static_cast<float>(mask->top + j) - cy;
+        float* row = mask->coverage.data() + static_cast<std::size_t>(j) * mask->width;
+        for (int i = 0; i < mask->width; ++i) {
+            const float dx = static_cast<float>(mask->left + i) - cx;
+            const float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist > radius) {
+                continue;
+            }
+            // GIMP-style falloff: gauss(pow(d / radius, exponent))
+            row[i] = gimpGauss(std::pow(dist / radius, exponent));
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Builds the mask of an eraser dab with a linear edge falloff.
+ */
+std::shared_ptr<const DabMask> buildEraser(int size, float hardness, float cx, float cy)
+{
+    const int radius = size / 2;
+    const auto radiusSq = static_cast<float>(radius * radius);
+    auto mask = allocateMask(static_cast<float>(radius), cx, cy);
+    for (int j = 0; j < mask->height; ++j) {
+        const float dy = static_cast<float>(mask->top + j) - cy;
+        float* row = mask->coverage.data() + static_cast<std::size_t>(j) * mask->width;
+        for (int i = 0; i < mask->width; ++i) {
+            const float dx = static_cast<float>(mask->left + i) - cx;
+            const float distSq = dx * dx + dy * dy;
+            if (distSq > radiusSq) {
+                continue;
+            }
+            const float dist = std::sqrt(distSq);
+            const float normalizedDist = (radius > 0) ? dist / static_cast<float>(radius) : 0.0F;
+
+            // hardness=1.0: hard edge (full strength until the edge)
+            // hardness=0.0: soft edge (linear falloff from center)
+            float edgeFalloff = 1.0F;
+            if (hardness < 1.0F && normalizedDist > hardness) {
+                edgeFalloff = 1.0F - (normalizedDist - hardness) / (1.0F - hardness + 0.001F);
+                edgeFalloff = std::max(0.0F, edgeFalloff);
+            }
+            row[i] = edgeFalloff;
+        }
+    }
+    return mask;
+}
+
+}  // namespace
+
+DabMaskCache& DabMaskCache::instance()
+{
+    static DabMaskCache cache;
+    return cache;
+}
+
+std::shared_ptr<const DabMask> DabMaskCache::solid(int size, float offsetX, float offsetY)
+{
+    const Key key{Shape::Solid, size, 0, quantizeOffset(offsetX), quantizeOffset(offsetY)};
+    return lookup(key, 0.0F);
+}
+
+std::shared_ptr<const DabMask> DabMaskCache::soft(int size,
+                                                  float hardness,
+                                                  float offsetX,
+                                                  float offsetY)
+{
+    const Key key{Shape::Soft,
+                  size,
+                  std::bit_cast<std::uint32_t>(hardness),
+                  quantizeOffset(offsetX),
+                  quantizeOffset(offsetY)};
+    return lookup(key, hardness);
+}
+
+std::shared_ptr<const DabMask> DabMaskCache::eraser(int size,
+                                                    float hardness,
+                                                    float offsetX,
+                                                    float offsetY)
+{
+    const Key key{Shape::Eraser,
+                  size,
+                  std::bit_cast<std::uint32_t>(hardness),
+                  quantizeOffset(offsetX),
+                  quantizeOffset(offsetY)};
+    return lookup(key, hardness);
+}
+
+void DabMaskCache::setByteBudget(std::size_t bytes)
+{
+    const std::scoped_lock lock(mutex_);
+    budget_ = bytes;
+    evict();
+}
+
+std::size_t DabMaskCache::byteSize() const
+{
+    const std::scoped_lock lock(mutex_);
+    return bytes_;
+}
+
+std::size_t DabMaskCache::count() const
+{
+    const std::scoped_lock lock(mutex_);
+    return lru_.size();
+}
+
+void DabMaskCache::clear()
+{
+    const std::scoped_lock lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+std::size_t DabMaskCache::KeyHash::operator()(const Key& key) const
+{
+    std::size_t hash = static_cast<std::size_t>(key.shape);
+    for (const std::size_t value : {static_cast<std::size_t>(key.size),
+                                    static_cast<std::size_t>(key.hardness),
+                                    static_cast<std::size_t>(key.subX),
+                                    static_cast<std::size_t>(key.subY)}) {
+        hash = hash * 1099511628211ULL ^ value;
+    }
+    return hash;
+}
+
+std::shared_ptr<const DabMask> DabMaskCache::lookup(const Key& key, float hardness)
+{
+    {
+        const std::scoped_lock lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return it->second->mask;
+        }
+    }
+
+    // Build outside the lock; two threads missing the same key both build it
+    const float cx = static_cast<float>(key.subX) / kSubpixelSteps;
+    const float cy = static_cast<float>(key.subY) / kSubpixelSteps;
+    std::shared_ptr<const DabMask> mask;
+    switch (key.shape) {
+        case Shape::Solid:
+            mask = buildSolid(key.size, cx, cy);
+            break;
+        case Shape::Soft:
+            mask = buildSoft(key.size, hardness, cx, cy);
+            break;
+        case Shape::Eraser:
+            mask = buildEraser(key.size, hardness, cx, cy);
+            break;
+    }
+
+    const std::scoped_lock lock(mutex_);
+    if (auto it = entries_.find(key); it != entries_.end()) {
+        return it->second->mask;
+    }
+    lru_.push_front({key, mask});
+    entries_.emplace(key, lru_.begin());
+    bytes_ += mask->coverage.size() * sizeof(float);
+    evict();
+    return mask;
+}
+
+void DabMaskCache::evict()
+{
+    // Keep the newest mask even if it alone exceeds the budget
+    while (bytes_ > budget_ && lru_.size() > 1) {
+        const Entry& oldest = lru_.back();
+        bytes_ -= oldest.mask->coverage.size() * sizeof(float);
+        entries_.erase(oldest.key);
+        lru_.pop_back();
+    }
+}
+
+}  // namespace gimp
@@ -0,0 +1,163 @@
+/**
+ * @file dab_rasterizer.cpp
+ * @brief Implementation of DabRasterizer.
+ * @author Laurent Jiang
+ * @date 2026-03-02
+ */
+
+#include "core/dab_rasterizer.h"
+
+#include "core/brush_strategy.h"
+#include "core/stroke_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <latch>
+#include <thread>
+
+namespace gimp {
+
+namespace {
+
+/// Fewest rows in a band, so that per-band overhead stays small.
+constexpr int kMinBandRows = 16;
+
+/// Bands per thread, so that a thread finishing early can take another.
+constexpr int kBandsPerLane = 4;
+
+/// Rows a dab can reach beyond its center row, including sub-pixel masks.
+int dabReach(int size)
+{
+    return size / 2 + 2;
+}
+
+}  // namespace
+
+DabRasterizer::DabRasterizer(std::size_t workerCount)
+{
+    if (workerCount > 0) {
+        executor_ = std::make_unique<CommandExecutor>(workerCount);
+    }
+}
+
+DabRasterizer& DabRasterizer::instance()
+{
+    static DabRasterizer rasterizer(
+        std::max(std::thread::hardware_concurrency(), 1U) - 1);
+    return rasterizer;
+}
+
+void DabRasterizer::render(BrushStrategy& brush,
+                           std::uint8_t* target,
+                           int targetWidth,
+                           int targetHeight,
+                           const std::vector<StrokeDab>& dabs,
+                           int size,
+                           std::uint32_t color)
+{
+    if (targetWidth <= 0) {
+        return;
+    }
+
+    const int reach = dabReach(size);
+    forEachBand(dabs, size, 0, targetHeight, [&](int firstRow, int endRow) {
+        for (const StrokeDab& dab : dabs) {
+            const int row = static_cast<int>(std::floor(dab.y));
+            if (row + reach < firstRow || row - reach >= endRow) {
+                continue;
+            }
+            brush.renderDabRows(target,
+                                targetWidth,
+                                targetHeight,
+                                dab.x,
+                                dab.y,
+                                size,
+                                color,
+                                dab.pressure,
+                                firstRow,
+                                endRow);
+        }
+    });
+}
+
+void DabRasterizer::accumulate(BrushStrategy& brush,
+                               StrokeBuffer& buffer,
+                               const std::vector<StrokeDab>& dabs,
+                               int size)
+{
+    const Rect& area = buffer.area();
+    if (area.w <= 0) {
+        return;
+    }
+
+    const int reach = dabReach(size);
+    forEachBand(dabs, size, area.y, area.y + area.h, [&](int firstRow, int endRow) {
+        for (const StrokeDab& dab : dabs) {
+            const int row = static_cast<int>(std::floor(dab.y));
+            if (row + reach < firstRow || row - reach >= endRow) {
+                continue;
+            }
+            brush.accumulateDabRows(buffer, dab.x, dab.y, size, dab.pressure, firstRow, endRow);
+        }
+    });
+}
+
+void DabRasterizer::forEachBand(const std::vector<StrokeDab>& dabs,
+                                int size,
+                                int minRow,
+                                int endRow,
+                                const std::function<void(int, int)>& band)
+{
+    if (dabs.empty() || minRow >= endRow) {
+        return;
+    }
+
+    const std::size_t area = dabs.size() * static_cast<std::size_t>(size) * size;
+    if (!executor_ || area < parallelThreshold_) {
+        band(minRow, endRow);
+        return;
+    }
+
+    // Rows touched by any dab, clipped to the target
+    float minY = dabs.front().y;
+    float maxY = minY;
+    for (const StrokeDab& dab : dabs) {
+        minY = std::min(minY, dab.y);
+        maxY = std::max(maxY, dab.y);
+    }
+    const int reach = dabReach(size);
+    const int first = std::max(static_cast<int>(std::floor(minY)) - reach, minRow);
+    const int end = std::min(static_cast<int>(std::floor(maxY)) + reach + 1, endRow);
+    if (first >= end) {
+        return;
+    }
+
+    const int rows = end - first;
+    const int lanes = static_cast<int>(executor_->threadCount()) + 1;
+    const int bandCount =
+        std::clamp((rows + kMinBandRows - 1) / kMinBandRows, 1, lanes * kBandsPerLane);
+    if (bandCount == 1) {
+        band(first, end);
+        return;
+    }
+
+    // Bands are disjoint, so they can run in any order; within a band the
+    // dabs keep their order and each pixel blends exactly as when serial.
+    // Each band is keyed by its own entry so the executor runs them in parallel.
+    std::vector<int> bandStarts(static_cast<std::size_t>(bandCount) + 1);
+    for (int i = 0; i <= bandCount; ++i) {
+        bandStarts[i] = first + rows * i / bandCount;
+    }
+
+    std::latch done(bandCount - 1);
+    for (int i = 1; i < bandCount; ++i) {
+        executor_->submit(&bandStarts[i], [&band, &done, &bandStarts, i] {
+            band(bandStarts[i], bandStarts[i + 1]);
+            done.count_down();
+        });
+    }
+    band(bandStarts[0], bandStarts[1]);
+    done.wait();
+}
+
+}  // namespace gimp
@@ -0,0 +1,185 @@
+/**
+ * @file dirty_tile_store.cpp
+ * @brief Implementation of DirtyTileStore.
+ * @author Laurent Jiang
+ * @date 2026-02-15
+ */
+
+#include "core/dirty_tile_store.h"
+
+#include <algorithm>
+
+namespace gimp {
+
+DirtyTileStore::DirtyTileStore(int width, int height)
+{
+    setSize(width, height);
+}
+
+void DirtyTileStore::setSize(int width, int height)
+{
+    m_width = std::max(0, width);
+    m_height = std::max(0, height);
+    m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+    m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+    m_composite.assign(static_cast<std::size_t>(m_tilesX) * static_cast<std::size_t>(m_tilesY),
+                       0);
+    m_layers.clear();
+    m_dirtyCount = 0;
+    m_full = true;
+}
+
+void DirtyTileStore::invalidate(const Rect& region)
+{
+    if (m_full) {
+        return;
+    }
+    m_dirtyCount += markTiles(m_composite, region);
+    if (static_cast<float>(m_dirtyCount) >
+        kFullRedrawRatio * static_cast<float>(m_composite.size())) {
+        m_full = true;
+    }
+}
+
+void DirtyTileStore::invalidateLayer(const Layer& layer, const Rect& region)
+{
+    if (m_full) {
+        return;
+    }
+    auto& bitmap = m_layers[&layer];
+    if (bitmap.size() != m_composite.size()) {
+        bitmap.assign(m_composite.size(), 0);
+    }
+    markTiles(bitmap, region);
+    invalidate(region);
+}
+
+void DirtyTileStore::invalidateAll()
+{
+    m_full = true;
+}
+
+bool DirtyTileStore::isFullyInvalid() const
+{
+    return m_full;
+}
+
+bool DirtyTileStore::hasDirtyRegions() const
+{
+    return m_full || m_dirtyCount > 0;
+}
+
+std::vector<Rect> DirtyTileStore::dirtyRects() const
+{
+    if (m_full) {
+        return {Rect{0, 0, m_width, m_height}};
+    }
+    return coalesce(m_composite);
+}
+
+std::vector<Rect> DirtyTileStore::dirtyRects(const Layer& layer) const
+{
+    if (m_full) {
+        return {Rect{0, 0, m_width, m_height}};
+    }
+    auto it = m_layers.find(&layer);
+    if (it == m_layers.end()) {
+        return {};
+    }
+    return coalesce(it->second);
+}
+
+void DirtyTileStore::clear()
+{
+    std::fill(m_composite.begin(), m_composite.end(), 0);
+    m_layers.clear();
+    m_dirtyCount = 0;
+    m_full = false;
+}
+
+std::size_t DirtyTileStore::dirtyTileCount() const
+{
+    return m_full ? m_composite.size() : m_dirtyCount;
+}
+
+std::size_t DirtyTileStore::markTiles(Bitmap& bitmap, const Rect& region) const
+{
+    const int x0 = std::max(0, region.x);
+    const int y0 = std::max(0, region.y);
+    const int x1 = std::min(m_width, region.x + region.w);
+    const int y1 = std::min(m_height, region.y + region.h);
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+
+    std::size_t newlyDirty = 0;
+    for (int ty = y0 / kTileSize; ty <= (y1 - 1) / kTileSize; ++ty) {
+        for (int tx = x0 / kTileSize; tx <= (x1 - 1) / kTileSize; ++tx) {
+            auto& bit = bitmap[static_cast<std::size_t>(ty) * m_tilesX + tx];
+            if (bit == 0) {
+                bit = 1;
+                ++newlyDirty;
+            }
+        }
+    }
+    return newlyDirty;
+}
+
+std::vector<Rect> DirtyTileStore::coalesce(const Bitmap& bitmap) const
+{
+    std::vector<Rect> rects;
+    // Rectangles still growing downwards, as tile-unit spans [x0, x1) starting at row y0
+    struct Open {
+        int x0;
+        int x1;
+        int y0;
+    };
+    std::vector<Open> open;
+    std::vector<Open> next;
+
+    auto emit = [&](const Open& span, int yEnd) {
+        const int px = span.x0 * kTileSize;
+        const int py = span.y0 * kTileSize;
+        rects.push_back({px,
+                         py,
+                         std::min(m_width, span.x1 * kTileSize) - px,
+                         std::min(m_height, yEnd * kTileSize) - py});
+    };
+
+    for (int ty = 0; ty <= m_tilesY; ++ty) {
+        next.clear();
+        if (ty < m_tilesY) {
+            const std::uint8_t* row = bitmap.data() + static_cast<std::size_t>(ty) * m_tilesX;
+            int tx = 0;
+            while (tx < m_tilesX) {
+                if (row[tx] == 0) {
+                    ++tx;
+                    continue;
+                }
+                const int start = tx;
+                while (tx < m_tilesX && row[tx] != 0) {
+                    ++tx;
+                }
+                next.push_back({start, tx, ty});
+            }
+        }
+
+        // Extend open rectangles whose span repeats exactly on this row
+        for (auto& span : next) {
+            auto it = std::find_if(open.begin(), open.end(), [&](const Open& o) {
+                return o.x0 == span.x0 && o.x1 == span.x1;
+            });
+            if (it != open.end()) {
+                span.y0 = it->y0;
+                open.erase(it);
+            }
+        }
+        for (const auto& span : open) {
+            emit(span, ty);
+        }
+        open.swap(next);
+    }
+    return rects;
+}
+
+}  // namespace gimp
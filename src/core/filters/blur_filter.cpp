@@ -11,9 +11,58 @@
 
 #include <algorithm>
 #include <cmath>
+#include <utility>
 
 namespace gimp {
 
+namespace {
+
+/**
+ * @brief One separable Gaussian pass over pixels with the given channel type.
+ * @tparam Channel Channel type of the layer format.
+ * @tparam Horizontal True to blur along rows, false along columns.
+ */
+template <typename Channel, bool Horizontal>
+void blurPass(std::vector<std::uint8_t>& data,
+              int width,
+              int height,
+              const std::vector<float>& kernel)
+{
+    constexpr std::size_t kPixelBytes = 4 * sizeof(Channel);
+    const std::vector<std::uint8_t> temp = data;
+    auto kernelRadius = static_cast<int>(kernel.size() / 2);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float sum[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+
+            for (std::size_t i = 0; i < kernel.size(); ++i) {
+                int px = x;
+                int py = y;
+                if constexpr (Horizontal) {
+                    px = std::clamp(x + (static_cast<int>(i) - kernelRadius), 0, width - 1);
+                } else {
+                    py = std::clamp(y + (static_cast<int>(i) - kernelRadius), 0, height - 1);
+                }
+
+                const std::uint8_t* src =
+                    temp.data() + (static_cast<std::size_t>(py) * width + px) * kPixelBytes;
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] += loadChannel<Channel>(src + c * sizeof(Channel)) * kernel[i];
+                }
+            }
+
+            std::uint8_t* dst =
+                data.data() + (static_cast<std::size_t>(y) * width + x) * kPixelBytes;
+            for (int c = 0; c < 4; ++c) {
+                storeChannel<Channel>(dst + c * sizeof(Channel), sum[c]);
+            }
+        }
+    }
+}
+
+}  // namespace
+
 void BlurFilter::setRadius(float radius)
 {
     radius_ = std::clamp(radius, 1.0F, 100.0F);
@@ -44,80 +93,31 @@ std::vector<float> BlurFilter::generateGaussianKernel(float radius)
 void BlurFilter::applyHorizontalBlur(std::vector<std::uint8_t>& data,
                                      int width,
                                      int height,
-                                     const std::vector<float>& kernel)
+                                     const std::vector<float>& kernel,
+                                     PixelFormat format)
 {
-    std::vector<std::uint8_t> temp = data;
-    auto kernelRadius = static_cast<int>(kernel.size() / 2);
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float r = 0.0F;
-            float g = 0.0F;
-            float b = 0.0F;
-            float a = 0.0F;
-
-            for (std::size_t i = 0; i < kernel.size(); ++i) {
-                int px = x + (static_cast<int>(i) - kernelRadius);
-                px = std::clamp(px, 0, width - 1);
-
-                int idx = (y * width + px) * 4;
-                r += static_cast<float>(temp[idx]) * kernel[i];
-                g += static_cast<float>(temp[idx + 1]) * kernel[i];
-                b += static_cast<float>(temp[idx + 2]) * kernel[i];
-                a += static_cast<float>(temp[idx + 3]) * kernel[i];
-            }
-
-            int idx = (y * width + x) * 4;
-            data[idx] = static_cast<std::uint8_t>(std::clamp(r, 0.0F, 255.0F));
-            data[idx + 1] = static_cast<std::uint8_t>(std::clamp(g, 0.0F, 255.0F));
-            data[idx + 2] = static_cast<std::uint8_t>(std::clamp(b, 0.0F, 255.0F));
-            data[idx + 3] = static_cast<std::uint8_t>(std::clamp(a, 0.0F, 255.0F));
-        }
-    }
+    visitChannelType(format, [&](auto zero) {
+        blurPass<decltype(zero), true>(data, width, height, kernel);
+    });
 }
 
 void BlurFilter::applyVerticalBlur(std::vector<std::uint8_t>& data,
                                    int width,
                                    int height,
-                                   const std::vector<float>& kernel)
+                                   const std::vector<float>& kernel,
+                                   PixelFormat format)
 {
-    std::vector<std::uint8_t> temp = data;
-    auto kernelRadius = static_cast<int>(kernel.size() / 2);
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float r = 0.0F;
-            float g = 0.0F;
-            float b = 0.0F;
-            float a = 0.0F;
-
-            for (std::size_t i = 0; i < kernel.size(); ++i) {
-                int py = y + (static_cast<int>(i) - kernelRadius);
-                py = std::clamp(py, 0, height - 1);
-
-                int idx = (py * width + x) * 4;
-                r += static_cast<float>(temp[idx]) * kernel[i];
-                g += static_cast<float>(temp[idx + 1]) * kernel[i];
-                b += static_cast<float>(temp[idx + 2]) * kernel[i];
-                a += static_cast<float>(temp[idx + 3]) * kernel[i];
-            }
-
-            int idx = (y * width + x) * 4;
-            data[idx] = static_cast<std::uint8_t>(std::clamp(r, 0.0F, 255.0F));
-            data[idx + 1] = static_cast<std::uint8_t>(std::clamp(g, 0.0F, 255.0F));
-            data[idx + 2] = static_cast<std::uint8_t>(std::clamp(b, 0.0F, 255.0F));
-            data[idx + 3] = static_cast<std::uint8_t>(std::clamp(a, 0.0F, 255.0F));
-        }
-    }
+    visitChannelType(format, [&](auto zero) {
+        blurPass<decltype(zero), false>(data, width, height, kernel);
+    });
 }
 
 bool BlurFilter::apply(std::shared_ptr<Layer> layer)
 {
-    if (!layer || layer->data().empty()) {
+    if (!layer || std::as_const(*layer).data().empty()) {
         return false;
     }
 
-    auto& data = layer->data();
     int width = layer->width();
     int height = layer->height();
 
@@ -125,10 +125,13 @@ bool BlurFilter::apply(std::shared_ptr<Layer> layer)
         return false;
     }
 
+    // The filter rewrites every pixel, so only now mark the whole layer modified
+    auto& data = layer->data();
+
     auto kernel = generateGaussianKernel(radius_);
 
-    applyHorizontalBlur(data, width, height, kernel);
-    applyVerticalBlur(data, width, height, kernel);
+    applyHorizontalBlur(data, width, height, kernel, layer->pixelFormat());
+    applyVerticalBlur(data, width, height, kernel, layer->pixelFormat());
 
     return true;
 }
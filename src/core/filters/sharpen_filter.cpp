@@ -11,9 +11,33 @@
 #include "core/layer.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace gimp {
 
+namespace {
+
+/**
+ * @brief Unsharp masking over pixels with the given channel type.
+ *
+ * output = original + amount * (original - blurred), per channel.
+ */
+template <typename Channel>
+void unsharpMask(std::vector<std::uint8_t>& data,
+                 const std::vector<std::uint8_t>& blurred,
+                 float amount)
+{
+    for (std::size_t i = 0; i < data.size(); i += sizeof(Channel)) {
+        float orig = loadChannel<Channel>(data.data() + i);
+        float blur = loadChannel<Channel>(blurred.data() + i);
+        float sharpened = orig + (orig - blur) * amount;
+
+        storeChannel<Channel>(data.data() + i, sharpened);
+    }
+}
+
+}  // namespace
+
 void SharpenFilter::setAmount(float amount)
 {
     amount_ = std::clamp(amount, 0.0F, 2.0F);
@@ -26,10 +50,11 @@ void SharpenFilter::setRadius(float radius)
 
 std::vector<std::uint8_t> SharpenFilter::createBlurredCopy(const std::vector<std::uint8_t>& data,
                                                            int width,
-                                                           int height) const
+                                                           int height,
+                                                           PixelFormat format) const
 {
     // Create a temporary layer with the data
-    auto tempLayer = std::make_shared<Layer>(width, height);
+    auto tempLayer = std::make_shared<Layer>(width, height, format);
     tempLayer->data() = data;
 
     // Apply blur using BlurFilter
@@ -42,11 +67,10 @@ std::vector<std::uint8_t> SharpenFilter::createBlurredCopy(const std::vector<std
 
 bool SharpenFilter::apply(std::shared_ptr<Layer> layer)
 {
-    if (!layer || layer->data().empty()) {
+    if (!layer || std::as_const(*layer).data().empty()) {
         return false;
     }
 
-    auto& data = layer->data();
     int width = layer->width();
     int height = layer->height();
 
@@ -54,17 +78,15 @@ bool SharpenFilter::apply(std::shared_ptr<Layer> layer)
         return false;
     }
 
+    // The filter rewrites every pixel, so only now mark the whole layer modified
+    auto& data = layer->data();
+
     // Create blurred version
-    auto blurred = createBlurredCopy(data, width, height);
+    auto blurred = createBlurredCopy(data, width, height, layer->pixelFormat());
 
     // Apply unsharp masking: output = original + amount * (original - blurred)
-    for (std::size_t i = 0; i < data.size(); ++i) {
-        float orig = static_cast<float>(data[i]);
-        float blur = static_cast<float>(blurred[i]);
-        float sharpened = orig + (orig - blur) * amount_;
-
-        data[i] = static_cast<std::uint8_t>(std::clamp(sharpened, 0.0F, 255.0F));
-    }
+    visitChannelType(layer->pixelFormat(),
+                     [&](auto zero) { unsharpMask<decltype(zero)>(data, blurred, amount_); });
 
     return true;
 }
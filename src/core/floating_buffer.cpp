@@ -8,6 +8,7 @@
 #include "core/floating_buffer.h"
 
 #include "core/layer.h"
+#include "core/pixel_format.h"
 #include "core/selection_manager.h"
 
 #include <QImage>
@@ -18,6 +19,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <utility>
 
 namespace gimp {
 
@@ -72,12 +74,13 @@ bool FloatingBuffer::extractFromLayer(const std::shared_ptr<Layer>& layer,
     // Pre-rasterize the selection mask
     rasterizeSelectionMask(selectionPath, sourceRect_);
 
-    // Allocate buffer (RGBA, 4 bytes per pixel) - initialize to transparent
+    // Allocate buffer (straight RGBA8, 4 bytes per pixel) - initialize to transparent
     buffer_.resize(static_cast<std::size_t>(width * height) * 4, 0);
 
-    const auto& layerData = layer->data();
+    const auto& layerData = std::as_const(*layer).data();
     int layerWidth = layer->width();
     constexpr int kPixelSize = 4;
+    const std::size_t layerPixelSize = layer->bytesPerPixel();
 
     // Copy pixels that are inside the selection
     for (int row = 0; row < height; ++row) {
@@ -86,10 +89,14 @@ bool FloatingBuffer::extractFromLayer(const std::shared_ptr<Layer>& layer,
                 int px = x1 + col;
                 int py = y1 + row;
                 std::size_t srcOffset =
-                    (static_cast<std::size_t>(py) * layerWidth + px) * kPixelSize;
+                    (static_cast<std::size_t>(py) * layerWidth + px) * layerPixelSize;
                 std::size_t dstOffset = (static_cast<std::size_t>(row) * width + col) * kPixelSize;
 
-                std::memcpy(buffer_.data() + dstOffset, layerData.data() + srcOffset, kPixelSize);
+                convertPixels(buffer_.data() + dstOffset,
+                              layerData.data() + srcOffset,
+                              1,
+                              layer->pixelFormat(),
+                              PixelFormat::Rgba8);
             }
         }
     }
@@ -105,7 +112,7 @@ void FloatingBuffer::clearSourcePixels(const std::shared_ptr<Layer>& layer)
 
     auto& layerData = layer->data();
     int layerWidth = layer->width();
-    constexpr int kPixelSize = 4;
+    const std::size_t pixelSize = layer->bytesPerPixel();
 
     int x1 = sourceRect_.left();
     int y1 = sourceRect_.top();
@@ -118,11 +125,9 @@ void FloatingBuffer::clearSourcePixels(const std::shared_ptr<Layer>& layer)
             if (isPixelSelected(col, row)) {
                 int px = x1 + col;
                 int py = y1 + row;
-                std::size_t offset = (static_cast<std::size_t>(py) * layerWidth + px) * kPixelSize;
-                layerData[offset + 0] = 0;  // R
-                layerData[offset + 1] = 0;  // G
-                layerData[offset + 2] = 0;  // B
-                layerData[offset + 3] = 0;  // A
+                std::size_t offset = (static_cast<std::size_t>(py) * layerWidth + px) * pixelSize;
+                // All-zero bytes are transparent in every pixel format
+                std::memset(layerData.data() + offset, 0, pixelSize);
             }
         }
     }
@@ -138,6 +143,7 @@ void FloatingBuffer::pasteToLayer(const std::shared_ptr<Layer>& layer, QPoint of
     int layerWidth = layer->width();
     int layerHeight = layer->height();
     constexpr int kPixelSize = 4;
+    const std::size_t layerPixelSize = layer->bytesPerPixel();
 
     int width = sourceRect_.width();
     int height = sourceRect_.height();
@@ -161,9 +167,13 @@ void FloatingBuffer::pasteToLayer(const std::shared_ptr<Layer>& layer, QPoint of
 
             std::size_t srcOffset = (static_cast<std::size_t>(row) * width + col) * kPixelSize;
             std::size_t dstOffset =
-                (static_cast<std::size_t>(destPy) * layerWidth + destPx) * kPixelSize;
+                (static_cast<std::size_t>(destPy) * layerWidth + destPx) * layerPixelSize;
 
-            std::memcpy(layerData.data() + dstOffset, buffer_.data() + srcOffset, kPixelSize);
+            convertPixels(layerData.data() + dstOffset,
+                          buffer_.data() + srcOffset,
+                          1,
+                          PixelFormat::Rgba8,
+                          layer->pixelFormat());
         }
     }
 }
@@ -0,0 +1,137 @@
+/**
+ * @file pixel_format.cpp
+ * @brief Implementation of pixel format conversions.
+ * @author Laurent Jiang
+ * @date 2026-02-20
+ */
+
+#include "core/pixel_format.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gimp {
+
+namespace {
+
+/**
+ * @brief Converts pixels through float, one whole pixel at a time (so dst may alias src).
+ * @tparam Src Channel type of the source.
+ * @tparam Dst Channel type of the destination.
+ */
+template <typename Src, typename Dst>
+void convertThroughFloat(std::uint8_t* dst,
+                         const std::uint8_t* src,
+                         std::size_t count,
+                         bool srcPremultiplied,
+                         bool dstPremultiplied)
+{
+    using SrcTraits = ChannelTraits<Src>;
+    using DstTraits = ChannelTraits<Dst>;
+    for (std::size_t i = 0; i < count; ++i, src += 4 * sizeof(Src), dst += 4 * sizeof(Dst)) {
+        float unit[4];
+        for (int c = 0; c < 4; ++c) {
+            unit[c] = loadChannel<Src>(src + c * sizeof(Src)) / SrcTraits::kOne;
+        }
+        if (srcPremultiplied) {
+            for (int c = 0; c < 3; ++c) {
+                unit[c] = unit[3] > 0.0F ? std::min(unit[c] / unit[3], 1.0F) : 0.0F;
+            }
+        }
+        if (dstPremultiplied) {
+            const float alpha = std::clamp(unit[3], 0.0F, 1.0F);
+            for (int c = 0; c < 3; ++c) {
+                unit[c] = std::clamp(unit[c], 0.0F, 1.0F) * alpha;
+            }
+        }
+        for (int c = 0; c < 4; ++c) {
+            storeChannel<Dst>(dst + c * sizeof(Dst), unit[c] * DstTraits::kOne + DstTraits::kRound);
+        }
+    }
+}
+
+}  // namespace
+
+void premultiplyRow(std::uint8_t* dst, const std::uint8_t* src, int count)
+{
+    for (int i = 0; i < count; ++i, dst += 4, src += 4) {
+        const std::uint32_t a = src[3];
+        dst[0] = static_cast<std::uint8_t>(mulDiv255(src[0], a));
+        dst[1] = static_cast<std::uint8_t>(mulDiv255(src[1], a));
+        dst[2] = static_cast<std::uint8_t>(mulDiv255(src[2], a));
+        dst[3] = static_cast<std::uint8_t>(a);
+    }
+}
+
+void unpremultiplyRow(std::uint8_t* dst, const std::uint8_t* src, int count)
+{
+    for (int i = 0; i < count; ++i, dst += 4, src += 4) {
+        const std::uint32_t a = src[3];
+        if (a == 0) {
+            dst[0] = dst[1] = dst[2] = dst[3] = 0;
+            continue;
+        }
+        for (int c = 0; c < 3; ++c) {
+            const std::uint32_t value = (src[c] * 255U + a / 2) / a;
+            dst[c] = static_cast<std::uint8_t>(std::min(value, 255U));
+        }
+        dst[3] = static_cast<std::uint8_t>(a);
+    }
+}
+
+void convertPixels(std::uint8_t* dst,
+                   const std::uint8_t* src,
+                   std::size_t count,
+                   PixelFormat from,
+                   PixelFormat to)
+{
+    if (from == to) {
+        if (dst != src) {
+            std::memcpy(dst, src, count * static_cast<std::size_t>(describe(from).bytesPerPixel()));
+        }
+        return;
+    }
+
+    const PixelFormatDescriptor fromDesc = describe(from);
+    const PixelFormatDescriptor toDesc = describe(to);
+    if (fromDesc.bytesPerChannel == 1 && toDesc.bytesPerChannel == 1) {
+        // Convert in bounded chunks so the int count of the row functions never overflows
+        constexpr std::size_t kChunk = 1U << 20;
+        for (std::size_t offset = 0; offset < count; offset += kChunk) {
+            const auto n = static_cast<int>(std::min(kChunk, count - offset));
+            if (toDesc.premultiplied) {
+                premultiplyRow(dst + offset * 4U, src + offset * 4U, n);
+            } else {
+                unpremultiplyRow(dst + offset * 4U, src + offset * 4U, n);
+            }
+        }
+        return;
+    }
+
+    visitChannelType(from, [&](auto srcZero) {
+        visitChannelType(to, [&](auto dstZero) {
+            convertThroughFloat<decltype(srcZero), decltype(dstZero)>(
+                dst, src, count, fromDesc.premultiplied, toDesc.premultiplied);
+        });
+    });
+}
+
+std::uint32_t readColor(const std::uint8_t* pixel, PixelFormat format)
+{
+    std::uint8_t rgba[4];
+    convertPixels(rgba, pixel, 1, format, PixelFormat::Rgba8);
+    return (static_cast<std::uint32_t>(rgba[0]) << 24) |
+           (static_cast<std::uint32_t>(rgba[1]) << 16) |
+           (static_cast<std::uint32_t>(rgba[2]) << 8) | rgba[3];
+}
+
+void writeColor(std::uint8_t* pixel, PixelFormat format, std::uint32_t rgba)
+{
+    const std::uint8_t straight[4] = {static_cast<std::uint8_t>((rgba >> 24) & 0xFFU),
+                                      static_cast<std::uint8_t>((rgba >> 16) & 0xFFU),
+                                      static_cast<std::uint8_t>((rgba >> 8) & 0xFFU),
+                                      static_cast<std::uint8_t>(rgba & 0xFFU)};
+    convertPixels(pixel, straight, 1, PixelFormat::Rgba8, format);
+}
+
+}  // namespace gimp
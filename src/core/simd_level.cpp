@@ -0,0 +1,71 @@
+/**
+ * @file simd_level.cpp
+ * @brief Runtime CPU feature detection for the pixel kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ */
+
+#include "core/simd_level.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace gimp {
+
+namespace {
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+/// Queries the CPU (and OS register state support) for SSE4.1 and AVX2.
+SimdLevel queryCpu()
+{
+#if defined(_MSC_VER)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1") != 0;
+    const bool avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+    if (avx2) {
+        return SimdLevel::Avx2;
+    }
+    return sse41 ? SimdLevel::Sse41 : SimdLevel::Scalar;
+}
+
+#else
+
+SimdLevel queryCpu()
+{
+    return SimdLevel::Scalar;
+}
+
+#endif
+
+}  // namespace
+
+SimdLevel detectSimdLevel()
+{
+    static const SimdLevel level = queryCpu();
+    return level;
+}
+
+SimdLevel supportedSimdLevel(SimdLevel level)
+{
+    const SimdLevel available = detectSimdLevel();
+    return static_cast<int>(level) > static_cast<int>(available) ? available : level;
+}
+
+}  // namespace gimp
@@ -0,0 +1,171 @@
+/**
+ * @file stroke_buffer.cpp
+ * @brief Implementation of StrokeBuffer.
+ * @author Laurent Jiang
+ * @date 2026-03-02
+ */
+
+#include "core/stroke_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace gimp {
+
+namespace {
+
+/// Returns the bounding box of two rectangles; empty ones are ignored.
+Rect unite(const Rect& a, const Rect& b)
+{
+    if (a.w <= 0 || a.h <= 0) {
+        return b;
+    }
+    if (b.w <= 0 || b.h <= 0) {
+        return a;
+    }
+    const int x0 = std::min(a.x, b.x);
+    const int y0 = std::min(a.y, b.y);
+    const int x1 = std::max(a.x + a.w, b.x + b.w);
+    const int y1 = std::max(a.y + a.h, b.y + b.h);
+    return Rect{x0, y0, x1 - x0, y1 - y0};
+}
+
+/// Intersects two rectangles; the result has zero size if they do not overlap.
+Rect intersect(const Rect& a, const Rect& b)
+{
+    const int x0 = std::max(a.x, b.x);
+    const int y0 = std::max(a.y, b.y);
+    const int x1 = std::min(a.x + a.w, b.x + b.w);
+    const int y1 = std::min(a.y + a.h, b.y + b.h);
+    return Rect{x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+}  // namespace
+
+StrokeBuffer::~StrokeBuffer()
+{
+    reset();
+}
+
+void StrokeBuffer::begin(const Rect& area)
+{
+    reset();
+    const Rect clipped{area.x, area.y, std::max(0, area.w), std::max(0, area.h)};
+    const int tilesX = (clipped.w + kTileSize - 1) / kTileSize;
+    const int tilesY = (clipped.h + kTileSize - 1) / kTileSize;
+    const auto count = static_cast<std::size_t>(tilesX) * static_cast<std::size_t>(tilesY);
+    if (count != tiles_.size()) {
+        // reset() left every slot empty; only a new grid size needs a new grid
+        tiles_ = std::vector<std::atomic<Tile*>>(count);
+    }
+    tilesX_ = tilesX;
+    area_ = clipped;
+    active_ = true;
+}
+
+void StrokeBuffer::reset()
+{
+    for (auto& slot : tiles_) {
+        delete slot.exchange(nullptr, std::memory_order_relaxed);
+    }
+    bounds_ = Rect{0, 0, 0, 0};
+    dirty_ = Rect{0, 0, 0, 0};
+    active_ = false;
+}
+
+void StrokeBuffer::accumulateRow(int x, int y, const float* coverage, int count, float strength)
+{
+    const float scale = strength * 255.0F;
+    const int localY = y - area_.y;
+    for (int done = 0; done < count;) {
+        const int localX = x + done - area_.x;
+        const int column = localX % kTileSize;
+        const int span = std::min(count - done, kTileSize - column);
+        const float* src = coverage + done;
+        done += span;
+
+        // Dab masks fade to zero at their corners; those runs need no tile
+        const Tile* existing = findTile(localX, localY);
+        if (existing == nullptr &&
+            std::none_of(src, src + span, [scale](float c) { return c * scale >= 0.5F; })) {
+            continue;
+        }
+        std::uint8_t* dst = tileFor(localX, localY).data() +
+                            static_cast<std::size_t>(localY % kTileSize) * kTileSize + column;
+        for (int i = 0; i < span; ++i) {
+            const auto value =
+                static_cast<std::uint8_t>(std::clamp(src[i] * scale + 0.5F, 0.0F, 255.0F));
+            dst[i] = std::max(dst[i], value);
+        }
+    }
+}
+
+void StrokeBuffer::readRow(int y, int x, int count, std::uint8_t* dst) const
+{
+    const int localY = y - area_.y;
+    for (int done = 0; done < count;) {
+        const int localX = x + done - area_.x;
+        const int column = localX % kTileSize;
+        const int span = std::min(count - done, kTileSize - column);
+        if (const Tile* tile = findTile(localX, localY)) {
+            std::memcpy(dst + done,
+                        tile->data() + static_cast<std::size_t>(localY % kTileSize) * kTileSize +
+                            column,
+                        static_cast<std::size_t>(span));
+        } else {
+            std::memset(dst + done, 0, static_cast<std::size_t>(span));
+        }
+        done += span;
+    }
+}
+
+void StrokeBuffer::markDirty(const Rect& region)
+{
+    const Rect clipped = intersect(region, area_);
+    if (clipped.w <= 0 || clipped.h <= 0) {
+        return;
+    }
+    bounds_ = unite(bounds_, clipped);
+    dirty_ = unite(dirty_, clipped);
+}
+
+Rect StrokeBuffer::takeDirty()
+{
+    const Rect dirty = dirty_;
+    dirty_ = Rect{0, 0, 0, 0};
+    return dirty;
+}
+
+std::size_t StrokeBuffer::allocatedTileCount() const
+{
+    return static_cast<std::size_t>(
+        std::count_if(tiles_.begin(), tiles_.end(), [](const std::atomic<Tile*>& slot) {
+            return slot.load(std::memory_order_relaxed) != nullptr;
+        }));
+}
+
+StrokeBuffer::Tile& StrokeBuffer::tileFor(int localX, int localY)
+{
+    auto& slot =
+        tiles_[static_cast<std::size_t>(localY / kTileSize) * tilesX_ + localX / kTileSize];
+    Tile* tile = slot.load(std::memory_order_acquire);
+    if (tile != nullptr) {
+        return *tile;
+    }
+
+    // Bands on neighbouring rows can reach a new tile together; the first one publishes it
+    auto fresh = std::make_unique<Tile>();
+    if (slot.compare_exchange_strong(tile, fresh.get(), std::memory_order_acq_rel)) {
+        return *fresh.release();
+    }
+    return *tile;
+}
+
+const StrokeBuffer::Tile* StrokeBuffer::findTile(int localX, int localY) const
+{
+    return tiles_[static_cast<std::size_t>(localY / kTileSize) * tilesX_ + localX / kTileSize]
+        .load(std::memory_order_acquire);
+}
+
+}  // namespace gimp
@@ -0,0 +1,134 @@
+/**
+ * @file stroke_interpolator.cpp
+ * @brief Implementation of StrokeInterpolator.
+ * @author Laurent Jiang
+ * @date 2026-03-01
+ */
+
+#include "core/stroke_interpolator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gimp {
+
+namespace {
+
+/// Smallest spacing accepted, a sub-pixel step of the dab mask cache.
+constexpr float kMinSpacing = 0.25F;
+
+/// Length of the straight pieces a spline segment is walked along.
+constexpr float kCurvePiece = 2.0F;
+
+/// Upper bound on the pieces of one spline segment.
+constexpr int kMaxCurvePieces = 64;
+
+/**
+ * @brief Evaluates a uniform Catmull-Rom spline between b (t = 0) and c (t = 1).
+ */
+float catmullRom(float a, float b, float c, float d, float t)
+{
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5F * (2.0F * b + (c - a) * t + (2.0F * a - 5.0F * b + 4.0F * c - d) * t2 +
+                   (3.0F * b - a - 3.0F * c + d) * t3);
+}
+
+}  // namespace
+
+void StrokeInterpolator::setSpacing(float pixels)
+{
+    spacing_ = std::max(pixels, kMinSpacing);
+}
+
+const std::vector<StrokeDab>& StrokeInterpolator::begin(float x, float y, float pressure)
+{
+    dabs_.clear();
+    const StrokeDab first{x, y, pressure};
+    std::fill(std::begin(points_), std::end(points_), first);
+    nextDab_ = spacing_;
+    pending_ = false;
+    active_ = true;
+    dabs_.push_back(first);
+    return dabs_;
+}
+
+const std::vector<StrokeDab>& StrokeInterpolator::addPoint(float x, float y, float pressure)
+{
+    dabs_.clear();
+    if (!active_) {
+        return dabs_;
+    }
+
+    const StrokeDab point{x, y, pressure};
+    if (pending_) {
+        // The segment ending at the previous point now knows its outgoing tangent
+        walkSegment(points_[0], points_[1], points_[2], point);
+    }
+    if (!smoothing_) {
+        walkLine(points_[2], point);
+    }
+    pending_ = smoothing_;
+
+    points_[0] = points_[1];
+    points_[1] = points_[2];
+    points_[2] = point;
+    return dabs_;
+}
+
+const std::vector<StrokeDab>& StrokeInterpolator::finish()
+{
+    dabs_.clear();
+    if (active_ && pending_) {
+        walkSegment(points_[0], points_[1], points_[2], points_[2]);
+    }
+    pending_ = false;
+    active_ = false;
+    return dabs_;
+}
+
+void StrokeInterpolator::reset()
+{
+    dabs_.clear();
+    pending_ = false;
+    active_ = false;
+}
+
+void StrokeInterpolator::walkSegment(const StrokeDab& p0,
+                                     const StrokeDab& p1,
+                                     const StrokeDab& p2,
+                                     const StrokeDab& p3)
+{
+    const float chord = std::hypot(p2.x - p1.x, p2.y - p1.y);
+    const int pieces =
+        std::clamp(static_cast<int>(std::ceil(chord / kCurvePiece)), 1, kMaxCurvePieces);
+
+    StrokeDab from = p1;
+    for (int i = 1; i <= pieces; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(pieces);
+        const StrokeDab to{catmullRom(p0.x, p1.x, p2.x, p3.x, t),
+                           catmullRom(p0.y, p1.y, p2.y, p3.y, t),
+                           p1.pressure + (p2.pressure - p1.pressure) * t};
+        walkLine(from, to);
+        from = to;
+    }
+}
+
+void StrokeInterpolator::walkLine(const StrokeDab& from, const StrokeDab& to)
+{
+    const float dx = to.x - from.x;
+    const float dy = to.y - from.y;
+    const float length = std::hypot(dx, dy);
+
+    // nextDab_ is always positive, so a zero-length line places nothing
+    while (nextDab_ <= length) {
+        const float t = nextDab_ / length;
+        dabs_.push_back({from.x + dx * t,
+                         from.y + dy * t,
+                         from.pressure + (to.pressure - from.pressure) * t});
+        nextDab_ += spacing_;
+    }
+    nextDab_ -= length;
+}
+
+}  // namespace gimp
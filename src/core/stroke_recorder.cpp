@@ -0,0 +1,221 @@
+/**
+ * @file stroke_recorder.cpp
+ * @brief Implementation of StrokeRecorder.
+ * @author Laurent Jiang
+ * @date 2026-02-23
+ */
+
+#include "core/stroke_recorder.h"
+
+#include "core/commands/draw_command.h"
+#include "core/layer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace gimp {
+
+namespace {
+
+/// Intersects a region with the bounds of a layer.
+Rect clipToLayer(const Rect& region, const Layer& layer)
+{
+    const int x0 = std::max(0, region.x);
+    const int y0 = std::max(0, region.y);
+    const int x1 = std::min(layer.width(), region.x + region.w);
+    const int y1 = std::min(layer.height(), region.y + region.h);
+    return Rect{x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+}  // namespace
+
+void StrokeRecorder::begin(std::shared_ptr<Layer> layer)
+{
+    reset();
+    m_layer = std::move(layer);
+    if (!m_layer) {
+        return;
+    }
+    m_tilesX = (m_layer->width() + kTileSize - 1) / kTileSize;
+    m_pixelBytes = m_layer->bytesPerPixel();
+}
+
+void StrokeRecorder::record(const Rect& region)
+{
+    if (!m_layer) {
+        return;
+    }
+
+    const Rect clipped = clipToLayer(region, *m_layer);
+    if (clipped.w <= 0 || clipped.h <= 0) {
+        return;
+    }
+
+    const int tx0 = clipped.x / kTileSize;
+    const int ty0 = clipped.y / kTileSize;
+    const int tx1 = (clipped.x + clipped.w - 1) / kTileSize;
+    const int ty1 = (clipped.y + clipped.h - 1) / kTileSize;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const auto index = static_cast<std::size_t>(ty) * m_tilesX + tx;
+            if (m_tiles.find(index) == m_tiles.end()) {
+                saveTile(tx, ty);
+            }
+        }
+    }
+}
+
+std::shared_ptr<DrawCommand> StrokeRecorder::finish(const Rect& region)
+{
+    if (!m_layer) {
+        return nullptr;
+    }
+
+    const Rect clipped = clipToLayer(region, *m_layer);
+    if (clipped.w <= 0 || clipped.h <= 0) {
+        reset();
+        return nullptr;
+    }
+
+    // Untouched tiles still hold their original pixels in the layer
+    const Layer& layer = *m_layer;
+    const std::size_t rowBytes = static_cast<std::size_t>(clipped.w) * m_pixelBytes;
+    std::vector<std::uint8_t> before(rowBytes * clipped.h);
+    for (int y = 0; y < clipped.h; ++y) {
+        const int layerY = clipped.y + y;
+        const int ty = layerY / kTileSize;
+        std::uint8_t* dst = before.data() + static_cast<std::size_t>(y) * rowBytes;
+
+        for (int x = clipped.x; x < clipped.x + clipped.w;) {
+            const int tx = x / kTileSize;
+            const int spanEnd = std::min(clipped.x + clipped.w, (tx + 1) * kTileSize);
+            const auto spanBytes = static_cast<std::size_t>(spanEnd - x) * m_pixelBytes;
+
+            const auto saved = m_tiles.find(static_cast<std::size_t>(ty) * m_tilesX + tx);
+            if (saved != m_tiles.end()) {
+                const int tileWidth = std::min(kTileSize, layer.width() - tx * kTileSize);
+                const std::size_t offset =
+                    (static_cast<std::size_t>(layerY - ty * kTileSize) * tileWidth +
+                     (x - tx * kTileSize)) *
+                    m_pixelBytes;
+                std::memcpy(dst, saved->second.data() + offset, spanBytes);
+            } else {
+                std::memcpy(dst, layer.row(layerY) + static_cast<std::size_t>(x) * m_pixelBytes,
+                            spanBytes);
+            }
+            dst += spanBytes;
+            x = spanEnd;
+        }
+    }
+
+    auto command = std::make_shared<DrawCommand>(m_layer, clipped.x, clipped.y, clipped.w,
+                                                 clipped.h);
+    command->captureBeforeState(std::move(before));
+    command->captureAfterState();
+    reset();
+    return command;
+}
+
+TileBuffer StrokeRecorder::finishSnapshot()
+{
+    if (!m_layer) {
+        return {};
+    }
+
+    // Tiles are stored in 4-byte units, so wide formats span several units per pixel
+    const int units = static_cast<int>(m_pixelBytes / TileBuffer::kBytesPerPixel);
+    TileBuffer before = m_layer->snapshot();
+    for (const auto& [index, pixels] : m_tiles) {
+        const int tx = static_cast<int>(index % m_tilesX);
+        const int ty = static_cast<int>(index / m_tilesX);
+        const Rect tile =
+            clipToLayer(Rect{tx * kTileSize, ty * kTileSize, kTileSize, kTileSize}, *m_layer);
+        before.writeRegion(Rect{tile.x * units, tile.y, tile.w * units, tile.h},
+                           pixels.data(),
+                           static_cast<std::size_t>(tile.w) * m_pixelBytes);
+    }
+    reset();
+    return before;
+}
+
+void StrokeRecorder::restore()
+{
+    if (!m_layer) {
+        return;
+    }
+
+    for (const auto& [index, pixels] : m_tiles) {
+        const int tx = static_cast<int>(index % m_tilesX);
+        const int ty = static_cast<int>(index / m_tilesX);
+        const Rect tile =
+            clipToLayer(Rect{tx * kTileSize, ty * kTileSize, kTileSize, kTileSize}, *m_layer);
+        m_layer->writeRegion(tile, pixels.data());
+    }
+    reset();
+}
+
+void StrokeRecorder::restoreRegion(const Rect& region)
+{
+    if (!m_layer) {
+        return;
+    }
+
+    const Rect clipped = clipToLayer(region, *m_layer);
+    if (clipped.w <= 0 || clipped.h <= 0) {
+        return;
+    }
+
+    Layer& layer = *m_layer;
+    std::uint8_t* pixels = layer.regionData(clipped);
+    const std::size_t rowBytes = layer.rowBytes();
+    const int tx0 = clipped.x / kTileSize;
+    const int ty0 = clipped.y / kTileSize;
+    const int tx1 = (clipped.x + clipped.w - 1) / kTileSize;
+    const int ty1 = (clipped.y + clipped.h - 1) / kTileSize;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            const auto saved = m_tiles.find(static_cast<std::size_t>(ty) * m_tilesX + tx);
+            if (saved == m_tiles.end()) {
+                continue;
+            }
+
+            const int tileWidth = std::min(kTileSize, layer.width() - tx * kTileSize);
+            const int x0 = std::max(clipped.x, tx * kTileSize);
+            const int x1 = std::min(clipped.x + clipped.w, tx * kTileSize + tileWidth);
+            const int y0 = std::max(clipped.y, ty * kTileSize);
+            const int y1 = std::min(clipped.y + clipped.h, (ty + 1) * kTileSize);
+            const auto spanBytes = static_cast<std::size_t>(x1 - x0) * m_pixelBytes;
+            for (int y = y0; y < y1; ++y) {
+                const std::size_t offset =
+                    (static_cast<std::size_t>(y - ty * kTileSize) * tileWidth +
+                     (x0 - tx * kTileSize)) *
+                    m_pixelBytes;
+                std::memcpy(pixels + static_cast<std::size_t>(y) * rowBytes +
+                                static_cast<std::size_t>(x0) * m_pixelBytes,
+                            saved->second.data() + offset,
+                            spanBytes);
+            }
+        }
+    }
+}
+
+void StrokeRecorder::reset()
+{
+    m_layer = nullptr;
+    m_tilesX = 0;
+    m_pixelBytes = 0;
+    m_tiles.clear();
+}
+
+void StrokeRecorder::saveTile(int tx, int ty)
+{
+    const Layer& layer = *m_layer;
+    const Rect tile =
+        clipToLayer(Rect{tx * kTileSize, ty * kTileSize, kTileSize, kTileSize}, layer);
+    auto& pixels = m_tiles[static_cast<std::size_t>(ty) * m_tilesX + tx];
+    pixels.resize(static_cast<std::size_t>(tile.w) * tile.h * m_pixelBytes);
+    layer.readRegion(tile, pixels.data());
+}
+
+}  // namespace gimp
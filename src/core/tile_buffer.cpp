@@ -0,0 +1,279 @@
+/**
+ * @file tile_buffer.cpp
+ * @brief Implementation of TileBuffer.
+ * @author Laurent Jiang
+ * @date 2026-02-14
+ */
+
+#include "core/tile_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gimp {
+
+namespace {
+
+constexpr std::size_t kTileStride =
+    static_cast<std::size_t>(TileBuffer::kTileSize) * TileBuffer::kBytesPerPixel;
+
+/// Returns true if every byte of the span is zero.
+bool isAllZero(const std::uint8_t* data, std::size_t size)
+{
+    return std::all_of(data, data + size, [](std::uint8_t v) { return v == 0; });
+}
+
+/// Allocates a tile apart from its control block, so weak references do not keep the pixels.
+std::shared_ptr<TileBuffer::Tile> newTile()
+{
+    return std::shared_ptr<TileBuffer::Tile>(std::make_unique<TileBuffer::Tile>());
+}
+
+}  // namespace
+
+TileBuffer::TileBuffer(int width, int height)
+    : m_width(std::max(0, width)),
+      m_height(std::max(0, height))
+{
+    if (m_width == 0 || m_height == 0) {
+        m_width = 0;
+        m_height = 0;
+        return;
+    }
+    m_tilesX = (m_width + kTileSize - 1) / kTileSize;
+    m_tilesY = (m_height + kTileSize - 1) / kTileSize;
+    m_tiles.resize(static_cast<std::size_t>(m_tilesX) * static_cast<std::size_t>(m_tilesY));
+}
+
+const std::uint8_t* TileBuffer::tileData(int tx, int ty) const
+{
+    const auto& tile = m_tiles[tileIndex(tx, ty)];
+    return tile ? tile->pixels.data() : nullptr;
+}
+
+std::uint8_t* TileBuffer::mutableTileData(int tx, int ty)
+{
+    auto& tile = m_tiles[tileIndex(tx, ty)];
+    if (!tile) {
+        tile = newTile();
+    } else if (tile.use_count() > 1 || tile->tracked.load(std::memory_order_relaxed)) {
+        auto copy = newTile();
+        copy->pixels = tile->pixels;
+        tile = std::move(copy);
+    }
+    return tile->pixels.data();
+}
+
+bool TileBuffer::sharesTile(const TileBuffer& other, int tx, int ty) const
+{
+    if (other.m_tilesX != m_tilesX || other.m_tilesY != m_tilesY) {
+        return false;
+    }
+    return m_tiles[tileIndex(tx, ty)] == other.m_tiles[tileIndex(tx, ty)];
+}
+
+bool TileBuffer::ownsTile(int tx, int ty) const
+{
+    const auto& tile = m_tiles[tileIndex(tx, ty)];
+    return tile && tile.use_count() == 1;
+}
+
+void TileBuffer::releaseTile(int tx, int ty)
+{
+    m_tiles[tileIndex(tx, ty)].reset();
+}
+
+void TileBuffer::readRegion(const Rect& region, std::uint8_t* dst, std::size_t dstStride) const
+{
+    for (int row = 0; row < region.h; ++row) {
+        readRow(region.y + row, region.x, region.w, dst + static_cast<std::size_t>(row) * dstStride);
+    }
+}
+
+void TileBuffer::writeRegion(const Rect& region, const std::uint8_t* src, std::size_t srcStride)
+{
+    for (int row = 0; row < region.h; ++row) {
+        writeRow(
+            region.y + row, region.x, region.w, src + static_cast<std::size_t>(row) * srcStride);
+    }
+}
+
+void TileBuffer::readRow(int y, int x, int count, std::uint8_t* dst) const
+{
+    const int ty = y / kTileSize;
+    const int inTileY = y % kTileSize;
+    int px = x;
+    const int end = x + count;
+
+    while (px < end) {
+        const int tx = px / kTileSize;
+        const int inTileX = px % kTileSize;
+        const int span = std::min(kTileSize - inTileX, end - px);
+        const std::size_t spanBytes = static_cast<std::size_t>(span) * kBytesPerPixel;
+
+        const std::uint8_t* tile = tileData(tx, ty);
+        if (tile) {
+            std::memcpy(dst,
+                        tile + static_cast<std::size_t>(inTileY) * kTileStride +
+                            static_cast<std::size_t>(inTileX) * kBytesPerPixel,
+                        spanBytes);
+        } else {
+            std::memset(dst, 0, spanBytes);
+        }
+
+        dst += spanBytes;
+        px += span;
+    }
+}
+
+void TileBuffer::writeRow(int y, int x, int count, const std::uint8_t* src)
+{
+    const int ty = y / kTileSize;
+    const int inTileY = y % kTileSize;
+    int px = x;
+    const int end = x + count;
+
+    while (px < end) {
+        const int tx = px / kTileSize;
+        const int inTileX = px % kTileSize;
+        const int span = std::min(kTileSize - inTileX, end - px);
+        const std::size_t spanBytes = static_cast<std::size_t>(span) * kBytesPerPixel;
+
+        // Writing transparent pixels into a transparent tile is a no-op
+        if (tileData(tx, ty) || !isAllZero(src, spanBytes)) {
+            std::uint8_t* tile = mutableTileData(tx, ty);
+            std::memcpy(tile + static_cast<std::size_t>(inTileY) * kTileStride +
+                            static_cast<std::size_t>(inTileX) * kBytesPerPixel,
+                        src,
+                        spanBytes);
+        }
+
+        src += spanBytes;
+        px += span;
+    }
+}
+
+std::size_t TileBuffer::syncFrom(const std::uint8_t* linear, std::size_t stride, const Rect& region)
+{
+    const int x0 = std::max(0, region.x);
+    const int y0 = std::max(0, region.y);
+    const int x1 = std::min(m_width, region.x + region.w);
+    const int y1 = std::min(m_height, region.y + region.h);
+    if (x0 >= x1 || y0 >= y1) {
+        return 0;
+    }
+
+    std::size_t changed = 0;
+    for (int ty = y0 / kTileSize; ty <= (y1 - 1) / kTileSize; ++ty) {
+        for (int tx = x0 / kTileSize; tx <= (x1 - 1) / kTileSize; ++tx) {
+            const int tileX = tx * kTileSize;
+            const int tileY = ty * kTileSize;
+            const int tileW = std::min(kTileSize, m_width - tileX);
+            const int tileH = std::min(kTileSize, m_height - tileY);
+            const std::size_t rowBytes = static_cast<std::size_t>(tileW) * kBytesPerPixel;
+
+            const std::uint8_t* current = tileData(tx, ty);
+            bool differs = false;
+            bool transparent = true;
+            for (int row = 0; row < tileH; ++row) {
+                const std::uint8_t* src = linear + static_cast<std::size_t>(tileY + row) * stride +
+                                          static_cast<std::size_t>(tileX) * kBytesPerPixel;
+                if (transparent && !isAllZero(src, rowBytes)) {
+                    transparent = false;
+                }
+                if (!differs) {
+                    differs = current
+                                  ? std::memcmp(current + static_cast<std::size_t>(row) *
+                                                              kTileStride,
+                                                src,
+                                                rowBytes) != 0
+                                  : !transparent;
+                }
+                if (differs && !transparent) {
+                    break;
+                }
+            }
+
+            if (!differs) {
+                continue;
+            }
+
+            ++changed;
+            auto& slot = m_tiles[tileIndex(tx, ty)];
+            if (transparent) {
+                slot.reset();
+                continue;
+            }
+
+            // Fresh tile: never write through storage that a snapshot may share
+            slot = newTile();
+            for (int row = 0; row < tileH; ++row) {
+                std::memcpy(slot->pixels.data() + static_cast<std::size_t>(row) * kTileStride,
+                            linear + static_cast<std::size_t>(tileY + row) * stride +
+                                static_cast<std::size_t>(tileX) * kBytesPerPixel,
+                            rowBytes);
+            }
+        }
+    }
+    return changed;
+}
+
+std::size_t TileBuffer::allocatedTileCount() const
+{
+    return static_cast<std::size_t>(
+        std::count_if(m_tiles.begin(), m_tiles.end(), [](const auto& tile) { return tile; }));
+}
+
+std::size_t TileBuffer::byteSize() const
+{
+    return allocatedTileCount() * kTileBytes;
+}
+
+std::size_t TileBuffer::exclusiveByteSize() const
+{
+    const auto exclusive = std::count_if(m_tiles.begin(), m_tiles.end(), [](const auto& tile) {
+        return tile && tile.use_count() == 1;
+    });
+    return static_cast<std::size_t>(exclusive) * kTileBytes;
+}
+
+WeakTileBuffer::WeakTileBuffer(const TileBuffer& tiles)
+    : m_width(tiles.m_width),
+      m_height(tiles.m_height),
+      m_tiles(tiles.m_tiles.begin(), tiles.m_tiles.end()),
+      m_allocated(tiles.m_tiles.size())
+{
+    for (std::size_t i = 0; i < tiles.m_tiles.size(); ++i) {
+        const auto& tile = tiles.m_tiles[i];
+        if (!tile) {
+            continue;
+        }
+        m_allocated[i] = true;
+        // Only a fresh tile, still private to its creator, can be untracked
+        if (!tile->tracked.load(std::memory_order_relaxed)) {
+            tile->tracked.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+TileBuffer WeakTileBuffer::lock(std::vector<Rect>& expired) const
+{
+    TileBuffer tiles(m_width, m_height);
+    for (std::size_t i = 0; i < m_tiles.size(); ++i) {
+        if (!m_allocated[i]) {
+            continue;
+        }
+        tiles.m_tiles[i] = m_tiles[i].lock();
+        if (!tiles.m_tiles[i]) {
+            const int tx = static_cast<int>(i % static_cast<std::size_t>(tiles.m_tilesX));
+            const int ty = static_cast<int>(i / static_cast<std::size_t>(tiles.m_tilesX));
+            expired.push_back(Rect{tx * TileBuffer::kTileSize,
+                                   ty * TileBuffer::kTileSize,
+                                   TileBuffer::kTileSize,
+                                   TileBuffer::kTileSize});
+        }
+    }
+    return tiles;
+}
+
+}  // namespace gimp
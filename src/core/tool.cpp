@@ -7,6 +7,9 @@
 
 #include "core/tool.h"
 
+#include "core/document.h"
+#include "core/tile_store.h"
+
 namespace gimp {
 
 bool Tool::onMousePress(const ToolInputEvent& event)
@@ -62,4 +65,11 @@ bool Tool::onKeyRelease(Qt::Key /*key*/, Qt::KeyboardModifiers /*modifiers*/)
     return false;
 }
 
+void Tool::invalidateRegion(const Layer& layer, const Rect& region) const
+{
+    if (document_) {
+        document_->tileStore().invalidateLayer(layer, region);
+    }
+}
+
 }  // namespace gimp
@@ -8,55 +8,17 @@
 #include "core/tools/brush_tool.h"
 
 #include "core/command_bus.h"
-#include "core/commands/draw_command.h"
+#include "core/commands/stroke_command.h"
+#include "core/dab_rasterizer.h"
 #include "core/document.h"
 #include "core/layer.h"
+#include "core/tile_store.h"
 #include "core/tool_factory.h"
 
 #include <algorithm>
-#include <cmath>
 
 namespace gimp {
 
-namespace {
-
-/**
- * @brief Interpolates points along a line between two stroke points.
- *
- * Uses tight spacing (10% of brush size) to ensure smooth strokes
- * without visible scalloping, especially for soft brushes.
- */
-std::vector<std::tuple<int, int, float>> interpolatePoints(int fromX,
-                                                           int fromY,
-                                                           float fromPressure,
-                                                           int toX,
-                                                           int toY,
-                                                           float toPressure,
-                                                           int brushSize)
-{
-    std::vector<std::tuple<int, int, float>> result;
-
-    int dx = toX - fromX;
-    int dy = toY - fromY;
-    float distance = std::sqrt(static_cast<float>(dx * dx + dy * dy));
-
-    // Spacing at 10% of brush size prevents visible scalloping on soft brushes
-    float spacing = std::max(1.0F, static_cast<float>(brushSize) * 0.1F);
-    int steps = std::max(1, static_cast<int>(distance / spacing));
-
-    for (int i = 0; i <= steps; ++i) {
-        float t = static_cast<float>(i) / static_cast<float>(steps);
-        int x = fromX + static_cast<int>(static_cast<float>(dx) * t);
-        int y = fromY + static_cast<int>(static_cast<float>(dy) * t);
-        float pressure = fromPressure + (toPressure - fromPressure) * t;
-        result.emplace_back(x, y, pressure);
-    }
-
-    return result;
-}
-
-}  // namespace
-
 BrushTool::BrushTool() : brush_(std::make_unique<SoftBrush>())
 {
     brush_->setHardness(hardness_);
@@ -80,41 +42,63 @@ void BrushTool::setVelocityDynamics(bool enabled)
     dynamics_.config().usePressure = !enabled;
 }
 
-void BrushTool::renderSegment(int fromX,
-                              int fromY,
-                              float fromPressure,
-                              int toX,
-                              int toY,
-                              float toPressure)
+void BrushTool::renderDabs(const std::vector<StrokeDab>& dabs)
 {
-    if (!activeLayer_) {
+    if (!activeLayer_ || dabs.empty()) {
         return;
     }
 
-    auto layer = activeLayer_;
-    auto* pixelData = layer->data().data();
-    int layerWidth = layer->width();
-    int layerHeight = layer->height();
+    const Rect region = StrokeCommand::dabBounds(dabs, stroke_.size);
+    recorder_.record(region);
 
-    std::uint32_t color = ToolFactory::instance().foregroundColor();
-    // Apply opacity to the alpha channel
-    std::uint8_t colorAlpha = static_cast<std::uint8_t>(color & 0xFF);
-    std::uint8_t adjustedAlpha =
-        static_cast<std::uint8_t>(static_cast<float>(colorAlpha) * opacity_);
-    color = (color & 0xFFFFFF00) | adjustedAlpha;
+    // Dabs only raise the stroke coverage; the layer is updated by compositeStroke()
+    DabRasterizer::instance().accumulate(*brush_, buffer_, dabs, stroke_.size);
+    buffer_.markDirty(region);
+    dabs_.insert(dabs_.end(), dabs.begin(), dabs.end());
+}
 
-    auto interpolated =
-        interpolatePoints(fromX, fromY, fromPressure, toX, toY, toPressure, brushSize_);
+void BrushTool::compositeStroke()
+{
+    const Rect dirty = buffer_.takeDirty();
+    if (!activeLayer_ || dirty.w <= 0 || dirty.h <= 0) {
+        return;
+    }
+
+    // Blend from the original pixels so the stroke is applied exactly once
+    recorder_.restoreRegion(dirty);
+    brush_->setPixelFormat(activeLayer_->pixelFormat());
+    brush_->compositeStroke(
+        activeLayer_->regionData(dirty), activeLayer_->width(), buffer_, dirty, stroke_.color);
+    invalidateRegion(*activeLayer_, dirty);
+}
+
+void BrushTool::prepareFrame()
+{
+    compositeStroke();
+}
+
+void BrushTool::extendStroke(const ToolInputEvent& event)
+{
+    const auto& lastPoint = interpolator_.lastPoint();
+    int newX = event.canvasPos.x();
+    int newY = event.canvasPos.y();
 
-    for (const auto& [x, y, pressure] : interpolated) {
-        brush_->renderDab(pixelData, layerWidth, layerHeight, x, y, brushSize_, color, pressure);
+    if (static_cast<float>(newX) != lastPoint.x || static_cast<float>(newY) != lastPoint.y) {
+        // Compute pressure from dynamics
+        DynamicsInput dynInput = dynamics_.update(newX, newY, event.pressure);
+        float effectivePressure = dynamics_.computePressure(dynInput);
+
+        renderDabs(interpolator_.addPoint(
+            static_cast<float>(newX), static_cast<float>(newY), effectivePressure));
     }
 }
 
 void BrushTool::beginStroke(const ToolInputEvent& event)
 {
-    strokePoints_.clear();
-    beforeState_.clear();
+    interpolator_.reset();
+    dabs_.clear();
+    recorder_.reset();
+    buffer_.reset();
     activeLayer_ = nullptr;
     dynamics_.beginStroke();
 
@@ -126,128 +110,99 @@ void BrushTool::beginStroke(const ToolInputEvent& event)
     if (!activeLayer_) {
         return;
     }
-    beforeState_ = activeLayer_->data();
+    recorder_.begin(activeLayer_);
+    buffer_.begin(Rect{0, 0, activeLayer_->width(), activeLayer_->height()});
+
+    // Latch the brush settings so the stroke can be replayed; opacity goes
+    // into the alpha channel of the dab color
+    std::uint32_t color = ToolFactory::instance().foregroundColor();
+    std::uint8_t colorAlpha = static_cast<std::uint8_t>(color & 0xFF);
+    std::uint8_t adjustedAlpha =
+        static_cast<std::uint8_t>(static_cast<float>(colorAlpha) * opacity_);
+    stroke_ = StrokeParams{};
+    stroke_.brush = StrokeBrush::Soft;
+    stroke_.size = brushSize_;
+    stroke_.hardness = brush_->hardness();
+    stroke_.color = (color & 0xFFFFFF00) | adjustedAlpha;
+
+    // Spacing at 10% of brush size prevents visible scalloping on soft brushes
+    interpolator_.setSpacing(std::max(1.0F, static_cast<float>(stroke_.size) * 0.1F));
 
     // Compute initial pressure from dynamics
     DynamicsInput dynInput =
         dynamics_.update(event.canvasPos.x(), event.canvasPos.y(), event.pressure);
     float effectivePressure = dynamics_.computePressure(dynInput);
 
-    strokePoints_.push_back({event.canvasPos.x(), event.canvasPos.y(), effectivePressure});
-
-    auto* pixelData = activeLayer_->data().data();
-    int layerWidth = activeLayer_->width();
-    int layerHeight = activeLayer_->height();
-
-    std::uint32_t color = ToolFactory::instance().foregroundColor();
-    std::uint8_t colorAlpha = static_cast<std::uint8_t>(color & 0xFF);
-    std::uint8_t adjustedAlpha =
-        static_cast<std::uint8_t>(static_cast<float>(colorAlpha) * opacity_);
-    color = (color & 0xFFFFFF00) | adjustedAlpha;
-
-    brush_->renderDab(pixelData,
-                      layerWidth,
-                      layerHeight,
-                      event.canvasPos.x(),
-                      event.canvasPos.y(),
-                      brushSize_,
-                      color,
-                      effectivePressure);
+    renderDabs(interpolator_.begin(static_cast<float>(event.canvasPos.x()),
+                                   static_cast<float>(event.canvasPos.y()),
+                                   effectivePressure));
 }
 
 void BrushTool::continueStroke(const ToolInputEvent& event)
 {
-    if (strokePoints_.empty()) {
-        return;
-    }
-
-    const auto& lastPoint = strokePoints_.back();
-    int newX = event.canvasPos.x();
-    int newY = event.canvasPos.y();
-
-    if (newX != lastPoint.x || newY != lastPoint.y) {
-        // Compute pressure from dynamics
-        DynamicsInput dynInput = dynamics_.update(newX, newY, event.pressure);
-        float effectivePressure = dynamics_.computePressure(dynInput);
-
-        renderSegment(lastPoint.x, lastPoint.y, lastPoint.pressure, newX, newY, effectivePressure);
-        strokePoints_.push_back({newX, newY, effectivePressure});
+    if (interpolator_.active()) {
+        extendStroke(event);
     }
 }
 
-std::shared_ptr<DrawCommand> BrushTool::buildDrawCommand(int minX, int maxX, int minY, int maxY)
+std::shared_ptr<StrokeCommand> BrushTool::buildStrokeCommand()
 {
-    for (const auto& pt : strokePoints_) {
-        int radius = brushSize_ / 2;
-        minX = std::min(minX, pt.x - radius);
-        maxX = std::max(maxX, pt.x + radius);
-        minY = std::min(minY, pt.y - radius);
-        maxY = std::max(maxY, pt.y + radius);
-    }
+    auto command = std::make_shared<StrokeCommand>(activeLayer_, stroke_, std::move(dabs_));
+    dabs_.clear();
 
-    if (minX > maxX || minY > maxY) {
-        strokePoints_.clear();
+    // The buffer bounds are the part of the layer the stroke changed
+    const Rect& changed = buffer_.bounds();
+    if (command->dabs().empty() || changed.w <= 0 || changed.h <= 0) {
+        recorder_.reset();
         return nullptr;
     }
 
-    int width = maxX - minX + 1;
-    int height = maxY - minY + 1;
-
-    return std::make_shared<DrawCommand>(activeLayer_, minX, minY, width, height);
+    // The dabs are already on the layer; the recorder knows what was under them
+    command->adoptCheckpoint(recorder_.finishSnapshot());
+    return command;
 }
 
 void BrushTool::endStroke(const ToolInputEvent& event)
 {
-    if (strokePoints_.empty() || beforeState_.empty()) {
-        strokePoints_.clear();
-        beforeState_.clear();
+    if (!interpolator_.active() || !recorder_.active()) {
+        interpolator_.reset();
+        recorder_.reset();
+        buffer_.reset();
         return;
     }
 
-    const auto& lastPoint = strokePoints_.back();
-    int newX = event.canvasPos.x();
-    int newY = event.canvasPos.y();
-    if (newX != lastPoint.x || newY != lastPoint.y) {
-        DynamicsInput dynInput = dynamics_.update(newX, newY, event.pressure);
-        float effectivePressure = dynamics_.computePressure(dynInput);
-        renderSegment(lastPoint.x, lastPoint.y, lastPoint.pressure, newX, newY, effectivePressure);
-        strokePoints_.push_back({newX, newY, effectivePressure});
-    }
+    extendStroke(event);
+    renderDabs(interpolator_.finish());
+    compositeStroke();
 
     if (!document_ || !commandBus_ || !activeLayer_) {
-        strokePoints_.clear();
-        beforeState_.clear();
+        recorder_.reset();
+        buffer_.reset();
         activeLayer_ = nullptr;
         return;
     }
 
-    auto drawCmd = buildDrawCommand(INT_MAX, INT_MIN, INT_MAX, INT_MIN);
-    if (!drawCmd) {
-        beforeState_.clear();
+    auto strokeCmd = buildStrokeCommand();
+    buffer_.reset();
+    if (!strokeCmd) {
         activeLayer_ = nullptr;
         return;
     }
 
-    std::vector<uint8_t> afterState = activeLayer_->data();
-
-    activeLayer_->data() = beforeState_;
-    drawCmd->captureBeforeState();
-
-    activeLayer_->data() = afterState;
-    drawCmd->captureAfterState();
-
-    commandBus_->dispatch(drawCmd);
+    commandBus_->dispatch(strokeCmd);
 
     ToolFactory::instance().markForegroundColorUsed();
 
-    strokePoints_.clear();
-    beforeState_.clear();
+    recorder_.reset();
     activeLayer_ = nullptr;
 }
 
 void BrushTool::cancelStroke()
 {
-    strokePoints_.clear();
+    interpolator_.reset();
+    dabs_.clear();
+    recorder_.reset();
+    buffer_.reset();
 }
 
 std::vector<ToolOption> BrushTool::getOptions() const
@@ -272,6 +227,12 @@ std::vector<ToolOption> BrushTool::getOptions() const
                    velocityDynamics(),
                    0.0F,                                                                      0.0F,
                    0.0F,                                                                                     {},
+                   0                                                                                              },
+        ToolOption{"smoothing",
+                   "Smooth Stroke",             ToolOption::Type::Checkbox,
+                   smoothing(),
+                   0.0F,                                                                      0.0F,
+                   0.0F,                                                                                     {},
                    0                                                                                              }
     };
 }
@@ -287,6 +248,8 @@ void BrushTool::setOptionValue(const std::string& optionId,
         setHardness(static_cast<float>(std::get<int>(value)) / 100.0F);
     } else if (optionId == "velocity_dynamics" && std::holds_alternative<bool>(value)) {
         setVelocityDynamics(std::get<bool>(value));
+    } else if (optionId == "smoothing" && std::holds_alternative<bool>(value)) {
+        setSmoothing(std::get<bool>(value));
     }
 }
 
@@ -305,6 +268,9 @@ std::variant<int, float, bool, std::string> BrushTool::getOptionValue(
     if (optionId == "velocity_dynamics") {
         return velocityDynamics();
     }
+    if (optionId == "smoothing") {
+        return smoothing();
+    }
     return 0;
 }
 
@@ -41,20 +41,13 @@ std::optional<std::uint32_t> ColorPickerTool::sampleColorAt(int x, int y) const
         return std::nullopt;
     }
 
-    const auto& data = layer->data();
-    const std::size_t offset = (static_cast<std::size_t>(y) * static_cast<std::size_t>(width) +
-                                static_cast<std::size_t>(x)) *
-                               4;
+    // Read through the const overload so sampling does not mark the layer dirty
+    const Layer& source = *layer;
+    const std::uint8_t* pixel =
+        source.row(y) + static_cast<std::size_t>(x) * source.bytesPerPixel();
 
-    // RGBA format: extract each channel
-    const std::uint8_t r = data[offset + 0];
-    const std::uint8_t g = data[offset + 1];
-    const std::uint8_t b = data[offset + 2];
-    const std::uint8_t a = data[offset + 3];
-
-    // Pack into 0xRRGGBBAA format
-    return (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) |
-           (static_cast<std::uint32_t>(b) << 8) | static_cast<std::uint32_t>(a);
+    // Packed as straight 0xRRGGBBAA whatever the layer format
+    return readColor(pixel, source.pixelFormat());
 }
 
 void ColorPickerTool::publishColorChanged(std::uint32_t color) const
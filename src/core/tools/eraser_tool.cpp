@@ -8,131 +8,70 @@
 #include "core/tools/eraser_tool.h"
 
 #include "core/command_bus.h"
-#include "core/commands/draw_command.h"
+#include "core/commands/stroke_command.h"
+#include "core/dab_rasterizer.h"
 #include "core/document.h"
 #include "core/layer.h"
+#include "core/tile_store.h"
 #include "core/tool_options.h"
 
 #include <algorithm>
-#include <cmath>
 
 namespace gimp {
 
-namespace {
-
-/**
- * @brief Interpolates points along a line between two stroke points.
- *
- * Uses linear interpolation to ensure smooth, continuous strokes without gaps.
- *
- * @param fromX Starting X position.
- * @param fromY Starting Y position.
- * @param fromPressure Starting pressure.
- * @param toX Ending X position.
- * @param toY Ending Y position.
- * @param toPressure Ending pressure.
- * @param brushSize Spacing is approximately 1/4 the brush size.
- * @return Vector of interpolated points including endpoints.
- */
-std::vector<std::tuple<int, int, float>> interpolatePoints(int fromX,
-                                                           int fromY,
-                                                           float fromPressure,
-                                                           int toX,
-                                                           int toY,
-                                                           float toPressure,
-                                                           int brushSize)
+void EraserTool::renderDabs(const std::vector<StrokeDab>& dabs)
 {
-    std::vector<std::tuple<int, int, float>> result;
-
-    int dx = toX - fromX;
-    int dy = toY - fromY;
-    float distance = std::sqrt(static_cast<float>(dx * dx + dy * dy));
-
-    float spacing = std::max(1.0F, static_cast<float>(brushSize) / 4.0F);
-    int steps = std::max(1, static_cast<int>(distance / spacing));
-
-    for (int i = 0; i <= steps; ++i) {
-        float t = static_cast<float>(i) / static_cast<float>(steps);
-        int x = fromX + static_cast<int>(static_cast<float>(dx) * t);
-        int y = fromY + static_cast<int>(static_cast<float>(dy) * t);
-        float pressure = fromPressure + (toPressure - fromPressure) * t;
-        result.emplace_back(x, y, pressure);
+    if (!activeLayer_ || dabs.empty()) {
+        return;
     }
 
-    return result;
-}
+    const Rect region = StrokeCommand::dabBounds(dabs, stroke_.size);
+    recorder_.record(region);
 
-}  // namespace
+    // Dabs only raise the stroke coverage; the layer is updated by compositeStroke()
+    DabRasterizer::instance().accumulate(eraser_, buffer_, dabs, stroke_.size);
+    buffer_.markDirty(region);
+    dabs_.insert(dabs_.end(), dabs.begin(), dabs.end());
+}
 
-void EraserTool::eraseAt(int x, int y, float pressure)
+void EraserTool::compositeStroke()
 {
-    if (!activeLayer_) {
+    const Rect dirty = buffer_.takeDirty();
+    if (!activeLayer_ || dirty.w <= 0 || dirty.h <= 0) {
         return;
     }
 
-    auto* pixelData = activeLayer_->data().data();
-    int layerWidth = activeLayer_->width();
-    int layerHeight = activeLayer_->height();
-
-    int radius = brushSize_ / 2;
-    int radiusSq = radius * radius;
-
-    int minX = std::max(0, x - radius);
-    int maxX = std::min(layerWidth - 1, x + radius);
-    int minY = std::max(0, y - radius);
-    int maxY = std::min(layerHeight - 1, y + radius);
-
-    for (int py = minY; py <= maxY; ++py) {
-        for (int px = minX; px <= maxX; ++px) {
-            int dx = px - x;
-            int dy = py - y;
-            int distSq = dx * dx + dy * dy;
-            if (distSq <= radiusSq) {
-                // Calculate distance-based falloff for softness
-                float dist = std::sqrt(static_cast<float>(distSq));
-                float normalizedDist = (radius > 0) ? dist / static_cast<float>(radius) : 0.0F;
-
-                // Apply hardness to falloff
-                // hardness=1.0: hard edge (full strength until the edge)
-                // hardness=0.0: soft edge (linear falloff from center)
-                float edgeFalloff = 1.0F;
-                if (hardness_ < 1.0F && normalizedDist > hardness_) {
-                    edgeFalloff = 1.0F - (normalizedDist - hardness_) / (1.0F - hardness_ + 0.001F);
-                    edgeFalloff = std::max(0.0F, edgeFalloff);
-                }
-
-                // Final erase strength combines pressure, opacity, and edge falloff
-                float eraseStrength = pressure * opacity_ * edgeFalloff;
-
-                std::uint8_t* pixel = pixelData + (py * layerWidth + px) * 4;
-                // Erase by reducing alpha (making pixels transparent)
-                float currentAlpha = static_cast<float>(pixel[3]);
-                float newAlpha = currentAlpha * (1.0F - eraseStrength);
-                pixel[3] = static_cast<std::uint8_t>(std::max(0.0F, newAlpha));
-            }
-        }
-    }
+    // Blend from the original pixels so the stroke is applied exactly once
+    recorder_.restoreRegion(dirty);
+    eraser_.setPixelFormat(activeLayer_->pixelFormat());
+    eraser_.compositeStroke(
+        activeLayer_->regionData(dirty), activeLayer_->width(), buffer_, dirty, 0);
+    invalidateRegion(*activeLayer_, dirty);
 }
 
-void EraserTool::renderSegment(int fromX,
-                               int fromY,
-                               float fromPressure,
-                               int toX,
-                               int toY,
-                               float toPressure)
+void EraserTool::prepareFrame()
 {
-    auto interpolated =
-        interpolatePoints(fromX, fromY, fromPressure, toX, toY, toPressure, brushSize_);
+    compositeStroke();
+}
 
-    for (const auto& [x, y, pressure] : interpolated) {
-        eraseAt(x, y, pressure);
+void EraserTool::extendStroke(const ToolInputEvent& event)
+{
+    const auto& lastPoint = interpolator_.lastPoint();
+    const auto newX = static_cast<float>(event.canvasPos.x());
+    const auto newY = static_cast<float>(event.canvasPos.y());
+
+    // Only render if the mouse moved
+    if (newX != lastPoint.x || newY != lastPoint.y) {
+        renderDabs(interpolator_.addPoint(newX, newY, event.pressure));
     }
 }
 
 void EraserTool::beginStroke(const ToolInputEvent& event)
 {
-    strokePoints_.clear();
-    beforeState_.clear();
+    interpolator_.reset();
+    dabs_.clear();
+    recorder_.reset();
+    buffer_.reset();
     activeLayer_ = nullptr;
 
     if (!document_ || document_->layers().count() == 0) {
@@ -144,105 +83,90 @@ void EraserTool::beginStroke(const ToolInputEvent& event)
     if (!activeLayer_) {
         return;
     }
-    beforeState_ = activeLayer_->data();
+    recorder_.begin(activeLayer_);
+    buffer_.begin(Rect{0, 0, activeLayer_->width(), activeLayer_->height()});
+
+    // Latch the eraser settings so the stroke can be replayed
+    stroke_ = StrokeParams{};
+    stroke_.brush = StrokeBrush::Eraser;
+    stroke_.size = brushSize_;
+    stroke_.hardness = hardness_;
+    stroke_.opacity = opacity_;
+    eraser_.setHardness(hardness_);
+    eraser_.setOpacity(opacity_);
+    interpolator_.setSpacing(std::max(1.0F, static_cast<float>(stroke_.size) / 4.0F));
 
     // Add first point and erase it
-    strokePoints_.push_back({event.canvasPos.x(), event.canvasPos.y(), event.pressure});
-    eraseAt(event.canvasPos.x(), event.canvasPos.y(), event.pressure);
+    renderDabs(interpolator_.begin(static_cast<float>(event.canvasPos.x()),
+                                   static_cast<float>(event.canvasPos.y()),
+                                   event.pressure));
 }
 
 void EraserTool::continueStroke(const ToolInputEvent& event)
 {
-    if (strokePoints_.empty()) {
-        return;
-    }
-
-    const auto& lastPoint = strokePoints_.back();
-    int newX = event.canvasPos.x();
-    int newY = event.canvasPos.y();
-
-    // Only render if the mouse moved
-    if (newX != lastPoint.x || newY != lastPoint.y) {
-        renderSegment(lastPoint.x, lastPoint.y, lastPoint.pressure, newX, newY, event.pressure);
-        strokePoints_.push_back({newX, newY, event.pressure});
+    if (interpolator_.active()) {
+        extendStroke(event);
     }
 }
 
-std::shared_ptr<DrawCommand> EraserTool::buildDrawCommand(int minX, int maxX, int minY, int maxY)
+std::shared_ptr<StrokeCommand> EraserTool::buildStrokeCommand()
 {
-    for (const auto& pt : strokePoints_) {
-        int radius = brushSize_ / 2;
-        minX = std::min(minX, pt.x - radius);
-        maxX = std::max(maxX, pt.x + radius);
-        minY = std::min(minY, pt.y - radius);
-        maxY = std::max(maxY, pt.y + radius);
-    }
+    auto command = std::make_shared<StrokeCommand>(activeLayer_, stroke_, std::move(dabs_));
+    dabs_.clear();
 
-    if (minX > maxX || minY > maxY) {
-        strokePoints_.clear();
+    // The buffer bounds are the part of the layer the stroke changed
+    const Rect& changed = buffer_.bounds();
+    if (command->dabs().empty() || changed.w <= 0 || changed.h <= 0) {
+        recorder_.reset();
         return nullptr;
     }
 
-    int width = maxX - minX + 1;
-    int height = maxY - minY + 1;
-
-    return std::make_shared<DrawCommand>(activeLayer_, minX, minY, width, height);
+    // The dabs are already on the layer; the recorder knows what was under them
+    command->adoptCheckpoint(recorder_.finishSnapshot());
+    return command;
 }
 
 void EraserTool::endStroke(const ToolInputEvent& event)
 {
-    if (strokePoints_.empty() || beforeState_.empty()) {
-        strokePoints_.clear();
-        beforeState_.clear();
+    if (!interpolator_.active() || !recorder_.active()) {
+        interpolator_.reset();
+        recorder_.reset();
+        buffer_.reset();
         return;
     }
 
     // Render the final segment
-    const auto& lastPoint = strokePoints_.back();
-    int newX = event.canvasPos.x();
-    int newY = event.canvasPos.y();
-    if (newX != lastPoint.x || newY != lastPoint.y) {
-        renderSegment(lastPoint.x, lastPoint.y, lastPoint.pressure, newX, newY, event.pressure);
-        strokePoints_.push_back({newX, newY, event.pressure});
-    }
+    extendStroke(event);
+    renderDabs(interpolator_.finish());
+    compositeStroke();
 
     if (!document_ || !commandBus_ || !activeLayer_) {
-        strokePoints_.clear();
-        beforeState_.clear();
+        recorder_.reset();
+        buffer_.reset();
         activeLayer_ = nullptr;
         return;
     }
 
-    // Create command for the affected region
-    auto drawCmd = buildDrawCommand(INT_MAX, INT_MIN, INT_MAX, INT_MIN);
-    if (!drawCmd) {
-        beforeState_.clear();
+    // Build the command from the recorded dabs and the tiles saved while erasing
+    auto strokeCmd = buildStrokeCommand();
+    buffer_.reset();
+    if (!strokeCmd) {
         activeLayer_ = nullptr;
         return;
     }
 
-    // The layer now has the "after" state (with the erased pixels)
-    // We need to swap in the "before" state, capture it, then swap back
-    std::vector<uint8_t> afterState = activeLayer_->data();
-
-    // Temporarily restore before state
-    activeLayer_->data() = beforeState_;
-    drawCmd->captureBeforeState();
-
-    // Restore after state (the erased stroke)
-    activeLayer_->data() = afterState;
-    drawCmd->captureAfterState();
-
-    commandBus_->dispatch(drawCmd);
+    commandBus_->dispatch(strokeCmd);
 
-    strokePoints_.clear();
-    beforeState_.clear();
+    recorder_.reset();
     activeLayer_ = nullptr;
 }
 
 void EraserTool::cancelStroke()
 {
-    strokePoints_.clear();
+    interpolator_.reset();
+    dabs_.clear();
+    recorder_.reset();
+    buffer_.reset();
 }
 
 std::vector<ToolOption> EraserTool::getOptions() const
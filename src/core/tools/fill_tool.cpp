@@ -11,6 +11,7 @@
 #include "core/commands/draw_command.h"
 #include "core/document.h"
 #include "core/layer.h"
+#include "core/tile_store.h"
 #include "core/tool_factory.h"
 
 #include <algorithm>
@@ -67,25 +68,41 @@ bool FillTool::colorMatches(std::uint32_t pixelColor, std::uint32_t targetColor)
            std::abs(pb - tb) <= tolerance_ && std::abs(pa - ta) <= tolerance_;
 }
 
-void FillTool::floodFill(int startX, int startY, std::uint32_t fillColor)
+Rect FillTool::floodFill(int startX, int startY, std::uint32_t fillColor)
 {
     if (!activeLayer_) {
-        return;
+        return {0, 0, 0, 0};
     }
 
-    std::vector<uint8_t>& data = activeLayer_->data();
     int width = activeLayer_->width();
     int height = activeLayer_->height();
 
     if (startX < 0 || startX >= width || startY < 0 || startY >= height) {
-        return;
+        return {0, 0, 0, 0};
+    }
+
+    // High bit-depth layers are matched through an 8-bit view (tolerance is in
+    // 8-bit steps); only the filled pixels are written back at full depth
+    const PixelFormat format = activeLayer_->pixelFormat();
+    const bool wide = describe(format).bytesPerChannel > 1;
+    std::vector<uint8_t> view;
+    std::uint8_t* widePixels = nullptr;
+    if (wide) {
+        view = activeLayer_->pixelsAs(PixelFormat::Rgba8);
+        widePixels = activeLayer_->data().data();
+    }
+    std::vector<uint8_t>& data = wide ? view : activeLayer_->data();
+
+    if (describe(format).premultiplied) {
+        // Compare and write in the layer's own representation
+        fillColor = premultiplyColor(fillColor);
     }
 
     std::uint32_t targetColor = getPixelColor(data, startX, startY, width);
 
     // If target is same as fill color, nothing to do
     if (targetColor == fillColor) {
-        return;
+        return {0, 0, 0, 0};
     }
 
     // Scanline flood fill algorithm using a stack
@@ -93,6 +110,12 @@ void FillTool::floodFill(int startX, int startY, std::uint32_t fillColor)
     std::stack<std::pair<int, int>> stack;
     stack.emplace(startX, startY);
 
+    // Bounding box of filled spans, reported to the tile store afterwards
+    int minX = startX;
+    int maxX = startX;
+    int minY = startY;
+    int maxY = startY;
+
     while (!stack.empty()) {
         auto [x, y] = stack.top();
         stack.pop();
@@ -114,12 +137,22 @@ void FillTool::floodFill(int startX, int startY, std::uint32_t fillColor)
             ++right;
         }
 
-        // Fill the span
+        // Fill the span, saving the tiles it overwrites first
+        recorder_.record(Rect{left, y, right - left + 1, 1});
         for (int px = left; px <= right; ++px) {
             if (colorMatches(getPixelColor(data, px, y, width), targetColor)) {
                 setPixelColor(data, px, y, width, fillColor);
+                if (widePixels) {
+                    const std::size_t index = static_cast<std::size_t>(y) * width + px;
+                    writeColor(
+                        widePixels + index * activeLayer_->bytesPerPixel(), format, fillColor);
+                }
             }
         }
+        minX = std::min(minX, left);
+        maxX = std::max(maxX, right);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
 
         // Check scanlines above and below
         bool aboveInside = false;
@@ -153,11 +186,16 @@ void FillTool::floodFill(int startX, int startY, std::uint32_t fillColor)
             }
         }
     }
+
+    const Rect bounds{minX, minY, maxX - minX + 1, maxY - minY + 1};
+    invalidateRegion(*activeLayer_, bounds);
+    return bounds;
 }
 
 void FillTool::beginStroke(const ToolInputEvent& event)
 {
-    beforeState_.clear();
+    recorder_.reset();
+    fillBounds_ = {0, 0, 0, 0};
     activeLayer_ = nullptr;
     fillPending_ = false;
 
@@ -170,16 +208,16 @@ void FillTool::beginStroke(const ToolInputEvent& event)
         return;
     }
 
-    // Capture the layer state before the fill
+    // Tiles are saved for undo as the fill reaches them
     activeLayer_ = document_->activeLayer();
     if (!activeLayer_) {
         return;
     }
-    beforeState_ = activeLayer_->data();
+    recorder_.begin(activeLayer_);
 
     // Perform the flood fill
     std::uint32_t fillColor = ToolFactory::instance().foregroundColor();
-    floodFill(event.canvasPos.x(), event.canvasPos.y(), fillColor);
+    fillBounds_ = floodFill(event.canvasPos.x(), event.canvasPos.y(), fillColor);
 
     fillPending_ = true;
 }
@@ -191,53 +229,41 @@ void FillTool::continueStroke(const ToolInputEvent& /*event*/)
 
 void FillTool::endStroke(const ToolInputEvent& /*event*/)
 {
-    if (!fillPending_ || beforeState_.empty() || !activeLayer_) {
-        beforeState_.clear();
+    if (!fillPending_ || !recorder_.active() || !activeLayer_) {
+        recorder_.reset();
         activeLayer_ = nullptr;
         fillPending_ = false;
         return;
     }
 
     if (!document_ || !commandBus_) {
-        beforeState_.clear();
+        recorder_.reset();
         activeLayer_ = nullptr;
         fillPending_ = false;
         return;
     }
 
-    int width = activeLayer_->width();
-    int height = activeLayer_->height();
-
-    // Create command for the entire layer (fill could affect any region)
-    auto drawCmd = std::make_shared<DrawCommand>(activeLayer_, 0, 0, width, height);
-
-    // The layer now has the "after" state (with the fill)
-    // Swap in the "before" state, capture it, then swap back
-    std::vector<uint8_t> afterState = activeLayer_->data();
+    // Only the bounds of the filled pixels are recorded; nothing to record if none changed
+    auto drawCmd = recorder_.finish(fillBounds_);
+    if (drawCmd) {
+        commandBus_->dispatch(drawCmd);
 
-    activeLayer_->data() = beforeState_;
-    drawCmd->captureBeforeState();
-
-    activeLayer_->data() = afterState;
-    drawCmd->captureAfterState();
-
-    commandBus_->dispatch(drawCmd);
-
-    // Mark the foreground color as used for recent colors tracking
-    ToolFactory::instance().markForegroundColorUsed();
+        // Mark the foreground color as used for recent colors tracking
+        ToolFactory::instance().markForegroundColorUsed();
+    }
 
-    beforeState_.clear();
     activeLayer_ = nullptr;
     fillPending_ = false;
 }
 
 void FillTool::cancelStroke()
 {
-    if (!beforeState_.empty() && activeLayer_) {
+    if (recorder_.active() && activeLayer_) {
         // Restore original state
-        activeLayer_->data() = beforeState_;
+        recorder_.restore();
+        invalidateRegion(*activeLayer_, fillBounds_);
     }
-    beforeState_.clear();
+    recorder_.reset();
     activeLayer_ = nullptr;
     fillPending_ = false;
 }
@@ -8,14 +8,12 @@
 #include "core/tools/gradient_tool.h"
 
 #include "core/command_bus.h"
-#include "core/commands/draw_command.h"
+#include "core/commands/gradient_command.h"
 #include "core/document.h"
 #include "core/layer.h"
+#include "core/tile_store.h"
 #include "core/tool_factory.h"
 
-#include <algorithm>
-#include <cmath>
-
 namespace gimp {
 
 std::string GradientTool::id() const
@@ -63,11 +61,6 @@ void GradientTool::beginStroke(const ToolInputEvent& event)
     startY_ = event.canvasPos.y();
     endX_ = event.canvasPos.x();
     endY_ = event.canvasPos.y();
-
-    // Capture before state
-    command_ = std::make_shared<DrawCommand>(
-        activeLayer_, 0, 0, activeLayer_->width(), activeLayer_->height());
-    command_->captureBeforeState();
 }
 
 void GradientTool::continueStroke(const ToolInputEvent& event)
@@ -80,16 +73,7 @@ void GradientTool::continueStroke(const ToolInputEvent& event)
 void GradientTool::endStroke(const ToolInputEvent& event)
 {
     auto doc = document();
-    if (!doc || !activeLayer_ || !command_) {
-        beforeState_.clear();
-        command_ = nullptr;
-        activeLayer_ = nullptr;
-        return;
-    }
-
-    if (!commandBus_) {
-        beforeState_.clear();
-        command_ = nullptr;
+    if (!doc || !activeLayer_ || !commandBus_) {
         activeLayer_ = nullptr;
         return;
     }
@@ -108,178 +92,32 @@ void GradientTool::endStroke(const ToolInputEvent& event)
                                  ? backgroundColor
                                  : 0x00000000;  // Transparent
 
-    // Apply gradient
-    if (mode_ == GradientMode::Linear) {
-        applyLinearGradient(activeLayer_, foregroundColor, endColor);
-    } else {
-        applyRadialGradient(activeLayer_, foregroundColor, endColor);
-    }
-
-    // Capture after state and dispatch command
-    command_->captureAfterState();
-    commandBus_->dispatch(command_);
+    GradientParams params;
+    params.mode = mode_;
+    params.startX = startX_;
+    params.startY = startY_;
+    params.endX = endX_;
+    params.endY = endY_;
+    params.startColor = foregroundColor;
+    params.endColor = endColor;
+
+    // The command snapshots the layer and renders the gradient when dispatched
+    auto command = std::make_shared<GradientCommand>(activeLayer_, params);
+    command->captureBeforeState();
+    commandBus_->dispatch(command);
+    invalidateRegion(*activeLayer_, Rect{0, 0, activeLayer_->width(), activeLayer_->height()});
 
-    beforeState_.clear();
-    command_ = nullptr;
     activeLayer_ = nullptr;
 }
 
 void GradientTool::cancelStroke()
 {
-    beforeState_.clear();
-    command_ = nullptr;
     activeLayer_ = nullptr;
 }
 
-void GradientTool::applyLinearGradient(const std::shared_ptr<Layer>& layer,
-                                       std::uint32_t startColor,
-                                       std::uint32_t endColor) const
-{
-    if (!layer) {
-        return;
-    }
-
-    auto& data = layer->data();
-    int width = layer->width();
-    int height = layer->height();
-
-    if (data.empty() || width <= 0 || height <= 0) {
-        return;
-    }
-
-    // Calculate gradient vector
-    float dx = static_cast<float>(endX_ - startX_);
-    float dy = static_cast<float>(endY_ - startY_);
-    float distSq = dx * dx + dy * dy;
-
-    // Avoid division by zero
-    if (distSq < 0.001F) {
-        // Degenerate case: start and end are same, just fill with start color
-        std::uint32_t r = (startColor >> 24) & 0xFF;
-        std::uint32_t g = (startColor >> 16) & 0xFF;
-        std::uint32_t b = (startColor >> 8) & 0xFF;
-        std::uint32_t a = startColor & 0xFF;
-
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int idx = (y * width + x) * 4;
-                data[idx] = r;
-                data[idx + 1] = g;
-                data[idx + 2] = b;
-                data[idx + 3] = a;
-            }
-        }
-        return;
-    }
-
-    // Fill each pixel with interpolated color
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            // Vector from start point to current pixel
-            float px = static_cast<float>(x - startX_);
-            float py = static_cast<float>(y - startY_);
-
-            // Project onto gradient vector
-            float t = (px * dx + py * dy) / distSq;
-            t = std::clamp(t, 0.0F, 1.0F);
-
-            // Interpolate color
-            std::uint32_t color = lerpColor(startColor, endColor, t);
-
-            int idx = (y * width + x) * 4;
-            data[idx] = (color >> 24) & 0xFF;
-            data[idx + 1] = (color >> 16) & 0xFF;
-            data[idx + 2] = (color >> 8) & 0xFF;
-            data[idx + 3] = color & 0xFF;
-        }
-    }
-}
-
-void GradientTool::applyRadialGradient(const std::shared_ptr<Layer>& layer,
-                                       std::uint32_t startColor,
-                                       std::uint32_t endColor) const
-{
-    if (!layer) {
-        return;
-    }
-
-    auto& data = layer->data();
-    int width = layer->width();
-    int height = layer->height();
-
-    if (data.empty() || width <= 0 || height <= 0) {
-        return;
-    }
-
-    // Center and radius
-    float cx = static_cast<float>(startX_);
-    float cy = static_cast<float>(startY_);
-
-    float dx = static_cast<float>(endX_ - startX_);
-    float dy = static_cast<float>(endY_ - startY_);
-    float radius = std::sqrt(dx * dx + dy * dy);
-
-    // Avoid division by zero
-    if (radius < 0.001F) {
-        // Degenerate case: fill with start color
-        std::uint32_t r = (startColor >> 24) & 0xFF;
-        std::uint32_t g = (startColor >> 16) & 0xFF;
-        std::uint32_t b = (startColor >> 8) & 0xFF;
-        std::uint32_t a = startColor & 0xFF;
-
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int idx = (y * width + x) * 4;
-                data[idx] = r;
-                data[idx + 1] = g;
-                data[idx + 2] = b;
-                data[idx + 3] = a;
-            }
-        }
-        return;
-    }
-
-    // Fill each pixel with interpolated color based on distance from center
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            float px = static_cast<float>(x) - cx;
-            float py = static_cast<float>(y) - cy;
-            float dist = std::sqrt(px * px + py * py);
-
-            float t = dist / radius;
-            t = std::clamp(t, 0.0F, 1.0F);
-
-            // Interpolate color
-            std::uint32_t color = lerpColor(startColor, endColor, t);
-
-            int idx = (y * width + x) * 4;
-            data[idx] = (color >> 24) & 0xFF;
-            data[idx + 1] = (color >> 16) & 0xFF;
-            data[idx + 2] = (color >> 8) & 0xFF;
-            data[idx + 3] = color & 0xFF;
-        }
-    }
-}
-
 std::uint32_t GradientTool::lerpColor(std::uint32_t color1, std::uint32_t color2, float t)
 {
-    auto r1 = static_cast<float>((color1 >> 24) & 0xFF);
-    auto g1 = static_cast<float>((color1 >> 16) & 0xFF);
-    auto b1 = static_cast<float>((color1 >> 8) & 0xFF);
-    auto a1 = static_cast<float>(color1 & 0xFF);
-
-    auto r2 = static_cast<float>((color2 >> 24) & 0xFF);
-    auto g2 = static_cast<float>((color2 >> 16) & 0xFF);
-    auto b2 = static_cast<float>((color2 >> 8) & 0xFF);
-    auto a2 = static_cast<float>(color2 & 0xFF);
-
-    auto r = static_cast<std::uint8_t>(r1 * (1.0F - t) + r2 * t);
-    auto g = static_cast<std::uint8_t>(g1 * (1.0F - t) + g2 * t);
-    auto b = static_cast<std::uint8_t>(b1 * (1.0F - t) + b2 * t);
-    auto a = static_cast<std::uint8_t>(a1 * (1.0F - t) + a2 * t);
-
-    return (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) |
-           (static_cast<std::uint32_t>(b) << 8) | static_cast<std::uint32_t>(a);
+    return GradientCommand::lerpColor(color1, color2, t);
 }
 
 std::vector<ToolOption> GradientTool::getOptions() const
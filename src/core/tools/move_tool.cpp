@@ -10,7 +10,9 @@
 #include "core/command_bus.h"
 #include "core/commands/move_command.h"
 #include "core/layer.h"
+#include "core/pixel_format.h"
 #include "core/selection_manager.h"
+#include "core/tile_store.h"
 
 #include <QImage>
 #include <QPainter>
@@ -130,6 +132,8 @@ void MoveTool::beginStroke(const ToolInputEvent& event)
     // Only clear source if not in copy mode (Shift+Alt = copy, Ctrl+Alt = cut)
     if (!effectiveCopyMode) {
         buffer_.clearSourcePixels(layer);
+        invalidateRegion(
+            *layer, Rect{clippedRect.x(), clippedRect.y(), clippedRect.width(), clippedRect.height()});
     }
 }
 
@@ -292,6 +296,8 @@ void MoveTool::commitMove()
         int layerWidth = targetLayer_->width();
         int layerHeight = targetLayer_->height();
         constexpr int kPixelSize = 4;
+        const std::size_t layerPixelSize = targetLayer_->bytesPerPixel();
+        const PixelFormat format = targetLayer_->pixelFormat();
 
         const std::vector<std::uint8_t>& srcBuf = scaled ? scaledBuf : buffer_.data();
         int srcW = scaled ? scaledSize.width() : buffer_.width();
@@ -311,12 +317,15 @@ void MoveTool::commitMove()
 
                 std::size_t srcOffset = (static_cast<std::size_t>(row) * srcW + col) * kPixelSize;
                 std::size_t dstOffset =
-                    (static_cast<std::size_t>(destPy) * layerWidth + destPx) * kPixelSize;
+                    (static_cast<std::size_t>(destPy) * layerWidth + destPx) * layerPixelSize;
 
                 // Only paste non-transparent pixels (check alpha)
                 if (srcBuf[srcOffset + 3] > 0) {
-                    std::memcpy(
-                        layerData.data() + dstOffset, srcBuf.data() + srcOffset, kPixelSize);
+                    convertPixels(layerData.data() + dstOffset,
+                                  srcBuf.data() + srcOffset,
+                                  1,
+                                  PixelFormat::Rgba8,
+                                  format);
                 }
             }
         }
@@ -338,6 +347,8 @@ void MoveTool::commitMove()
         pasteBuffer(offset, hasScale);
         cmd->captureAfterState();
     }
+    invalidateRegion(*targetLayer_,
+                     Rect{unionRect.x(), unionRect.y(), unionRect.width(), unionRect.height()});
 
     // Dispatch command
     if (commandBus_) {
@@ -376,6 +387,9 @@ void MoveTool::cancelMove()
     // Only restore if we were in cut mode (source was cleared)
     if (!effectiveCopyMode) {
         buffer_.pasteToLayer(targetLayer_, QPoint(0, 0));
+        const QRect srcRect = buffer_.sourceRect();
+        invalidateRegion(*targetLayer_,
+                         Rect{srcRect.x(), srcRect.y(), srcRect.width(), srcRect.height()});
     }
 
     clearFloatingState();
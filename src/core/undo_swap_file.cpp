@@ -0,0 +1,304 @@
+/**
+ * @file undo_swap_file.cpp
+ * @brief Implementation of UndoSwapFile, SwapBlock and SwappedTiles.
+ * @author Laurent Jiang
+ * @date 2026-02-22
+ */
+
+#include "core/undo_swap_file.h"
+
+#include <random>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace gimp {
+
+namespace {
+
+/// Returns true if [offset, offset + size) lies inside the extent.
+bool fitsExtent(const UndoSwapFile::Extent& extent, std::uint64_t offset, std::size_t size)
+{
+    return offset <= extent.size && size <= extent.size - offset;
+}
+
+}  // namespace
+
+std::shared_ptr<UndoSwapFile> UndoSwapFile::create(const std::filesystem::path& directory)
+{
+    std::random_device random;
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const auto path =
+            directory / ("gimp-remake-undo-" + std::to_string(random()) + ".swap");
+        std::error_code error;
+        if (std::filesystem::exists(path, error)) {
+            continue;
+        }
+
+        std::fstream file(path,
+                          std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            return std::shared_ptr<UndoSwapFile>(new UndoSwapFile(path, std::move(file)));
+        }
+    }
+    return nullptr;
+}
+
+UndoSwapFile::UndoSwapFile(std::filesystem::path path, std::fstream file)
+    : m_path(std::move(path)),
+      m_file(std::move(file))
+{
+}
+
+UndoSwapFile::~UndoSwapFile()
+{
+    m_file.close();
+    std::error_code error;
+    std::filesystem::remove(m_path, error);
+}
+
+std::optional<UndoSwapFile::Extent> UndoSwapFile::allocate(std::uint64_t size)
+{
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_used += size;
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+        if (it->second < size) {
+            continue;
+        }
+        const Extent extent{it->first, size};
+        const std::uint64_t remaining = it->second - size;
+        m_free.erase(it);
+        if (remaining > 0) {
+            m_free.emplace(extent.offset + size, remaining);
+        }
+        return extent;
+    }
+
+    const Extent extent{m_end, size};
+    m_end += size;
+    return extent;
+}
+
+bool UndoSwapFile::write(const Extent& extent,
+                         std::uint64_t offset,
+                         const void* data,
+                         std::size_t size)
+{
+    if (!fitsExtent(extent, offset, size)) {
+        return false;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_file.clear();
+    m_file.seekp(static_cast<std::streamoff>(extent.offset + offset));
+    m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return m_file.good();
+}
+
+bool UndoSwapFile::read(const Extent& extent, std::uint64_t offset, void* out, std::size_t size)
+{
+    if (!fitsExtent(extent, offset, size)) {
+        return false;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_file.clear();
+    // Pending writes must reach the file before reading through the same stream
+    m_file.flush();
+    m_file.seekg(static_cast<std::streamoff>(extent.offset + offset));
+    m_file.read(static_cast<char*>(out), static_cast<std::streamsize>(size));
+    return m_file.gcount() == static_cast<std::streamsize>(size);
+}
+
+void UndoSwapFile::release(const Extent& extent)
+{
+    if (extent.size == 0) {
+        return;
+    }
+
+    std::lock_guard lock(m_mutex);
+    m_used -= extent.size;
+
+    Extent merged = extent;
+    auto next = m_free.lower_bound(merged.offset);
+    if (next != m_free.end() && merged.offset + merged.size == next->first) {
+        merged.size += next->second;
+        next = m_free.erase(next);
+    }
+    if (next != m_free.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == merged.offset) {
+            merged.offset = previous->first;
+            merged.size += previous->second;
+            m_free.erase(previous);
+        }
+    }
+
+    // A hole at the end of the file just shortens the used part
+    if (merged.offset + merged.size == m_end) {
+        m_end = merged.offset;
+    } else {
+        m_free.emplace(merged.offset, merged.size);
+    }
+}
+
+std::uint64_t UndoSwapFile::usedBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_used;
+}
+
+SwapBlock::~SwapBlock()
+{
+    reset();
+}
+
+SwapBlock::SwapBlock(SwapBlock&& other) noexcept
+    : m_swap(std::move(other.m_swap)),
+      m_extent(std::exchange(other.m_extent, {}))
+{
+}
+
+SwapBlock& SwapBlock::operator=(SwapBlock&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_swap = std::move(other.m_swap);
+        m_extent = std::exchange(other.m_extent, {});
+    }
+    return *this;
+}
+
+bool SwapBlock::allocate(const std::shared_ptr<UndoSwapFile>& swap, std::uint64_t size)
+{
+    reset();
+    if (!swap) {
+        return false;
+    }
+
+    const auto extent = swap->allocate(size);
+    if (!extent) {
+        return false;
+    }
+    m_swap = swap;
+    m_extent = *extent;
+    return true;
+}
+
+bool SwapBlock::store(const std::shared_ptr<UndoSwapFile>& swap,
+                      const std::vector<std::uint8_t>& data)
+{
+    reset();
+    if (data.empty()) {
+        return swap != nullptr;
+    }
+    if (!allocate(swap, data.size()) || !write(0, data.data(), data.size())) {
+        reset();
+        return false;
+    }
+    return true;
+}
+
+bool SwapBlock::load(std::vector<std::uint8_t>& out) const
+{
+    out.resize(static_cast<std::size_t>(m_extent.size));
+    return out.empty() || read(0, out.data(), out.size());
+}
+
+bool SwapBlock::write(std::uint64_t offset, const void* data, std::size_t size)
+{
+    return m_swap && m_swap->write(m_extent, offset, data, size);
+}
+
+bool SwapBlock::read(std::uint64_t offset, void* out, std::size_t size) const
+{
+    return m_swap && m_swap->read(m_extent, offset, out, size);
+}
+
+void SwapBlock::reset()
+{
+    if (m_swap) {
+        m_swap->release(m_extent);
+    }
+    m_swap.reset();
+    m_extent = {};
+}
+
+bool SwappedTiles::store(const std::shared_ptr<UndoSwapFile>& swap, const TileBuffer& tiles)
+{
+    reset();
+    if (!swap) {
+        return false;
+    }
+
+    std::vector<std::uint32_t> indices;
+    for (int ty = 0; ty < tiles.tilesY(); ++ty) {
+        for (int tx = 0; tx < tiles.tilesX(); ++tx) {
+            if (tiles.ownsTile(tx, ty)) {
+                indices.push_back(static_cast<std::uint32_t>(ty * tiles.tilesX() + tx));
+            }
+        }
+    }
+
+    if (!indices.empty()) {
+        if (!m_block.allocate(swap, indices.size() * TileBuffer::kTileBytes)) {
+            return false;
+        }
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            const int tx = static_cast<int>(indices[i]) % tiles.tilesX();
+            const int ty = static_cast<int>(indices[i]) / tiles.tilesX();
+            if (!m_block.write(i * TileBuffer::kTileBytes,
+                               tiles.tileData(tx, ty),
+                               TileBuffer::kTileBytes)) {
+                m_block.reset();
+                return false;
+            }
+        }
+    }
+
+    // Written tiles are freed once the caller drops its buffer; the rest stay shared
+    TileBuffer resident = tiles;
+    for (const std::uint32_t index : indices) {
+        resident.releaseTile(static_cast<int>(index) % tiles.tilesX(),
+                             static_cast<int>(index) / tiles.tilesX());
+    }
+    m_resident = std::move(resident);
+    m_indices = std::move(indices);
+    m_stored = true;
+    return true;
+}
+
+bool SwappedTiles::load(TileBuffer& tiles) const
+{
+    if (!m_stored) {
+        return false;
+    }
+
+    TileBuffer restored = m_resident;
+    for (std::size_t i = 0; i < m_indices.size(); ++i) {
+        const int tx = static_cast<int>(m_indices[i]) % restored.tilesX();
+        const int ty = static_cast<int>(m_indices[i]) / restored.tilesX();
+        if (!m_block.read(i * TileBuffer::kTileBytes,
+                          restored.mutableTileData(tx, ty),
+                          TileBuffer::kTileBytes)) {
+            return false;
+        }
+    }
+    tiles = std::move(restored);
+    return true;
+}
+
+void SwappedTiles::reset()
+{
+    m_block.reset();
+    m_indices.clear();
+    m_indices.shrink_to_fit();
+    m_resident = TileBuffer();
+    m_stored = false;
+}
+
+}  // namespace gimp
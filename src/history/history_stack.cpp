@@ -8,16 +8,47 @@
 #include "history/history_stack.h"
 
 #include "core/command.h"
+#include "core/commands/replayable_command.h"
+#include "core/layer.h"
+
+#include <algorithm>
 
 namespace gimp {
+namespace {
+/// Returns the entry as a replayable command on the given layer, or null.
+ReplayableCommand* run_member(const std::shared_ptr<Command>& entry,
+                              const std::shared_ptr<Layer>& layer)
+{
+    auto* replayable = dynamic_cast<ReplayableCommand*>(entry.get());
+    if (replayable == nullptr || !layer || replayable->layer() != layer) {
+        return nullptr;
+    }
+    return replayable;
+}
+}  // namespace
+
 void HistoryStack::push(std::shared_ptr<Command> command)
 {
     if (!command) {
         return;
     }
 
+    if (auto* replayable = dynamic_cast<ReplayableCommand*>(command.get())) {
+        place_checkpoint(*replayable);
+    }
     undo_stack_.push_back(std::move(command));
-    redo_stack_.clear();
+    if (!redo_stack_.empty()) {
+        // The discarded steps may have shared tiles with the remaining ones
+        redo_stack_.clear();
+        measure_byte_size();
+        return;
+    }
+
+    // The new checkpoint may share tiles the previous command counted as its own
+    remeasure(*undo_stack_.back());
+    if (undo_stack_.size() > 1) {
+        remeasure(*undo_stack_[undo_stack_.size() - 2]);
+    }
 }
 
 bool HistoryStack::undo()
@@ -29,7 +60,13 @@ bool HistoryStack::undo()
     auto command = undo_stack_.back();
     undo_stack_.pop_back();
 
-    command->undo();
+    auto* replayable = dynamic_cast<ReplayableCommand*>(command.get());
+    if (replayable != nullptr && !replayable->hasCheckpoint()) {
+        replay_to(*replayable);
+    } else {
+        command->undo();
+    }
+    remeasure(*command);
     redo_stack_.push_back(std::move(command));
 
     return true;
@@ -47,6 +84,24 @@ bool HistoryStack::redo()
     command->apply();
     undo_stack_.push_back(std::move(command));
 
+    // Applying may capture a checkpoint that shares tiles with the previous one
+    remeasure(*undo_stack_.back());
+    if (undo_stack_.size() > 1) {
+        remeasure(*undo_stack_[undo_stack_.size() - 2]);
+    }
+
+    return true;
+}
+
+bool HistoryStack::merge_top(Command& command)
+{
+    if (undo_stack_.empty() || !redo_stack_.empty()) {
+        return false;
+    }
+    if (!undo_stack_.back()->mergeWith(command)) {
+        return false;
+    }
+    remeasure(*undo_stack_.back());
     return true;
 }
 
@@ -54,6 +109,8 @@ void HistoryStack::clear()
 {
     undo_stack_.clear();
     redo_stack_.clear();
+    sizes_.clear();
+    bytes_ = 0;
 }
 
 bool HistoryStack::can_undo() const
@@ -75,4 +132,140 @@ size_t HistoryStack::redo_size() const
 {
     return redo_stack_.size();
 }
+
+size_t HistoryStack::byte_size() const
+{
+    return bytes_;
+}
+
+size_t HistoryStack::measure_byte_size()
+{
+    sizes_.clear();
+    bytes_ = 0;
+    for (const auto& command : undo_stack_) {
+        remeasure(*command);
+    }
+    for (const auto& command : redo_stack_) {
+        remeasure(*command);
+    }
+    return bytes_;
+}
+
+size_t HistoryStack::spill_oldest(const std::shared_ptr<UndoSwapFile>& swap, size_t budget)
+{
+    for (size_t i = 0; i + 1 < undo_stack_.size() && bytes_ > budget; ++i) {
+        if (sizes_[undo_stack_[i].get()] > 0 && undo_stack_[i]->spill(swap)) {
+            remeasure(*undo_stack_[i]);
+        }
+    }
+    return bytes_;
+}
+
+size_t HistoryStack::drop_oldest()
+{
+    if (undo_stack_.empty()) {
+        return 0;
+    }
+
+    const size_t before = bytes_;
+    drop_front();
+    // Tiles the dropped command shared may now be held by a single command
+    measure_byte_size();
+    return before > bytes_ ? before - bytes_ : 0;
+}
+
+void HistoryStack::drop_front()
+{
+    const auto command = undo_stack_.front();
+    undo_stack_.pop_front();
+
+    // The next command of a run may depend on the dropped checkpoint
+    const auto* dropped = dynamic_cast<const ReplayableCommand*>(command.get());
+    if (dropped == nullptr) {
+        return;
+    }
+    std::shared_ptr<Command> next;
+    if (!undo_stack_.empty()) {
+        next = undo_stack_.front();
+    } else if (!redo_stack_.empty()) {
+        next = redo_stack_.back();
+    }
+    auto* dependent = run_member(next, dropped->layer());
+    if (dependent == nullptr || dependent->hasCheckpoint()) {
+        return;
+    }
+
+    // Without a base the dependent command can no longer be undone either
+    if (!dependent->rebaseOnto(*dropped) && !undo_stack_.empty()) {
+        drop_front();
+    }
+}
+
+void HistoryStack::set_checkpoint_interval(size_t commands)
+{
+    checkpoint_interval_ = std::max<size_t>(1, commands);
+}
+
+void HistoryStack::set_checkpoint_cost(size_t pixels)
+{
+    checkpoint_cost_ = pixels;
+}
+
+void HistoryStack::place_checkpoint(ReplayableCommand& command) const
+{
+    // Walk back over the run to its last checkpoint, adding up the work an
+    // undo of this command would replay
+    size_t commands = 0;
+    size_t cost = 0;
+    for (auto it = undo_stack_.rbegin(); it != undo_stack_.rend(); ++it) {
+        const auto* previous = run_member(*it, command.layer());
+        if (previous == nullptr) {
+            break;
+        }
+        ++commands;
+        cost += previous->replayCost();
+        if (previous->hasCheckpoint()) {
+            if (commands < checkpoint_interval_ && cost < checkpoint_cost_) {
+                command.dropCheckpoint();
+            }
+            return;
+        }
+    }
+    // First command of a run: its checkpoint is kept
+}
+
+void HistoryStack::remeasure(const Command& command)
+{
+    const size_t bytes = command.byteSize();
+    size_t& recorded = sizes_[&command];
+    bytes_ = bytes_ - recorded + bytes;
+    recorded = bytes;
+}
+
+void HistoryStack::replay_to(ReplayableCommand& command)
+{
+    // The commands before it in the run lead back to the nearest checkpoint
+    size_t first = undo_stack_.size();
+    ReplayableCommand* base = nullptr;
+    while (first > 0 && base == nullptr) {
+        auto* previous = run_member(undo_stack_[first - 1], command.layer());
+        if (previous == nullptr) {
+            break;
+        }
+        --first;
+        if (previous->hasCheckpoint()) {
+            base = previous;
+        }
+    }
+    if (base == nullptr || !base->restoreCheckpoint()) {
+        return;
+    }
+    // Restoring may have paged the base checkpoint back in
+    remeasure(*base);
+
+    Layer& layer = *command.layer();
+    for (size_t i = first; i < undo_stack_.size(); ++i) {
+        run_member(undo_stack_[i], command.layer())->replay(layer);
+    }
+}
 }  // namespace gimp
@@ -7,6 +7,9 @@
 
 #include "history/simple_history_manager.h"
 
+#include "core/event_bus.h"
+#include "core/events.h"
+#include "core/undo_swap_file.h"
 #include "history/history_stack.h"
 
 namespace gimp {
@@ -21,23 +24,44 @@ void SimpleHistoryManager::push(std::shared_ptr<Command> command)
 {
     if (stack_) {
         stack_->push(std::move(command));
+        enforce_budget();
+        publish_changed();
     }
 }
 
 bool SimpleHistoryManager::undo()
 {
-    return stack_ && stack_->undo();
+    if (!stack_ || !stack_->undo()) {
+        return false;
+    }
+    publish_changed();
+    return true;
 }
 
 bool SimpleHistoryManager::redo()
 {
-    return stack_ && stack_->redo();
+    if (!stack_ || !stack_->redo()) {
+        return false;
+    }
+    publish_changed();
+    return true;
+}
+
+bool SimpleHistoryManager::coalesce(const std::shared_ptr<Command>& command)
+{
+    if (!stack_ || !command || !stack_->merge_top(*command)) {
+        return false;
+    }
+    enforce_budget();
+    publish_changed();
+    return true;
 }
 
 void SimpleHistoryManager::clear()
 {
     if (stack_) {
         stack_->clear();
+        publish_changed();
     }
 }
 
@@ -60,4 +84,72 @@ size_t SimpleHistoryManager::redo_size() const
 {
     return stack_ ? stack_->redo_size() : 0;
 }
+
+void SimpleHistoryManager::set_memory_budget(size_t bytes)
+{
+    budget_ = bytes;
+    if (stack_) {
+        enforce_budget();
+        publish_changed();
+    }
+}
+
+size_t SimpleHistoryManager::byte_size() const
+{
+    return stack_ ? stack_->byte_size() : 0;
+}
+
+void SimpleHistoryManager::set_swap_file(std::shared_ptr<UndoSwapFile> swap)
+{
+    swap_ = std::move(swap);
+    if (stack_) {
+        enforce_budget();
+        publish_changed();
+    }
+}
+
+void SimpleHistoryManager::set_swap_budget(size_t bytes)
+{
+    swap_budget_ = bytes;
+    if (stack_) {
+        enforce_budget();
+        publish_changed();
+    }
+}
+
+size_t SimpleHistoryManager::swap_size() const
+{
+    return swap_ ? static_cast<size_t>(swap_->usedBytes()) : 0;
+}
+
+void SimpleHistoryManager::enforce_budget()
+{
+    if (stack_->byte_size() <= budget_ && swap_size() <= swap_budget_) {
+        return;
+    }
+
+    // The running total may overestimate; evict only on an exact measure
+    size_t bytes = stack_->measure_byte_size();
+    if (bytes > budget_ && swap_) {
+        bytes = stack_->spill_oldest(swap_, budget_);
+    }
+
+    // Oldest steps go first; the newest one is kept so it can always be undone.
+    // Each drop re-measures, since the next step may now hold tiles it shared.
+    while ((bytes > budget_ || swap_size() > swap_budget_) && stack_->undo_size() > 1) {
+        stack_->drop_oldest();
+        bytes = stack_->byte_size();
+    }
+}
+
+void SimpleHistoryManager::publish_changed() const
+{
+    HistoryChangedEvent event;
+    event.undoCount = stack_->undo_size();
+    event.redoCount = stack_->redo_size();
+    event.byteSize = stack_->byte_size();
+    event.byteBudget = budget_;
+    event.swapSize = swap_size();
+    EventBus::instance().publish(event);
+}
 }  // namespace gimp
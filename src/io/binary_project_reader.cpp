@@ -65,8 +65,8 @@ std::vector<uint8_t> decompressLZ4(const std::vector<char>& compressed, size_t u
     return decompressed;
 }
 
-// Deserialize a layer from bytes
-std::shared_ptr<Layer> deserializeLayer(const std::vector<uint8_t>& data)
+// Deserialize a layer from bytes; version 1 layers have no pixel format and are Rgba8
+std::shared_ptr<Layer> deserializeLayer(const std::vector<uint8_t>& data, uint32_t version)
 {
     if (data.size() < 4) {
         return nullptr;
@@ -112,15 +112,29 @@ std::shared_ptr<Layer> deserializeLayer(const std::vector<uint8_t>& data)
     std::memcpy(&layerHeight, data.data() + offset, sizeof(layerHeight));
     offset += sizeof(layerHeight);
 
+    // Pixel format (1 byte, version 2 and later)
+    PixelFormat format = PixelFormat::Rgba8;
+    if (version >= 2) {
+        if (offset + 1 > data.size()) {
+            return nullptr;
+        }
+        if (data[offset] > static_cast<uint8_t>(PixelFormat::Rgba32F)) {
+            return nullptr;
+        }
+        format = static_cast<PixelFormat>(data[offset]);
+        offset += 1;
+    }
+
     // Verify pixel data size
-    const size_t expectedPixelSize = static_cast<size_t>(layerWidth) * layerHeight * 4;
+    const size_t expectedPixelSize =
+        static_cast<size_t>(layerWidth) * layerHeight * describe(format).bytesPerPixel();
     if (offset + expectedPixelSize > data.size()) {
         return nullptr;
     }
 
     // Create layer and copy pixel data
-    auto layer =
-        std::make_shared<Layer>(static_cast<int>(layerWidth), static_cast<int>(layerHeight));
+    auto layer = std::make_shared<Layer>(
+        static_cast<int>(layerWidth), static_cast<int>(layerHeight), format);
     layer->setName(name);
     layer->setVisible(visible);
     layer->setOpacity(opacity);
@@ -256,7 +270,7 @@ error::Result<std::shared_ptr<ProjectFile>> BinaryProjectReader::read(
         }
 
         if (chunk.type == kChunkTypeLayer) {
-            auto layer = deserializeLayer(decompressed);
+            auto layer = deserializeLayer(decompressed, version);
             if (!layer) {
                 return error::ErrorInfo(error::ErrorCode::IOCorruptedFile,
                                         "Failed to deserialize layer");
@@ -269,9 +283,10 @@ error::Result<std::shared_ptr<ProjectFile>> BinaryProjectReader::read(
             docLayer->setOpacity(layer->opacity());
             docLayer->setBlendMode(layer->blendMode());
 
-            // Copy pixel data
+            // Copy pixel data, keeping the stored depth
             if (layer->width() == docLayer->width() && layer->height() == docLayer->height()) {
-                std::memcpy(docLayer->data().data(), layer->data().data(), layer->data().size());
+                docLayer->setPixelFormat(layer->pixelFormat());
+                docLayer->assignPixels(layer->data(), layer->pixelFormat());
             }
         } else if (chunk.type == kChunkTypeSelection) {
             QPainterPath selection = deserializeSelection(decompressed);
@@ -8,6 +8,7 @@
 #include "io/binary_project_writer.h"
 
 #include "core/layer.h"
+#include "io/utility.h"
 
 #include <cstring>
 #include <fstream>
@@ -95,9 +96,17 @@ std::vector<uint8_t> serializeLayer(const Layer& layer)
                   reinterpret_cast<const uint8_t*>(&layerHeight),
                   reinterpret_cast<const uint8_t*>(&layerHeight) + sizeof(layerHeight));
 
-    // RGBA pixel data (uncompressed in this buffer, will be LZ4 compressed later)
-    const auto& pixelData = layer.data();
-    buffer.insert(buffer.end(), pixelData.begin(), pixelData.end());
+    // Pixel format (1 byte), so wide layers keep their depth
+    const PixelFormat format = project_storage_format(layer.pixelFormat());
+    buffer.push_back(static_cast<uint8_t>(format));
+
+    // Straight-alpha RGBA pixel data (uncompressed in this buffer, will be LZ4 compressed later)
+    if (layer.pixelFormat() == format) {
+        buffer.insert(buffer.end(), layer.data().begin(), layer.data().end());
+    } else {
+        const auto pixelData = layer.pixelsAs(format);
+        buffer.insert(buffer.end(), pixelData.begin(), pixelData.end());
+    }
 
     return buffer;
 }
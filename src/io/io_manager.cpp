@@ -21,6 +21,7 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 
 /*! @brief Alias for nlohmann::json for convenience. */
 using json = nlohmann::json;
@@ -142,7 +143,8 @@ error::Result<std::shared_ptr<ProjectFile>> IOManager::loadProject(
             dstLayer->setVisible(srcLayer->visible());
             dstLayer->setOpacity(srcLayer->opacity());
             dstLayer->setBlendMode(srcLayer->blendMode());
-            std::memcpy(dstLayer->data().data(), srcLayer->data().data(), srcLayer->data().size());
+            dstLayer->setPixelFormat(srcLayer->pixelFormat());
+            dstLayer->assignPixels(std::as_const(*srcLayer).data(), srcLayer->pixelFormat());
         }
 
         return result;
@@ -187,12 +189,15 @@ ProjectFile IOManager::importProject(const std::string& filePath)
                     string_to_blend_mode(layerJson.at("blend_mode").get<std::string>()));
             }
 
-            // Restore layer data when present
+            // Restore layer data when present, in the depth it was saved with
+            const PixelFormat format =
+                string_to_pixel_format(layerJson.value("pixel_format", std::string("Rgba8")));
+            layer->setPixelFormat(format);
             if (layerJson.contains("data")) {
                 const std::vector<uint8_t> layerData =
                     layerJson.at("data").get<std::vector<uint8_t>>();
-                if (layerData.size() == layer->data().size()) {
-                    layer->data() = layerData;
+                if (layerData.size() == std::as_const(*layer).data().size()) {
+                    layer->assignPixels(layerData, format);
                 } else {
                     throw std::runtime_error("Layer data size mismatch during import");
                 }
@@ -228,7 +233,9 @@ bool IOManager::exportProject(const ProjectFile& project, const std::string& fil
             layerJson["blend_mode"] = blend_mode_to_string(layer->blendMode());
             layerJson["width"] = layer->width();
             layerJson["height"] = layer->height();
-            layerJson["data"] = layer->data();
+            const PixelFormat format = project_storage_format(layer->pixelFormat());
+            layerJson["pixel_format"] = pixel_format_to_string(format);
+            layerJson["data"] = layer->pixelsAs(format);
 
             layersJson.push_back(layerJson);
         }
@@ -260,6 +267,86 @@ ImageFile IOManager::readImage(const std::string& filePath)
     return {img, filePath};
 }
 
+std::shared_ptr<Layer> IOManager::imageToLayer(const ImageFile& image)
+{
+    if (image.empty()) {
+        return nullptr;
+    }
+
+    PixelFormat format = PixelFormat::Rgba8;
+    switch (image.depth()) {
+        case CV_8U:
+            format = PixelFormat::Rgba8;
+            break;
+        case CV_16U:
+            format = PixelFormat::Rgba16;
+            break;
+        case CV_16F:
+            format = PixelFormat::Rgba16F;
+            break;
+        case CV_32F:
+            format = PixelFormat::Rgba32F;
+            break;
+        default:
+            return nullptr;
+    }
+
+    // cvtColor has no half-float path: widen to float and narrow again per row
+    cv::Mat source = image.mat();
+    PixelFormat sourceFormat = format;
+    if (image.depth() == CV_16F) {
+        image.mat().convertTo(source, CV_32F);
+        sourceFormat = PixelFormat::Rgba32F;
+    }
+
+    cv::Mat rgba;
+    switch (image.channels()) {
+        case 1:
+            cv::cvtColor(source, rgba, cv::COLOR_GRAY2RGBA);
+            break;
+        case 3:
+            cv::cvtColor(source, rgba, cv::COLOR_BGR2RGBA);
+            break;
+        case 4:
+            cv::cvtColor(source, rgba, cv::COLOR_BGRA2RGBA);
+            break;
+        default:
+            return nullptr;
+    }
+
+    auto layer = std::make_shared<Layer>(rgba.cols, rgba.rows, format);
+    for (int y = 0; y < rgba.rows; ++y) {
+        convertPixels(layer->row(y),
+                      rgba.ptr<std::uint8_t>(y),
+                      static_cast<std::size_t>(rgba.cols),
+                      sourceFormat,
+                      format);
+    }
+    return layer;
+}
+
+error::Result<std::shared_ptr<ProjectFile>> IOManager::loadImage(
+    const std::filesystem::path& path)
+{
+    if (!std::filesystem::exists(path)) {
+        return error::ErrorInfo(error::ErrorCode::IOFileNotFound,
+                                "File not found: " + path.string());
+    }
+
+    const auto layer = imageToLayer(readImage(path.string()));
+    if (!layer) {
+        return error::ErrorInfo(error::ErrorCode::IOUnsupportedFormat,
+                                "Unsupported image: " + path.string());
+    }
+
+    auto document = std::make_shared<ProjectFile>(layer->width(), layer->height());
+    auto docLayer = document->addLayer();
+    docLayer->setName(path.stem().string());
+    docLayer->setPixelFormat(layer->pixelFormat());
+    docLayer->assignPixels(layer->data(), layer->pixelFormat());
+    return document;
+}
+
 bool IOManager::writeImage(const cv::Mat& mat, const std::string& filePath)
 {
     return cv::imwrite(filePath, mat);
@@ -0,0 +1,106 @@
+/**
+ * @file blend_kernels.cpp
+ * @brief Portable blend kernels and SIMD dispatch.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ */
+
+#include "render/blend_kernels.h"
+
+#include <algorithm>
+
+namespace gimp {
+
+namespace {
+
+/// Blends one premultiplied color channel; alpha is handled separately.
+template <BlendMode Mode>
+std::uint32_t blendChannel(std::uint32_t s, std::uint32_t d, std::uint32_t sa, std::uint32_t da)
+{
+    if constexpr (Mode == BlendMode::Normal) {
+        return s + mulDiv255(d, 255 - sa);
+    } else if constexpr (Mode == BlendMode::Multiply) {
+        return mulDiv255(s, 255 - da) + mulDiv255(d, 255 - sa) + mulDiv255(s, d);
+    } else if constexpr (Mode == BlendMode::Screen) {
+        return s + d - mulDiv255(s, d);
+    } else if constexpr (Mode == BlendMode::Darken) {
+        return s + d - std::max(mulDiv255(s, da), mulDiv255(d, sa));
+    } else if constexpr (Mode == BlendMode::Lighten) {
+        return s + d - std::min(mulDiv255(s, da), mulDiv255(d, sa));
+    } else {
+        // Overlay: multiply where the backdrop is dark, screen where it is light
+        const std::uint32_t outside = mulDiv255(s, 255 - da) + mulDiv255(d, 255 - sa);
+        if (2 * d <= da) {
+            return outside + 2 * mulDiv255(s, d);
+        }
+        const std::uint32_t both = mulDiv255(sa, da);
+        const std::uint32_t inverse = 2 * mulDiv255(da - d, sa - s);
+        return outside + (both > inverse ? both - inverse : 0);
+    }
+}
+
+template <BlendMode Mode>
+void blendRowScalar(std::uint8_t* dst, const std::uint8_t* src, int count, std::uint8_t opacity)
+{
+    for (int i = 0; i < count; ++i, dst += 4, src += 4) {
+        std::uint32_t s[4] = {src[0], src[1], src[2], src[3]};
+        if (opacity != 255) {
+            for (auto& channel : s) {
+                channel = mulDiv255(channel, opacity);
+            }
+        }
+        const std::uint32_t sa = s[3];
+        if (sa == 0) {
+            continue;
+        }
+
+        const std::uint32_t da = dst[3];
+        const std::uint32_t outA = sa + mulDiv255(da, 255 - sa);
+        for (int c = 0; c < 3; ++c) {
+            const std::uint32_t value = blendChannel<Mode>(s[c], dst[c], sa, da);
+            dst[c] = static_cast<std::uint8_t>(std::min({value, 255U, outA}));
+        }
+        dst[3] = static_cast<std::uint8_t>(outA);
+    }
+}
+
+}  // namespace
+
+BlendRowFn blendRowKernel(BlendMode mode, SimdLevel level)
+{
+    level = supportedSimdLevel(level);
+
+    BlendRowFn kernel = nullptr;
+    if (level == SimdLevel::Avx2) {
+        kernel = detail::avx2BlendRow(mode);
+    }
+    if (!kernel && level != SimdLevel::Scalar) {
+        kernel = detail::sse41BlendRow(mode);
+    }
+    return kernel ? kernel : detail::scalarBlendRow(mode);
+}
+
+namespace detail {
+
+BlendRowFn scalarBlendRow(BlendMode mode)
+{
+    switch (mode) {
+        case BlendMode::Normal:
+            return &blendRowScalar<BlendMode::Normal>;
+        case BlendMode::Multiply:
+            return &blendRowScalar<BlendMode::Multiply>;
+        case BlendMode::Overlay:
+            return &blendRowScalar<BlendMode::Overlay>;
+        case BlendMode::Screen:
+            return &blendRowScalar<BlendMode::Screen>;
+        case BlendMode::Darken:
+            return &blendRowScalar<BlendMode::Darken>;
+        case BlendMode::Lighten:
+            return &blendRowScalar<BlendMode::Lighten>;
+    }
+    return &blendRowScalar<BlendMode::Normal>;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
@@ -0,0 +1,148 @@
+/**
+ * @file blend_kernels_avx2.cpp
+ * @brief AVX2 blend kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ *
+ * Built with AVX2 code generation enabled; see blend_kernels_sse41.cpp for
+ * why only functions defined in this file are called from here.
+ */
+
+#include "render/blend_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace gimp {
+
+namespace {
+
+/// round(a * b / 255) per 16-bit lane, identical to gimp::mulDiv255.
+inline __m256i mulDiv255(__m256i a, __m256i b)
+{
+    const __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(a, b), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+/// Copies each pixel's alpha lane to its four lanes.
+inline __m256i broadcastAlpha(__m256i v)
+{
+    return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)),
+                                  _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/// Blends four premultiplied pixels held in 16-bit lanes.
+template <BlendMode Mode>
+__m256i blendPixels(__m256i s, __m256i d)
+{
+    const __m256i c255 = _mm256_set1_epi16(255);
+    const __m256i sa = broadcastAlpha(s);
+    const __m256i da = broadcastAlpha(d);
+
+    __m256i c;
+    if constexpr (Mode == BlendMode::Normal) {
+        c = _mm256_add_epi16(s, mulDiv255(d, _mm256_sub_epi16(c255, sa)));
+    } else if constexpr (Mode == BlendMode::Multiply) {
+        c = _mm256_add_epi16(_mm256_add_epi16(mulDiv255(s, _mm256_sub_epi16(c255, da)),
+                                              mulDiv255(d, _mm256_sub_epi16(c255, sa))),
+                             mulDiv255(s, d));
+    } else if constexpr (Mode == BlendMode::Screen) {
+        c = _mm256_sub_epi16(_mm256_add_epi16(s, d), mulDiv255(s, d));
+    } else if constexpr (Mode == BlendMode::Darken) {
+        c = _mm256_sub_epi16(_mm256_add_epi16(s, d),
+                             _mm256_max_epu16(mulDiv255(s, da), mulDiv255(d, sa)));
+    } else if constexpr (Mode == BlendMode::Lighten) {
+        c = _mm256_sub_epi16(_mm256_add_epi16(s, d),
+                             _mm256_min_epu16(mulDiv255(s, da), mulDiv255(d, sa)));
+    } else {
+        const __m256i outside = _mm256_add_epi16(mulDiv255(s, _mm256_sub_epi16(c255, da)),
+                                                 mulDiv255(d, _mm256_sub_epi16(c255, sa)));
+        const __m256i dark = _mm256_slli_epi16(mulDiv255(s, d), 1);
+        const __m256i inverse =
+            _mm256_slli_epi16(mulDiv255(_mm256_sub_epi16(da, d), _mm256_sub_epi16(sa, s)), 1);
+        const __m256i light = _mm256_subs_epu16(mulDiv255(sa, da), inverse);
+        const __m256i isLight = _mm256_cmpgt_epi16(_mm256_add_epi16(d, d), da);
+        c = _mm256_add_epi16(outside, _mm256_blendv_epi8(dark, light, isLight));
+    }
+
+    const __m256i outA = _mm256_add_epi16(sa, mulDiv255(da, _mm256_sub_epi16(c255, sa)));
+    c = _mm256_min_epu16(_mm256_min_epu16(c, c255), outA);
+    return _mm256_blend_epi16(c, outA, 0x88);
+}
+
+template <BlendMode Mode>
+void blendRowAvx2(std::uint8_t* dst, const std::uint8_t* src, int count, std::uint8_t opacity)
+{
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000U));
+    const __m256i scale = _mm256_set1_epi16(opacity);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const std::size_t offset = static_cast<std::size_t>(i) * 4U;
+        auto* out = reinterpret_cast<__m256i*>(dst + offset);
+        const __m256i s8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + offset));
+        if (_mm256_testz_si256(s8, alphaMask)) {
+            continue;
+        }
+        const __m256i d8 = _mm256_loadu_si256(out);
+
+        __m256i sLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(s8));
+        __m256i sHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(s8, 1));
+        if (opacity != 255) {
+            sLo = mulDiv255(sLo, scale);
+            sHi = mulDiv255(sHi, scale);
+        }
+        const __m256i lo = blendPixels<Mode>(sLo, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(d8)));
+        const __m256i hi =
+            blendPixels<Mode>(sHi, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(d8, 1)));
+        // packus works within 128-bit lanes; restore pixel order afterwards
+        const __m256i packed = _mm256_packus_epi16(lo, hi);
+        _mm256_storeu_si256(out, _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    if (i < count) {
+        const std::size_t offset = static_cast<std::size_t>(i) * 4U;
+        detail::scalarBlendRow(Mode)(dst + offset, src + offset, count - i, opacity);
+    }
+}
+
+}  // namespace
+
+namespace detail {
+
+BlendRowFn avx2BlendRow(BlendMode mode)
+{
+    switch (mode) {
+        case BlendMode::Normal:
+            return &blendRowAvx2<BlendMode::Normal>;
+        case BlendMode::Multiply:
+            return &blendRowAvx2<BlendMode::Multiply>;
+        case BlendMode::Overlay:
+            return &blendRowAvx2<BlendMode::Overlay>;
+        case BlendMode::Screen:
+            return &blendRowAvx2<BlendMode::Screen>;
+        case BlendMode::Darken:
+            return &blendRowAvx2<BlendMode::Darken>;
+        case BlendMode::Lighten:
+            return &blendRowAvx2<BlendMode::Lighten>;
+    }
+    return nullptr;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
+
+#else
+
+namespace gimp::detail {
+
+BlendRowFn avx2BlendRow(BlendMode /*mode*/)
+{
+    return nullptr;
+}
+
+}  // namespace gimp::detail
+
+#endif
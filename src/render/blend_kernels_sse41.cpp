@@ -0,0 +1,146 @@
+/**
+ * @file blend_kernels_sse41.cpp
+ * @brief SSE4.1 blend kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ *
+ * Built with SSE4.1 code generation enabled. Only call functions defined in
+ * this file (or intrinsics) from here: inline functions shared with other
+ * translation units could be emitted with SSE4.1 instructions and picked by
+ * the linker for callers running on older CPUs.
+ */
+
+#include "render/blend_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+
+#include <immintrin.h>
+
+namespace gimp {
+
+namespace {
+
+/// round(a * b / 255) per 16-bit lane, identical to gimp::mulDiv255.
+inline __m128i mulDiv255(__m128i a, __m128i b)
+{
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/// Copies each pixel's alpha lane to its four lanes.
+inline __m128i broadcastAlpha(__m128i v)
+{
+    return _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)),
+                               _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/// Blends two premultiplied pixels held in 16-bit lanes.
+template <BlendMode Mode>
+__m128i blendPixels(__m128i s, __m128i d)
+{
+    const __m128i c255 = _mm_set1_epi16(255);
+    const __m128i sa = broadcastAlpha(s);
+    const __m128i da = broadcastAlpha(d);
+
+    __m128i c;
+    if constexpr (Mode == BlendMode::Normal) {
+        c = _mm_add_epi16(s, mulDiv255(d, _mm_sub_epi16(c255, sa)));
+    } else if constexpr (Mode == BlendMode::Multiply) {
+        c = _mm_add_epi16(_mm_add_epi16(mulDiv255(s, _mm_sub_epi16(c255, da)),
+                                        mulDiv255(d, _mm_sub_epi16(c255, sa))),
+                          mulDiv255(s, d));
+    } else if constexpr (Mode == BlendMode::Screen) {
+        c = _mm_sub_epi16(_mm_add_epi16(s, d), mulDiv255(s, d));
+    } else if constexpr (Mode == BlendMode::Darken) {
+        c = _mm_sub_epi16(_mm_add_epi16(s, d), _mm_max_epu16(mulDiv255(s, da), mulDiv255(d, sa)));
+    } else if constexpr (Mode == BlendMode::Lighten) {
+        c = _mm_sub_epi16(_mm_add_epi16(s, d), _mm_min_epu16(mulDiv255(s, da), mulDiv255(d, sa)));
+    } else {
+        const __m128i outside = _mm_add_epi16(mulDiv255(s, _mm_sub_epi16(c255, da)),
+                                              mulDiv255(d, _mm_sub_epi16(c255, sa)));
+        const __m128i dark = _mm_slli_epi16(mulDiv255(s, d), 1);
+        const __m128i inverse =
+            _mm_slli_epi16(mulDiv255(_mm_sub_epi16(da, d), _mm_sub_epi16(sa, s)), 1);
+        const __m128i light = _mm_subs_epu16(mulDiv255(sa, da), inverse);
+        const __m128i isLight = _mm_cmpgt_epi16(_mm_add_epi16(d, d), da);
+        c = _mm_add_epi16(outside, _mm_blendv_epi8(dark, light, isLight));
+    }
+
+    const __m128i outA = _mm_add_epi16(sa, mulDiv255(da, _mm_sub_epi16(c255, sa)));
+    c = _mm_min_epu16(_mm_min_epu16(c, c255), outA);
+    return _mm_blend_epi16(c, outA, 0x88);
+}
+
+template <BlendMode Mode>
+void blendRowSse41(std::uint8_t* dst, const std::uint8_t* src, int count, std::uint8_t opacity)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000U));
+    const __m128i scale = _mm_set1_epi16(opacity);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const std::size_t offset = static_cast<std::size_t>(i) * 4U;
+        auto* out = reinterpret_cast<__m128i*>(dst + offset);
+        const __m128i s8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + offset));
+        if (_mm_testz_si128(s8, alphaMask)) {
+            continue;
+        }
+        const __m128i d8 = _mm_loadu_si128(out);
+
+        __m128i sLo = _mm_cvtepu8_epi16(s8);
+        __m128i sHi = _mm_unpackhi_epi8(s8, zero);
+        if (opacity != 255) {
+            sLo = mulDiv255(sLo, scale);
+            sHi = mulDiv255(sHi, scale);
+        }
+        const __m128i lo = blendPixels<Mode>(sLo, _mm_cvtepu8_epi16(d8));
+        const __m128i hi = blendPixels<Mode>(sHi, _mm_unpackhi_epi8(d8, zero));
+        _mm_storeu_si128(out, _mm_packus_epi16(lo, hi));
+    }
+
+    if (i < count) {
+        const std::size_t offset = static_cast<std::size_t>(i) * 4U;
+        detail::scalarBlendRow(Mode)(dst + offset, src + offset, count - i, opacity);
+    }
+}
+
+}  // namespace
+
+namespace detail {
+
+BlendRowFn sse41BlendRow(BlendMode mode)
+{
+    switch (mode) {
+        case BlendMode::Normal:
+            return &blendRowSse41<BlendMode::Normal>;
+        case BlendMode::Multiply:
+            return &blendRowSse41<BlendMode::Multiply>;
+        case BlendMode::Overlay:
+            return &blendRowSse41<BlendMode::Overlay>;
+        case BlendMode::Screen:
+            return &blendRowSse41<BlendMode::Screen>;
+        case BlendMode::Darken:
+            return &blendRowSse41<BlendMode::Darken>;
+        case BlendMode::Lighten:
+            return &blendRowSse41<BlendMode::Lighten>;
+    }
+    return nullptr;
+}
+
+}  // namespace detail
+
+}  // namespace gimp
+
+#else
+
+namespace gimp::detail {
+
+BlendRowFn sse41BlendRow(BlendMode /*mode*/)
+{
+    return nullptr;
+}
+
+}  // namespace gimp::detail
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * @file cpu_compositor.cpp
+ * @brief Implementation of CpuCompositor.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ */
+
+#include "render/cpu_compositor.h"
+
+#include "core/layer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace gimp {
+
+void CpuCompositor::compose(const LayerStack& layers,
+                            const Rect& region,
+                            std::uint8_t* dst,
+                            std::size_t dstRowBytes)
+{
+    for (const auto& layer : layers) {
+        if (!layer->visible()) {
+            continue;
+        }
+        const auto opacity = static_cast<std::uint8_t>(
+            std::lround(std::clamp(layer->opacity(), 0.0F, 1.0F) * 255.0F));
+        if (opacity == 0) {
+            continue;
+        }
+
+        const int x0 = std::max(region.x, 0);
+        const int y0 = std::max(region.y, 0);
+        const int x1 = std::min(region.x + region.w, layer->width());
+        const int y1 = std::min(region.y + region.h, layer->height());
+        if (x0 >= x1 || y0 >= y1) {
+            continue;
+        }
+
+        const BlendRowFn kernel = blendRowKernel(layer->blendMode(), m_level);
+        const int count = x1 - x0;
+        const PixelFormat format = layer->pixelFormat();
+        const bool direct = format == PixelFormat::Rgba8Premultiplied;
+        if (!direct) {
+            m_row.resize(static_cast<std::size_t>(count) * 4U);
+        }
+
+        const Layer& source = *layer;
+        for (int y = y0; y < y1; ++y) {
+            const std::uint8_t* in =
+                source.row(y) + static_cast<std::size_t>(x0) * source.bytesPerPixel();
+            if (!direct) {
+                convertPixels(m_row.data(),
+                              in,
+                              static_cast<std::size_t>(count),
+                              format,
+                              PixelFormat::Rgba8Premultiplied);
+                in = m_row.data();
+            }
+            std::uint8_t* out = dst + static_cast<std::size_t>(y - region.y) * dstRowBytes +
+                                static_cast<std::size_t>(x0 - region.x) * 4U;
+            kernel(out, in, count, opacity);
+        }
+    }
+}
+
+std::vector<std::uint8_t> CpuCompositor::flatten(const LayerStack& layers, int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        return {};
+    }
+
+    const std::size_t rowBytes = static_cast<std::size_t>(width) * 4U;
+    std::vector<std::uint8_t> pixels(rowBytes * static_cast<std::size_t>(height), 0);
+    compose(layers, {0, 0, width, height}, pixels.data(), rowBytes);
+    unpremultiplyRow(pixels.data(), pixels.data(), width * height);
+    return pixels;
+}
+
+}  // namespace gimp
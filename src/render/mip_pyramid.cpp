@@ -0,0 +1,333 @@
+/**
+ * @file mip_pyramid.cpp
+ * @brief Implementation of MipPyramid and LayerMipCache.
+ * @author Laurent Jiang
+ * @date 2026-02-17
+ */
+
+#include "render/mip_pyramid.h"
+
+#include "core/layer.h"
+#include "core/layer_stack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace gimp {
+
+namespace {
+
+/// Clips a rectangle to [0, width) x [0, height); returns an empty rect if disjoint.
+Rect clipRect(const Rect& region, int width, int height)
+{
+    const int x0 = std::max(0, region.x);
+    const int y0 = std::max(0, region.y);
+    const int x1 = std::min(width, region.x + region.w);
+    const int y1 = std::min(height, region.y + region.h);
+    if (x0 >= x1 || y0 >= y1) {
+        return {0, 0, 0, 0};
+    }
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+/// Maps a region of one level to the region of the next (half-size) level it affects.
+Rect halveRect(const Rect& region)
+{
+    const int x0 = region.x >> 1;
+    const int y0 = region.y >> 1;
+    const int x1 = (region.x + region.w - 1) >> 1;
+    const int y1 = (region.y + region.h - 1) >> 1;
+    return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+}
+
+/**
+ * @brief Alpha-weighted 2x2 box filter for straight-alpha high bit-depth levels.
+ * @tparam Channel Channel type of the level format.
+ */
+template <typename Channel>
+void downsampleWide(MipLevel& dst,
+                    const std::uint8_t* source,
+                    int srcWidth,
+                    int srcHeight,
+                    const Rect& target)
+{
+    using Traits = ChannelTraits<Channel>;
+    constexpr std::size_t kPixelBytes = 4 * sizeof(Channel);
+
+    for (int dy = target.y; dy < target.y + target.h; ++dy) {
+        std::uint8_t* out = dst.pixels.data() +
+                            (static_cast<std::size_t>(dy) * dst.width + target.x) * kPixelBytes;
+        for (int dx = target.x; dx < target.x + target.w; ++dx, out += kPixelBytes) {
+            float sum[4] = {0.0F, 0.0F, 0.0F, 0.0F};
+            int count = 0;
+            for (int sy = dy * 2; sy < std::min(dy * 2 + 2, srcHeight); ++sy) {
+                for (int sx = dx * 2; sx < std::min(dx * 2 + 2, srcWidth); ++sx) {
+                    const std::uint8_t* px =
+                        source + (static_cast<std::size_t>(sy) * srcWidth + sx) * kPixelBytes;
+                    const float a = loadChannel<Channel>(px + 3 * sizeof(Channel));
+                    for (int c = 0; c < 3; ++c) {
+                        sum[c] += loadChannel<Channel>(px + c * sizeof(Channel)) * a;
+                    }
+                    sum[3] += a;
+                    ++count;
+                }
+            }
+
+            const bool empty = count == 0 || sum[3] <= 0.0F;
+            for (int c = 0; c < 3; ++c) {
+                const float value = empty ? 0.0F : sum[c] / sum[3] + Traits::kRound;
+                storeChannel<Channel>(out + c * sizeof(Channel), value);
+            }
+            const float alpha = empty ? 0.0F : sum[3] / static_cast<float>(count) + Traits::kRound;
+            storeChannel<Channel>(out + 3 * sizeof(Channel), alpha);
+        }
+    }
+}
+
+}  // namespace
+
+int MipPyramid::levelForZoom(float zoom)
+{
+    if (zoom >= 1.0F || zoom <= 0.0F) {
+        return 0;
+    }
+    const auto level = static_cast<int>(std::floor(std::log2(1.0F / zoom)));
+    return std::clamp(level, 0, kMaxLevel);
+}
+
+int MipPyramid::levelExtent(int size, int level)
+{
+    return (size + (1 << level) - 1) >> level;
+}
+
+void MipPyramid::markDirty(const Rect& region)
+{
+    if (region.w <= 0 || region.h <= 0) {
+        return;
+    }
+    if (m_pending.w <= 0 || m_pending.h <= 0) {
+        m_pending = region;
+        return;
+    }
+    const int x0 = std::min(m_pending.x, region.x);
+    const int y0 = std::min(m_pending.y, region.y);
+    const int x1 = std::max(m_pending.x + m_pending.w, region.x + region.w);
+    const int y1 = std::max(m_pending.y + m_pending.h, region.y + region.h);
+    m_pending = {x0, y0, x1 - x0, y1 - y0};
+}
+
+void MipPyramid::markAllDirty()
+{
+    m_fullRebuild = true;
+}
+
+bool MipPyramid::update(const Layer& layer, int levelCount)
+{
+    levelCount = std::clamp(levelCount, 0, kMaxLevel);
+    if (levelCount == 0) {
+        return false;
+    }
+
+    if (layer.width() != m_sourceWidth || layer.height() != m_sourceHeight ||
+        layer.pixelFormat() != m_format) {
+        m_sourceWidth = layer.width();
+        m_sourceHeight = layer.height();
+        m_format = layer.pixelFormat();
+        m_fullRebuild = true;
+    } else if (layer.version() == m_version) {
+        // Same pixels as at the last update: whatever was marked dirty did not change them
+        m_pending = {0, 0, 0, 0};
+        m_fullRebuild = false;
+    }
+
+    const Rect pending = clipRect(m_pending, m_sourceWidth, m_sourceHeight);
+    const bool hasPending = pending.w > 0 && pending.h > 0;
+    if (layer.version() != m_version && !hasPending) {
+        // Modified without a reported region: the whole layer may differ
+        m_fullRebuild = true;
+    }
+
+    if (m_fullRebuild) {
+        m_levels.clear();
+    }
+
+    // Refresh the levels that already exist, one pending region per level
+    const int existing = builtLevels();
+    bool recomputed = existing > 0 && hasPending;
+    if (recomputed) {
+        const std::uint8_t* source = layer.data().data();
+        int srcWidth = m_sourceWidth;
+        int srcHeight = m_sourceHeight;
+        Rect region = pending;
+        for (int index = 1; index <= existing; ++index) {
+            downsample(index, source, srcWidth, srcHeight, region);
+            const MipLevel& built = m_levels[static_cast<std::size_t>(index - 1)];
+            source = built.pixels.data();
+            srcWidth = built.width;
+            srcHeight = built.height;
+            region = halveRect(region);
+        }
+    }
+
+    // Build any missing levels in full
+    for (int index = existing + 1; index <= levelCount; ++index) {
+        const MipLevel* parent =
+            index > 1 ? &m_levels[static_cast<std::size_t>(index - 2)] : nullptr;
+        const int srcWidth = parent ? parent->width : m_sourceWidth;
+        const int srcHeight = parent ? parent->height : m_sourceHeight;
+        if (srcWidth <= 1 && srcHeight <= 1) {
+            break;
+        }
+
+        MipLevel next;
+        next.width = levelExtent(m_sourceWidth, index);
+        next.height = levelExtent(m_sourceHeight, index);
+        next.format = m_format;
+        next.pixels.assign(static_cast<std::size_t>(next.width) * next.height *
+                               static_cast<std::size_t>(describe(m_format).bytesPerPixel()),
+                           0);
+        m_levels.push_back(std::move(next));
+
+        // push_back may have moved the parent level, so look it up again
+        const std::uint8_t* source =
+            index > 1 ? m_levels[static_cast<std::size_t>(index - 2)].pixels.data()
+                      : layer.data().data();
+        downsample(index, source, srcWidth, srcHeight, {0, 0, srcWidth, srcHeight});
+        recomputed = true;
+    }
+
+    m_version = layer.version();
+    m_pending = {0, 0, 0, 0};
+    m_fullRebuild = false;
+    return recomputed;
+}
+
+const MipLevel* MipPyramid::level(int level) const
+{
+    if (level < 1 || level > builtLevels()) {
+        return nullptr;
+    }
+    return &m_levels[static_cast<std::size_t>(level - 1)];
+}
+
+void MipPyramid::downsample(int index,
+                            const std::uint8_t* source,
+                            int srcWidth,
+                            int srcHeight,
+                            const Rect& region)
+{
+    MipLevel& dst = m_levels[static_cast<std::size_t>(index - 1)];
+    const Rect target = clipRect(halveRect(region), dst.width, dst.height);
+    const bool premultiplied = describe(m_format).premultiplied;
+    if (describe(m_format).bytesPerChannel > 1) {
+        visitChannelType(m_format, [&](auto zero) {
+            downsampleWide<decltype(zero)>(dst, source, srcWidth, srcHeight, target);
+        });
+        return;
+    }
+
+    for (int dy = target.y; dy < target.y + target.h; ++dy) {
+        std::uint8_t* out = dst.pixels.data() +
+                            (static_cast<std::size_t>(dy) * dst.width + target.x) * 4U;
+        for (int dx = target.x; dx < target.x + target.w; ++dx, out += 4) {
+            if (premultiplied) {
+                // Premultiplied colors already carry their weight: plain 2x2 box filter
+                std::uint32_t sum[4] = {0, 0, 0, 0};
+                std::uint32_t count = 0;
+                for (int sy = dy * 2; sy < std::min(dy * 2 + 2, srcHeight); ++sy) {
+                    for (int sx = dx * 2; sx < std::min(dx * 2 + 2, srcWidth); ++sx) {
+                        const std::uint8_t* px =
+                            source + (static_cast<std::size_t>(sy) * srcWidth + sx) * 4U;
+                        for (int c = 0; c < 4; ++c) {
+                            sum[c] += px[c];
+                        }
+                        ++count;
+                    }
+                }
+                for (int c = 0; c < 4; ++c) {
+                    out[c] = static_cast<std::uint8_t>(count ? (sum[c] + count / 2) / count : 0);
+                }
+                continue;
+            }
+
+            // Alpha-weighted 2x2 box filter over the source pixels that exist
+            std::uint32_t sumA = 0;
+            std::uint32_t sumR = 0;
+            std::uint32_t sumG = 0;
+            std::uint32_t sumB = 0;
+            std::uint32_t count = 0;
+            for (int sy = dy * 2; sy < std::min(dy * 2 + 2, srcHeight); ++sy) {
+                for (int sx = dx * 2; sx < std::min(dx * 2 + 2, srcWidth); ++sx) {
+                    const std::uint8_t* px =
+                        source + (static_cast<std::size_t>(sy) * srcWidth + sx) * 4U;
+                    const std::uint32_t a = px[3];
+                    sumR += px[0] * a;
+                    sumG += px[1] * a;
+                    sumB += px[2] * a;
+                    sumA += a;
+                    ++count;
+                }
+            }
+
+            if (count == 0 || sumA == 0) {
+                out[0] = out[1] = out[2] = out[3] = 0;
+                continue;
+            }
+            out[0] = static_cast<std::uint8_t>((sumR + sumA / 2) / sumA);
+            out[1] = static_cast<std::uint8_t>((sumG + sumA / 2) / sumA);
+            out[2] = static_cast<std::uint8_t>((sumB + sumA / 2) / sumA);
+            out[3] = static_cast<std::uint8_t>((sumA + count / 2) / count);
+        }
+    }
+}
+
+void LayerMipCache::noteDirty(const TileStore& store, const LayerStack& layers)
+{
+    prune(layers);
+    if (m_pyramids.empty()) {
+        return;
+    }
+
+    const bool full = store.isFullyInvalid();
+    for (auto& [layer, pyramid] : m_pyramids) {
+        if (full) {
+            pyramid.markAllDirty();
+            continue;
+        }
+        for (const Rect& rect : store.dirtyRects(*layer)) {
+            pyramid.markDirty(rect);
+        }
+    }
+}
+
+const MipLevel* LayerMipCache::level(const Layer& layer, int level)
+{
+    if (level < 1) {
+        return nullptr;
+    }
+    MipPyramid& pyramid = m_pyramids[&layer];
+    pyramid.update(layer, level);
+    return pyramid.level(level);
+}
+
+void LayerMipCache::prune(const LayerStack& layers)
+{
+    if (m_pyramids.empty()) {
+        return;
+    }
+
+    std::unordered_set<const Layer*> live;
+    for (const auto& layer : layers) {
+        live.insert(layer.get());
+    }
+    for (auto it = m_pyramids.begin(); it != m_pyramids.end();) {
+        if (live.count(it->first) == 0) {
+            it = m_pyramids.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace gimp
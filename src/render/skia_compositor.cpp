@@ -8,12 +8,18 @@
 #include "render/skia_compositor.h"
 
 #include "core/layer.h"
+#include "render/mip_pyramid.h"
+
+#include <algorithm>
+#include <unordered_set>
 
-#include <include/core/SkBitmap.h>
 #include <include/core/SkCanvas.h>
 #include <include/core/SkImage.h>
 #include <include/core/SkImageInfo.h>
 #include <include/core/SkPaint.h>
+#include <include/core/SkPixmap.h>
+#include <include/core/SkRect.h>
+#include <include/core/SkSurface.h>
 
 namespace gimp {
 
@@ -39,35 +45,212 @@ SkBlendMode toSkBlendMode(BlendMode mode)
     return SkBlendMode::kSrcOver;
 }
 
-/// Draws a single layer onto the canvas with its blend mode and opacity.
-void drawLayerToCanvas(SkCanvas* canvas, const Layer& layer)
+/// Returns the Skia color type with the same memory layout as a layer pixel format.
+SkColorType toSkColorType(PixelFormat format)
 {
-    const SkImageInfo info = SkImageInfo::Make(
-        layer.width(), layer.height(), kRGBA_8888_SkColorType, kUnpremul_SkAlphaType);
-
-    SkBitmap bitmap;
-    // Use const_cast because installPixels expects void* but we are reading
-    if (!bitmap.installPixels(info,
-                              const_cast<void*>(reinterpret_cast<const void*>(layer.data().data())),
-                              info.minRowBytes())) {
-        return;
+    switch (format) {
+        case PixelFormat::Rgba16:
+            return kR16G16B16A16_unorm_SkColorType;
+        case PixelFormat::Rgba16F:
+            return kRGBA_F16_SkColorType;
+        case PixelFormat::Rgba32F:
+            return kRGBA_F32_SkColorType;
+        case PixelFormat::Rgba8:
+        case PixelFormat::Rgba8Premultiplied:
+            break;
+    }
+    return kRGBA_8888_SkColorType;
+}
+
+/// Clips a rectangle to [0, width) x [0, height); returns an empty rect if disjoint.
+Rect clipRect(const Rect& region, int width, int height)
+{
+    const int x0 = std::max(0, region.x);
+    const int y0 = std::max(0, region.y);
+    const int x1 = std::min(width, region.x + region.w);
+    const int y1 = std::min(height, region.y + region.h);
+    if (x0 >= x1 || y0 >= y1) {
+        return {0, 0, 0, 0};
+    }
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+/// Maps a full-resolution region to the mip level pixels it affects.
+Rect levelRect(const Rect& region, int level)
+{
+    const int x0 = region.x >> level;
+    const int y0 = region.y >> level;
+    const int x1 = (region.x + region.w - 1) >> level;
+    const int y1 = (region.y + region.h - 1) >> level;
+    return {x0, y0, x1 - x0 + 1, y1 - y0 + 1};
+}
+
+/// Returns the bounding box of a list of rectangles.
+Rect boundingRect(const std::vector<Rect>& regions)
+{
+    int x0 = regions.front().x;
+    int y0 = regions.front().y;
+    int x1 = regions.front().x + regions.front().w;
+    int y1 = regions.front().y + regions.front().h;
+    for (const Rect& region : regions) {
+        x0 = std::min(x0, region.x);
+        y0 = std::min(y0, region.y);
+        x1 = std::max(x1, region.x + region.w);
+        y1 = std::max(y1, region.y + region.h);
     }
+    return {x0, y0, x1 - x0, y1 - y0};
+}
 
+/// Draws a layer image onto the canvas with the layer's blend mode and opacity.
+/// Mip level images are scaled up by 2^level and clipped to the layer.
+void drawLayerImage(SkCanvas* canvas,
+                    const Layer& layer,
+                    const sk_sp<SkImage>& image,
+                    const SkSamplingOptions& sampling,
+                    int level)
+{
     SkPaint paint;
     paint.setAlphaf(layer.opacity());
     paint.setBlendMode(toSkBlendMode(layer.blendMode()));
 
-    canvas->drawImage(bitmap.asImage(), 0, 0, SkSamplingOptions(), &paint);
+    if (level == 0) {
+        canvas->drawImage(image, 0, 0, sampling, &paint);
+        return;
+    }
+
+    const auto scale = static_cast<float>(1 << level);
+    canvas->save();
+    canvas->clipRect(SkRect::MakeIWH(layer.width(), layer.height()));
+    canvas->scale(scale, scale);
+    canvas->drawImage(image, 0, 0, sampling, &paint);
+    canvas->restore();
 }
 
 }  // namespace
 
+void SkiaCompositor::noteDirty(const TileStore& store, const LayerStack& layers)
+{
+    ++m_frame;
+    if (m_images.empty()) {
+        return;
+    }
+
+    std::unordered_set<const Layer*> live;
+    for (const auto& layer : layers) {
+        live.insert(layer.get());
+    }
+
+    const bool full = store.isFullyInvalid();
+    for (auto it = m_images.begin(); it != m_images.end();) {
+        const Layer* layer = it->first.first;
+        CachedImage& cached = it->second;
+        if (live.count(layer) == 0 || m_frame - cached.lastUsed > kMaxIdleFrames) {
+            it = m_images.erase(it);
+            continue;
+        }
+
+        if (full) {
+            cached.fullUpload = true;
+            cached.pending.clear();
+        } else if (!cached.fullUpload) {
+            for (const Rect& rect : store.dirtyRects(*layer)) {
+                cached.pending.push_back(rect);
+            }
+            if (cached.pending.size() > kMaxPendingRegions) {
+                const Rect merged = boundingRect(cached.pending);
+                cached.pending.assign(1, merged);
+            }
+        }
+        ++it;
+    }
+}
+
+sk_sp<SkImage> SkiaCompositor::layerImage(SkCanvas* canvas,
+                                          const Layer& layer,
+                                          const MipLevel* mip,
+                                          int level)
+{
+    const int width = mip ? mip->width : layer.width();
+    const int height = mip ? mip->height : layer.height();
+    const std::uint8_t* pixels = mip ? mip->pixels.data() : layer.data().data();
+    const PixelFormat format = mip ? mip->format : layer.pixelFormat();
+    const SkImageInfo info =
+        SkImageInfo::Make(width,
+                          height,
+                          toSkColorType(format),
+                          describe(format).premultiplied ? kPremul_SkAlphaType
+                                                         : kUnpremul_SkAlphaType);
+    const SkPixmap source(info, pixels, info.minRowBytes());
+    // High bit-depth layers keep half-float precision on the GPU
+    const SkImageInfo surfaceInfo =
+        info.makeColorType(describe(format).bytesPerChannel > 1 ? kRGBA_F16_SkColorType
+                                                                : kRGBA_8888_SkColorType)
+            .makeAlphaType(kPremul_SkAlphaType);
+
+    const ImageKey key{&layer, level};
+    CachedImage& cached = m_images[key];
+    cached.lastUsed = m_frame;
+
+    if (cached.surface && (cached.surface->width() != width || cached.surface->height() != height ||
+                           cached.surface->imageInfo().colorType() != surfaceInfo.colorType())) {
+        cached.surface.reset();
+    }
+    if (!cached.surface) {
+        cached.surface = canvas->makeSurface(surfaceInfo);
+        if (!cached.surface) {
+            // Canvas without a backing device (e.g. a recorder): draw a one-off copy
+            m_images.erase(key);
+            return SkImages::RasterFromPixmapCopy(source);
+        }
+        cached.image.reset();
+        cached.fullUpload = true;
+    }
+
+    if (cached.image && cached.version == layer.version()) {
+        cached.pending.clear();
+        return cached.image;
+    }
+
+    // Release the snapshot first so writing does not copy the whole surface
+    cached.image.reset();
+    if (cached.fullUpload || cached.pending.empty()) {
+        cached.surface->writePixels(source, 0, 0);
+    } else {
+        for (const Rect& region : cached.pending) {
+            const Rect target = clipRect(levelRect(region, level), width, height);
+            SkPixmap subset;
+            if (target.w <= 0 || target.h <= 0 ||
+                !source.extractSubset(&subset,
+                                      SkIRect::MakeXYWH(target.x, target.y, target.w, target.h))) {
+                continue;
+            }
+            cached.surface->writePixels(subset, target.x, target.y);
+        }
+    }
+
+    cached.pending.clear();
+    cached.fullUpload = false;
+    cached.version = layer.version();
+    cached.image = cached.surface->makeImageSnapshot();
+    return cached.image;
+}
+
+void SkiaCompositor::drawLayer(SkCanvas* canvas, const Layer& layer)
+{
+    const MipLevel* mip = (m_mips && m_mipLevel > 0) ? m_mips->level(layer, m_mipLevel) : nullptr;
+    const int level = mip ? m_mipLevel : 0;
+    const sk_sp<SkImage> image = layerImage(canvas, layer, mip, level);
+    if (image) {
+        drawLayerImage(canvas, layer, image, m_sampling, level);
+    }
+}
+
 void SkiaCompositor::compose(SkCanvas* canvas, const LayerStack& layers)
 {
     for (const auto& layer : layers) {
         if (!layer->visible())
             continue;
-        drawLayerToCanvas(canvas, *layer);
+        drawLayer(canvas, *layer);
     }
 }
 
@@ -81,16 +264,29 @@ void SkiaCompositor::composeUpTo(SkCanvas* canvas,
             break;
         }
         if (layer->visible()) {
-            drawLayerToCanvas(canvas, *layer);
+            drawLayer(canvas, *layer);
         }
         ++idx;
     }
 }
 
+void SkiaCompositor::composeRange(SkCanvas* canvas,
+                                  const LayerStack& layers,
+                                  std::size_t beginIndex,
+                                  std::size_t endIndex)
+{
+    endIndex = std::min(endIndex, layers.count());
+    for (std::size_t idx = beginIndex; idx < endIndex; ++idx) {
+        if (layers[idx]->visible()) {
+            drawLayer(canvas, *layers[idx]);
+        }
+    }
+}
+
 void SkiaCompositor::composeSingleLayer(SkCanvas* canvas, const Layer& layer)
 {
     if (layer.visible()) {
-        drawLayerToCanvas(canvas, layer);
+        drawLayer(canvas, layer);
     }
 }
 
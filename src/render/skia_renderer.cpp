@@ -10,13 +10,49 @@
 #include "core/document.h"
 #include "render/gpu_context.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include <gpu/ganesh/SkSurfaceGanesh.h>
 #include <include/core/SkCanvas.h>
+#include <include/core/SkMatrix.h>
+#include <include/core/SkRect.h>
 
 namespace gimp {
 
+namespace {
+
+/// Cached composites cover the needed area rounded out to this many mip level
+/// pixels, so that small pans keep reusing them.
+constexpr int kCompositeCacheAlign = 256;
+
+/// Rounds a coordinate up to the next multiple of kCompositeCacheAlign.
+int alignUp(int value)
+{
+    return (value + kCompositeCacheAlign - 1) / kCompositeCacheAlign * kCompositeCacheAlign;
+}
+
+/// Returns the mip level pixels a cached composite needs to cover a document area.
+Rect compositeCacheArea(const Rect& area, int level, int levelWidth, int levelHeight)
+{
+    // One extra level pixel on each side keeps filtered samples at the edges inside the cache
+    const int scale = 1 << level;
+    const int x0 = std::max(0, area.x / scale - 1) / kCompositeCacheAlign * kCompositeCacheAlign;
+    const int y0 = std::max(0, area.y / scale - 1) / kCompositeCacheAlign * kCompositeCacheAlign;
+    const int x1 = std::min(levelWidth, alignUp((area.x + area.w + scale - 1) / scale + 1));
+    const int y1 = std::min(levelHeight, alignUp((area.y + area.h + scale - 1) / scale + 1));
+    return {x0, y0, std::max(0, x1 - x0), std::max(0, y1 - y0)};
+}
+
+/// Returns true if outer covers all of inner.
+bool covers(const Rect& outer, const Rect& inner)
+{
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.w <= outer.x + outer.w &&
+           inner.y + inner.h <= outer.y + outer.h;
+}
+
+}  // namespace
+
 SkiaRenderer::SkiaRenderer() = default;
 
 SkiaRenderer::~SkiaRenderer() = default;
@@ -27,6 +63,14 @@ void SkiaRenderer::setGpuContext(IGpuContext* gpuContext)
     // Invalidate existing surfaces so they get recreated with correct backend
     m_surface.reset();
     m_partialSurface.reset();
+    m_compositor.clearImageCache();
+    invalidateCompositeCache();
+}
+
+void SkiaRenderer::invalidateCompositeCache()
+{
+    m_below = CachedComposite{};
+    m_above = CachedComposite{};
 }
 
 bool SkiaRenderer::isUsingGpu() const
@@ -78,7 +122,234 @@ void SkiaRenderer::render(const Document& document)
     SkCanvas* canvas = m_surface->getCanvas();
     canvas->clear(SK_ColorTRANSPARENT);
 
+    m_compositor.setMipSource(nullptr, 0);
     m_compositor.compose(canvas, document.layers());
+    m_lastRendered.assign(1, Rect{0, 0, w, h});
+    m_viewportMode = false;
+}
+
+void SkiaRenderer::render(const Document& document, TileStore& dirtyTiles)
+{
+    const int w = document.width();
+    const int h = document.height();
+
+    if (w <= 0 || h <= 0)
+        return;
+
+    m_lastRendered.clear();
+
+    const bool reuseSurface =
+        !m_viewportMode && m_surface && m_surface->width() == w && m_surface->height() == h;
+    const bool fullRedraw = !reuseSurface || dirtyTiles.isFullyInvalid();
+    if (!fullRedraw && !dirtyTiles.hasDirtyRegions())
+        return;
+
+    if (!ensureSurface(m_surface, w, h))
+        return;
+    m_viewportMode = false;
+
+    m_mips.noteDirty(dirtyTiles, document.layers());
+    m_compositor.noteDirty(dirtyTiles, document.layers());
+    m_compositor.setMipSource(nullptr, 0);
+    m_compositor.setSampling(SkSamplingOptions());
+    updateCompositeCaches(document, Rect{0, 0, w, h});
+
+    SkCanvas* canvas = m_surface->getCanvas();
+    if (fullRedraw) {
+        m_lastRendered.push_back({0, 0, w, h});
+    } else {
+        m_lastRendered = dirtyTiles.dirtyRects();
+    }
+    for (const Rect& rect : m_lastRendered) {
+        composeCached(
+            canvas, document, SkIRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h), SkMatrix::I());
+    }
+    dirtyTiles.clear();
+}
+
+void SkiaRenderer::render(const Document& document,
+                          TileStore& dirtyTiles,
+                          const ViewportState& viewport,
+                          int viewWidth,
+                          int viewHeight)
+{
+    const int docW = document.width();
+    const int docH = document.height();
+
+    if (docW <= 0 || docH <= 0 || viewWidth <= 0 || viewHeight <= 0)
+        return;
+
+    m_lastRendered.clear();
+
+    const bool reuseSurface = m_viewportMode && viewport == m_lastViewport && m_surface &&
+                              m_surface->width() == viewWidth && m_surface->height() == viewHeight;
+    const bool fullRedraw = !reuseSurface || dirtyTiles.isFullyInvalid();
+    if (!fullRedraw && !dirtyTiles.hasDirtyRegions())
+        return;
+
+    if (!ensureSurface(m_surface, viewWidth, viewHeight))
+        return;
+    m_viewportMode = true;
+    m_lastViewport = viewport;
+
+    // Zoomed out, draw from the mip level closest above the zoom so blending
+    // cost follows the displayed resolution rather than the document size
+    m_mips.noteDirty(dirtyTiles, document.layers());
+    m_compositor.noteDirty(dirtyTiles, document.layers());
+    m_compositor.setMipSource(&m_mips, MipPyramid::levelForZoom(viewport.zoomLevel));
+
+    // Magnified pixels stay crisp; minified ones are filtered
+    m_compositor.setSampling(viewport.zoomLevel < 1.0F ? SkSamplingOptions(SkFilterMode::kLinear)
+                                                       : SkSamplingOptions());
+
+    // The cached composites only cover the visible part of the document
+    const Rect visible = visibleDocumentRect(viewport, viewWidth, viewHeight, docW, docH);
+    updateCompositeCaches(document, visible);
+
+    const SkMatrix docToView = SkMatrix::Translate(viewport.panX, viewport.panY)
+                                   .preScale(viewport.zoomLevel, viewport.zoomLevel);
+    const SkIRect viewBounds = SkIRect::MakeWH(viewWidth, viewHeight);
+
+    if (fullRedraw) {
+        m_lastRendered.push_back({0, 0, viewWidth, viewHeight});
+    } else {
+        // Only dirty regions that are on screen need compositing
+        const SkIRect visibleDoc = SkIRect::MakeXYWH(visible.x, visible.y, visible.w, visible.h);
+        for (const Rect& rect : dirtyTiles.dirtyRects()) {
+            if (!SkIRect::Intersects(SkIRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h),
+                                     visibleDoc)) {
+                continue;
+            }
+            const Rect mapped = documentToViewRect(viewport, rect);
+            SkIRect viewRect = SkIRect::MakeXYWH(mapped.x, mapped.y, mapped.w, mapped.h);
+            if (viewRect.intersect(viewBounds)) {
+                m_lastRendered.push_back(
+                    {viewRect.x(), viewRect.y(), viewRect.width(), viewRect.height()});
+            }
+        }
+    }
+
+    SkCanvas* canvas = m_surface->getCanvas();
+    for (const Rect& rect : m_lastRendered) {
+        composeCached(
+            canvas, document, SkIRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h), docToView);
+    }
+    dirtyTiles.clear();
+}
+
+void SkiaRenderer::updateCompositeCaches(const Document& document, const Rect& area)
+{
+    // Refresh the composites around the active layer; unchanged layers keep their cache
+    const LayerStack& layers = document.layers();
+    const std::size_t activeIndex = layers.empty() ? 0 : document.activeLayerIndex();
+    const std::size_t aboveBegin = layers.empty() ? 0 : activeIndex + 1;
+    updateComposite(m_below, document, 0, activeIndex, area);
+
+    // Only source-over is associative, so other blend modes above must see the real backdrop
+    m_composeAboveDirectly = false;
+    for (std::size_t idx = aboveBegin; idx < layers.count(); ++idx) {
+        if (layers[idx]->visible() && layers[idx]->blendMode() != BlendMode::Normal) {
+            m_composeAboveDirectly = true;
+            break;
+        }
+    }
+    if (m_composeAboveDirectly) {
+        m_above = CachedComposite{};
+    } else {
+        updateComposite(m_above, document, aboveBegin, layers.count(), area);
+    }
+}
+
+void SkiaRenderer::updateComposite(CachedComposite& cache,
+                                   const Document& document,
+                                   std::size_t beginIndex,
+                                   std::size_t endIndex,
+                                   const Rect& area)
+{
+    const LayerStack& layers = document.layers();
+    endIndex = std::min(endIndex, layers.count());
+    if (area.w <= 0 || area.h <= 0) {
+        return;  // Nothing on screen; the cache is refreshed once something is
+    }
+
+    m_keyScratch.clear();
+    for (std::size_t idx = beginIndex; idx < endIndex; ++idx) {
+        const Layer& layer = *layers[idx];
+        m_keyScratch.push_back({&layer, layer.version(), layer.propertiesVersion()});
+    }
+
+    // Caches hold the needed area at the resolution of the mip level being drawn,
+    // so rebuilding one costs as much as the view rather than the document
+    const int level = m_compositor.mipLevel();
+    const Rect needed = compositeCacheArea(area,
+                                           level,
+                                           MipPyramid::levelExtent(document.width(), level),
+                                           MipPyramid::levelExtent(document.height(), level));
+    if (cache.level == level && m_keyScratch == cache.key &&
+        (cache.key.empty() || (cache.image && covers(cache.area, needed)))) {
+        return;
+    }
+
+    cache.key.swap(m_keyScratch);
+    cache.level = level;
+    cache.area = needed;
+    // Drop the old image first so drawing into the surface does not force a copy-on-write
+    cache.image.reset();
+    if (cache.key.empty() || needed.w <= 0 || needed.h <= 0 ||
+        !ensureSurface(cache.surface, needed.w, needed.h)) {
+        return;
+    }
+
+    SkCanvas* canvas = cache.surface->getCanvas();
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->save();
+    const float inverseScale = 1.0F / static_cast<float>(1 << level);
+    canvas->translate(static_cast<float>(-needed.x), static_cast<float>(-needed.y));
+    canvas->scale(inverseScale, inverseScale);
+    m_compositor.composeRange(canvas, layers, beginIndex, endIndex);
+    canvas->restore();
+    cache.image = cache.surface->makeImageSnapshot();
+}
+
+void SkiaRenderer::composeCached(SkCanvas* canvas,
+                                 const Document& document,
+                                 const SkIRect& clip,
+                                 const SkMatrix& docToView)
+{
+    canvas->save();
+    canvas->clipIRect(clip);
+    canvas->clear(SK_ColorTRANSPARENT);
+    canvas->concat(docToView);
+    canvas->clipRect(SkRect::MakeIWH(document.width(), document.height()));
+
+    const SkSamplingOptions& sampling = m_compositor.sampling();
+    auto drawCached = [&](const CachedComposite& cache) {
+        const auto scale = static_cast<float>(1 << cache.level);
+        canvas->save();
+        canvas->scale(scale, scale);
+        canvas->drawImage(cache.image,
+                          static_cast<float>(cache.area.x),
+                          static_cast<float>(cache.area.y),
+                          sampling);
+        canvas->restore();
+    };
+
+    if (m_below.image) {
+        drawCached(m_below);
+    }
+
+    const LayerStack& layers = document.layers();
+    if (!layers.empty()) {
+        const std::size_t activeIndex = document.activeLayerIndex();
+        m_compositor.composeRange(canvas, layers, activeIndex, activeIndex + 1);
+        if (m_composeAboveDirectly) {
+            m_compositor.composeRange(canvas, layers, activeIndex + 1, layers.count());
+        } else if (m_above.image) {
+            drawCached(m_above);
+        }
+    }
+
+    canvas->restore();
 }
 
 sk_sp<SkImage> SkiaRenderer::renderBelow(const Document& document, std::size_t activeLayerIndex)
@@ -97,6 +368,7 @@ sk_sp<SkImage> SkiaRenderer::renderBelow(const Document& document, std::size_t a
     SkCanvas* canvas = m_partialSurface->getCanvas();
     canvas->clear(SK_ColorTRANSPARENT);
 
+    m_compositor.setMipSource(nullptr, 0);
     m_compositor.composeUpTo(canvas, document.layers(), activeLayerIndex);
 
     return m_partialSurface->makeImageSnapshot();
@@ -123,6 +395,7 @@ sk_sp<SkImage> SkiaRenderer::renderActiveLayerOnly(const Document& document)
     SkCanvas* canvas = m_partialSurface->getCanvas();
     canvas->clear(SK_ColorTRANSPARENT);
 
+    m_compositor.setMipSource(nullptr, 0);
     m_compositor.composeSingleLayer(canvas, *activeLayer);
 
     return m_partialSurface->makeImageSnapshot();
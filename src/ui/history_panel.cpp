@@ -11,6 +11,7 @@
 
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLocale>
 
 namespace gimp {
 
@@ -23,6 +24,7 @@ HistoryPanel::HistoryPanel(QWidget* parent) : QWidget(parent)
             if (!event.lastActionName.empty()) {
                 addEntry(event.lastActionName);
             }
+            setMemoryUsage(event.byteSize, event.byteBudget, event.swapSize);
         });
 
     addEntry("Original");
@@ -50,6 +52,12 @@ void HistoryPanel::setupUi()
 
     connect(historyList_, &QListWidget::itemClicked, this, &HistoryPanel::onItemClicked);
 
+    memoryLabel_ = new QLabel(this);
+    memoryLabel_->setToolTip(
+        "Memory held by the undo history; the oldest steps are dropped past the budget");
+    mainLayout_->addWidget(memoryLabel_);
+    setMemoryUsage(0, 0);
+
     auto* buttonLayout = new QHBoxLayout();
     buttonLayout->setSpacing(2);
 
@@ -93,6 +101,19 @@ void HistoryPanel::clear()
     addEntry("Original");
 }
 
+void HistoryPanel::setMemoryUsage(std::size_t bytes, std::size_t budget, std::size_t swapped)
+{
+    const QLocale locale;
+    QString text = "Memory: " + locale.formattedDataSize(static_cast<qint64>(bytes));
+    if (budget > 0) {
+        text += " / " + locale.formattedDataSize(static_cast<qint64>(budget));
+    }
+    if (swapped > 0) {
+        text += ", disk: " + locale.formattedDataSize(static_cast<qint64>(swapped));
+    }
+    memoryLabel_->setText(text);
+}
+
 void HistoryPanel::refreshList()
 {
     historyList_->clear();
@@ -189,7 +189,7 @@ void LayersPanel::onOpacityChanged(int value)
             updateLayerItem(items.first(), layers[i]);
             opacityLabel_->setText(QString("Opacity: %1%").arg(value));
             // NOLINTNEXTLINE(modernize-use-designated-initializers)
-            EventBus::instance().publish(LayerPropertyChangedEvent{layers[i], "opacity"});
+            EventBus::instance().post(LayerPropertyChangedEvent{layers[i], "opacity"});
             break;
         }
     }
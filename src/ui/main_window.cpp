@@ -7,9 +7,11 @@
 
 #include "ui/main_window.h"
 
+#include "core/async_command_bus.h"
 #include "core/clipboard_manager.h"
 #include "core/command_bus.h"
 #include "core/commands/crop_command.h"
+#include "core/commands/filter_command.h"
 #include "core/commands/resize_command.h"
 #include "core/commands/selection_command.h"
 #include "core/document.h"
@@ -31,6 +33,7 @@
 #include "core/tools/move_tool.h"
 #include "core/tools/pencil_tool.h"
 #include "core/tools/rect_selection_tool.h"
+#include "core/undo_swap_file.h"
 #include "io/io_manager.h"
 #include "io/project_file.h"
 #include "render/skia_renderer.h"
@@ -68,8 +71,10 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <filesystem>
+#include <utility>
 
 namespace {
 
@@ -99,7 +104,15 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent)
 
     m_renderer = std::make_shared<SkiaRenderer>();
     m_historyManager = std::make_unique<SimpleHistoryManager>();
-    m_commandBus = std::make_unique<BasicCommandBus>(*m_historyManager);
+    m_historyManager->set_swap_file(UndoSwapFile::create());
+    m_commandBus = std::make_unique<AsyncCommandBus>(*m_historyManager);
+    // Workers wake the GUI thread, which commits finished commands
+    m_commandBus->setCompletionNotifier([this]() {
+        QMetaObject::invokeMethod(
+            this, [this]() { m_commandBus->processCompletions(); }, Qt::QueuedConnection);
+    });
+    // Quick nudges and selection tweaks collapse into one undo step
+    m_commandBus->setCoalesceWindow(std::chrono::milliseconds{500});
     m_recentFilesManager = std::make_unique<RecentFilesManager>();
 
     // Register tools with the factory
@@ -115,6 +128,13 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent)
     factory.registerTool("select_rect", []() { return std::make_unique<RectSelectTool>(); });
     factory.registerTool("select_free", []() { return std::make_unique<FreeSelectTool>(); });
 
+    // Queued events (mouse position, view, slider drags) reach handlers once
+    // per event-loop iteration rather than once per input event
+    EventBus::instance().setFlushScheduler([this]() {
+        QMetaObject::invokeMethod(
+            this, []() { EventBus::instance().flush(); }, Qt::QueuedConnection);
+    });
+
     // Subscribe to tool changes to update ToolFactory
     m_toolChangedSubscription =
         EventBus::instance().subscribe<ToolChangedEvent>([this](const ToolChangedEvent& event) {
@@ -153,6 +173,24 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent)
             m_lastCanvasMousePos = QPoint(event.canvasX, event.canvasY);
         });
 
+    // Repaint once an asynchronous command is committed
+    m_commandCompletedSubscription = EventBus::instance().subscribe<CommandCompletedEvent>(
+        [this](const CommandCompletedEvent& event) {
+            if (m_canvasWidget != nullptr) {
+                m_canvasWidget->invalidateCache();
+            }
+            const auto* filterCommand = dynamic_cast<const FilterCommand*>(event.command.get());
+            if (filterCommand == nullptr || !filterCommand->filter()) {
+                return;
+            }
+            const QString name = QString::fromStdString(filterCommand->filter()->name());
+            if (filterCommand->succeeded()) {
+                statusBar()->showMessage(QString("Applied %1").arg(name.toLower()), 2000);
+            } else {
+                statusBar()->showMessage(QString("Failed to apply %1").arg(name.toLower()), 2000);
+            }
+        });
+
     // Create log bridge and panel
     m_logBridge = new LogBridge(this);
     m_logPanel = new LogPanel(this);
@@ -203,6 +241,8 @@ MainWindow::~MainWindow()
     EventBus::instance().unsubscribe(m_colorChangedSubscription);
     EventBus::instance().unsubscribe(m_layerSelectionSubscription);
     EventBus::instance().unsubscribe(m_mousePositionSubscription);
+    EventBus::instance().unsubscribe(m_commandCompletedSubscription);
+    EventBus::instance().setFlushScheduler({});
 }
 
 void MainWindow::setupMenuBar()
@@ -210,6 +250,7 @@ void MainWindow::setupMenuBar()
     auto* fileMenu = menuBar()->addMenu("&File");
     fileMenu->addAction("&New Project", QKeySequence::New, this, &MainWindow::onNewProject);
     fileMenu->addAction("&Open Project...", QKeySequence::Open, this, &MainWindow::onOpenProject);
+    fileMenu->addAction("Open &Image...", this, &MainWindow::onOpenImage);
     m_openRecentMenu = fileMenu->addMenu("Open &Recent");
     refreshRecentFilesMenu();
     fileMenu->addSeparator();
@@ -433,6 +474,9 @@ void MainWindow::createDocument(const NewDocumentSettings& settings)
     m_layersPanel->setDocument(m_document);
     m_debugHud->setDocument(m_document);
 
+    if (m_commandBus) {
+        m_commandBus->waitIdle();  // Commit work on the old document before its history goes
+    }
     if (m_historyManager) {
         m_historyManager->clear();
     }
@@ -635,15 +679,14 @@ void MainWindow::onApplyBlur()
         statusBar()->showMessage("No active layer", 2000);
         return;
     }
-    BlurFilter filter;
-    filter.setRadius(static_cast<float>(radius));
+    auto filter = std::make_shared<BlurFilter>();
+    filter->setRadius(static_cast<float>(radius));
 
-    if (filter.apply(layer)) {
-        m_canvasWidget->update();
-        statusBar()->showMessage(QString("Applied blur with radius %1").arg(radius), 2000);
-    } else {
-        statusBar()->showMessage("Failed to apply blur filter", 2000);
-    }
+    // The command keeps the filter and its parameters; undo restores a checkpoint.
+    // It renders on a worker; CommandCompletedEvent reports the result.
+    auto cmd = std::make_shared<FilterCommand>(layer, filter);
+    m_commandBus->dispatchAsync(cmd, m_document.get());
+    statusBar()->showMessage(QString("Applying blur with radius %1...").arg(radius));
 }
 
 void MainWindow::onApplySharpen()
@@ -666,15 +709,12 @@ void MainWindow::onApplySharpen()
         statusBar()->showMessage("No active layer", 2000);
         return;
     }
-    SharpenFilter filter;
-    filter.setAmount(static_cast<float>(amount));
+    auto filter = std::make_shared<SharpenFilter>();
+    filter->setAmount(static_cast<float>(amount));
 
-    if (filter.apply(layer)) {
-        m_canvasWidget->update();
-        statusBar()->showMessage(QString("Applied sharpen with amount %1").arg(amount), 2000);
-    } else {
-        statusBar()->showMessage("Failed to apply sharpen filter", 2000);
-    }
+    auto cmd = std::make_shared<FilterCommand>(layer, filter);
+    m_commandBus->dispatchAsync(cmd, m_document.get());
+    statusBar()->showMessage(QString("Applying sharpen with amount %1...").arg(amount));
 }
 
 void MainWindow::onSelectAll()
@@ -781,15 +821,17 @@ std::shared_ptr<ProjectFile> MainWindow::buildProjectSnapshot() const
         newLayer->setVisible(layer->visible());
         newLayer->setOpacity(layer->opacity());
         newLayer->setBlendMode(layer->blendMode());
+        newLayer->setPixelFormat(layer->pixelFormat());
 
-        if (newLayer->data().size() != layer->data().size()) {
+        const auto& pixels = std::as_const(*layer).data();
+        if (std::as_const(*newLayer).data().size() != pixels.size()) {
             error::ErrorHandler::GetInstance().ReportError(
                 error::ErrorCode::InvalidArgumentSize,
                 "Layer data size mismatch while saving project");
             return nullptr;
         }
 
-        newLayer->data() = layer->data();
+        newLayer->assignPixels(pixels, layer->pixelFormat());
     }
 
     return snapshot;
@@ -825,6 +867,9 @@ void MainWindow::onOpenProject()
         m_canvasWidget->fitInView();
     }
 
+    if (m_commandBus) {
+        m_commandBus->waitIdle();  // Commit work on the old document before its history goes
+    }
     if (m_historyManager) {
         m_historyManager->clear();
     }
@@ -836,6 +881,46 @@ void MainWindow::onOpenProject()
     statusBar()->showMessage("Project loaded", 2000);
 }
 
+void MainWindow::onOpenImage()
+{
+    const QString filePath = QFileDialog::getOpenFileName(
+        this,
+        "Open Image",
+        QString(),
+        "Images (*.png *.jpg *.jpeg *.bmp *.tif *.tiff *.webp *.exr *.hdr)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    IOManager ioManager;
+    auto result = ioManager.loadImage(std::filesystem::path(filePath.toStdString()));
+    if (!result.IsOk()) {
+        error::ErrorHandler::GetInstance().ReportError(result.Error().GetCode(),
+                                                       result.Error().GetMessage());
+        statusBar()->showMessage("Failed to open image", 3000);
+        return;
+    }
+
+    set_document(result.Value());
+    if (m_canvasWidget) {
+        m_canvasWidget->fitInView();
+    }
+
+    if (m_commandBus) {
+        m_commandBus->waitIdle();  // Commit work on the old document before its history goes
+    }
+    if (m_historyManager) {
+        m_historyManager->clear();
+    }
+    if (m_historyPanel) {
+        m_historyPanel->clear();
+    }
+
+    // Saving asks for a project path instead of overwriting the image
+    m_projectPath.clear();
+    statusBar()->showMessage("Image loaded", 2000);
+}
+
 void MainWindow::onSaveProject()
 {
     if (!m_document) {
@@ -848,6 +933,8 @@ void MainWindow::onSaveProject()
         return;
     }
 
+    // Filters still running belong in the saved file
+    m_commandBus->waitIdle();
     auto snapshot = buildProjectSnapshot();
     if (!snapshot) {
         statusBar()->showMessage("Failed to prepare project for saving", 3000);
@@ -945,12 +1032,20 @@ void MainWindow::onCropToSelection()
     }
 
     auto cmd = std::make_shared<CropCommand>(m_document, cropBounds);
+    auto clearSelection = std::make_shared<SelectionCommand>("Clear Selection");
+    clearSelection->captureBeforeState();
     if (m_commandBus) {
+        // Crop and selection clear undo together as one step
+        CommandTransaction transaction{*m_commandBus};
         m_commandBus->dispatch(cmd);
-    }
 
-    // Clear selection after crop - the canvas now matches the selection bounds
-    SelectionManager::instance().clear();
+        // Clear selection after crop - the canvas now matches the selection bounds
+        SelectionManager::instance().clear();
+        clearSelection->captureAfterState();
+        m_commandBus->dispatch(clearSelection);
+    } else {
+        SelectionManager::instance().clear();
+    }
 
     // Reset selection tools to clear stale local state (phase, currentBounds)
     auto& factory = ToolFactory::instance();
@@ -988,7 +1083,7 @@ void MainWindow::onCut()
     }
 
     if (ClipboardManager::instance().cutSelection(m_document, nullptr, m_commandBus.get())) {
-        m_canvasWidget->update();
+        m_canvasWidget->invalidateCache();
         statusBar()->showMessage("Cut to clipboard", 1000);
     } else {
         statusBar()->showMessage("Nothing to cut (no selection)", 2000);
@@ -1032,7 +1127,7 @@ void MainWindow::onPaste()
 
     if (ClipboardManager::instance().pasteToDocument(
             m_document, m_commandBus.get(), m_lastCanvasMousePos, useCursor)) {
-        m_canvasWidget->update();
+        m_canvasWidget->invalidateCache();
         statusBar()->showMessage("Pasted from clipboard", 1000);
     } else {
         statusBar()->showMessage("Nothing to paste", 2000);
@@ -1113,6 +1208,9 @@ bool MainWindow::openProjectFromPath(const QString& filePath, bool addToRecent)
         m_canvasWidget->fitInView();
     }
 
+    if (m_commandBus) {
+        m_commandBus->waitIdle();  // Commit work on the old document before its history goes
+    }
     if (m_historyManager) {
         m_historyManager->clear();
     }
@@ -12,6 +12,7 @@
 #include "core/events.h"
 #include "core/layer.h"
 #include "core/selection_manager.h"
+#include "core/tile_store.h"
 #include "core/tool.h"
 #include "core/tool_factory.h"
 #include "core/tool_registry.h"
@@ -38,6 +39,7 @@
 #include <include/core/SkImage.h>
 #include <include/core/SkImageInfo.h>
 #include <include/core/SkPixmap.h>
+#include <include/core/SkSurface.h>
 
 namespace gimp {
 
@@ -63,11 +65,11 @@ SkiaCanvasWidget::SkiaCanvasWidget(std::shared_ptr<Document> document,
 
     // Subscribe to layer events to refresh canvas when layers change
     m_layerStackSub = EventBus::instance().subscribe<LayerStackChangedEvent>(
-        [this](const LayerStackChangedEvent& /*event*/) { update(); });
+        [this](const LayerStackChangedEvent& /*event*/) { invalidateCache(); });
     m_layerSelectionSub = EventBus::instance().subscribe<LayerSelectionChangedEvent>(
         [this](const LayerSelectionChangedEvent& /*event*/) { update(); });
     m_layerPropertySub = EventBus::instance().subscribe<LayerPropertyChangedEvent>(
-        [this](const LayerPropertyChangedEvent& /*event*/) { update(); });
+        [this](const LayerPropertyChangedEvent& /*event*/) { invalidateCache(); });
 }
 
 SkiaCanvasWidget::~SkiaCanvasWidget()
@@ -171,13 +173,16 @@ void SkiaCanvasWidget::zoomOut()
 
 void SkiaCanvasWidget::invalidateCache()
 {
+    if (m_document) {
+        m_document->tileStore().invalidateAll();
+    }
     update();
 }
 
 void SkiaCanvasWidget::setDocument(std::shared_ptr<Document> document)
 {
     m_document = std::move(document);
-    update();
+    invalidateCache();
 }
 
 void SkiaCanvasWidget::initializeGL()
@@ -198,6 +203,67 @@ void SkiaCanvasWidget::resizeGL(int /*w*/, int /*h*/)
     // Surfaces will be recreated on next render - nothing to do here
 }
 
+QImage SkiaCanvasWidget::presentableImage()
+{
+    SkSurface* surface = m_renderer->surface();
+    if (!surface) {
+        return {};
+    }
+
+    // Raster fallback: present the surface memory directly, no readback or copy
+    if (!m_renderer->isUsingGpu()) {
+        SkPixmap pixmap;
+        if (surface->peekPixels(&pixmap)) {
+            const QImage::Format format = pixmap.colorType() == kRGBA_8888_SkColorType
+                                              ? QImage::Format_RGBA8888_Premultiplied
+                                              : QImage::Format_ARGB32_Premultiplied;
+            return QImage(static_cast<const uchar*>(pixmap.addr()),
+                          pixmap.width(),
+                          pixmap.height(),
+                          static_cast<qsizetype>(pixmap.rowBytes()),
+                          format);
+        }
+    }
+
+    // GPU: keep a persistent image and read back only what the renderer redrew
+    const int imgW = surface->width();
+    const int imgH = surface->height();
+    bool fullReadback = false;
+    if (m_presentImage.width() != imgW || m_presentImage.height() != imgH) {
+        m_presentImage = QImage(imgW, imgH, QImage::Format_ARGB32_Premultiplied);
+        fullReadback = true;
+    }
+
+    // Use BGRA format for SkPixmap to match QImage's byte order on Windows
+    const SkImageInfo targetInfo =
+        SkImageInfo::Make(imgW, imgH, kBGRA_8888_SkColorType, kPremul_SkAlphaType);
+    const SkPixmap target(targetInfo, m_presentImage.bits(), m_presentImage.bytesPerLine());
+
+    auto readBack = [&](const SkIRect& region) {
+        SkPixmap subset;
+        if (!target.extractSubset(&subset, region)) {
+            return true;  // Region lies outside the surface, nothing to copy
+        }
+        return surface->readPixels(subset, region.x(), region.y());
+    };
+
+    bool ok = true;
+    if (fullReadback) {
+        ok = readBack(SkIRect::MakeWH(imgW, imgH));
+    } else {
+        for (const Rect& rect : m_renderer->lastRenderedRegions()) {
+            ok = readBack(SkIRect::MakeXYWH(rect.x, rect.y, rect.w, rect.h)) && ok;
+        }
+    }
+
+    if (!ok) {
+        spdlog::warn("SkiaCanvasWidget: readPixels failed");
+        m_presentImage = QImage();  // Force a full readback next frame
+        return {};
+    }
+    return m_presentImage;
+}
+
 void SkiaCanvasWidget::paintGL()
 {
     const auto startTime = std::chrono::high_resolution_clock::now();
@@ -212,30 +278,18 @@ void SkiaCanvasWidget::paintGL()
         return;
     }
 
-    // 1. Render document via Skia (GPU or CPU based on context)
-    m_renderer->render(*m_document);
+    // Paint tools composite the dabs buffered since the last frame onto the layer
+    if (Tool* tool = activeTool()) {
+        tool->prepareFrame();
+    }
+
+    // 1. Render the visible part of the document via Skia (GPU or CPU based on context),
+    //    redrawing only dirty tiles that are on screen
+    m_renderer->render(*m_document, m_document->tileStore(), m_viewport, width(), height());
 
-    // 2. Copy rendered surface to QImage BEFORE resetting GL state
+    // 2. Get the rendered surface as a QImage BEFORE resetting GL state
     //    GPU readPixels requires valid Skia GL state
-    QImage renderImage;
-    auto skImage = m_renderer->get_result();
-    if (skImage) {
-        const int imgW = skImage->width();
-        const int imgH = skImage->height();
-
-        // Create QImage with correct format for Windows (BGRA)
-        renderImage = QImage(imgW, imgH, QImage::Format_ARGB32_Premultiplied);
-
-        // Use BGRA format for SkPixmap to match QImage's byte order on Windows
-        const SkImageInfo targetInfo =
-            SkImageInfo::Make(imgW, imgH, kBGRA_8888_SkColorType, kPremul_SkAlphaType);
-        const SkPixmap pixmap(targetInfo, renderImage.bits(), renderImage.bytesPerLine());
-
-        if (!skImage->readPixels(pixmap, 0, 0)) {
-            spdlog::warn("SkiaCanvasWidget: readPixels failed");
-            renderImage = QImage();  // Clear on failure
-        }
-    }
+    const QImage renderImage = presentableImage();
 
     // 3. Flush Skia GPU work
     m_gpuContext->flush();
@@ -256,10 +310,9 @@ void SkiaCanvasWidget::paintGL()
     // Draw checkerboard pattern for transparency visualization
     drawCheckerboard(painter, targetRect);
 
-    // Draw the pre-rendered document image
+    // Draw the pre-rendered view; pan and zoom are already applied by the renderer
     if (!renderImage.isNull()) {
-        painter.setRenderHint(QPainter::SmoothPixmapTransform, m_viewport.zoomLevel < 1.0F);
-        painter.drawImage(targetRect, renderImage);
+        painter.drawImage(QPoint(0, 0), renderImage);
     }
 
     // Draw pixel grid at high zoom
@@ -684,7 +737,7 @@ void SkiaCanvasWidget::enterEvent(QEnterEvent* event)
 void SkiaCanvasWidget::leaveEvent(QEvent* event)
 {
     (void)event;
-    EventBus::instance().publish(MousePositionChangedEvent{-1, -1, -1, -1});
+    EventBus::instance().post(MousePositionChangedEvent{-1, -1, -1, -1});
 }
 
 void SkiaCanvasWidget::updateCursor()
@@ -719,7 +772,7 @@ void SkiaCanvasWidget::emitViewportChanged()
     event.zoomLevel = m_viewport.zoomLevel;
     event.panX = m_viewport.panX;
     event.panY = m_viewport.panY;
-    EventBus::instance().publish(event);
+    EventBus::instance().post(event);
 }
 
 void SkiaCanvasWidget::emitMousePosition(const QPoint& screenPos) const
@@ -731,7 +784,7 @@ void SkiaCanvasWidget::emitMousePosition(const QPoint& screenPos) const
     event.canvasY = static_cast<int>(std::floor(canvasPos.y()));
     event.screenX = screenPos.x();
     event.screenY = screenPos.y();
-    EventBus::instance().publish(event);
+    EventBus::instance().post(event);
 }
 
 void SkiaCanvasWidget::dispatchToolEvent(QMouseEvent* event, bool isPress, bool isRelease)
@@ -850,9 +903,9 @@ void SkiaCanvasWidget::dispatchToolEvent(QMouseEvent* event, bool isPress, bool
     } else if (isRelease) {
         handled = tool->onMouseRelease(toolEvent);
         m_isStroking = false;
-        // Full re-render on stroke end for proper compositing
+        // Tools report the pixels they changed to the document's tile store
         if (handled) {
-            invalidateCache();
+            update();
             emit canvasModified();
         }
         return;
@@ -893,19 +946,9 @@ void SkiaCanvasWidget::sampleColorAtPosition(const QPoint& screenPos)
         return;
     }
 
-    const auto& layerData = layer->data();
-    const std::size_t offset = (static_cast<std::size_t>(y) * static_cast<std::size_t>(width) +
-                                static_cast<std::size_t>(x)) *
-                               4;
-
-    const std::uint8_t r = layerData[offset + 0];
-    const std::uint8_t g = layerData[offset + 1];
-    const std::uint8_t b = layerData[offset + 2];
-    const std::uint8_t a = layerData[offset + 3];
-
-    const std::uint32_t color =
-        (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) |
-        (static_cast<std::uint32_t>(b) << 8) | static_cast<std::uint32_t>(a);
+    const Layer& source = *layer;
+    const std::uint32_t color = readColor(
+        source.row(y) + static_cast<std::size_t>(x) * source.bytesPerPixel(), source.pixelFormat());
 
     ColorChangedEvent event;
     event.color = color;
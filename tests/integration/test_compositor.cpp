@@ -5,7 +5,9 @@
  * @date 2025-12-16
  */
 
+#include "core/dirty_tile_store.h"
 #include "core/layer.h"
+#include "render/cpu_compositor.h"
 #include "render/skia_compositor.h"
 
 #include <include/core/SkBitmap.h>
@@ -14,6 +16,10 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 TEST_CASE("SkiaCompositor blends layers correctly", "[render][integration]")
 {
     // Setup
@@ -62,3 +68,135 @@ TEST_CASE("SkiaCompositor blends layers correctly", "[render][integration]")
     REQUIRE((b >= 127 && b <= 128));
     REQUIRE(a == 255);
 }
+
+TEST_CASE("CpuCompositor matches the Skia blend expectations", "[render][integration]")
+{
+    gimp::LayerStack stack;
+
+    auto layer1 = std::make_shared<gimp::Layer>(100, 100);
+    auto* pixels1 = reinterpret_cast<uint32_t*>(layer1->data().data());
+    for (int i = 0; i < 100 * 100; ++i) {
+        pixels1[i] = 0xFF0000FF;
+    }
+    stack.addLayer(layer1);
+
+    auto layer2 = std::make_shared<gimp::Layer>(100, 100);
+    layer2->setOpacity(0.5F);
+    auto* pixels2 = reinterpret_cast<uint32_t*>(layer2->data().data());
+    for (int i = 0; i < 100 * 100; ++i) {
+        pixels2[i] = 0xFFFF0000;
+    }
+    stack.addLayer(layer2);
+
+    gimp::CpuCompositor compositor;
+    const auto pixels = compositor.flatten(stack, 100, 100);
+    const std::uint8_t* px = pixels.data() + (50 * 100 + 50) * 4;
+
+    // Same tolerance as the Skia test above; the CPU result is exactly 127/128
+    REQUIRE((px[0] >= 127 && px[0] <= 128));
+    REQUIRE(px[1] == 0);
+    REQUIRE((px[2] >= 127 && px[2] <= 128));
+    REQUIRE(px[3] == 255);
+}
+
+namespace {
+
+/**
+ * @brief Fills a layer region with a solid RGBA color through writeRegion().
+ */
+void fillRegion(gimp::Layer& layer, const gimp::Rect& region, std::uint32_t rgba)
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(region.w * region.h) * 4U);
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i + 0] = static_cast<std::uint8_t>((rgba >> 24) & 0xFF);
+        pixels[i + 1] = static_cast<std::uint8_t>((rgba >> 16) & 0xFF);
+        pixels[i + 2] = static_cast<std::uint8_t>((rgba >> 8) & 0xFF);
+        pixels[i + 3] = static_cast<std::uint8_t>(rgba & 0xFF);
+    }
+    layer.writeRegion(region, pixels.data());
+}
+
+/**
+ * @brief Composites a stack onto a cleared bitmap.
+ */
+void composeInto(gimp::SkiaCompositor& compositor, const gimp::LayerStack& stack, SkBitmap& bitmap)
+{
+    SkCanvas canvas(bitmap);
+    canvas.clear(SK_ColorTRANSPARENT);
+    compositor.compose(&canvas, stack);
+}
+
+}  // namespace
+
+TEST_CASE("SkiaCompositor uploads only reported regions of a changed layer",
+          "[render][integration]")
+{
+    gimp::LayerStack stack;
+    auto layer = std::make_shared<gimp::Layer>(128, 128);
+    fillRegion(*layer, {0, 0, 128, 128}, 0xFF0000FF);
+    stack.addLayer(layer);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(128, 128);
+    gimp::SkiaCompositor compositor;
+    gimp::DirtyTileStore store(128, 128);
+    store.clear();
+
+    composeInto(compositor, stack, bitmap);
+    REQUIRE(compositor.cachedImageCount() == 1);
+    REQUIRE(bitmap.getColor(100, 100) == SK_ColorRED);
+
+    // Bypass version tracking for one pixel so a full upload would be visible
+    std::uint8_t* stale = layer->data().data();
+    fillRegion(*layer, {0, 0, 8, 8}, 0x00FF00FF);
+    store.invalidateLayer(*layer, {0, 0, 8, 8});
+    const std::size_t offset = (static_cast<std::size_t>(100) * 128 + 100) * 4U;
+    stale[offset + 0] = 0x00;
+    stale[offset + 2] = 0xFF;
+
+    compositor.noteDirty(store, stack);
+    composeInto(compositor, stack, bitmap);
+
+    REQUIRE(bitmap.getColor(4, 4) == SK_ColorGREEN);
+    REQUIRE(bitmap.getColor(100, 100) == SK_ColorRED);
+    REQUIRE(compositor.cachedImageCount() == 1);
+}
+
+TEST_CASE("SkiaCompositor re-uploads a layer changed without a region", "[render][integration]")
+{
+    gimp::LayerStack stack;
+    auto layer = std::make_shared<gimp::Layer>(64, 64);
+    fillRegion(*layer, {0, 0, 64, 64}, 0xFF0000FF);
+    stack.addLayer(layer);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    gimp::SkiaCompositor compositor;
+
+    composeInto(compositor, stack, bitmap);
+    REQUIRE(bitmap.getColor(40, 40) == SK_ColorRED);
+
+    fillRegion(*layer, {0, 0, 64, 64}, 0x0000FFFF);
+    composeInto(compositor, stack, bitmap);
+    REQUIRE(bitmap.getColor(40, 40) == SK_ColorBLUE);
+}
+
+TEST_CASE("SkiaCompositor releases images of removed layers", "[render][integration]")
+{
+    gimp::LayerStack stack;
+    auto first = std::make_shared<gimp::Layer>(32, 32);
+    auto second = std::make_shared<gimp::Layer>(32, 32);
+    stack.addLayer(first);
+    stack.addLayer(second);
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(32, 32);
+    gimp::SkiaCompositor compositor;
+    composeInto(compositor, stack, bitmap);
+    REQUIRE(compositor.cachedImageCount() == 2);
+
+    gimp::DirtyTileStore store(32, 32);
+    stack.removeLayer(second);
+    compositor.noteDirty(store, stack);
+    REQUIRE(compositor.cachedImageCount() == 1);
+}
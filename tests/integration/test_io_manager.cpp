@@ -104,6 +104,35 @@ TEST_CASE("IOManager reads and writes image files", "[io][integration]")
     }
 }
 
+TEST_CASE("IOManager keeps the bit depth of loaded images", "[io][integration]")
+{
+    gimp::IOManager ioManager;
+
+    // 16-bit BGR: blue channel first, alpha is added as fully opaque
+    cv::Mat deep(2, 3, CV_16UC3, cv::Scalar(1000, 2000, 3000));
+    auto layer = ioManager.imageToLayer(gimp::ImageFile(deep, "deep.png"));
+    REQUIRE(layer);
+    REQUIRE(layer->pixelFormat() == gimp::PixelFormat::Rgba16);
+    REQUIRE(layer->data().size() == 2U * 3U * 8U);
+    std::uint16_t px[4] = {};
+    std::memcpy(px, layer->data().data(), sizeof(px));
+    REQUIRE(px[0] == 3000);
+    REQUIRE(px[1] == 2000);
+    REQUIRE(px[2] == 1000);
+    REQUIRE(px[3] == 65535);
+
+    cv::Mat hdr(1, 1, CV_32FC4, cv::Scalar(0.25, 0.5, 2.0, 1.0));
+    layer = ioManager.imageToLayer(gimp::ImageFile(hdr, "hdr.exr"));
+    REQUIRE(layer);
+    REQUIRE(layer->pixelFormat() == gimp::PixelFormat::Rgba32F);
+    float channels[4] = {};
+    std::memcpy(channels, layer->data().data(), sizeof(channels));
+    REQUIRE(channels[0] == 2.0F);
+    REQUIRE(channels[2] == 0.25F);
+
+    REQUIRE_FALSE(ioManager.imageToLayer(gimp::ImageFile(cv::Mat(), "empty.png")));
+}
+
 TEST_CASE("IOManager exports and imports ProjectFile", "[io][integration]")
 {
     gimp::IOManager ioManager;
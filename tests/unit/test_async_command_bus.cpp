@@ -0,0 +1,258 @@
+/**
+ * @file test_async_command_bus.cpp
+ * @brief Unit tests for CommandExecutor and AsyncCommandBus.
+ * @author Laurent Jiang
+ * @date 2026-02-26
+ */
+
+#include "core/async_command_bus.h"
+#include "core/command_executor.h"
+#include "core/commands/filter_command.h"
+#include "core/event_bus.h"
+#include "core/events.h"
+#include "core/filters/filter.h"
+#include "core/layer.h"
+
+#include "history/simple_history_manager.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Layer with a deterministic, non-uniform background.
+std::shared_ptr<gimp::Layer> makeLayer(int width, int height)
+{
+    auto layer = std::make_shared<gimp::Layer>(width, height);
+    auto& data = layer->data();
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = (i % 4 == 3) ? 255 : static_cast<std::uint8_t>(i * 7);
+    }
+    return layer;
+}
+
+/// Adds a constant to every color channel, wrapping around.
+class ShiftFilter : public gimp::Filter {
+  public:
+    explicit ShiftFilter(int shift) : shift_(shift) {}
+
+    [[nodiscard]] std::string id() const override { return "shift"; }
+    [[nodiscard]] std::string name() const override { return "Shift"; }
+    [[nodiscard]] std::string description() const override { return "Shifts colors"; }
+
+    bool apply(std::shared_ptr<gimp::Layer> layer) override
+    {
+        if (!layer) {
+            return false;
+        }
+        auto& data = layer->data();
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (i % 4 != 3) {
+                data[i] = static_cast<std::uint8_t>(data[i] + shift_);
+            }
+        }
+        return true;
+    }
+
+    bool setParameter(const std::string& /*name*/, float /*value*/) override { return false; }
+    bool getParameter(const std::string& /*name*/, float& /*value*/) const override
+    {
+        return false;
+    }
+    [[nodiscard]] float progress() const override { return 1.0F; }
+    [[nodiscard]] bool isRunning() const override { return false; }
+
+  private:
+    int shift_;
+};
+
+std::shared_ptr<gimp::FilterCommand> makeShift(const std::shared_ptr<gimp::Layer>& layer,
+                                               int shift)
+{
+    return std::make_shared<gimp::FilterCommand>(layer, std::make_shared<ShiftFilter>(shift));
+}
+
+}  // namespace
+
+TEST_CASE("CommandExecutor runs tasks with the same key in order", "[command_executor][unit]")
+{
+    std::mutex mutex;
+    std::vector<int> first;
+    std::vector<int> second;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+
+    {
+        gimp::CommandExecutor executor(4);
+        REQUIRE(executor.threadCount() == 4);
+        int keyA = 0;
+        int keyB = 0;
+        for (int i = 0; i < 200; ++i) {
+            executor.submit(&keyA, [&, i] {
+                if (running.fetch_add(1) != 0) {
+                    overlapped = true;
+                }
+                {
+                    const std::scoped_lock lock(mutex);
+                    first.push_back(i);
+                }
+                running.fetch_sub(1);
+            });
+            executor.submit(&keyB, [&, i] {
+                const std::scoped_lock lock(mutex);
+                second.push_back(i);
+            });
+        }
+        executor.waitIdle();
+        REQUIRE(first.size() == 200);
+    }
+
+    REQUIRE_FALSE(overlapped);
+    for (int i = 0; i < 200; ++i) {
+        REQUIRE(first[static_cast<std::size_t>(i)] == i);
+        REQUIRE(second[static_cast<std::size_t>(i)] == i);
+    }
+}
+
+TEST_CASE("AsyncCommandBus commits worker results on the calling thread",
+          "[async_command_bus][unit]")
+{
+    auto layer = makeLayer(300, 200);
+    const auto before = layer->data();
+    auto expected = makeLayer(300, 200);
+    makeShift(expected, 40)->apply();
+
+    gimp::SimpleHistoryManager history;
+    gimp::AsyncCommandBus bus(history, 2);
+    std::atomic<int> notified{0};
+    bus.setCompletionNotifier([&notified] { ++notified; });
+
+    int completed = 0;
+    bool rerun = true;
+    const auto subscription = gimp::EventBus::instance().subscribe<gimp::CommandCompletedEvent>(
+        [&](const gimp::CommandCompletedEvent& event) {
+            ++completed;
+            rerun = event.rerun;
+        });
+
+    auto command = makeShift(layer, 40);
+    bus.dispatchAsync(command);
+    REQUIRE(bus.pendingCount() == 1);
+    REQUIRE(bus.isPending(*layer));
+
+    // Workers render into a copy; the live layer waits for the commit. Read
+    // through a const reference: non-const data() counts as an edit.
+    const gimp::Layer& live = *layer;
+    REQUIRE(live.data() == before);
+    REQUIRE(history.undo_size() == 0);
+
+    bus.waitIdle();
+    gimp::EventBus::instance().unsubscribe(subscription);
+
+    REQUIRE(notified == 1);
+    REQUIRE(completed == 1);
+    REQUIRE_FALSE(rerun);
+    REQUIRE(bus.pendingCount() == 0);
+    REQUIRE_FALSE(bus.isPending(*layer));
+    REQUIRE(command->succeeded());
+    REQUIRE(layer->data() == expected->data());
+    REQUIRE(history.undo_size() == 1);
+
+    REQUIRE(history.undo());
+    REQUIRE(layer->data() == before);
+    REQUIRE(history.redo());
+    REQUIRE(layer->data() == expected->data());
+}
+
+TEST_CASE("AsyncCommandBus chains commands queued on the same layer",
+          "[async_command_bus][unit]")
+{
+    auto layer = makeLayer(128, 96);
+    const auto before = layer->data();
+    auto expected = makeLayer(128, 96);
+    for (int shift : {3, 50, 9}) {
+        makeShift(expected, shift)->apply();
+    }
+
+    gimp::SimpleHistoryManager history;
+    gimp::AsyncCommandBus bus(history, 3);
+    int document = 0;
+    for (int shift : {3, 50, 9}) {
+        bus.dispatchAsync(makeShift(layer, shift), &document);
+    }
+    bus.waitIdle();
+
+    REQUIRE(layer->data() == expected->data());
+    REQUIRE(history.undo_size() == 3);
+    while (history.undo()) {
+    }
+    REQUIRE(layer->data() == before);
+}
+
+TEST_CASE("AsyncCommandBus reruns a command whose layer changed meanwhile",
+          "[async_command_bus][unit]")
+{
+    auto layer = makeLayer(64, 64);
+    auto expected = makeLayer(64, 64);
+
+    gimp::SimpleHistoryManager history;
+    gimp::AsyncCommandBus bus(history, 1);
+    bool rerun = false;
+    const auto subscription = gimp::EventBus::instance().subscribe<gimp::CommandCompletedEvent>(
+        [&](const gimp::CommandCompletedEvent& event) { rerun = event.rerun; });
+
+    bus.dispatchAsync(makeShift(layer, 20));
+
+    // A synchronous edit lands before the result is committed
+    bus.dispatch(makeShift(layer, 100));
+    makeShift(expected, 100)->apply();
+    makeShift(expected, 20)->apply();
+
+    bus.waitIdle();
+    gimp::EventBus::instance().unsubscribe(subscription);
+
+    REQUIRE(rerun);
+    REQUIRE(layer->data() == expected->data());
+    REQUIRE(history.undo_size() == 2);
+}
+
+TEST_CASE("AsyncCommandBus renders a stale command again on a worker",
+          "[async_command_bus][unit]")
+{
+    auto layer = makeLayer(64, 64);
+    auto edited = makeLayer(64, 64);
+    makeShift(edited, 100)->apply();
+    auto expected = makeLayer(64, 64);
+    for (int shift : {100, 20, 7}) {
+        makeShift(expected, shift)->apply();
+    }
+
+    gimp::SimpleHistoryManager history;
+    gimp::AsyncCommandBus bus(history, 1);
+    std::atomic<int> finished{0};
+    bus.setCompletionNotifier([&] { ++finished; });
+
+    bus.dispatchAsync(makeShift(layer, 20));
+    bus.dispatchAsync(makeShift(layer, 7));
+    bus.dispatch(makeShift(layer, 100));
+    while (finished.load() < 2) {
+        std::this_thread::yield();
+    }
+
+    // Both results are stale; committing queues them again instead of running them here
+    bus.processCompletions();
+    REQUIRE(bus.pendingCount() == 2);
+    REQUIRE(layer->data() == edited->data());
+
+    bus.waitIdle();
+    REQUIRE(bus.pendingCount() == 0);
+    REQUIRE(layer->data() == expected->data());
+    REQUIRE(history.undo_size() == 3);
+}
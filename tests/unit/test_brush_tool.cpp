@@ -338,6 +338,45 @@ TEST_CASE("BrushTool with low opacity creates semi-transparent strokes", "[brush
     REQUIRE(alpha > 0);
 }
 
+TEST_CASE("BrushTool applies opacity once per stroke where dabs overlap", "[brush_tool][unit]")
+{
+    gimp::BrushTool tool;
+    tool.setBrushSize(10);
+    tool.setOpacity(0.5F);
+    tool.setHardness(1.0F);
+    tool.setColor(0xFF0000FF);
+
+    auto doc = std::make_shared<gimp::ProjectFile>(100, 100);
+    doc->addLayer();
+    tool.setDocument(doc);
+    const auto& data = doc->layers()[0]->data();
+
+    gimp::ToolInputEvent event;
+    event.canvasPos = QPoint(50, 50);
+    event.buttons = Qt::LeftButton;
+    event.pressure = 1.0F;
+    tool.onMousePress(event);
+
+    // Dabs are buffered until the next frame
+    int centerIdx = (50 * 100 + 50) * 4;
+    REQUIRE(data[centerIdx + 3] == 0);
+    tool.prepareFrame();
+    const uint8_t firstAlpha = data[centerIdx + 3];
+    REQUIRE(firstAlpha > 0);
+
+    // Scrubbing back and forth over the same pixels does not build up alpha
+    for (int i = 0; i < 6; ++i) {
+        event.canvasPos = QPoint(i % 2 == 0 ? 60 : 40, 50);
+        tool.onMouseMove(event);
+        tool.prepareFrame();
+    }
+    event.buttons = Qt::NoButton;
+    tool.onMouseRelease(event);
+
+    REQUIRE(data[centerIdx + 3] == firstAlpha);
+    REQUIRE(data[(50 * 100 + 45) * 4 + 3] == firstAlpha);
+}
+
 TEST_CASE("BrushTool handles empty document gracefully", "[brush_tool][unit]")
 {
     gimp::BrushTool tool;
@@ -368,7 +407,7 @@ TEST_CASE("BrushTool handles document with no layers", "[brush_tool][unit]")
 // ToolOptions Interface Tests
 // ============================================================================
 
-TEST_CASE("BrushTool getOptions returns size, opacity, hardness, velocity_dynamics",
+TEST_CASE("BrushTool getOptions returns size, opacity, hardness, velocity_dynamics, smoothing",
           "[brush_tool][unit]")
 {
     gimp::BrushTool tool;
@@ -377,11 +416,12 @@ TEST_CASE("BrushTool getOptions returns size, opacity, hardness, velocity_dynami
 
     auto options = toolOptions->getOptions();
 
-    REQUIRE(options.size() == 4);
+    REQUIRE(options.size() == 5);
     REQUIRE(options[0].id == "brush_size");
     REQUIRE(options[1].id == "opacity");
     REQUIRE(options[2].id == "hardness");
     REQUIRE(options[3].id == "velocity_dynamics");
+    REQUIRE(options[4].id == "smoothing");
 }
 
 TEST_CASE("BrushTool setOptionValue updates brush_size", "[brush_tool][unit]")
@@ -442,6 +482,22 @@ TEST_CASE("BrushTool setOptionValue updates velocity_dynamics", "[brush_tool][un
     REQUIRE(std::get<bool>(value) == true);
 }
 
+TEST_CASE("BrushTool setOptionValue updates smoothing", "[brush_tool][unit]")
+{
+    gimp::BrushTool tool;
+    auto* toolOptions = dynamic_cast<gimp::ToolOptions*>(&tool);
+    REQUIRE(toolOptions != nullptr);
+
+    REQUIRE(tool.smoothing() == false);
+
+    toolOptions->setOptionValue("smoothing", true);
+    REQUIRE(tool.smoothing() == true);
+
+    auto value = toolOptions->getOptionValue("smoothing");
+    REQUIRE(std::holds_alternative<bool>(value));
+    REQUIRE(std::get<bool>(value) == true);
+}
+
 TEST_CASE("BrushTool getOptionValue returns 0 for unknown option", "[brush_tool][unit]")
 {
     gimp::BrushTool tool;
@@ -5,6 +5,7 @@
  * @date 2026-01-27
  */
 
+#include "render/viewport_state.h"
 #include "ui/skia_canvas_widget.h"
 
 #include <catch2/catch_test_macros.hpp>
@@ -255,3 +256,66 @@ TEST_CASE("Zoom step calculations", "[canvas][viewport][unit]")
         REQUIRE_THAT(zoom, WithinAbs(2.4414, 0.01));
     }
 }
+
+TEST_CASE("Visible document rect follows pan and zoom", "[canvas][viewport][unit]")
+{
+    SECTION("Whole document visible at 100% without pan")
+    {
+        gimp::ViewportState viewport;
+        const gimp::Rect visible = gimp::visibleDocumentRect(viewport, 800, 600, 400, 300);
+        REQUIRE(visible.x == 0);
+        REQUIRE(visible.y == 0);
+        REQUIRE(visible.w == 400);
+        REQUIRE(visible.h == 300);
+    }
+
+    SECTION("High zoom shows a small window of the document")
+    {
+        gimp::ViewportState viewport;
+        viewport.zoomLevel = 32.0F;
+        viewport.panX = -32.0F * 100.0F;
+        viewport.panY = -32.0F * 50.0F;
+
+        const gimp::Rect visible = gimp::visibleDocumentRect(viewport, 640, 320, 4000, 4000);
+        REQUIRE(visible.x == 100);
+        REQUIRE(visible.y == 50);
+        REQUIRE(visible.w == 20);
+        REQUIRE(visible.h == 10);
+    }
+
+    SECTION("Partial pixels at the view edge are included")
+    {
+        gimp::ViewportState viewport;
+        viewport.zoomLevel = 4.0F;
+        viewport.panX = -2.0F;
+
+        const gimp::Rect visible = gimp::visibleDocumentRect(viewport, 10, 8, 100, 100);
+        REQUIRE(visible.x == 0);
+        REQUIRE(visible.w == 3);
+        REQUIRE(visible.h == 2);
+    }
+
+    SECTION("Document panned out of view is empty")
+    {
+        gimp::ViewportState viewport;
+        viewport.panX = 1000.0F;
+
+        const gimp::Rect visible = gimp::visibleDocumentRect(viewport, 800, 600, 400, 300);
+        REQUIRE(visible.w == 0);
+    }
+}
+
+TEST_CASE("Document rects map to covering view rects", "[canvas][viewport][unit]")
+{
+    gimp::ViewportState viewport;
+    viewport.zoomLevel = 2.0F;
+    viewport.panX = 10.0F;
+    viewport.panY = 20.0F;
+
+    const gimp::Rect view = gimp::documentToViewRect(viewport, {5, 5, 10, 4});
+    // Exact mapping is (20, 30) 20x8, grown by one pixel on each side
+    REQUIRE(view.x == 19);
+    REQUIRE(view.y == 29);
+    REQUIRE(view.w == 22);
+    REQUIRE(view.h == 10);
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_command_bus.cpp
+ * @brief Unit tests for BasicCommandBus transactions and coalescing.
+ * @author Laurent Jiang
+ * @date 2026-02-25
+ */
+
+#include "core/command.h"
+#include "core/command_bus.h"
+#include "core/commands/compound_command.h"
+
+#include "history/simple_history_manager.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace {
+
+/// Appends a letter to a log on apply and removes it on undo.
+class LogCommand : public gimp::Command {
+  public:
+    LogCommand(std::string& log, char letter) : log_(log), letter_(letter) {}
+
+    void apply() override { log_.push_back(letter_); }
+    void undo() override
+    {
+        const auto pos = log_.rfind(letter_);
+        if (pos != std::string::npos) {
+            log_.erase(pos, 1);
+        }
+    }
+
+  private:
+    std::string& log_;
+    char letter_;
+};
+
+/// Adds a delta to a value; consecutive nudges on the same value merge.
+class NudgeCommand : public gimp::Command {
+  public:
+    NudgeCommand(int& value, int delta) : value_(&value), delta_(delta) {}
+
+    void apply() override { *value_ += delta_; }
+    void undo() override { *value_ -= delta_; }
+
+    bool mergeWith(gimp::Command& next) override
+    {
+        auto* nudge = dynamic_cast<NudgeCommand*>(&next);
+        if (nudge == nullptr || nudge->value_ != value_) {
+            return false;
+        }
+        delta_ += nudge->delta_;
+        return true;
+    }
+
+  private:
+    int* value_;
+    int delta_;
+};
+
+}  // namespace
+
+TEST_CASE("CommandBus transaction records one undo step", "[command_bus][unit]")
+{
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus bus(history);
+    std::string log;
+
+    {
+        gimp::CommandTransaction transaction{bus};
+        REQUIRE(bus.inTransaction());
+        bus.dispatch(std::make_shared<LogCommand>(log, 'a'));
+        bus.dispatch(std::make_shared<LogCommand>(log, 'b'));
+        bus.dispatch(std::make_shared<LogCommand>(log, 'c'));
+        // Commands are applied as they are dispatched
+        REQUIRE(log == "abc");
+        REQUIRE(history.undo_size() == 0);
+    }
+
+    REQUIRE_FALSE(bus.inTransaction());
+    REQUIRE(history.undo_size() == 1);
+    REQUIRE(history.undo());
+    REQUIRE(log.empty());
+    REQUIRE(history.redo());
+    REQUIRE(log == "abc");
+}
+
+TEST_CASE("CommandBus nested transactions record once", "[command_bus][unit]")
+{
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus bus(history);
+    std::string log;
+
+    bus.beginTransaction();
+    bus.dispatch(std::make_shared<LogCommand>(log, 'a'));
+    bus.beginTransaction();
+    bus.dispatch(std::make_shared<LogCommand>(log, 'b'));
+    bus.endTransaction();
+    REQUIRE(history.undo_size() == 0);
+    bus.endTransaction();
+
+    REQUIRE(history.undo_size() == 1);
+    REQUIRE(history.undo());
+    REQUIRE(log.empty());
+}
+
+TEST_CASE("CommandBus empty transaction records nothing", "[command_bus][unit]")
+{
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus bus(history);
+
+    { gimp::CommandTransaction transaction{bus}; }
+    bus.endTransaction();  // Unbalanced end is ignored
+
+    REQUIRE(history.undo_size() == 0);
+}
+
+TEST_CASE("CommandBus coalesces mergeable commands within the window", "[command_bus][unit]")
+{
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus bus(history);
+    bus.setCoalesceWindow(std::chrono::hours{1});
+    int value = 0;
+
+    bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+    bus.dispatch(std::make_shared<NudgeCommand>(value, 2));
+    bus.dispatch(std::make_shared<NudgeCommand>(value, 3));
+    REQUIRE(value == 6);
+    REQUIRE(history.undo_size() == 1);
+
+    REQUIRE(history.undo());
+    REQUIRE(value == 0);
+    REQUIRE(history.redo());
+    REQUIRE(value == 6);
+}
+
+TEST_CASE("CommandBus does not coalesce when disabled or after undo", "[command_bus][unit]")
+{
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus bus(history);
+    int value = 0;
+
+    SECTION("Zero window")
+    {
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+        REQUIRE(history.undo_size() == 2);
+    }
+
+    SECTION("Redo history pending")
+    {
+        bus.setCoalesceWindow(std::chrono::hours{1});
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+        REQUIRE(history.undo_size() == 1);
+        REQUIRE(history.undo());
+
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 5));
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 5));
+        REQUIRE(value == 10);
+        REQUIRE(history.undo_size() == 1);
+        REQUIRE(history.undo());
+        REQUIRE(value == 0);
+    }
+
+    SECTION("Different command type")
+    {
+        bus.setCoalesceWindow(std::chrono::hours{1});
+        std::string log;
+        bus.dispatch(std::make_shared<NudgeCommand>(value, 1));
+        bus.dispatch(std::make_shared<LogCommand>(log, 'a'));
+        REQUIRE(history.undo_size() == 2);
+    }
+}
+
+TEST_CASE("CompoundCommand merges adjacent children", "[command_bus][unit]")
+{
+    int value = 0;
+    std::string log;
+    gimp::CompoundCommand compound("Batch");
+
+    auto first = std::make_shared<NudgeCommand>(value, 1);
+    first->apply();
+    compound.add(first);
+    auto second = std::make_shared<NudgeCommand>(value, 2);
+    second->apply();
+    compound.add(second);
+    auto letter = std::make_shared<LogCommand>(log, 'x');
+    letter->apply();
+    compound.add(letter);
+
+    REQUIRE(compound.commands().size() == 2);
+    REQUIRE(compound.description() == "Batch");
+
+    compound.undo();
+    REQUIRE(value == 0);
+    REQUIRE(log.empty());
+    compound.apply();
+    REQUIRE(value == 3);
+    REQUIRE(log == "x");
+}
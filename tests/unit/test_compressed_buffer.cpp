@@ -0,0 +1,79 @@
+/**
+ * @file test_compressed_buffer.cpp
+ * @brief Unit tests for CompressedBuffer and compressed DrawCommand snapshots.
+ * @author Laurent Jiang
+ * @date 2026-02-21
+ */
+
+#include "core/commands/draw_command.h"
+#include "core/compressed_buffer.h"
+#include "core/layer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+TEST_CASE("CompressedBuffer round-trips data and deltas", "[compressed_buffer][unit]")
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> base(10000);
+    for (auto& value : base) {
+        value = static_cast<std::uint8_t>(byte(rng));
+    }
+    std::vector<std::uint8_t> target = base;
+    for (std::size_t i = 4000; i < 4100; ++i) {
+        target[i] = 0xFF;
+    }
+
+    const auto compressed = gimp::CompressedBuffer::compress(base);
+    REQUIRE(compressed.rawSize() == base.size());
+    std::vector<std::uint8_t> restored;
+    REQUIRE(compressed.decompress(restored));
+    REQUIRE(restored == base);
+
+    // The delta of a small change is tiny even when the data itself is noise
+    const auto delta = gimp::CompressedBuffer::compressDelta(base, target);
+    REQUIRE(delta.byteSize() < base.size() / 20);
+    REQUIRE(delta.applyDelta(restored));
+    REQUIRE(restored == target);
+
+    std::vector<std::uint8_t> wrongSize(base.size() - 1);
+    REQUIRE_FALSE(delta.applyDelta(wrongSize));
+    REQUIRE(gimp::CompressedBuffer::compress({}).empty());
+    REQUIRE(gimp::CompressedBuffer::compressDelta(base, wrongSize).empty());
+}
+
+TEST_CASE("DrawCommand keeps compressed states and restores them exactly",
+          "[compressed_buffer][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(256, 256);
+    for (std::size_t i = 0; i < layer->data().size(); i += 4) {
+        layer->data()[i + 0] = static_cast<std::uint8_t>(i / 4);
+        layer->data()[i + 3] = 255;
+    }
+    const auto before = layer->data();
+
+    gimp::DrawCommand command(layer, 0, 0, 256, 256);
+    command.captureBeforeState();
+    for (int y = 100; y < 110; ++y) {
+        for (int x = 50; x < 80; ++x) {
+            layer->data()[(static_cast<std::size_t>(y) * 256 + x) * 4 + 1] = 200;
+        }
+    }
+    const auto after = layer->data();
+    command.captureAfterState();
+
+    // A raw copy of both states would hold 2 * 256 KiB
+    REQUIRE(command.byteSize() < 256U * 256U * 4U / 10U);
+
+    command.undo();
+    REQUIRE(layer->data() == before);
+    command.apply();
+    REQUIRE(layer->data() == after);
+    command.undo();
+    REQUIRE(layer->data() == before);
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_cpu_compositor.cpp
+ * @brief Unit tests for the blend kernels and CpuCompositor.
+ * @author Laurent Jiang
+ * @date 2026-02-19
+ */
+
+#include "core/layer.h"
+#include "core/layer_stack.h"
+#include "render/blend_kernels.h"
+#include "render/cpu_compositor.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr gimp::BlendMode kModes[] = {gimp::BlendMode::Normal,   gimp::BlendMode::Multiply,
+                                      gimp::BlendMode::Overlay,  gimp::BlendMode::Screen,
+                                      gimp::BlendMode::Darken,   gimp::BlendMode::Lighten};
+
+/**
+ * @brief Returns random premultiplied RGBA pixels, including fully transparent runs.
+ */
+std::vector<std::uint8_t> randomPremultiplied(std::mt19937& rng, int count)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(count) * 4U);
+    for (int i = 0; i < count; ++i) {
+        std::uint8_t* px = pixels.data() + static_cast<std::size_t>(i) * 4U;
+        // Every fifth group of four pixels is transparent to exercise the skip path
+        const int alpha = ((i / 4) % 5 == 0) ? 0 : byte(rng);
+        px[3] = static_cast<std::uint8_t>(alpha);
+        for (int c = 0; c < 3; ++c) {
+            px[c] = static_cast<std::uint8_t>(alpha == 0 ? 0 : byte(rng) % (alpha + 1));
+        }
+    }
+    return pixels;
+}
+
+/**
+ * @brief Floating-point separable blend of one premultiplied channel (0-1 range).
+ */
+double referenceChannel(gimp::BlendMode mode, double s, double d, double sa, double da)
+{
+    const double outside = s * (1.0 - da) + d * (1.0 - sa);
+    switch (mode) {
+        case gimp::BlendMode::Normal:
+            return s + d * (1.0 - sa);
+        case gimp::BlendMode::Multiply:
+            return outside + s * d;
+        case gimp::BlendMode::Screen:
+            return s + d - s * d;
+        case gimp::BlendMode::Darken:
+            return s + d - std::max(s * da, d * sa);
+        case gimp::BlendMode::Lighten:
+            return s + d - std::min(s * da, d * sa);
+        case gimp::BlendMode::Overlay:
+            return outside + (2.0 * d <= da ? 2.0 * s * d : sa * da - 2.0 * (da - d) * (sa - s));
+    }
+    return 0.0;
+}
+
+}  // namespace
+
+TEST_CASE("Blend kernels are bit-exact across instruction sets", "[blend_kernels][unit]")
+{
+    std::mt19937 rng(1234);
+    // Odd length so the SIMD kernels also run their scalar tails
+    constexpr int kCount = 203;
+    const auto src = randomPremultiplied(rng, kCount);
+    const auto base = randomPremultiplied(rng, kCount);
+
+    const gimp::SimdLevel levels[] = {gimp::SimdLevel::Sse41, gimp::SimdLevel::Avx2};
+    for (const auto mode : kModes) {
+        for (const std::uint8_t opacity : {std::uint8_t{255}, std::uint8_t{128}, std::uint8_t{3}}) {
+            auto expected = base;
+            gimp::blendRowKernel(mode, gimp::SimdLevel::Scalar)(expected.data(), src.data(),
+                                                                 kCount, opacity);
+            for (const auto level : levels) {
+                if (static_cast<int>(level) > static_cast<int>(gimp::detectSimdLevel())) {
+                    continue;
+                }
+                auto actual = base;
+                gimp::blendRowKernel(mode, level)(actual.data(), src.data(), kCount, opacity);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Scalar blend kernels follow the separable blend formulas", "[blend_kernels][unit]")
+{
+    std::mt19937 rng(99);
+    constexpr int kCount = 512;
+    const auto src = randomPremultiplied(rng, kCount);
+    const auto base = randomPremultiplied(rng, kCount);
+
+    for (const auto mode : kModes) {
+        auto result = base;
+        gimp::blendRowKernel(mode, gimp::SimdLevel::Scalar)(result.data(), src.data(), kCount,
+                                                             255);
+        for (std::size_t i = 0; i < result.size(); i += 4) {
+            const double sa = src[i + 3] / 255.0;
+            const double da = base[i + 3] / 255.0;
+            REQUIRE(std::abs(result[i + 3] - std::lround((sa + da - sa * da) * 255.0)) <= 1);
+            REQUIRE(result[i] <= result[i + 3]);
+            for (std::size_t c = 0; c < 3; ++c) {
+                const double expected =
+                    referenceChannel(mode, src[i + c] / 255.0, base[i + c] / 255.0, sa, da);
+                REQUIRE(std::abs(result[i + c] - std::lround(expected * 255.0)) <= 2);
+            }
+        }
+    }
+}
+
+TEST_CASE("Premultiply and unpremultiply round-trip opaque pixels", "[blend_kernels][unit]")
+{
+    const std::vector<std::uint8_t> straight = {10, 200, 30, 255, 200, 100, 50, 128, 9, 9, 9, 0};
+    std::vector<std::uint8_t> premultiplied(straight.size());
+    gimp::premultiplyRow(premultiplied.data(), straight.data(), 3);
+
+    REQUIRE(premultiplied[4] == 100);
+    REQUIRE(premultiplied[5] == 50);
+    REQUIRE(premultiplied[8] == 0);
+
+    std::vector<std::uint8_t> restored(straight.size());
+    gimp::unpremultiplyRow(restored.data(), premultiplied.data(), 3);
+    REQUIRE(std::equal(restored.begin(), restored.begin() + 4, straight.begin()));
+    REQUIRE(std::abs(restored[4] - 200) <= 1);
+    REQUIRE(restored[11] == 0);
+}
+
+TEST_CASE("CpuCompositor blends layers with opacity", "[cpu_compositor][unit]")
+{
+    gimp::LayerStack stack;
+    auto background = std::make_shared<gimp::Layer>(16, 16);
+    auto overlay = std::make_shared<gimp::Layer>(16, 16);
+    for (int i = 0; i < 16 * 16; ++i) {
+        std::uint8_t* bg = background->data().data() + static_cast<std::size_t>(i) * 4U;
+        bg[0] = 255;
+        bg[3] = 255;
+        std::uint8_t* ov = overlay->data().data() + static_cast<std::size_t>(i) * 4U;
+        ov[2] = 255;
+        ov[3] = 255;
+    }
+    overlay->setOpacity(0.5F);
+    stack.addLayer(background);
+    stack.addLayer(overlay);
+
+    gimp::CpuCompositor compositor;
+    const auto pixels = compositor.flatten(stack, 16, 16);
+    const std::uint8_t* px = pixels.data() + (8 * 16 + 8) * 4;
+
+    REQUIRE(px[0] == 127);
+    REQUIRE(px[1] == 0);
+    REQUIRE(px[2] == 128);
+    REQUIRE(px[3] == 255);
+}
+
+TEST_CASE("CpuCompositor composes a sub-region and skips hidden layers", "[cpu_compositor][unit]")
+{
+    gimp::LayerStack stack;
+    auto layer = std::make_shared<gimp::Layer>(8, 8);
+    auto hidden = std::make_shared<gimp::Layer>(8, 8);
+    std::fill(layer->data().begin(), layer->data().end(), std::uint8_t{255});
+    std::fill(hidden->data().begin(), hidden->data().end(), std::uint8_t{0x40});
+    hidden->setVisible(false);
+    stack.addLayer(layer);
+    stack.addLayer(hidden);
+
+    // 4x4 buffer covering document pixels (6..9, 6..9); only 2x2 overlaps the layer
+    std::vector<std::uint8_t> buffer(4 * 4 * 4, 0);
+    gimp::CpuCompositor compositor;
+    compositor.setSimdLevel(gimp::SimdLevel::Scalar);
+    compositor.compose(stack, {6, 6, 4, 4}, buffer.data(), 4 * 4);
+
+    REQUIRE(buffer[(1 * 4 + 1) * 4 + 3] == 255);
+    REQUIRE(buffer[(1 * 4 + 1) * 4 + 0] == 255);
+    REQUIRE(buffer[(2 * 4 + 2) * 4 + 3] == 0);
+}
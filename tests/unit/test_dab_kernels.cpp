@@ -0,0 +1,217 @@
+/**
+ * @file test_dab_kernels.cpp
+ * @brief Unit tests and microbenchmarks for the brush dab kernels.
+ * @author Laurent Jiang
+ * @date 2026-02-28
+ */
+
+#include "core/brush_strategy.h"
+#include "core/dab_kernels.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr gimp::DabOp kOps[] = {gimp::DabOp::Paint,
+                                gimp::DabOp::PaintPremultiplied,
+                                gimp::DabOp::Erase,
+                                gimp::DabOp::ErasePremultiplied};
+
+constexpr gimp::SimdLevel kLevels[] = {
+    gimp::SimdLevel::Scalar, gimp::SimdLevel::Sse41, gimp::SimdLevel::Avx2};
+
+bool isPremultiplied(gimp::DabOp op)
+{
+    return op == gimp::DabOp::PaintPremultiplied || op == gimp::DabOp::ErasePremultiplied;
+}
+
+bool isSupported(gimp::SimdLevel level)
+{
+    return static_cast<int>(level) <= static_cast<int>(gimp::detectSimdLevel());
+}
+
+/**
+ * @brief Returns random RGBA8 pixels with transparent and opaque runs.
+ */
+std::vector<std::uint8_t> randomPixels(std::mt19937& rng, int count, bool premultiplied)
+{
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(count) * 4U);
+    for (int i = 0; i < count; ++i) {
+        std::uint8_t* px = pixels.data() + static_cast<std::size_t>(i) * 4U;
+        const int run = (i / 4) % 6;
+        px[3] = static_cast<std::uint8_t>(run == 0 ? 0 : run == 1 ? 255 : byte(rng));
+        for (int c = 0; c < 3; ++c) {
+            const int value = byte(rng);
+            px[c] = static_cast<std::uint8_t>(premultiplied ? value * px[3] / 255 : value);
+        }
+    }
+    return pixels;
+}
+
+/**
+ * @brief Returns random coverage with uncovered runs and fully covered pixels.
+ */
+std::vector<float> randomCoverage(std::mt19937& rng, int count)
+{
+    std::uniform_real_distribution<float> unit(0.0F, 1.0F);
+    std::vector<float> coverage(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const int run = (i / 4) % 7;
+        coverage[i] = run == 0 ? 0.0F : run == 1 ? 1.0F : unit(rng);
+    }
+    return coverage;
+}
+
+}  // namespace
+
+TEST_CASE("Dab kernels are bit-exact across instruction sets", "[dab_kernels][unit]")
+{
+    std::mt19937 rng(4321);
+    // Odd length so the SIMD kernels also run their scalar tails
+    constexpr int kCount = 203;
+    const auto coverage = randomCoverage(rng, kCount);
+
+    for (const auto op : kOps) {
+        const auto base = randomPixels(rng, kCount, isPremultiplied(op));
+        const bool erase = op == gimp::DabOp::Erase || op == gimp::DabOp::ErasePremultiplied;
+        const float scales[] = {erase ? 1.0F : 255.0F, erase ? 0.37F : 93.5F};
+        for (const float scale : scales) {
+            auto expected = base;
+            gimp::dabRowKernel(op, gimp::SimdLevel::Scalar)(
+                expected.data(), coverage.data(), kCount, 0xC0408000, scale);
+            for (const auto level : kLevels) {
+                if (!isSupported(level)) {
+                    continue;
+                }
+                auto actual = base;
+                gimp::dabRowKernel(op, level)(
+                    actual.data(), coverage.data(), kCount, 0xC0408000, scale);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Scalar dab kernels paint and erase covered pixels", "[dab_kernels][unit]")
+{
+    const std::vector<float> coverage = {0.0F, 1.0F, 0.5F};
+    const std::vector<std::uint8_t> base = {1, 2, 3, 4, 10, 20, 30, 0, 100, 100, 100, 255};
+
+    auto painted = base;
+    gimp::dabRowKernel(gimp::DabOp::Paint, gimp::SimdLevel::Scalar)(
+        painted.data(), coverage.data(), 3, 0xFF000000, 255.0F);
+    // Uncovered pixels stay, transparent ones take the color, others blend over
+    REQUIRE(painted == std::vector<std::uint8_t>{1, 2, 3, 4, 255, 0, 0, 255, 177, 50, 50, 255});
+
+    auto premultiplied = base;
+    gimp::dabRowKernel(gimp::DabOp::PaintPremultiplied, gimp::SimdLevel::Scalar)(
+        premultiplied.data(), coverage.data(), 3, 0xFF000000, 255.0F);
+    REQUIRE(premultiplied ==
+            std::vector<std::uint8_t>{1, 2, 3, 4, 255, 0, 0, 255, 177, 50, 50, 255});
+
+    auto erased = base;
+    gimp::dabRowKernel(gimp::DabOp::Erase, gimp::SimdLevel::Scalar)(
+        erased.data(), coverage.data(), 3, 0, 1.0F);
+    REQUIRE(erased == std::vector<std::uint8_t>{1, 2, 3, 4, 10, 20, 30, 0, 100, 100, 100, 127});
+
+    auto erasedPremultiplied = base;
+    gimp::dabRowKernel(gimp::DabOp::ErasePremultiplied, gimp::SimdLevel::Scalar)(
+        erasedPremultiplied.data(), coverage.data(), 3, 0, 1.0F);
+    REQUIRE(erasedPremultiplied ==
+            std::vector<std::uint8_t>{1, 2, 3, 4, 0, 0, 0, 0, 50, 50, 50, 128});
+}
+
+TEST_CASE("Brushes render the same dabs at every instruction set", "[dab_kernels][unit]")
+{
+    constexpr int kSize = 40;
+    std::mt19937 rng(77);
+    std::vector<std::uint8_t> stamp(9 * 7);
+    for (auto& value : stamp) {
+        value = static_cast<std::uint8_t>(rng() & 0xFFU);
+    }
+
+    const auto makeBrushes = [&stamp] {
+        std::vector<std::unique_ptr<gimp::BrushStrategy>> brushes;
+        for (const char* name : {"solid", "soft", "stamp", "eraser"}) {
+            brushes.push_back(gimp::createBrushStrategy(name));
+        }
+        static_cast<gimp::StampBrush&>(*brushes[2]).setStamp(stamp, 9, 7);
+        return brushes;
+    };
+
+    for (const auto format : {gimp::PixelFormat::Rgba8, gimp::PixelFormat::Rgba8Premultiplied}) {
+        const auto base = randomPixels(rng, kSize * kSize, gimp::describe(format).premultiplied);
+        std::vector<std::uint8_t> expected;
+        for (const auto level : kLevels) {
+            if (!isSupported(level)) {
+                continue;
+            }
+            auto pixels = base;
+            for (const auto& brush : makeBrushes()) {
+                brush->setPixelFormat(format);
+                brush->setSimdLevel(level);
+                // Dabs overlap each other and the edges of the buffer
+                for (int i = 0; i < 6; ++i) {
+                    brush->renderDab(
+                        pixels.data(), kSize, kSize, i * 9 - 4, 38 - i * 7, 17, 0x3060C0A0, 0.8F);
+                }
+            }
+            if (expected.empty()) {
+                expected = pixels;
+            }
+            REQUIRE(pixels == expected);
+        }
+    }
+}
+
+TEST_CASE("Dab kernel throughput per instruction set", "[.][dab_kernels][benchmark]")
+{
+    constexpr int kCount = 256;
+    std::mt19937 rng(5);
+    const auto coverage = randomCoverage(rng, kCount);
+    const auto base = randomPixels(rng, kCount, false);
+    const char* names[] = {"scalar", "sse4.1", "avx2"};
+
+    for (const auto level : kLevels) {
+        if (!isSupported(level)) {
+            continue;
+        }
+        const auto paint = gimp::dabRowKernel(gimp::DabOp::Paint, level);
+        const auto erase = gimp::dabRowKernel(gimp::DabOp::Erase, level);
+        auto pixels = base;
+
+        BENCHMARK(std::string("paint row, ") + names[static_cast<int>(level)])
+        {
+            paint(pixels.data(), coverage.data(), kCount, 0x3060C000, 128.0F);
+            return pixels[3];
+        };
+
+        BENCHMARK(std::string("erase row, ") + names[static_cast<int>(level)])
+        {
+            erase(pixels.data(), coverage.data(), kCount, 0, 0.05F);
+            return pixels[3];
+        };
+    }
+
+    gimp::SoftBrush brush;
+    std::vector<std::uint8_t> layer(512 * 512 * 4, 0);
+    for (const auto level : kLevels) {
+        if (!isSupported(level)) {
+            continue;
+        }
+        brush.setSimdLevel(level);
+        BENCHMARK(std::string("soft 64 px dab, ") + names[static_cast<int>(level)])
+        {
+            brush.renderDab(layer.data(), 512, 512, 256, 256, 64, 0x3060C0FF, 0.5F);
+            return layer[256 * 512 * 4 + 256 * 4 + 3];
+        };
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file test_dab_mask_cache.cpp
+ * @brief Unit tests for DabMaskCache and the brushes that use it.
+ * @author Laurent Jiang
+ * @date 2026-02-27
+ */
+
+#include "core/brush_strategy.h"
+#include "core/dab_mask_cache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+/// Distance falloff of a soft dab, computed per pixel like the brush used to.
+float referenceFalloff(int dx, int dy, int size, float hardness)
+{
+    const float radius = std::max(static_cast<float>(size) / 2.0F, 0.5F);
+    const float dist = std::sqrt(static_cast<float>(dx * dx + dy * dy));
+    if (dist > radius) {
+        return 0.0F;
+    }
+    const float exponent = 0.4F / (1.0F - hardness);
+    float f = std::pow(dist / radius, exponent);
+    if (f < 0.5F) {
+        return 1.0F - 2.0F * f * f;
+    }
+    f = 1.0F - f;
+    return 2.0F * f * f;
+}
+
+}  // namespace
+
+TEST_CASE("DabMaskCache returns the same mask for the same key", "[dab_mask_cache][unit]")
+{
+    auto& cache = gimp::DabMaskCache::instance();
+    cache.clear();
+
+    const auto soft = cache.soft(12, 0.5F);
+    REQUIRE(cache.soft(12, 0.5F) == soft);
+    REQUIRE(cache.soft(12, 0.6F) != soft);
+    REQUIRE(cache.soft(14, 0.5F) != soft);
+    REQUIRE(cache.solid(12) != soft);
+
+    // Offsets within one sub-pixel step share a mask
+    const auto shifted = cache.soft(12, 0.5F, 0.5F, 0.0F);
+    REQUIRE(shifted != soft);
+    REQUIRE(cache.soft(12, 0.5F, 0.55F, 0.0F) == shifted);
+    REQUIRE(cache.count() == 5);
+    cache.clear();
+    REQUIRE(cache.count() == 0);
+    REQUIRE(cache.byteSize() == 0);
+}
+
+TEST_CASE("DabMaskCache evicts least recently used masks over budget", "[dab_mask_cache][unit]")
+{
+    auto& cache = gimp::DabMaskCache::instance();
+    cache.clear();
+
+    const auto first = cache.solid(30);
+    const std::size_t maskBytes = cache.byteSize();
+    cache.solid(31);
+    cache.setByteBudget(maskBytes * 2 + maskBytes / 2);
+    REQUIRE(cache.count() == 2);
+
+    cache.solid(30);  // Now the most recently used
+    cache.solid(32);
+    REQUIRE(cache.count() == 2);
+    REQUIRE(cache.solid(30) == first);
+
+    // A mask larger than the budget is still returned, and kept alone
+    cache.setByteBudget(1);
+    REQUIRE(cache.count() == 1);
+    REQUIRE(cache.solid(64)->width == 65);
+    REQUIRE(cache.count() == 1);
+
+    cache.setByteBudget(gimp::DabMaskCache::kDefaultByteBudget);
+    cache.clear();
+}
+
+TEST_CASE("Dab masks cover a circle with the brush falloff", "[dab_mask_cache][unit]")
+{
+    auto& cache = gimp::DabMaskCache::instance();
+
+    const auto solid = cache.solid(10);
+    REQUIRE(solid->left == -5);
+    REQUIRE(solid->top == -5);
+    for (int row = 0; row < solid->height; ++row) {
+        for (int col = 0; col < solid->width; ++col) {
+            const int dx = col + solid->left;
+            const int dy = row + solid->top;
+            const float expected = dx * dx + dy * dy <= 25 ? 1.0F : 0.0F;
+            REQUIRE(solid->row(row)[col] == expected);
+        }
+    }
+
+    const auto soft = cache.soft(10, 0.25F);
+    for (int row = 0; row < soft->height; ++row) {
+        for (int col = 0; col < soft->width; ++col) {
+            const float expected =
+                referenceFalloff(col + soft->left, row + soft->top, 10, 0.25F);
+            REQUIRE(std::abs(soft->row(row)[col] - expected) < 1e-6F);
+        }
+    }
+    REQUIRE(soft->row(-soft->top)[-soft->left] == 1.0F);
+
+    // A hard eraser covers the same circle as a solid dab at full strength
+    const auto eraser = cache.eraser(10, 1.0F);
+    REQUIRE(eraser->coverage == solid->coverage);
+    const auto feathered = cache.eraser(10, 0.0F);
+    REQUIRE(feathered->row(-feathered->top)[-feathered->left] == 1.0F);
+    REQUIRE(feathered->row(-feathered->top)[0] < 0.01F);
+}
+
+TEST_CASE("Soft brush dabs from the cache match per-pixel rendering", "[dab_mask_cache][unit]")
+{
+    constexpr int kSize = 12;
+    constexpr int kDiameter = 9;
+    gimp::SoftBrush brush;
+    brush.setHardness(0.3F);
+
+    // Centered near a corner so the mask is clipped on two sides
+    std::vector<std::uint8_t> pixels(kSize * kSize * 4, 0);
+    brush.renderDab(pixels.data(), kSize, kSize, 2, 10, kDiameter, 0x4080C0FF, 0.8F);
+
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            const float falloff = referenceFalloff(x - 2, y - 10, kDiameter, 0.3F);
+            const auto alpha = static_cast<std::uint8_t>(255.0F * 0.8F * falloff);
+            const std::uint8_t* pixel = pixels.data() + (y * kSize + x) * 4;
+            REQUIRE(pixel[3] == alpha);
+            if (alpha > 0) {
+                REQUIRE(pixel[0] == 0x40);
+                REQUIRE(pixel[2] == 0xC0);
+            }
+        }
+    }
+}
+
+TEST_CASE("Sub-pixel dabs are centered between pixels", "[dab_mask_cache][unit]")
+{
+    constexpr int kSize = 24;
+    const auto render = [](float x, float y) {
+        gimp::SoftBrush brush;
+        std::vector<std::uint8_t> pixels(kSize * kSize * 4, 0);
+        brush.renderSubpixelDab(pixels.data(), kSize, kSize, x, y, 11, 0x4080C0FF, 1.0F);
+        return pixels;
+    };
+    const auto alphaAt = [](const std::vector<std::uint8_t>& pixels, int x, int y) {
+        return pixels[(static_cast<std::size_t>(y) * kSize + x) * 4 + 3];
+    };
+
+    // Pixel centers render like the integer API
+    gimp::SoftBrush brush;
+    std::vector<std::uint8_t> whole(kSize * kSize * 4, 0);
+    brush.renderDab(whole.data(), kSize, kSize, 12, 12, 11, 0x4080C0FF, 1.0F);
+    REQUIRE(render(12.0F, 12.0F) == whole);
+
+    // Half a pixel right, the dab is mirrored around x = 12.5
+    const auto half = render(12.5F, 12.0F);
+    REQUIRE(half != whole);
+    for (int y = 0; y < kSize; ++y) {
+        for (int k = 0; k < 8; ++k) {
+            REQUIRE(alphaAt(half, 12 - k, y) == alphaAt(half, 13 + k, y));
+        }
+    }
+
+    // Centers snap to the nearest quarter pixel
+    REQUIRE(render(12.45F, 12.0F) == half);
+    REQUIRE(render(11.9F, 12.1F) == whole);
+}
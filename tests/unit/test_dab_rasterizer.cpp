@@ -0,0 +1,176 @@
+/**
+ * @file test_dab_rasterizer.cpp
+ * @brief Unit tests and a benchmark for DabRasterizer.
+ * @author Laurent Jiang
+ * @date 2026-03-02
+ */
+
+#include "core/brush_strategy.h"
+#include "core/dab_rasterizer.h"
+#include "core/pixel_format.h"
+#include "core/stroke_buffer.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 150;
+constexpr int kHeight = 130;
+
+std::vector<std::uint8_t> randomPixels(gimp::PixelFormat format)
+{
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(kWidth) * kHeight *
+                                     gimp::describe(format).bytesPerPixel());
+    for (auto& value : pixels) {
+        value = static_cast<std::uint8_t>(byte(rng));
+    }
+    return pixels;
+}
+
+/// Overlapping sub-pixel dabs, some of them hanging off the canvas.
+std::vector<gimp::StrokeDab> overlappingDabs()
+{
+    std::vector<gimp::StrokeDab> dabs;
+    for (int i = 0; i < 24; ++i) {
+        const auto t = static_cast<float>(i);
+        dabs.push_back({-10.0F + 7.25F * t, 140.0F - 6.5F * t, 0.3F + 0.03F * t});
+    }
+    return dabs;
+}
+
+std::vector<std::unique_ptr<gimp::BrushStrategy>> brushes()
+{
+    std::vector<std::unique_ptr<gimp::BrushStrategy>> all;
+    all.push_back(std::make_unique<gimp::SolidBrush>());
+    auto soft = std::make_unique<gimp::SoftBrush>();
+    soft->setHardness(0.2F);
+    all.push_back(std::move(soft));
+    auto stamp = std::make_unique<gimp::StampBrush>();
+    std::vector<std::uint8_t> texture(16 * 16);
+    for (std::size_t i = 0; i < texture.size(); ++i) {
+        texture[i] = static_cast<std::uint8_t>(i * 37);
+    }
+    stamp->setStamp(std::move(texture), 16, 16);
+    all.push_back(std::move(stamp));
+    auto eraser = std::make_unique<gimp::EraserBrush>();
+    eraser->setHardness(0.4F);
+    all.push_back(std::move(eraser));
+    return all;
+}
+
+}  // namespace
+
+TEST_CASE("DabRasterizer bands render exactly like serial dabs", "[dab_rasterizer][unit]")
+{
+    gimp::DabRasterizer serial(0);
+    gimp::DabRasterizer parallel(3);
+    parallel.setParallelThreshold(0);
+    REQUIRE(serial.workerCount() == 0);
+    REQUIRE(parallel.workerCount() == 3);
+
+    const auto dabs = overlappingDabs();
+    const gimp::PixelFormat formats[] = {gimp::PixelFormat::Rgba8,
+                                         gimp::PixelFormat::Rgba8Premultiplied,
+                                         gimp::PixelFormat::Rgba16};
+    for (const auto format : formats) {
+        for (const auto& brush : brushes()) {
+            brush->setPixelFormat(format);
+            for (const int size : {5, 40, 90}) {
+                auto expected = randomPixels(format);
+                for (const auto& dab : dabs) {
+                    brush->renderSubpixelDab(expected.data(),
+                                             kWidth,
+                                             kHeight,
+                                             dab.x,
+                                             dab.y,
+                                             size,
+                                             0x3060C0FF,
+                                             dab.pressure);
+                }
+
+                auto pixels = randomPixels(format);
+                serial.render(*brush, pixels.data(), kWidth, kHeight, dabs, size, 0x3060C0FF);
+                REQUIRE(pixels == expected);
+
+                pixels = randomPixels(format);
+                parallel.render(*brush, pixels.data(), kWidth, kHeight, dabs, size, 0x3060C0FF);
+                REQUIRE(pixels == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("DabRasterizer bands accumulate exactly like serial dabs", "[dab_rasterizer][unit]")
+{
+    gimp::DabRasterizer serial(0);
+    gimp::DabRasterizer parallel(3);
+    parallel.setParallelThreshold(0);
+
+    // An area that does not start at the origin, as when replaying a stroke
+    const gimp::Rect area{-5, 12, kWidth, kHeight - 20};
+    const auto dabs = overlappingDabs();
+    for (const auto& brush : brushes()) {
+        for (const int size : {5, 40, 90}) {
+            gimp::StrokeBuffer expected;
+            expected.begin(area);
+            serial.accumulate(*brush, expected, dabs, size);
+
+            gimp::StrokeBuffer buffer;
+            buffer.begin(area);
+            parallel.accumulate(*brush, buffer, dabs, size);
+            std::vector<std::uint8_t> row(static_cast<std::size_t>(area.w));
+            std::vector<std::uint8_t> expectedRow(row.size());
+            for (int y = area.y; y < area.y + area.h; ++y) {
+                buffer.readRow(y, area.x, area.w, row.data());
+                expected.readRow(y, area.x, area.w, expectedRow.data());
+                REQUIRE(row == expectedRow);
+            }
+        }
+    }
+}
+
+TEST_CASE("DabRasterizer leaves the target alone without dabs in reach", "[dab_rasterizer][unit]")
+{
+    gimp::DabRasterizer rasterizer(2);
+    REQUIRE(rasterizer.parallelThreshold() == gimp::DabRasterizer::kDefaultParallelThreshold);
+
+    // A dab entirely off the canvas and an empty run leave the target alone
+    gimp::SolidBrush brush;
+    auto pixels = randomPixels(gimp::PixelFormat::Rgba8);
+    const auto before = pixels;
+    rasterizer.setParallelThreshold(0);
+    rasterizer.render(brush, pixels.data(), kWidth, kHeight, {{75.0F, -400.0F, 1.0F}}, 300, ~0U);
+    rasterizer.render(brush, pixels.data(), kWidth, kHeight, {}, 300, ~0U);
+    REQUIRE(pixels == before);
+}
+
+TEST_CASE("DabRasterizer throughput on a very large dab", "[.][dab_rasterizer][benchmark]")
+{
+    constexpr int kSize = 1200;
+    gimp::SoftBrush brush;
+    std::vector<std::uint8_t> layer(static_cast<std::size_t>(kSize) * kSize * 4, 0);
+    const std::vector<gimp::StrokeDab> dabs = {{600.0F, 600.0F, 0.5F}};
+
+    gimp::DabRasterizer serial(0);
+    BENCHMARK("soft 1000 px dab, serial")
+    {
+        serial.render(brush, layer.data(), kSize, kSize, dabs, 1000, 0x3060C0FF);
+        return layer[600 * kSize * 4 + 600 * 4 + 3];
+    };
+
+    auto& shared = gimp::DabRasterizer::instance();
+    BENCHMARK("soft 1000 px dab, parallel")
+    {
+        shared.render(brush, layer.data(), kSize, kSize, dabs, 1000, 0x3060C0FF);
+        return layer[600 * kSize * 4 + 600 * 4 + 3];
+    };
+}
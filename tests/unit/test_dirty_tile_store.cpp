@@ -0,0 +1,136 @@
+/**
+ * @file test_dirty_tile_store.cpp
+ * @brief Unit tests for DirtyTileStore invalidation and rectangle coalescing.
+ * @author Laurent Jiang
+ * @date 2026-02-15
+ */
+
+#include "core/dirty_tile_store.h"
+#include "core/layer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+/**
+ * @brief Returns a store with the initial full invalidation already consumed.
+ */
+gimp::DirtyTileStore makeCleanStore(int width, int height)
+{
+    gimp::DirtyTileStore store(width, height);
+    store.clear();
+    return store;
+}
+
+}  // namespace
+
+TEST_CASE("DirtyTileStore starts fully invalid", "[dirty_tile_store][unit]")
+{
+    gimp::DirtyTileStore store(300, 200);
+
+    REQUIRE(store.isFullyInvalid());
+    REQUIRE(store.hasDirtyRegions());
+
+    auto rects = store.dirtyRects();
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0].w == 300);
+    REQUIRE(rects[0].h == 200);
+}
+
+TEST_CASE("DirtyTileStore snaps invalidations to tile bounds", "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(512, 512);
+    REQUIRE_FALSE(store.hasDirtyRegions());
+
+    store.invalidate({70, 10, 4, 4});
+
+    auto rects = store.dirtyRects();
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0].x == 64);
+    REQUIRE(rects[0].y == 0);
+    REQUIRE(rects[0].w == 64);
+    REQUIRE(rects[0].h == 64);
+    REQUIRE(store.dirtyTileCount() == 1);
+}
+
+TEST_CASE("DirtyTileStore coalesces adjacent tiles into rectangles", "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(1024, 1024);
+
+    // A 2x3 block of tiles built from separate small invalidations
+    for (int ty = 2; ty < 5; ++ty) {
+        store.invalidate({64 + 1, ty * 64 + 1, 2, 2});
+        store.invalidate({128 + 1, ty * 64 + 1, 2, 2});
+    }
+
+    auto rects = store.dirtyRects();
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0].x == 64);
+    REQUIRE(rects[0].y == 128);
+    REQUIRE(rects[0].w == 128);
+    REQUIRE(rects[0].h == 192);
+}
+
+TEST_CASE("DirtyTileStore clips edge tiles to the canvas", "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(100, 70);
+
+    store.invalidate({90, 66, 50, 50});
+
+    auto rects = store.dirtyRects();
+    REQUIRE(rects.size() == 1);
+    REQUIRE(rects[0].x == 64);
+    REQUIRE(rects[0].y == 64);
+    REQUIRE(rects[0].w == 36);
+    REQUIRE(rects[0].h == 6);
+
+    store.invalidate({-500, -500, 10, 10});
+    REQUIRE(store.dirtyTileCount() == 1);
+}
+
+TEST_CASE("DirtyTileStore tracks layer invalidations separately", "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(256, 256);
+    gimp::Layer first(256, 256);
+    gimp::Layer second(256, 256);
+
+    store.invalidateLayer(first, {0, 0, 10, 10});
+    store.invalidateLayer(second, {200, 200, 10, 10});
+
+    REQUIRE(store.dirtyRects(first).size() == 1);
+    REQUIRE(store.dirtyRects(first)[0].x == 0);
+    REQUIRE(store.dirtyRects(second).size() == 1);
+    REQUIRE(store.dirtyRects(second)[0].x == 192);
+    REQUIRE(store.dirtyRects().size() == 2);
+
+    gimp::Layer untouched(256, 256);
+    REQUIRE(store.dirtyRects(untouched).empty());
+}
+
+TEST_CASE("DirtyTileStore falls back to a full redraw past the threshold",
+          "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(256, 256);
+
+    // 16 tiles total; 10 dirty tiles exceed the 60% threshold
+    store.invalidate({0, 0, 256, 128});
+    REQUIRE_FALSE(store.isFullyInvalid());
+    store.invalidate({0, 128, 128, 64});
+    REQUIRE(store.isFullyInvalid());
+    REQUIRE(store.dirtyTileCount() == 16);
+}
+
+TEST_CASE("DirtyTileStore clear and resize reset state", "[dirty_tile_store][unit]")
+{
+    auto store = makeCleanStore(128, 128);
+    store.invalidate({0, 0, 1, 1});
+    REQUIRE(store.hasDirtyRegions());
+
+    store.clear();
+    REQUIRE_FALSE(store.hasDirtyRegions());
+    REQUIRE(store.dirtyRects().empty());
+
+    store.setSize(640, 480);
+    REQUIRE(store.isFullyInvalid());
+    REQUIRE(store.dirtyRects()[0].w == 640);
+}
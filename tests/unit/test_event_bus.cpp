@@ -6,9 +6,15 @@
  */
 
 #include "core/event_bus.h"
+#include "core/events.h"
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 namespace {
@@ -144,3 +150,184 @@ TEST_CASE("EventBus unsubscribe with invalid ID does not crash", "[event_bus][un
 
     REQUIRE_NOTHROW(gimp::EventBus::instance().unsubscribe(999999));
 }
+
+TEST_CASE("EventBus handler may unsubscribe itself during publish", "[event_bus][unit]")
+{
+    gimp::EventBus::instance().clear();
+
+    int callCount = 0;
+    int otherCount = 0;
+    gimp::EventBus::SubscriptionId selfId = 0;
+    selfId = gimp::EventBus::instance().subscribe<TestEvent>([&](const TestEvent& /*event*/) {
+        ++callCount;
+        gimp::EventBus::instance().unsubscribe(selfId);
+    });
+    gimp::EventBus::instance().subscribe<TestEvent>(
+        [&otherCount](const TestEvent& /*event*/) { ++otherCount; });
+
+    // The running publish keeps delivering from the list it started with
+    gimp::EventBus::instance().publish(TestEvent{1});
+    gimp::EventBus::instance().publish(TestEvent{2});
+
+    REQUIRE(callCount == 1);
+    REQUIRE(otherCount == 2);
+    gimp::EventBus::instance().clear();
+}
+
+TEST_CASE("EventBus delivers while other threads subscribe and publish", "[event_bus][unit]")
+{
+    gimp::EventBus::instance().clear();
+
+    std::atomic<int> received{0};
+    auto subId = gimp::EventBus::instance().subscribe<TestEvent>(
+        [&received](const TestEvent& /*event*/) { received.fetch_add(1); });
+
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 2000;
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < kThreads; ++t) {
+        publishers.emplace_back([] {
+            for (int i = 0; i < kEvents; ++i) {
+                gimp::EventBus::instance().publish(TestEvent{i});
+            }
+        });
+    }
+    // Churn a second subscriber while the publishers run
+    for (int i = 0; i < 200; ++i) {
+        auto id = gimp::EventBus::instance().subscribe<TestEvent>([](const TestEvent&) {});
+        gimp::EventBus::instance().unsubscribe(id);
+    }
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+
+    REQUIRE(received.load() == kThreads * kEvents);
+    gimp::EventBus::instance().unsubscribe(subId);
+}
+
+TEST_CASE("EventBus post queues events until flush", "[event_bus][unit]")
+{
+    gimp::EventBus::instance().clear();
+
+    std::vector<int> received;
+    gimp::EventBus::instance().subscribe<TestEvent>(
+        [&received](const TestEvent& event) { received.push_back(event.value); });
+
+    gimp::EventBus::instance().post(TestEvent{1});
+    gimp::EventBus::instance().post(TestEvent{2});
+    REQUIRE(received.empty());
+
+    // Types that are not coalesced keep every event, in order
+    gimp::EventBus::instance().flush();
+    REQUIRE(received == std::vector<int>{1, 2});
+
+    gimp::EventBus::instance().flush();
+    REQUIRE(received.size() == 2);
+    gimp::EventBus::instance().clear();
+}
+
+TEST_CASE("EventBus post keeps only the latest coalesced event", "[event_bus][unit]")
+{
+    gimp::EventBus::instance().clear();
+
+    int calls = 0;
+    int lastX = 0;
+    gimp::EventBus::instance().subscribe<gimp::MousePositionChangedEvent>(
+        [&](const gimp::MousePositionChangedEvent& event) {
+            ++calls;
+            lastX = event.canvasX;
+        });
+    std::vector<std::string> properties;
+    gimp::EventBus::instance().subscribe<gimp::LayerPropertyChangedEvent>(
+        [&properties](const gimp::LayerPropertyChangedEvent& event) {
+            properties.push_back(event.propertyName);
+        });
+
+    for (int x = 0; x < 100; ++x) {
+        gimp::EventBus::instance().post(gimp::MousePositionChangedEvent{x, 0, x, 0});
+    }
+    // Repeated changes of one property collapse; other properties stay queued
+    gimp::EventBus::instance().post(gimp::LayerPropertyChangedEvent{nullptr, "opacity"});
+    gimp::EventBus::instance().post(gimp::LayerPropertyChangedEvent{nullptr, "visible"});
+    gimp::EventBus::instance().post(gimp::LayerPropertyChangedEvent{nullptr, "opacity"});
+    gimp::EventBus::instance().flush();
+
+    REQUIRE(calls == 1);
+    REQUIRE(lastX == 99);
+    REQUIRE(properties == std::vector<std::string>{"visible", "opacity"});
+    gimp::EventBus::instance().clear();
+}
+
+TEST_CASE("EventBus asks for one flush per batch of posts", "[event_bus][unit]")
+{
+    gimp::EventBus::instance().clear();
+
+    int scheduled = 0;
+    gimp::EventBus::instance().setFlushScheduler([&scheduled] { ++scheduled; });
+
+    std::vector<int> received;
+    gimp::EventBus::instance().subscribe<TestEvent>([&received](const TestEvent& event) {
+        received.push_back(event.value);
+        if (event.value == 1) {
+            // Posted while flushing: waits for the next flush
+            gimp::EventBus::instance().post(TestEvent{3});
+        }
+    });
+
+    gimp::EventBus::instance().post(TestEvent{1});
+    gimp::EventBus::instance().post(TestEvent{2});
+    REQUIRE(scheduled == 1);
+
+    gimp::EventBus::instance().flush();
+    REQUIRE(received == std::vector<int>{1, 2});
+    REQUIRE(scheduled == 2);
+
+    gimp::EventBus::instance().flush();
+    REQUIRE(received == std::vector<int>{1, 2, 3});
+
+    gimp::EventBus::instance().setFlushScheduler({});
+    gimp::EventBus::instance().clear();
+}
+
+TEST_CASE("EventBus publish cost under contention", "[.][event_bus][benchmark]")
+{
+    gimp::EventBus::instance().clear();
+
+    // Handlers touch only thread-local state, so any contention is the bus's own
+    for (int i = 0; i < 4; ++i) {
+        gimp::EventBus::instance().subscribe<gimp::MousePositionChangedEvent>(
+            [](const gimp::MousePositionChangedEvent& event) {
+                thread_local int sink = 0;
+                sink += event.canvasX;
+            });
+    }
+
+    BENCHMARK("publish, uncontended")
+    {
+        gimp::EventBus::instance().publish(gimp::MousePositionChangedEvent{1, 2, 3, 4});
+    };
+
+    // Background threads publish the same event type as fast as they can
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> publishers;
+    const unsigned hardware = std::thread::hardware_concurrency();
+    const unsigned count = hardware > 2 ? std::min(hardware - 1, 7U) : 1U;
+    for (unsigned t = 0; t < count; ++t) {
+        publishers.emplace_back([&stop] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                gimp::EventBus::instance().publish(gimp::MousePositionChangedEvent{1, 2, 3, 4});
+            }
+        });
+    }
+
+    BENCHMARK("publish, contended")
+    {
+        gimp::EventBus::instance().publish(gimp::MousePositionChangedEvent{1, 2, 3, 4});
+    };
+
+    stop = true;
+    for (auto& publisher : publishers) {
+        publisher.join();
+    }
+    gimp::EventBus::instance().clear();
+}
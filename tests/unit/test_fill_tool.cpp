@@ -9,10 +9,14 @@
 #include "core/layer.h"
 #include "core/tool_factory.h"
 #include "core/tools/fill_tool.h"
+#include "history/simple_history_manager.h"
 #include "io/project_file.h"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <cstdint>
+
 // ============================================================================
 // Basic Property Tests
 // ============================================================================
@@ -517,3 +521,52 @@ TEST_CASE("FillTool handles right mouse button (no action)", "[fill_tool][unit]"
     REQUIRE(data[1] == origG);
     REQUIRE(data[2] == origB);
 }
+
+// ============================================================================
+// Undo Tests
+// ============================================================================
+
+TEST_CASE("FillTool records only the filled region for undo", "[fill_tool][unit]")
+{
+    gimp::FillTool tool;
+    auto doc = std::make_shared<gimp::ProjectFile>(512, 512);
+    auto layer = doc->addLayer();
+    gimp::SimpleHistoryManager history;
+    gimp::BasicCommandBus commandBus(history);
+    tool.setDocument(doc);
+    tool.setCommandBus(&commandBus);
+
+    // A small red square on an opaque white layer
+    auto& data = layer->data();
+    std::fill(data.begin(), data.end(), std::uint8_t{255});
+    for (int y = 200; y < 205; ++y) {
+        for (int x = 300; x < 305; ++x) {
+            const std::size_t idx = (static_cast<std::size_t>(y) * 512 + x) * 4;
+            data[idx] = 255;
+            data[idx + 1] = 0;
+            data[idx + 2] = 0;
+        }
+    }
+    const auto before = data;
+
+    gimp::ToolFactory::instance().setForegroundColor(0x0000FFFF);  // Blue
+    gimp::ToolInputEvent event;
+    event.canvasPos = QPoint(302, 202);
+    event.buttons = Qt::LeftButton;
+    event.pressure = 1.0F;
+    tool.onMousePress(event);
+    event.buttons = Qt::NoButton;
+    tool.onMouseRelease(event);
+
+    const auto after = layer->data();
+    REQUIRE(after[(202 * 512 + 302) * 4 + 2] == 255);
+    REQUIRE(after[(100 * 512 + 100) * 4 + 1] == 255);
+
+    // Undo state covers the 5x5 square, not the 1 MiB layer
+    REQUIRE(history.byte_size() < 1024);
+
+    REQUIRE(history.undo());
+    REQUIRE(layer->data() == before);
+    REQUIRE(history.redo());
+    REQUIRE(layer->data() == after);
+}
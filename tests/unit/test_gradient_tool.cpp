@@ -99,4 +99,37 @@ TEST_CASE("GradientTool color interpolation", "[gradient_tool][unit]")
     REQUIRE(((colorMid >> 8) & 0xFF) > 0);   // Some blue
 }
 
+TEST_CASE("GradientCommand re-renders on redo and restores on undo", "[gradient_tool][unit]")
+{
+    auto layer = std::make_shared<Layer>(100, 40);
+    for (std::size_t i = 0; i < layer->data().size(); ++i) {
+        layer->data()[i] = static_cast<std::uint8_t>(i % 251);
+    }
+    const auto before = layer->data();
+
+    GradientParams params;
+    params.startX = 10;
+    params.endX = 90;
+    params.startColor = 0xFF0000FF;
+    params.endColor = 0x0000FFFF;
+
+    GradientCommand command(layer, params);
+    command.captureBeforeState();
+    command.apply();
+    const auto rendered = layer->data();
+    REQUIRE(rendered[0] == 255);                   // Red before the start point
+    REQUIRE(rendered[99 * 4 + 2] == 255);          // Blue past the end point
+    REQUIRE(rendered[(39 * 100 + 50) * 4] < 255);  // Mixed in between
+
+    command.undo();
+    REQUIRE(layer->data() == before);
+    command.apply();
+    REQUIRE(layer->data() == rendered);
+
+    // Wide formats get the same gradient, converted once
+    auto wide = std::make_shared<Layer>(100, 40, PixelFormat::Rgba16);
+    GradientCommand::render(*wide, params);
+    REQUIRE(wide->pixelsAs(PixelFormat::Rgba8) == rendered);
+}
+
 }  // namespace gimp
@@ -12,6 +12,9 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <memory>
+#include <utility>
+
 namespace {
 
 class TestCommand : public gimp::Command {
@@ -26,6 +29,38 @@ class TestCommand : public gimp::Command {
     int delta_;
 };
 
+class SizedCommand : public gimp::Command {
+  public:
+    explicit SizedCommand(std::size_t bytes) : bytes_(bytes) {}
+
+    void apply() override {}
+    void undo() override {}
+    [[nodiscard]] std::size_t byteSize() const override { return bytes_; }
+
+  private:
+    std::size_t bytes_;
+};
+
+/// Counts a block it shares with other commands only once it holds it alone.
+class SharingCommand : public gimp::Command {
+  public:
+    SharingCommand(std::size_t bytes, std::shared_ptr<const std::size_t> shared)
+        : bytes_(bytes), shared_(std::move(shared))
+    {
+    }
+
+    void apply() override {}
+    void undo() override {}
+    [[nodiscard]] std::size_t byteSize() const override
+    {
+        return bytes_ + (shared_.use_count() == 1 ? *shared_ : 0);
+    }
+
+  private:
+    std::size_t bytes_;
+    std::shared_ptr<const std::size_t> shared_;
+};
+
 }  // namespace
 
 // ============================================================================
@@ -242,3 +277,69 @@ TEST_CASE("SimpleHistoryManager clear", "[history_manager][unit]")
     REQUIRE(manager.undo_size() == 0);
     REQUIRE_FALSE(manager.can_undo());
 }
+
+TEST_CASE("HistoryStack reports bytes and drops the oldest command", "[history_stack][unit]")
+{
+    gimp::HistoryStack stack;
+    stack.push(std::make_shared<SizedCommand>(100));
+    stack.push(std::make_shared<SizedCommand>(20));
+    stack.push(std::make_shared<SizedCommand>(3));
+    stack.undo();
+
+    REQUIRE(stack.byte_size() == 123);
+
+    REQUIRE(stack.drop_oldest() == 100);
+    REQUIRE(stack.undo_size() == 1);
+    REQUIRE(stack.redo_size() == 1);
+    REQUIRE(stack.byte_size() == 23);
+
+    REQUIRE(stack.drop_oldest() == 20);
+    REQUIRE(stack.drop_oldest() == 0);
+}
+
+TEST_CASE("SimpleHistoryManager evicts oldest steps past the memory budget",
+          "[history_manager][unit]")
+{
+    gimp::SimpleHistoryManager manager;
+    REQUIRE(manager.memory_budget() == gimp::SimpleHistoryManager::kDefaultMemoryBudget);
+    manager.set_memory_budget(100);
+
+    manager.push(std::make_shared<SizedCommand>(0));
+    for (int i = 0; i < 4; ++i) {
+        manager.push(std::make_shared<SizedCommand>(30));
+    }
+
+    // 4 x 30 bytes exceed the budget: steps are dropped oldest first until it fits
+    REQUIRE(manager.byte_size() == 90);
+    REQUIRE(manager.undo_size() == 3);
+
+    // A single step larger than the budget stays undoable
+    manager.push(std::make_shared<SizedCommand>(500));
+    REQUIRE(manager.undo_size() == 1);
+    REQUIRE(manager.byte_size() == 500);
+    REQUIRE(manager.undo());
+
+    manager.set_memory_budget(1000);
+    manager.push(std::make_shared<SizedCommand>(10));
+    REQUIRE(manager.byte_size() == 10);
+}
+
+TEST_CASE("SimpleHistoryManager re-measures after dropping a step that shared memory",
+          "[history_manager][unit]")
+{
+    gimp::SimpleHistoryManager manager;
+    manager.set_memory_budget(100);
+
+    auto shared = std::make_shared<const std::size_t>(80);
+    manager.push(std::make_shared<SharingCommand>(60, shared));
+    manager.push(std::make_shared<SharingCommand>(10, shared));
+    shared.reset();
+    manager.push(std::make_shared<SizedCommand>(10));
+    REQUIRE(manager.byte_size() == 80);
+
+    // Dropping the first step leaves the shared 80 bytes to the second one,
+    // so the second step has to go as well
+    manager.push(std::make_shared<SizedCommand>(50));
+    REQUIRE(manager.undo_size() == 2);
+    REQUIRE(manager.byte_size() == 60);
+}
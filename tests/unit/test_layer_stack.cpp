@@ -221,6 +221,69 @@ TEST_CASE("LayerStack reverse iteration", "[layer_stack][unit]")
     REQUIRE(names[2] == "First");
 }
 
+// =============================================================================
+// Layer Version Tests
+// =============================================================================
+
+TEST_CASE("Layer version changes on pixel writes", "[layer][unit]")
+{
+    gimp::Layer layer(64, 64);
+    const std::uint64_t initial = layer.version();
+
+    std::uint8_t pixel[4] = {1, 2, 3, 4};
+    layer.writeRegion({0, 0, 1, 1}, pixel);
+    const std::uint64_t afterWrite = layer.version();
+    REQUIRE(afterWrite != initial);
+
+    (void)layer.row(5);
+    REQUIRE(layer.version() != afterWrite);
+}
+
+TEST_CASE("Layer version ignores const reads", "[layer][unit]")
+{
+    gimp::Layer layer(64, 64);
+    const gimp::Layer& constLayer = layer;
+    const std::uint64_t initial = layer.version();
+
+    (void)constLayer.data();
+    (void)constLayer.row(0);
+    (void)constLayer.snapshot();
+
+    REQUIRE(layer.version() == initial);
+}
+
+TEST_CASE("Layer properties version changes on compositing properties", "[layer][unit]")
+{
+    gimp::Layer layer(16, 16);
+    const std::uint64_t content = layer.version();
+
+    std::uint64_t previous = layer.propertiesVersion();
+    layer.setOpacity(0.5F);
+    REQUIRE(layer.propertiesVersion() != previous);
+
+    previous = layer.propertiesVersion();
+    layer.setVisible(false);
+    REQUIRE(layer.propertiesVersion() != previous);
+
+    previous = layer.propertiesVersion();
+    layer.setBlendMode(gimp::BlendMode::Multiply);
+    REQUIRE(layer.propertiesVersion() != previous);
+
+    // Pixel caches stay valid across property edits, and pixel writes leave properties alone
+    REQUIRE(layer.version() == content);
+    previous = layer.propertiesVersion();
+    (void)layer.row(3);
+    REQUIRE(layer.propertiesVersion() == previous);
+}
+
+TEST_CASE("Layer versions are unique across layers", "[layer][unit]")
+{
+    gimp::Layer first(8, 8);
+    gimp::Layer second(8, 8);
+
+    REQUIRE(first.version() != second.version());
+}
+
 // =============================================================================
 // Active Layer Tracking Tests (using ProjectFile as Document implementation)
 // =============================================================================
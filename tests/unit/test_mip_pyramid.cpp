@@ -0,0 +1,177 @@
+/**
+ * @file test_mip_pyramid.cpp
+ * @brief Unit tests for MipPyramid level construction and incremental updates.
+ * @author Laurent Jiang
+ * @date 2026-02-17
+ */
+
+#include "core/dirty_tile_store.h"
+#include "core/layer.h"
+#include "core/layer_stack.h"
+#include "render/mip_pyramid.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Fills a layer region with a solid RGBA color.
+ */
+void fillRegion(gimp::Layer& layer, const gimp::Rect& region, std::uint32_t rgba)
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(region.w * region.h) * 4U);
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i + 0] = static_cast<std::uint8_t>((rgba >> 24) & 0xFF);
+        pixels[i + 1] = static_cast<std::uint8_t>((rgba >> 16) & 0xFF);
+        pixels[i + 2] = static_cast<std::uint8_t>((rgba >> 8) & 0xFF);
+        pixels[i + 3] = static_cast<std::uint8_t>(rgba & 0xFF);
+    }
+    layer.writeRegion(region, pixels.data());
+}
+
+/**
+ * @brief Returns the RGBA value of a mip level pixel.
+ */
+std::uint32_t pixelAt(const gimp::MipLevel& level, int x, int y)
+{
+    const std::uint8_t* px =
+        level.pixels.data() + (static_cast<std::size_t>(y) * level.width + x) * 4U;
+    return (static_cast<std::uint32_t>(px[0]) << 24) | (static_cast<std::uint32_t>(px[1]) << 16) |
+           (static_cast<std::uint32_t>(px[2]) << 8) | px[3];
+}
+
+}  // namespace
+
+TEST_CASE("MipPyramid picks the level matching the zoom", "[mip_pyramid][unit]")
+{
+    REQUIRE(gimp::MipPyramid::levelForZoom(1.0F) == 0);
+    REQUIRE(gimp::MipPyramid::levelForZoom(4.0F) == 0);
+    REQUIRE(gimp::MipPyramid::levelForZoom(0.8F) == 0);
+    REQUIRE(gimp::MipPyramid::levelForZoom(0.5F) == 1);
+    REQUIRE(gimp::MipPyramid::levelForZoom(0.3F) == 1);
+    REQUIRE(gimp::MipPyramid::levelForZoom(0.1F) == 3);
+
+    REQUIRE(gimp::MipPyramid::levelExtent(100, 1) == 50);
+    REQUIRE(gimp::MipPyramid::levelExtent(101, 1) == 51);
+    REQUIRE(gimp::MipPyramid::levelExtent(101, 3) == 13);
+}
+
+TEST_CASE("MipPyramid builds half-size levels", "[mip_pyramid][unit]")
+{
+    gimp::Layer layer(37, 20);
+    fillRegion(layer, {0, 0, 37, 20}, 0x204060FF);
+
+    gimp::MipPyramid pyramid;
+    pyramid.update(layer, 3);
+
+    REQUIRE(pyramid.builtLevels() == 3);
+    REQUIRE(pyramid.level(1)->width == 19);
+    REQUIRE(pyramid.level(1)->height == 10);
+    REQUIRE(pyramid.level(3)->width == 5);
+    REQUIRE(pyramid.level(3)->height == 3);
+    REQUIRE(pixelAt(*pyramid.level(1), 18, 9) == 0x204060FF);
+    REQUIRE(pixelAt(*pyramid.level(3), 4, 2) == 0x204060FF);
+    REQUIRE(pyramid.level(4) == nullptr);
+}
+
+TEST_CASE("MipPyramid averages with alpha weighting", "[mip_pyramid][unit]")
+{
+    gimp::Layer layer(2, 2);
+    // One opaque red pixel, three transparent pixels with garbage color
+    fillRegion(layer, {0, 0, 2, 2}, 0x00FF0000);
+    fillRegion(layer, {0, 0, 1, 1}, 0xFF0000FF);
+
+    gimp::MipPyramid pyramid;
+    pyramid.update(layer, 1);
+
+    // Color comes only from the opaque pixel; coverage is a quarter
+    REQUIRE(pixelAt(*pyramid.level(1), 0, 0) == 0xFF000040);
+}
+
+TEST_CASE("MipPyramid updates only pending regions", "[mip_pyramid][unit]")
+{
+    gimp::Layer layer(64, 64);
+    fillRegion(layer, {0, 0, 64, 64}, 0x000000FF);
+
+    gimp::MipPyramid pyramid;
+    pyramid.update(layer, 2);
+
+    fillRegion(layer, {0, 0, 4, 4}, 0xFFFFFFFF);
+    pyramid.markDirty({0, 0, 4, 4});
+    pyramid.update(layer, 2);
+
+    REQUIRE(pixelAt(*pyramid.level(1), 0, 0) == 0xFFFFFFFF);
+    REQUIRE(pixelAt(*pyramid.level(1), 1, 1) == 0xFFFFFFFF);
+    REQUIRE(pixelAt(*pyramid.level(1), 2, 2) == 0x000000FF);
+    REQUIRE(pixelAt(*pyramid.level(2), 0, 0) == 0xFFFFFFFF);
+    REQUIRE(pixelAt(*pyramid.level(2), 1, 0) == 0x000000FF);
+}
+
+TEST_CASE("MipPyramid rebuilds when the layer changes without a region",
+          "[mip_pyramid][unit]")
+{
+    gimp::Layer layer(8, 8);
+
+    gimp::MipPyramid pyramid;
+    pyramid.update(layer, 1);
+    REQUIRE(pixelAt(*pyramid.level(1), 3, 3) == 0x00000000);
+
+    fillRegion(layer, {0, 0, 8, 8}, 0x11223344);
+    pyramid.update(layer, 1);
+
+    REQUIRE(pixelAt(*pyramid.level(1), 3, 3) == 0x11223344);
+}
+
+TEST_CASE("MipPyramid keeps its levels while the layer version is unchanged",
+          "[mip_pyramid][unit]")
+{
+    gimp::Layer layer(64, 64);
+    fillRegion(layer, {0, 0, 64, 64}, 0x102030FF);
+
+    gimp::MipPyramid pyramid;
+    REQUIRE(pyramid.update(layer, 2));
+    REQUIRE_FALSE(pyramid.update(layer, 2));
+
+    // Property edits and full invalidations leave unchanged pixels alone
+    layer.setOpacity(0.25F);
+    pyramid.markAllDirty();
+    pyramid.markDirty({0, 0, 8, 8});
+    REQUIRE_FALSE(pyramid.update(layer, 2));
+
+    // A full invalidation after a real change still rebuilds everything
+    fillRegion(layer, {40, 40, 4, 4}, 0xFFFFFFFF);
+    pyramid.markDirty({0, 0, 2, 2});
+    pyramid.markAllDirty();
+    REQUIRE(pyramid.update(layer, 2));
+    REQUIRE(pixelAt(*pyramid.level(1), 20, 20) == 0xFFFFFFFF);
+    REQUIRE(pixelAt(*pyramid.level(2), 10, 10) == 0xFFFFFFFF);
+}
+
+TEST_CASE("LayerMipCache follows tile store regions and drops removed layers",
+          "[mip_pyramid][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(128, 128);
+    gimp::LayerStack layers;
+    layers.addLayer(layer);
+
+    gimp::LayerMipCache cache;
+    REQUIRE(pixelAt(*cache.level(*layer, 1), 10, 10) == 0x00000000);
+
+    gimp::DirtyTileStore store(128, 128);
+    store.clear();
+    fillRegion(*layer, {20, 20, 2, 2}, 0xABCDEFFF);
+    store.invalidateLayer(*layer, {20, 20, 2, 2});
+    cache.noteDirty(store, layers);
+
+    REQUIRE(pixelAt(*cache.level(*layer, 1), 10, 10) == 0xABCDEFFF);
+    REQUIRE(cache.level(*layer, 0) == nullptr);
+
+    layers.removeLayer(layer);
+    cache.prune(layers);
+    // A fresh pyramid is built for the (still alive) layer on demand; at level 2
+    // the 2x2 patch covers a quarter of one 4x4 block
+    REQUIRE(pixelAt(*cache.level(*layer, 2), 5, 5) == 0xABCDEF40);
+}
@@ -477,3 +477,48 @@ TEST_CASE("MoveCommand with empty QRect doesn't crash", "[move_command][unit]")
 
     REQUIRE(true);
 }
+
+TEST_CASE("MoveCommand merges consecutive moves on the same layer", "[move_command][unit]")
+{
+    auto layer = createTestLayer(100, 100);
+    setRegionColor(layer, 10, 10, 20, 20, 255, 0, 0, 255);
+
+    // First nudge: red block from (10, 10) to (15, 10)
+    auto first = std::make_shared<gimp::MoveCommand>(layer, QRect(10, 10, 25, 20));
+    first->captureBeforeState();
+    setRegionColor(layer, 10, 10, 25, 20, 0, 0, 0, 0);
+    setRegionColor(layer, 15, 10, 20, 20, 255, 0, 0, 255);
+    first->captureAfterState();
+
+    // Second nudge: from (15, 10) to (15, 40), outside the first region
+    auto second = std::make_shared<gimp::MoveCommand>(layer, QRect(15, 10, 20, 50));
+    second->captureBeforeState();
+    setRegionColor(layer, 15, 10, 20, 50, 0, 0, 0, 0);
+    setRegionColor(layer, 15, 40, 20, 20, 255, 0, 0, 255);
+    second->captureAfterState();
+
+    REQUIRE(first->mergeWith(*second));
+
+    first->undo();
+    REQUIRE(regionHasColor(layer, 10, 10, 20, 20, 255, 0, 0, 255));
+    REQUIRE(regionHasColor(layer, 15, 40, 20, 20, 0, 0, 0, 0));
+
+    first->apply();
+    REQUIRE(regionHasColor(layer, 10, 10, 5, 20, 0, 0, 0, 0));
+    REQUIRE(regionHasColor(layer, 15, 40, 20, 20, 255, 0, 0, 255));
+}
+
+TEST_CASE("MoveCommand does not merge moves on different layers", "[move_command][unit]")
+{
+    auto layerA = createTestLayer(50, 50);
+    auto layerB = createTestLayer(50, 50);
+
+    auto first = std::make_shared<gimp::MoveCommand>(layerA, QRect(0, 0, 10, 10));
+    first->captureBeforeState();
+    first->captureAfterState();
+    auto second = std::make_shared<gimp::MoveCommand>(layerB, QRect(0, 0, 10, 10));
+    second->captureBeforeState();
+    second->captureAfterState();
+
+    REQUIRE_FALSE(first->mergeWith(*second));
+}
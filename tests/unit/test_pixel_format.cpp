@@ -0,0 +1,222 @@
+/**
+ * @file test_pixel_format.cpp
+ * @brief Unit tests for layer pixel formats and premultiplied painting.
+ * @author Laurent Jiang
+ * @date 2026-02-20
+ */
+
+#include "core/brush_strategy.h"
+#include "core/filters/blur_filter.h"
+#include "core/layer.h"
+#include "core/layer_stack.h"
+#include "core/pixel_format.h"
+#include "render/cpu_compositor.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+TEST_CASE("Premultiplied colors convert exactly for opaque and transparent pixels",
+          "[pixel_format][unit]")
+{
+    REQUIRE(gimp::premultiplyColor(0xC8643280) == 0x64321980);
+    REQUIRE(gimp::premultiplyColor(0x102030FF) == 0x102030FF);
+    REQUIRE(gimp::premultiplyColor(0xFFFFFF00) == 0x00000000);
+    REQUIRE(gimp::unpremultiplyColor(0x102030FF) == 0x102030FF);
+    REQUIRE(gimp::unpremultiplyColor(0x00000000) == 0x00000000);
+
+    // Round trips are exact whenever alpha keeps enough precision
+    for (std::uint32_t value = 0; value < 256; value += 5) {
+        const std::uint32_t color = (value << 24) | (value << 16) | (255 - value) << 8 | 0xFF;
+        REQUIRE(gimp::unpremultiplyColor(gimp::premultiplyColor(color)) == color);
+    }
+}
+
+TEST_CASE("Layer pixel format changes convert in place", "[pixel_format][unit]")
+{
+    gimp::Layer layer(2, 1);
+    layer.data() = {200, 100, 50, 128, 10, 20, 30, 255};
+    REQUIRE(layer.pixelFormat() == gimp::PixelFormat::Rgba8);
+
+    const auto version = layer.version();
+    layer.setPixelFormat(gimp::PixelFormat::Rgba8Premultiplied);
+    REQUIRE(layer.pixelFormat() == gimp::PixelFormat::Rgba8Premultiplied);
+    REQUIRE(layer.version() != version);
+    REQUIRE(layer.data() == std::vector<std::uint8_t>{100, 50, 25, 128, 10, 20, 30, 255});
+
+    // Export boundaries always see straight alpha
+    const auto straight = layer.pixelsAs(gimp::PixelFormat::Rgba8);
+    REQUIRE(std::abs(straight[0] - 200) <= 1);
+    REQUIRE(straight[7] == 255);
+
+    gimp::Layer imported(2, 1, gimp::PixelFormat::Rgba8Premultiplied);
+    imported.assignPixels({255, 255, 255, 0, 255, 0, 0, 51}, gimp::PixelFormat::Rgba8);
+    REQUIRE(imported.data() == std::vector<std::uint8_t>{0, 0, 0, 0, 51, 0, 0, 51});
+}
+
+TEST_CASE("Brush dabs on premultiplied layers match straight-alpha dabs",
+          "[pixel_format][unit]")
+{
+    constexpr int kSize = 16;
+    std::vector<std::uint8_t> straight(kSize * kSize * 4, 0);
+    for (std::size_t i = 0; i < straight.size(); i += 4) {
+        straight[i + 0] = 40;
+        straight[i + 1] = 200;
+        straight[i + 2] = 90;
+        straight[i + 3] = 160;
+    }
+    std::vector<std::uint8_t> premultiplied(straight.size());
+    gimp::premultiplyRow(premultiplied.data(), straight.data(), kSize * kSize);
+
+    gimp::SoftBrush straightBrush;
+    straightBrush.renderDab(straight.data(), kSize, kSize, 8, 8, 10, 0xFF2080C0, 1.0F);
+    gimp::SoftBrush premultipliedBrush;
+    premultipliedBrush.setPixelFormat(gimp::PixelFormat::Rgba8Premultiplied);
+    premultipliedBrush.renderDab(premultiplied.data(), kSize, kSize, 8, 8, 10, 0xFF2080C0, 1.0F);
+
+    std::vector<std::uint8_t> expected(straight.size());
+    gimp::premultiplyRow(expected.data(), straight.data(), kSize * kSize);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(std::abs(premultiplied[i] - expected[i]) <= 2);
+    }
+}
+
+TEST_CASE("CpuCompositor output does not depend on the layer pixel format",
+          "[pixel_format][cpu_compositor][unit]")
+{
+    auto makeStack = [](gimp::PixelFormat format) {
+        gimp::LayerStack stack;
+        auto background = std::make_shared<gimp::Layer>(8, 8);
+        auto overlay = std::make_shared<gimp::Layer>(8, 8);
+        for (std::size_t i = 0; i < background->data().size(); i += 4) {
+            background->data()[i + 1] = 255;
+            background->data()[i + 3] = 255;
+            overlay->data()[i + 0] = 250;
+            overlay->data()[i + 2] = 20;
+            overlay->data()[i + 3] = static_cast<std::uint8_t>(i % 256);
+        }
+        overlay->setBlendMode(gimp::BlendMode::Screen);
+        overlay->setPixelFormat(format);
+        stack.addLayer(background);
+        stack.addLayer(overlay);
+        return stack;
+    };
+
+    gimp::CpuCompositor compositor;
+    const auto fromStraight = compositor.flatten(makeStack(gimp::PixelFormat::Rgba8), 8, 8);
+    const auto fromPremultiplied =
+        compositor.flatten(makeStack(gimp::PixelFormat::Rgba8Premultiplied), 8, 8);
+    REQUIRE(fromStraight == fromPremultiplied);
+}
+
+TEST_CASE("Half floats round-trip and round to nearest", "[pixel_format][unit]")
+{
+    REQUIRE(gimp::floatToHalf(1.0F).bits == 0x3C00);
+    REQUIRE(gimp::floatToHalf(-2.0F).bits == 0xC000);
+    REQUIRE(gimp::floatToHalf(65504.0F).bits == 0x7BFF);
+    REQUIRE(gimp::floatToHalf(1.0e6F).bits == 0x7C00);
+    REQUIRE(gimp::halfToFloat(gimp::Half{0x0001}) == std::ldexp(1.0F, -24));
+
+    for (float value : {0.0F, 0.5F, 0.333F, 1.0F / 255.0F, 2.75F, 1.0e-5F}) {
+        const float restored = gimp::halfToFloat(gimp::floatToHalf(value));
+        REQUIRE(std::abs(restored - value) <= value * (1.0F / 2048.0F) + 1.0e-7F);
+    }
+}
+
+TEST_CASE("Wide layer formats store more bytes and convert back exactly",
+          "[pixel_format][unit]")
+{
+    gimp::Layer layer(2, 1);
+    layer.data() = {200, 100, 50, 128, 10, 20, 30, 255};
+
+    layer.setPixelFormat(gimp::PixelFormat::Rgba16);
+    REQUIRE(layer.bytesPerPixel() == 8U);
+    REQUIRE(layer.data().size() == 16U);
+    std::uint16_t red = 0;
+    std::memcpy(&red, layer.data().data(), sizeof(red));
+    REQUIRE(red == 200 * 257);
+
+    for (const auto format : {gimp::PixelFormat::Rgba16F, gimp::PixelFormat::Rgba32F,
+                              gimp::PixelFormat::Rgba8}) {
+        layer.setPixelFormat(format);
+        REQUIRE(static_cast<int>(layer.bytesPerPixel()) == gimp::describe(format).bytesPerPixel());
+        REQUIRE(layer.pixelsAs(gimp::PixelFormat::Rgba8) ==
+                std::vector<std::uint8_t>{200, 100, 50, 128, 10, 20, 30, 255});
+    }
+
+    // Snapshots of wide layers restore every byte
+    gimp::Layer wide(33, 9, gimp::PixelFormat::Rgba32F);
+    for (std::size_t i = 0; i < wide.data().size(); ++i) {
+        wide.data()[i] = static_cast<std::uint8_t>(i * 7);
+    }
+    const auto original = wide.data();
+    const auto tiles = wide.snapshot();
+    std::fill(wide.data().begin(), wide.data().end(), std::uint8_t{0});
+    REQUIRE(wide.restore(tiles));
+    REQUIRE(wide.data() == original);
+}
+
+TEST_CASE("Brush dabs and blur on wide layers match 8-bit results",
+          "[pixel_format][unit]")
+{
+    constexpr int kSize = 16;
+    gimp::Layer reference(kSize, kSize);
+    gimp::SoftBrush brush;
+    brush.renderDab(reference.data().data(), kSize, kSize, 8, 8, 10, 0xFF2080C0, 1.0F);
+    gimp::BlurFilter blur;
+    blur.setRadius(2.0F);
+    auto referenceLayer = std::make_shared<gimp::Layer>(reference);
+    REQUIRE(blur.apply(referenceLayer));
+    const auto expected = referenceLayer->pixelsAs(gimp::PixelFormat::Rgba8);
+
+    for (const auto format : {gimp::PixelFormat::Rgba16, gimp::PixelFormat::Rgba16F,
+                              gimp::PixelFormat::Rgba32F}) {
+        auto layer = std::make_shared<gimp::Layer>(kSize, kSize, format);
+        gimp::SoftBrush wideBrush;
+        wideBrush.setPixelFormat(format);
+        wideBrush.renderDab(layer->data().data(), kSize, kSize, 8, 8, 10, 0xFF2080C0, 1.0F);
+        REQUIRE(blur.apply(layer));
+
+        const auto actual = layer->pixelsAs(gimp::PixelFormat::Rgba8);
+        for (std::size_t i = 0; i < expected.size(); i += 4) {
+            // Color is meaningless where coverage is (nearly) zero
+            const int tolerance = expected[i + 3] < 8 ? 255 : 3;
+            REQUIRE(std::abs(actual[i + 3] - expected[i + 3]) <= 3);
+            for (std::size_t c = 0; c < 3; ++c) {
+                REQUIRE(std::abs(actual[i + c] - expected[i + c]) <= tolerance);
+            }
+        }
+    }
+}
+
+TEST_CASE("CpuCompositor composes float layers like 8-bit layers",
+          "[pixel_format][cpu_compositor][unit]")
+{
+    auto makeStack = [](gimp::PixelFormat format) {
+        gimp::LayerStack stack;
+        auto layer = std::make_shared<gimp::Layer>(8, 8);
+        for (std::size_t i = 0; i < layer->data().size(); i += 4) {
+            layer->data()[i + 0] = 250;
+            layer->data()[i + 2] = static_cast<std::uint8_t>(i % 200);
+            layer->data()[i + 3] = static_cast<std::uint8_t>(i % 256);
+        }
+        layer->setPixelFormat(format);
+        stack.addLayer(layer);
+        return stack;
+    };
+
+    gimp::CpuCompositor compositor;
+    const auto narrow = compositor.flatten(makeStack(gimp::PixelFormat::Rgba8), 8, 8);
+    for (const auto format : {gimp::PixelFormat::Rgba16, gimp::PixelFormat::Rgba32F}) {
+        const auto wide = compositor.flatten(makeStack(format), 8, 8);
+        REQUIRE(wide.size() == narrow.size());
+        for (std::size_t i = 0; i < wide.size(); ++i) {
+            REQUIRE(std::abs(wide[i] - narrow[i]) <= 1);
+        }
+    }
+}
@@ -0,0 +1,314 @@
+/**
+ * @file test_replayable_command.cpp
+ * @brief Unit tests for replayable commands and HistoryStack checkpoints.
+ * @author Laurent Jiang
+ * @date 2026-02-24
+ */
+
+#include "core/brush_strategy.h"
+#include "core/commands/filter_command.h"
+#include "core/commands/stroke_command.h"
+#include "core/filters/filter.h"
+#include "core/layer.h"
+#include "core/stroke_buffer.h"
+#include "core/stroke_recorder.h"
+#include "core/tile_buffer.h"
+
+#include "history/history_stack.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+/// Layer with a deterministic, non-uniform background.
+std::shared_ptr<gimp::Layer> makeLayer(int width, int height)
+{
+    auto layer = std::make_shared<gimp::Layer>(width, height);
+    auto& data = layer->data();
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = (i % 4 == 3) ? 255 : static_cast<std::uint8_t>(i * 13);
+    }
+    return layer;
+}
+
+/// A short diagonal soft stroke starting at (x, y).
+std::shared_ptr<gimp::StrokeCommand> makeStroke(const std::shared_ptr<gimp::Layer>& layer,
+                                                int x,
+                                                int y,
+                                                std::uint32_t color)
+{
+    gimp::StrokeParams params;
+    params.size = 12;
+    params.hardness = 0.3F;
+    params.color = color;
+    std::vector<gimp::StrokeDab> dabs;
+    for (int i = 0; i < 10; ++i) {
+        dabs.push_back({static_cast<float>(x + i * 3),
+                        static_cast<float>(y + i * 2),
+                        0.5F + 0.05F * static_cast<float>(i)});
+    }
+    return std::make_shared<gimp::StrokeCommand>(layer, params, std::move(dabs));
+}
+
+/// Inverts the color channels, blending by the "amount" parameter.
+class InvertFilter : public gimp::Filter {
+  public:
+    [[nodiscard]] std::string id() const override { return "invert"; }
+    [[nodiscard]] std::string name() const override { return "Invert"; }
+    [[nodiscard]] std::string description() const override { return "Inverts colors"; }
+
+    bool apply(std::shared_ptr<gimp::Layer> layer) override
+    {
+        if (!layer) {
+            return false;
+        }
+        auto& data = layer->data();
+        for (std::size_t i = 0; i < data.size(); ++i) {
+            if (i % 4 != 3) {
+                const float inverted = 255.0F - data[i];
+                data[i] = static_cast<std::uint8_t>(data[i] + (inverted - data[i]) * amount_);
+            }
+        }
+        return true;
+    }
+
+    bool setParameter(const std::string& name, float value) override
+    {
+        if (name != "amount") {
+            return false;
+        }
+        amount_ = value;
+        return true;
+    }
+
+    bool getParameter(const std::string& name, float& value) const override
+    {
+        if (name != "amount") {
+            return false;
+        }
+        value = amount_;
+        return true;
+    }
+
+    [[nodiscard]] float progress() const override { return 1.0F; }
+    [[nodiscard]] bool isRunning() const override { return false; }
+
+  private:
+    float amount_ = 1.0F;
+};
+
+}  // namespace
+
+TEST_CASE("StrokeCommand replays a live stroke exactly", "[replayable_command][unit]")
+{
+    auto layer = makeLayer(300, 200);
+    const auto before = layer->data();
+
+    // Render the dabs the way the paint tools do: record touched tiles,
+    // accumulate coverage and composite from the original pixels per frame
+    gimp::StrokeParams params;
+    params.brush = gimp::StrokeBrush::Eraser;
+    params.size = 16;
+    params.hardness = 0.4F;
+    params.opacity = 0.8F;
+    gimp::EraserBrush eraser;
+    eraser.setHardness(params.hardness);
+    eraser.setOpacity(params.opacity);
+
+    gimp::StrokeRecorder recorder;
+    recorder.begin(layer);
+    gimp::StrokeBuffer buffer;
+    buffer.begin(gimp::Rect{0, 0, layer->width(), layer->height()});
+    const auto composite = [&] {
+        const gimp::Rect dirty = buffer.takeDirty();
+        recorder.restoreRegion(dirty);
+        eraser.compositeStroke(layer->regionData(dirty), layer->width(), buffer, dirty, 0);
+    };
+    std::vector<gimp::StrokeDab> dabs;
+    for (int i = 0; i < 40; ++i) {
+        // Quarter-pixel steps exercise the sub-pixel masks
+        const gimp::StrokeDab dab{60.0F + 4.25F * static_cast<float>(i),
+                                  50.0F + 1.5F * static_cast<float>(i),
+                                  0.5F + 0.01F * static_cast<float>(i % 7)};
+        const gimp::Rect bounds = gimp::StrokeCommand::dabBounds(dab.x, dab.y, params.size);
+        recorder.record(bounds);
+        eraser.accumulateDab(buffer, dab.x, dab.y, params.size, dab.pressure);
+        buffer.markDirty(bounds);
+        dabs.push_back(dab);
+        if (i % 6 == 5) {
+            composite();
+        }
+    }
+    composite();
+    const auto after = layer->data();
+    REQUIRE(after != before);
+
+    auto command = std::make_shared<gimp::StrokeCommand>(layer, params, std::move(dabs));
+    command->adoptCheckpoint(recorder.finishSnapshot());
+    REQUIRE(command->hasCheckpoint());
+
+    // The first apply() finds the stroke already rendered
+    command->apply();
+    REQUIRE(layer->data() == after);
+
+    command->undo();
+    REQUIRE(layer->data() == before);
+    command->apply();
+    REQUIRE(layer->data() == after);
+}
+
+TEST_CASE("Checkpoints count only the tiles they hold alone", "[replayable_command][unit]")
+{
+    auto layer = makeLayer(256, 256);
+    const std::size_t layerBytes = 16 * gimp::TileBuffer::kTileBytes;
+
+    auto first = makeStroke(layer, 10, 20, 0xFF0000FFU);
+    first->apply();
+    auto second = makeStroke(layer, 150, 150, 0x00FF00FFU);
+    second->apply();
+
+    // The checkpoints share every tile the first stroke did not touch
+    REQUIRE(first->byteSize() < 4 * gimp::TileBuffer::kTileBytes + 1024);
+    REQUIRE(second->byteSize() < 4 * gimp::TileBuffer::kTileBytes + 1024);
+
+    second.reset();
+    REQUIRE(first->byteSize() >= layerBytes);
+}
+
+TEST_CASE("HistoryStack keeps a checkpoint every N replayable commands",
+          "[replayable_command][history_stack][unit]")
+{
+    auto layer = makeLayer(256, 256);
+    gimp::HistoryStack stack;
+    stack.set_checkpoint_interval(3);
+
+    std::vector<std::vector<std::uint8_t>> states{layer->data()};
+    std::vector<std::shared_ptr<gimp::StrokeCommand>> strokes;
+    for (int i = 0; i < 7; ++i) {
+        auto stroke = makeStroke(layer, 10 + i * 25, 20 + i * 20, 0xFF000080U + i * 0x00201000U);
+        stroke->apply();
+        stack.push(stroke);
+        strokes.push_back(stroke);
+        states.push_back(layer->data());
+    }
+
+    const std::vector<bool> expected{true, false, false, true, false, false, true};
+    for (std::size_t i = 0; i < strokes.size(); ++i) {
+        REQUIRE(strokes[i]->hasCheckpoint() == expected[i]);
+    }
+
+    // Undo replays from the nearest checkpoint and lands on the exact pixels
+    for (std::size_t i = strokes.size(); i > 0; --i) {
+        REQUIRE(stack.undo());
+        REQUIRE(layer->data() == states[i - 1]);
+    }
+    while (stack.redo()) {
+    }
+    REQUIRE(layer->data() == states.back());
+}
+
+TEST_CASE("HistoryStack keeps a checkpoint once replay cost adds up",
+          "[replayable_command][history_stack][unit]")
+{
+    auto layer = makeLayer(128, 128);
+    gimp::HistoryStack stack;
+    auto first = makeStroke(layer, 10, 10, 0x00FF00FFU);
+    stack.set_checkpoint_cost(first->replayCost() * 2);
+
+    std::vector<std::shared_ptr<gimp::StrokeCommand>> strokes{first};
+    first->apply();
+    stack.push(first);
+    for (int i = 1; i < 5; ++i) {
+        auto stroke = makeStroke(layer, 10 + i * 15, 40, 0x0000FFFFU);
+        stroke->apply();
+        stack.push(stroke);
+        strokes.push_back(stroke);
+    }
+
+    REQUIRE(strokes[0]->hasCheckpoint());
+    REQUIRE_FALSE(strokes[1]->hasCheckpoint());
+    REQUIRE(strokes[2]->hasCheckpoint());
+    REQUIRE_FALSE(strokes[3]->hasCheckpoint());
+    REQUIRE(strokes[4]->hasCheckpoint());
+}
+
+TEST_CASE("A replayable command on another layer starts a new run",
+          "[replayable_command][history_stack][unit]")
+{
+    auto first = makeLayer(64, 64);
+    auto second = makeLayer(64, 64);
+    gimp::HistoryStack stack;
+
+    auto a = makeStroke(first, 5, 5, 0xFF0000FFU);
+    auto b = makeStroke(second, 5, 5, 0xFF0000FFU);
+    auto c = makeStroke(first, 20, 5, 0xFF0000FFU);
+    for (const auto& stroke : {a, b, c}) {
+        stroke->apply();
+        stack.push(stroke);
+    }
+
+    REQUIRE(a->hasCheckpoint());
+    REQUIRE(b->hasCheckpoint());
+    REQUIRE(c->hasCheckpoint());
+}
+
+TEST_CASE("drop_oldest rebuilds the checkpoint the next command depends on",
+          "[replayable_command][history_stack][unit]")
+{
+    auto layer = makeLayer(200, 200);
+    gimp::HistoryStack stack;
+
+    std::vector<std::vector<std::uint8_t>> states{layer->data()};
+    std::vector<std::shared_ptr<gimp::StrokeCommand>> strokes;
+    for (int i = 0; i < 3; ++i) {
+        auto stroke = makeStroke(layer, 30 + i * 10, 30 + i * 30, 0x20C040FFU);
+        stroke->apply();
+        stack.push(stroke);
+        strokes.push_back(stroke);
+        states.push_back(layer->data());
+    }
+    REQUIRE_FALSE(strokes[1]->hasCheckpoint());
+
+    REQUIRE(stack.drop_oldest() > 0);
+    REQUIRE(strokes[1]->hasCheckpoint());
+    REQUIRE(stack.undo_size() == 2);
+
+    REQUIRE(stack.undo());
+    REQUIRE(layer->data() == states[2]);
+    REQUIRE(stack.undo());
+    REQUIRE(layer->data() == states[1]);
+}
+
+TEST_CASE("FilterCommand reruns its filter and undoes through the run",
+          "[replayable_command][history_stack][unit]")
+{
+    auto layer = makeLayer(96, 80);
+    const auto original = layer->data();
+    gimp::HistoryStack stack;
+
+    auto filter = std::make_shared<InvertFilter>();
+    REQUIRE(filter->setParameter("amount", 0.5F));
+    auto invert = std::make_shared<gimp::FilterCommand>(layer, filter);
+    invert->apply();
+    REQUIRE(invert->succeeded());
+    stack.push(invert);
+    const auto inverted = layer->data();
+    REQUIRE(inverted != original);
+
+    auto stroke = makeStroke(layer, 40, 20, 0x102030FFU);
+    stroke->apply();
+    stack.push(stroke);
+    REQUIRE_FALSE(stroke->hasCheckpoint());
+
+    REQUIRE(stack.undo());
+    REQUIRE(layer->data() == inverted);
+    REQUIRE(stack.undo());
+    REQUIRE(layer->data() == original);
+    REQUIRE(stack.redo());
+    REQUIRE(layer->data() == inverted);
+}
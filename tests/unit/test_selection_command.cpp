@@ -135,6 +135,38 @@ TEST_CASE("SelectionCommand handles multiple undo/redo cycles", "[selection_comm
     }
 }
 
+TEST_CASE("SelectionCommand merges a following selection change", "[selection_command][unit]")
+{
+    auto doc = std::make_shared<gimp::ProjectFile>(100, 100);
+    doc->addLayer();
+    gimp::SelectionManager::instance().setDocument(doc);
+    gimp::SelectionManager::instance().clear();
+
+    gimp::SelectionCommand first("Select Rect");
+    first.captureBeforeState();  // Empty
+    QPainterPath firstPath;
+    firstPath.addRect(10, 10, 20, 20);
+    gimp::SelectionManager::instance().applySelection(firstPath, gimp::SelectionMode::Replace);
+    first.captureAfterState();
+
+    gimp::SelectionCommand second("Grow Rect");
+    second.captureBeforeState();
+    QPainterPath secondPath;
+    secondPath.addRect(10, 10, 60, 60);
+    gimp::SelectionManager::instance().applySelection(secondPath, gimp::SelectionMode::Replace);
+    second.captureAfterState();
+
+    REQUIRE(first.mergeWith(second));
+
+    // Undo skips the intermediate selection entirely
+    first.undo();
+    REQUIRE_FALSE(gimp::SelectionManager::instance().hasSelection());
+
+    first.apply();
+    REQUIRE(gimp::SelectionManager::instance().selectionPath().boundingRect() ==
+            secondPath.boundingRect());
+}
+
 // ============================================================================
 // Edge Cases
 // ============================================================================
@@ -0,0 +1,141 @@
+/**
+ * @file test_stroke_buffer.cpp
+ * @brief Unit tests for StrokeBuffer and stroke compositing.
+ * @author Laurent Jiang
+ * @date 2026-03-02
+ */
+
+#include "core/brush_strategy.h"
+#include "core/stroke_buffer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+TEST_CASE("StrokeBuffer keeps the largest coverage of each pixel", "[stroke_buffer][unit]")
+{
+    gimp::StrokeBuffer buffer;
+    buffer.begin(gimp::Rect{10, 20, 8, 4});
+    REQUIRE(buffer.active());
+
+    const float first[] = {1.0F, 0.5F, 0.2F, 0.0F};
+    const float second[] = {0.1F, 0.8F, 0.2F, 1.0F};
+    buffer.accumulateRow(12, 21, first, 4, 1.0F);
+    buffer.accumulateRow(12, 21, second, 4, 0.5F);
+
+    std::uint8_t row[8] = {};
+    buffer.readRow(21, 10, 8, row);
+    const std::uint8_t expected[] = {0, 0, 255, 128, 51, 128, 0, 0};
+    for (int x = 0; x < 8; ++x) {
+        REQUIRE(row[x] == expected[x]);
+    }
+    buffer.readRow(20, 12, 1, row);
+    REQUIRE(row[0] == 0);
+}
+
+TEST_CASE("StrokeBuffer tracks the dirty area and the stroke bounds", "[stroke_buffer][unit]")
+{
+    gimp::StrokeBuffer buffer;
+    buffer.begin(gimp::Rect{0, 0, 100, 80});
+    REQUIRE(buffer.takeDirty().w == 0);
+
+    buffer.markDirty(gimp::Rect{-5, 10, 20, 10});
+    buffer.markDirty(gimp::Rect{30, 5, 10, 10});
+    const gimp::Rect dirty = buffer.takeDirty();
+    REQUIRE(dirty.x == 0);
+    REQUIRE(dirty.y == 5);
+    REQUIRE(dirty.w == 40);
+    REQUIRE(dirty.h == 15);
+    REQUIRE(buffer.takeDirty().w == 0);
+
+    // Regions outside the area are ignored
+    buffer.markDirty(gimp::Rect{90, 70, 20, 20});
+    buffer.markDirty(gimp::Rect{200, 0, 5, 5});
+    REQUIRE(buffer.takeDirty().h == 10);
+    const gimp::Rect& bounds = buffer.bounds();
+    REQUIRE(bounds.x == 0);
+    REQUIRE(bounds.y == 5);
+    REQUIRE(bounds.w == 100);
+    REQUIRE(bounds.h == 75);
+}
+
+TEST_CASE("StrokeBuffer clears the last stroke on reset", "[stroke_buffer][unit]")
+{
+    gimp::StrokeBuffer buffer;
+    buffer.begin(gimp::Rect{0, 0, 64, 64});
+    gimp::SoftBrush brush;
+    brush.accumulateDab(buffer, 20.0F, 20.0F, 16, 1.0F);
+    buffer.markDirty(gimp::Rect{10, 10, 21, 21});
+    std::uint8_t row[64] = {};
+    buffer.readRow(20, 20, 1, row);
+    REQUIRE(row[0] == 255);
+
+    buffer.reset();
+    REQUIRE_FALSE(buffer.active());
+    REQUIRE(buffer.allocatedTileCount() == 0);
+    buffer.begin(gimp::Rect{0, 0, 64, 64});
+    for (int y = 0; y < 64; ++y) {
+        buffer.readRow(y, 0, 64, row);
+        for (int x = 0; x < 64; ++x) {
+            REQUIRE(row[x] == 0);
+        }
+    }
+    REQUIRE(buffer.bounds().w == 0);
+}
+
+TEST_CASE("Overlapping dabs composite like the strongest one", "[stroke_buffer][unit]")
+{
+    constexpr int kSize = 40;
+    const gimp::Rect area{0, 0, kSize, kSize};
+    const auto composite = [&](gimp::BrushStrategy& brush, int dabs, std::uint32_t color) {
+        std::vector<std::uint8_t> pixels(kSize * kSize * 4, 200);
+        gimp::StrokeBuffer buffer;
+        buffer.begin(area);
+        for (int i = 0; i < dabs; ++i) {
+            brush.accumulateDab(buffer, 20.25F, 19.5F, 21, 0.8F);
+        }
+        buffer.markDirty(area);
+        brush.compositeStroke(pixels.data(), kSize, buffer, buffer.takeDirty(), color);
+        return pixels;
+    };
+
+    gimp::SoftBrush soft;
+    soft.setHardness(0.3F);
+    const auto once = composite(soft, 1, 0x2040607F);
+    REQUIRE(composite(soft, 5, 0x2040607F) == once);
+    REQUIRE(once[(20 * kSize + 20) * 4 + 3] < 255);
+
+    // The eraser applies its opacity to the whole stroke the same way
+    gimp::EraserBrush eraser;
+    eraser.setOpacity(0.5F);
+    const auto erased = composite(eraser, 1, 0);
+    REQUIRE(composite(eraser, 4, 0) == erased);
+    // Pressure 0.8 at half opacity removes 40% of the alpha under the center
+    REQUIRE(std::abs(erased[(20 * kSize + 20) * 4 + 3] - 120) <= 2);
+    REQUIRE(erased[(20 * kSize + 20) * 4] == 200);
+    REQUIRE(erased[3] == 200);
+}
+
+TEST_CASE("StrokeBuffer allocates only the tiles dabs write", "[stroke_buffer][unit]")
+{
+    gimp::StrokeBuffer buffer;
+    buffer.begin(gimp::Rect{0, 0, 4096, 4096});
+    REQUIRE(buffer.allocatedTileCount() == 0);
+
+    // A dab straddling a tile corner touches four tiles, nothing else
+    gimp::SoftBrush brush;
+    brush.accumulateDab(buffer, 128.0F, 128.0F, 16, 1.0F);
+    REQUIRE(buffer.allocatedTileCount() == 4);
+
+    // Tiles never written read as zero
+    std::uint8_t row[64] = {};
+    row[0] = 7;
+    buffer.readRow(3000, 2000, 64, row);
+    REQUIRE(std::all_of(std::begin(row), std::end(row), [](std::uint8_t c) { return c == 0; }));
+    buffer.readRow(128, 100, 56, row);
+    REQUIRE(row[28] == 255);
+}
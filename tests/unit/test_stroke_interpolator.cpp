@@ -0,0 +1,105 @@
+/**
+ * @file test_stroke_interpolator.cpp
+ * @brief Unit tests for StrokeInterpolator.
+ * @author Laurent Jiang
+ * @date 2026-03-01
+ */
+
+#include "core/stroke_interpolator.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+void append(std::vector<gimp::StrokeDab>& all, const std::vector<gimp::StrokeDab>& dabs)
+{
+    all.insert(all.end(), dabs.begin(), dabs.end());
+}
+
+}  // namespace
+
+TEST_CASE("StrokeInterpolator keeps spacing across input segments", "[stroke_interpolator][unit]")
+{
+    gimp::StrokeInterpolator interpolator;
+    interpolator.setSpacing(2.5F);
+
+    // Many events closer together than the spacing, then one far apart
+    std::vector<gimp::StrokeDab> dabs;
+    append(dabs, interpolator.begin(0.0F, 0.0F, 1.0F));
+    for (int i = 1; i <= 40; ++i) {
+        append(dabs, interpolator.addPoint(0.7F * static_cast<float>(i), 0.0F, 1.0F));
+    }
+    append(dabs, interpolator.addPoint(48.0F, 0.0F, 1.0F));
+    REQUIRE(interpolator.finish().empty());
+
+    REQUIRE(dabs.size() == 20);
+    for (std::size_t i = 0; i < dabs.size(); ++i) {
+        REQUIRE_THAT(dabs[i].x, WithinAbs(2.5 * static_cast<double>(i), 0.001));
+        REQUIRE(dabs[i].y == 0.0F);
+    }
+}
+
+TEST_CASE("StrokeInterpolator places sub-pixel dabs with interpolated pressure",
+          "[stroke_interpolator][unit]")
+{
+    gimp::StrokeInterpolator interpolator;
+    interpolator.setSpacing(1.0F);
+
+    REQUIRE(interpolator.begin(0.0F, 0.0F, 0.0F).size() == 1);
+    const auto& dabs = interpolator.addPoint(3.0F, 4.0F, 1.0F);
+    REQUIRE(dabs.size() == 5);
+    REQUIRE_THAT(dabs[0].x, WithinAbs(0.6, 0.001));
+    REQUIRE_THAT(dabs[0].y, WithinAbs(0.8, 0.001));
+    REQUIRE_THAT(dabs[0].pressure, WithinAbs(0.2, 0.001));
+    REQUIRE_THAT(dabs[4].x, WithinAbs(3.0, 0.001));
+    REQUIRE_THAT(dabs[4].pressure, WithinAbs(1.0, 0.001));
+
+    // Points that do not reach the next dab place nothing
+    REQUIRE(interpolator.addPoint(3.3F, 4.4F, 1.0F).empty());
+    REQUIRE(interpolator.lastPoint().x == 3.3F);
+
+    interpolator.reset();
+    REQUIRE_FALSE(interpolator.active());
+    REQUIRE(interpolator.addPoint(10.0F, 10.0F, 1.0F).empty());
+}
+
+TEST_CASE("StrokeInterpolator smoothing curves through the input points",
+          "[stroke_interpolator][unit]")
+{
+    gimp::StrokeInterpolator interpolator;
+    interpolator.setSpacing(0.5F);
+    interpolator.setSmoothing(true);
+
+    const float points[][2] = {{0.0F, 0.0F}, {20.0F, 0.0F}, {20.0F, 20.0F}, {0.0F, 20.0F}};
+    std::vector<gimp::StrokeDab> dabs;
+    append(dabs, interpolator.begin(points[0][0], points[0][1], 1.0F));
+    // A segment is placed once the point after it is known
+    REQUIRE(interpolator.addPoint(points[1][0], points[1][1], 1.0F).empty());
+    append(dabs, interpolator.addPoint(points[2][0], points[2][1], 1.0F));
+    append(dabs, interpolator.addPoint(points[3][0], points[3][1], 1.0F));
+    append(dabs, interpolator.finish());
+    REQUIRE_FALSE(interpolator.active());
+
+    // Every input point lies on the path, which bulges out around the corners
+    for (const auto& point : points) {
+        float nearest = 1e9F;
+        for (const auto& dab : dabs) {
+            nearest = std::min(nearest, std::hypot(dab.x - point[0], dab.y - point[1]));
+        }
+        REQUIRE(nearest <= 0.5F);
+    }
+    bool overshoots = false;
+    for (std::size_t i = 1; i < dabs.size(); ++i) {
+        overshoots = overshoots || dabs[i].x > 20.0F || dabs[i].y < 0.0F;
+        const float step = std::hypot(dabs[i].x - dabs[i - 1].x, dabs[i].y - dabs[i - 1].y);
+        REQUIRE(step <= 0.5F + 1e-3F);
+    }
+    REQUIRE(overshoots);
+}
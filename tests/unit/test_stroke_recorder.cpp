@@ -0,0 +1,138 @@
+/**
+ * @file test_stroke_recorder.cpp
+ * @brief Unit tests for StrokeRecorder.
+ * @author Laurent Jiang
+ * @date 2026-02-23
+ */
+
+#include "core/commands/draw_command.h"
+#include "core/layer.h"
+#include "core/stroke_recorder.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// Fills a region of the layer with a value, as a dab would.
+void paint(gimp::Layer& layer, const gimp::Rect& region, std::uint8_t value)
+{
+    const std::size_t pixelBytes = layer.bytesPerPixel();
+    for (int y = region.y; y < region.y + region.h; ++y) {
+        std::uint8_t* row = layer.row(y);
+        for (std::size_t i = region.x * pixelBytes; i < (region.x + region.w) * pixelBytes; ++i) {
+            row[i] = value;
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("StrokeRecorder only saves the tiles a stroke touches", "[stroke_recorder][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(1000, 700);
+    for (std::size_t i = 0; i < layer->data().size(); ++i) {
+        layer->data()[i] = static_cast<std::uint8_t>(i * 7);
+    }
+    const auto before = layer->data();
+
+    gimp::StrokeRecorder recorder;
+    recorder.begin(layer);
+    REQUIRE(recorder.active());
+
+    // Two overlapping dabs across a tile corner, one partly outside the layer
+    const gimp::Rect first{60, 60, 10, 10};
+    const gimp::Rect second{-5, 690, 20, 20};
+    recorder.record(first);
+    paint(*layer, first, 1);
+    recorder.record(first);
+    paint(*layer, first, 2);
+    recorder.record(second);
+    paint(*layer, gimp::Rect{0, 690, 15, 10}, 3);
+    REQUIRE(recorder.savedTileCount() == 5);
+    const auto after = layer->data();
+
+    auto command = recorder.finish(gimp::Rect{-5, 50, 100, 700});
+    REQUIRE(command);
+    REQUIRE_FALSE(recorder.active());
+    REQUIRE(recorder.savedTileCount() == 0);
+
+    command->undo();
+    REQUIRE(layer->data() == before);
+    command->apply();
+    REQUIRE(layer->data() == after);
+}
+
+TEST_CASE("StrokeRecorder handles wide formats and empty strokes", "[stroke_recorder][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(130, 70, gimp::PixelFormat::Rgba32F);
+    const auto before = layer->data();
+
+    gimp::StrokeRecorder recorder;
+    REQUIRE_FALSE(recorder.finish(gimp::Rect{0, 0, 10, 10}));
+
+    recorder.begin(layer);
+    recorder.record(gimp::Rect{120, 60, 20, 20});
+    paint(*layer, gimp::Rect{120, 60, 10, 10}, 0x3F);
+    const auto after = layer->data();
+
+    auto command = recorder.finish(gimp::Rect{100, 50, 40, 40});
+    REQUIRE(command);
+    command->undo();
+    REQUIRE(layer->data() == before);
+    command->apply();
+    REQUIRE(layer->data() == after);
+
+    recorder.begin(layer);
+    REQUIRE_FALSE(recorder.finish(gimp::Rect{200, 200, 10, 10}));
+    REQUIRE_FALSE(recorder.active());
+}
+
+TEST_CASE("StrokeRecorder restores the saved tiles", "[stroke_recorder][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(200, 100);
+    const auto before = layer->data();
+
+    gimp::StrokeRecorder recorder;
+    recorder.begin(layer);
+    recorder.record(gimp::Rect{50, 50, 100, 10});
+    paint(*layer, gimp::Rect{50, 50, 100, 10}, 9);
+    REQUIRE(layer->data() != before);
+
+    recorder.restore();
+    REQUIRE_FALSE(recorder.active());
+    REQUIRE(layer->data() == before);
+}
+
+TEST_CASE("StrokeRecorder restores a region and keeps recording", "[stroke_recorder][unit]")
+{
+    auto layer = std::make_shared<gimp::Layer>(200, 100, gimp::PixelFormat::Rgba16);
+    for (std::size_t i = 0; i < layer->data().size(); ++i) {
+        layer->data()[i] = static_cast<std::uint8_t>(i * 5);
+    }
+    const auto before = layer->data();
+
+    gimp::StrokeRecorder recorder;
+    recorder.begin(layer);
+    recorder.record(gimp::Rect{50, 50, 100, 10});
+    paint(*layer, gimp::Rect{50, 50, 100, 10}, 9);
+    const auto painted = layer->data();
+
+    // Rows 55 to 59 go back; rows 50 to 54 keep the paint
+    recorder.restoreRegion(gimp::Rect{40, 55, 200, 10});
+    REQUIRE(recorder.active());
+    const std::size_t rowBytes = layer->rowBytes();
+    for (int y = 0; y < layer->height(); ++y) {
+        const auto& expected = (y >= 55 && y < 60) ? before : painted;
+        const auto offset = static_cast<std::ptrdiff_t>(y * rowBytes);
+        REQUIRE(std::equal(layer->row(y), layer->row(y) + rowBytes, expected.begin() + offset));
+    }
+
+    recorder.restore();
+    REQUIRE(layer->data() == before);
+}
@@ -0,0 +1,195 @@
+/**
+ * @file test_tile_buffer.cpp
+ * @brief Unit tests for TileBuffer and Layer tile snapshots.
+ * @author Laurent Jiang
+ * @date 2026-02-14
+ */
+
+#include "core/layer.h"
+#include "core/tile_buffer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Fills a layer region with a solid RGBA color through the region accessor.
+ */
+void fillRegion(gimp::Layer& layer, const gimp::Rect& region, std::uint32_t rgba)
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(region.w * region.h) * 4U);
+    for (std::size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i + 0] = static_cast<std::uint8_t>((rgba >> 24) & 0xFF);
+        pixels[i + 1] = static_cast<std::uint8_t>((rgba >> 16) & 0xFF);
+        pixels[i + 2] = static_cast<std::uint8_t>((rgba >> 8) & 0xFF);
+        pixels[i + 3] = static_cast<std::uint8_t>(rgba & 0xFF);
+    }
+    layer.writeRegion(region, pixels.data());
+}
+
+}  // namespace
+
+TEST_CASE("TileBuffer computes tile grid for partial edge tiles", "[tile_buffer][unit]")
+{
+    gimp::TileBuffer buffer(130, 64);
+
+    REQUIRE(buffer.tilesX() == 3);
+    REQUIRE(buffer.tilesY() == 1);
+    REQUIRE(buffer.allocatedTileCount() == 0);
+    REQUIRE(buffer.byteSize() == 0);
+}
+
+TEST_CASE("TileBuffer round-trips rows across tile boundaries", "[tile_buffer][unit]")
+{
+    gimp::TileBuffer buffer(200, 100);
+
+    std::vector<std::uint8_t> row(100 * 4);
+    for (std::size_t i = 0; i < row.size(); ++i) {
+        row[i] = static_cast<std::uint8_t>(i % 251 + 1);
+    }
+    buffer.writeRow(70, 40, 100, row.data());
+
+    std::vector<std::uint8_t> readBack(100 * 4);
+    buffer.readRow(70, 40, 100, readBack.data());
+    REQUIRE(readBack == row);
+
+    // Pixels 40..139 span tiles 0, 1 and 2 of tile row 1
+    REQUIRE(buffer.allocatedTileCount() == 3);
+}
+
+TEST_CASE("TileBuffer does not allocate tiles for transparent writes", "[tile_buffer][unit]")
+{
+    gimp::TileBuffer buffer(128, 128);
+
+    std::vector<std::uint8_t> zeros(128 * 128 * 4, 0);
+    buffer.writeRegion({0, 0, 128, 128}, zeros.data(), 128 * 4);
+
+    REQUIRE(buffer.allocatedTileCount() == 0);
+}
+
+TEST_CASE("TileBuffer copies share tiles until written", "[tile_buffer][unit]")
+{
+    gimp::TileBuffer original(128, 128);
+    std::vector<std::uint8_t> pixel = {10, 20, 30, 255};
+    original.writeRow(0, 0, 1, pixel.data());
+    original.writeRow(100, 100, 1, pixel.data());
+
+    gimp::TileBuffer copy = original;
+    REQUIRE(copy.sharesTile(original, 0, 0));
+    REQUIRE(copy.sharesTile(original, 1, 1));
+    REQUIRE(original.exclusiveByteSize() == 0);
+
+    std::vector<std::uint8_t> other = {1, 2, 3, 4};
+    copy.writeRow(0, 0, 1, other.data());
+
+    REQUIRE_FALSE(copy.sharesTile(original, 0, 0));
+    REQUIRE(copy.sharesTile(original, 1, 1));
+
+    std::vector<std::uint8_t> readBack(4);
+    original.readRow(0, 0, 1, readBack.data());
+    REQUIRE(readBack == pixel);
+    copy.readRow(0, 0, 1, readBack.data());
+    REQUIRE(readBack == other);
+}
+
+TEST_CASE("Layer snapshots share tiles outside modified regions", "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(256, 256);
+    fillRegion(layer, {0, 0, 256, 256}, 0xFF0000FF);
+
+    gimp::TileBuffer first = layer.snapshot();
+    REQUIRE(first.allocatedTileCount() == 16);
+
+    fillRegion(layer, {10, 10, 4, 4}, 0x00FF00FF);
+    gimp::TileBuffer second = layer.snapshot();
+
+    REQUIRE_FALSE(second.sharesTile(first, 0, 0));
+    REQUIRE(second.sharesTile(first, 1, 0));
+    REQUIRE(second.sharesTile(first, 3, 3));
+}
+
+TEST_CASE("Layer snapshot keeps sharing when bulk access leaves pixels unchanged",
+          "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(128, 128);
+    fillRegion(layer, {0, 0, 128, 128}, 0x123456FF);
+
+    gimp::TileBuffer first = layer.snapshot();
+
+    // Mutable data() marks the whole layer dirty but nothing actually changes
+    (void)layer.data();
+    gimp::TileBuffer second = layer.snapshot();
+
+    REQUIRE(second.sharesTile(first, 0, 0));
+    REQUIRE(second.sharesTile(first, 1, 1));
+}
+
+TEST_CASE("Layer snapshots do not keep tiles alive", "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(128, 128);
+    fillRegion(layer, {0, 0, 128, 128}, 0xFF0000FF);
+
+    // The layer holds no reference, so the snapshot owns every tile
+    gimp::TileBuffer first = layer.snapshot();
+    REQUIRE(first.byteSize() == 4 * gimp::TileBuffer::kTileBytes);
+    REQUIRE(first.exclusiveByteSize() == first.byteSize());
+
+    // Tiles freed with the snapshot are copied again from the pixels
+    first = gimp::TileBuffer();
+    const gimp::TileBuffer second = layer.snapshot();
+    REQUIRE(second.allocatedTileCount() == 4);
+    std::vector<std::uint8_t> readBack(4);
+    second.readRow(100, 100, 1, readBack.data());
+    REQUIRE(readBack == std::vector<std::uint8_t>{0xFF, 0x00, 0x00, 0xFF});
+}
+
+TEST_CASE("Writing into a snapshot leaves the next snapshot intact", "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(128, 128);
+    fillRegion(layer, {0, 0, 128, 128}, 0xFF0000FF);
+
+    gimp::TileBuffer first = layer.snapshot();
+    const std::vector<std::uint8_t> black(4 * 4 * 4, 0);
+    first.writeRegion({0, 0, 4, 4}, black.data(), 4 * 4);
+
+    const gimp::TileBuffer second = layer.snapshot();
+    REQUIRE_FALSE(second.sharesTile(first, 0, 0));
+    REQUIRE(second.sharesTile(first, 1, 1));
+    std::vector<std::uint8_t> readBack(4);
+    second.readRow(0, 0, 1, readBack.data());
+    REQUIRE(readBack == std::vector<std::uint8_t>{0xFF, 0x00, 0x00, 0xFF});
+}
+
+TEST_CASE("Layer restore brings back snapshot pixels", "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(100, 70);
+    fillRegion(layer, {5, 5, 20, 20}, 0xAABBCCDD);
+
+    gimp::TileBuffer saved = layer.snapshot();
+    const std::vector<std::uint8_t> expected = layer.data();
+
+    fillRegion(layer, {0, 0, 100, 70}, 0x000000FF);
+    REQUIRE(layer.restore(saved));
+    REQUIRE(layer.data() == expected);
+
+    gimp::TileBuffer wrongSize(10, 10);
+    REQUIRE_FALSE(layer.restore(wrongSize));
+}
+
+TEST_CASE("Layer region accessors read back written pixels", "[tile_buffer][layer][unit]")
+{
+    gimp::Layer layer(32, 32);
+    fillRegion(layer, {8, 4, 3, 2}, 0x01020304);
+
+    std::vector<std::uint8_t> region(3 * 2 * 4);
+    layer.readRegion({8, 4, 3, 2}, region.data());
+    for (std::size_t i = 0; i < region.size(); i += 4) {
+        REQUIRE(region[i] == 0x01);
+        REQUIRE(region[i + 3] == 0x04);
+    }
+
+    REQUIRE(layer.row(4)[8 * 4] == 0x01);
+    REQUIRE(layer.row(3)[8 * 4] == 0x00);
+}
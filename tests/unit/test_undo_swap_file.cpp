@@ -0,0 +1,213 @@
+/**
+ * @file test_undo_swap_file.cpp
+ * @brief Unit tests for UndoSwapFile and undo history paging.
+ * @author Laurent Jiang
+ * @date 2026-02-22
+ */
+
+#include "core/commands/draw_command.h"
+#include "core/compressed_buffer.h"
+#include "core/layer.h"
+#include "core/tile_buffer.h"
+#include "core/undo_swap_file.h"
+#include "history/history_stack.h"
+#include "history/simple_history_manager.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace {
+
+/// Creates a DrawCommand for a full-layer stroke on a layer with noisy pixels.
+std::shared_ptr<gimp::DrawCommand> makeStroke(const std::shared_ptr<gimp::Layer>& layer,
+                                              std::uint8_t value)
+{
+    auto command = std::make_shared<gimp::DrawCommand>(layer, 0, 0, layer->width(),
+                                                       layer->height());
+    command->captureBeforeState();
+    auto& data = layer->data();
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>((i * 2654435761U) >> 13) ^ value;
+    }
+    command->captureAfterState();
+    return command;
+}
+
+}  // namespace
+
+TEST_CASE("UndoSwapFile reuses released extents", "[undo_swap_file][unit]")
+{
+    auto swap = gimp::UndoSwapFile::create();
+    REQUIRE(swap);
+    const auto path = swap->path();
+    REQUIRE(std::filesystem::exists(path));
+
+    const auto a = swap->allocate(100);
+    const auto b = swap->allocate(50);
+    REQUIRE(a);
+    REQUIRE(b);
+    REQUIRE_FALSE(swap->allocate(0));
+    REQUIRE(swap->usedBytes() == 150);
+
+    const std::vector<std::uint8_t> payload(50, 0xAB);
+    REQUIRE(swap->write(*b, 0, payload.data(), payload.size()));
+    REQUIRE_FALSE(swap->write(*b, 1, payload.data(), payload.size()));
+
+    swap->release(*a);
+    REQUIRE(swap->usedBytes() == 50);
+    const auto c = swap->allocate(80);
+    REQUIRE(c);
+    REQUIRE(c->offset == a->offset);
+
+    std::vector<std::uint8_t> readBack(50);
+    REQUIRE(swap->read(*b, 0, readBack.data(), readBack.size()));
+    REQUIRE(readBack == payload);
+
+    swap.reset();
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
+
+TEST_CASE("CompressedBuffer and SwappedTiles round-trip through the swap file",
+          "[undo_swap_file][unit]")
+{
+    auto swap = gimp::UndoSwapFile::create();
+    REQUIRE(swap);
+
+    std::vector<std::uint8_t> data(5000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<std::uint8_t>(i * 31);
+    }
+    auto compressed = gimp::CompressedBuffer::compress(data);
+    REQUIRE(compressed.spill(swap));
+    REQUIRE(compressed.spilled());
+    REQUIRE(compressed.byteSize() == 0);
+    REQUIRE(swap->usedBytes() > 0);
+
+    std::vector<std::uint8_t> restored;
+    REQUIRE_FALSE(compressed.decompress(restored));
+    REQUIRE(compressed.load());
+    REQUIRE(swap->usedBytes() == 0);
+    REQUIRE(compressed.decompress(restored));
+    REQUIRE(restored == data);
+
+    gimp::TileBuffer tiles(300, 200);
+    const std::vector<std::uint8_t> row(40 * 4, 0x5A);
+    tiles.writeRow(150, 260, 40, row.data());
+
+    gimp::SwappedTiles swapped;
+    REQUIRE(swapped.store(swap, tiles));
+    REQUIRE(swap->usedBytes() == tiles.allocatedTileCount() * gimp::TileBuffer::kTileBytes);
+
+    gimp::TileBuffer loaded;
+    REQUIRE(swapped.load(loaded));
+    REQUIRE(loaded.width() == 300);
+    REQUIRE(loaded.height() == 200);
+    REQUIRE(loaded.allocatedTileCount() == tiles.allocatedTileCount());
+    std::vector<std::uint8_t> readBack(row.size());
+    loaded.readRow(150, 260, 40, readBack.data());
+    REQUIRE(readBack == row);
+
+    swapped.reset();
+    REQUIRE(swapped.empty());
+    REQUIRE(swap->usedBytes() == 0);
+}
+
+TEST_CASE("Spilled DrawCommand faults its states back in", "[undo_swap_file][unit]")
+{
+    auto swap = gimp::UndoSwapFile::create();
+    REQUIRE(swap);
+    auto layer = std::make_shared<gimp::Layer>(128, 128);
+    const auto before = layer->data();
+    auto command = makeStroke(layer, 0x3C);
+    const auto after = layer->data();
+
+    REQUIRE(command->byteSize() > 0);
+    REQUIRE(command->spill(swap));
+    REQUIRE(command->byteSize() < 1024);
+    REQUIRE(swap->usedBytes() > 0);
+
+    command->undo();
+    REQUIRE(layer->data() == before);
+    REQUIRE(swap->usedBytes() == 0);
+    command->apply();
+    REQUIRE(layer->data() == after);
+}
+
+TEST_CASE("SimpleHistoryManager pages old steps out instead of dropping them",
+          "[undo_swap_file][unit]")
+{
+    auto swap = gimp::UndoSwapFile::create();
+    REQUIRE(swap);
+    auto stack = std::make_shared<gimp::HistoryStack>();
+    gimp::SimpleHistoryManager manager(stack);
+    manager.set_swap_file(swap);
+
+    auto layer = std::make_shared<gimp::Layer>(128, 128);
+    std::vector<std::vector<std::uint8_t>> states{layer->data()};
+    std::size_t strokeBytes = 0;
+    for (std::uint8_t i = 1; i <= 4; ++i) {
+        auto command = makeStroke(layer, i);
+        strokeBytes = command->byteSize();
+        states.push_back(layer->data());
+        manager.push(command);
+    }
+
+    // Room for a single step: the others go to disk and stay undoable
+    manager.set_memory_budget(strokeBytes + strokeBytes / 2);
+    REQUIRE(stack->undo_size() == 4);
+    REQUIRE(manager.byte_size() <= manager.memory_budget());
+    REQUIRE(manager.swap_size() > 0);
+
+    for (int i = 3; i >= 0; --i) {
+        manager.undo();
+        REQUIRE(layer->data() == states[static_cast<std::size_t>(i)]);
+    }
+
+    // Without disk room the oldest steps are evicted as before
+    manager.redo();
+    manager.redo();
+    manager.redo();
+    manager.set_swap_budget(0);
+    REQUIRE(manager.swap_size() == 0);
+    REQUIRE(stack->undo_size() < 3);
+}
+
+TEST_CASE("SwappedTiles writes only tiles no other buffer shares", "[undo_swap_file][unit]")
+{
+    auto swap = gimp::UndoSwapFile::create();
+    REQUIRE(swap);
+
+    // Two tiles; the second checkpoint rewrites only the right one
+    auto older = std::make_unique<gimp::TileBuffer>(128, 64);
+    const std::vector<std::uint8_t> left(4, 0x11);
+    const std::vector<std::uint8_t> right(4, 0x22);
+    older->writeRow(10, 10, 1, left.data());
+    older->writeRow(10, 70, 1, left.data());
+    gimp::TileBuffer newer = *older;
+    newer.writeRow(10, 70, 1, right.data());
+
+    gimp::SwappedTiles swapped;
+    REQUIRE(swapped.store(swap, newer));
+    REQUIRE(swap->usedBytes() == gimp::TileBuffer::kTileBytes);
+    newer = gimp::TileBuffer();
+    REQUIRE(swapped.residentByteSize() == 0);
+
+    gimp::TileBuffer loaded;
+    REQUIRE(swapped.load(loaded));
+    REQUIRE(loaded.sharesTile(*older, 0, 0));
+    REQUIRE_FALSE(loaded.sharesTile(*older, 1, 0));
+    std::vector<std::uint8_t> pixel(4);
+    loaded.readRow(10, 10, 1, pixel.data());
+    REQUIRE(pixel == left);
+    loaded.readRow(10, 70, 1, pixel.data());
+    REQUIRE(pixel == right);
+
+    // Once the other owners are gone the kept tile counts against the stored buffer
+    loaded = gimp::TileBuffer();
+    older.reset();
+    REQUIRE(swapped.residentByteSize() == gimp::TileBuffer::kTileBytes);
+}